@@ -2553,6 +2553,24 @@ void QCPAxisPainterPrivate::clearCache()
     mLabelCache.clear();
 }
 
+/*! \internal
+
+  Returns the number of bytes held by the pixmaps of the cached tick labels. Used for the plot's
+  memory accounting (\ref QCustomPlot::memoryReport).
+*/
+quint64 QCPAxisPainterPrivate::labelCacheBytes() const
+{
+    quint64 bytes = 0;
+    const QList<QString> keys = mLabelCache.keys();
+    for (const QString& key : keys)
+    {
+        if (const CachedLabel* label = mLabelCache.object(key))
+            bytes += quint64(label->pixmap.width()) * label->pixmap.height()
+                * qMax(1, label->pixmap.depth() / 8);
+    }
+    return bytes;
+}
+
 /*! \internal
 
   Returns a hash that allows uniquely identifying whether the label parameters have changed such
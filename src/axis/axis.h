@@ -492,6 +492,7 @@ public:
     virtual void draw(QCPPainter* painter);
     virtual int size();
     void clearCache();
+    quint64 labelCacheBytes() const;
 
     QRect axisSelectionBox() const { return mAxisSelectionBox; }
 
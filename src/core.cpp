@@ -146,7 +146,7 @@
 
   \a event is the mouse event that caused the click and \a plottable is the plottable that received
   the click. The parameter \a dataIndex indicates the data point that was closest to the click
-  position.
+  position. Indices beyond the range of int are clamped to \c INT_MAX.
 
   \see plottableDoubleClick
 */
@@ -158,7 +158,7 @@
 
   \a event is the mouse event that caused the click and \a plottable is the plottable that received
   the click. The parameter \a dataIndex indicates the data point that was closest to the click
-  position.
+  position. Indices beyond the range of int are clamped to \c INT_MAX.
 
   \see plottableClick
 */
@@ -501,6 +501,7 @@ QCustomPlot::QCustomPlot(QWidget* parent)
     connectThemeSignal();
 
     mPipelineScheduler = new QCPPipelineScheduler(0, this);
+    QCPMemoryBudget::instance().registerPlot(this);
 
     // No replot here — initialize() + resizeEvent() will handle the first replot once
     // the RHI backend is ready, avoiding throwaway pixmap buffer creation.
@@ -508,6 +509,7 @@ QCustomPlot::QCustomPlot(QWidget* parent)
 
 QCustomPlot::~QCustomPlot()
 {
+    QCPMemoryBudget::instance().unregisterPlot(this);
     // Release paint buffer GPU resources before QRhiWidget tears down the RHI
     qDeleteAll(mPlottableRhiLayers);
     mPlottableRhiLayers.clear();
@@ -656,6 +658,24 @@ void QCustomPlot::setMaxPipelineThreads(int count)
     mPipelineScheduler->setMaxThreads(count);
 }
 
+/*!
+  Sets whether this plot's background pipeline jobs draw from the process-wide budget shared by
+  all plots that enable it (\ref QCPPipelineScheduler::setSharedMaxThreads), rather than from a
+  budget of their own. Useful for dashboards of many plots.
+
+  Independently of this, jobs of plots that are hidden or scrolled out of view are served after
+  those of visible plots, and the plot under the mouse or with keyboard focus is served first.
+*/
+void QCustomPlot::setSharedPipelineScheduling(bool enabled)
+{
+    mPipelineScheduler->setShared(enabled);
+}
+
+bool QCustomPlot::sharedPipelineScheduling() const
+{
+    return mPipelineScheduler->isShared();
+}
+
 QCPOverlay* QCustomPlot::overlay()
 {
     if (!mOverlay) {
@@ -2129,6 +2149,8 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
 
     mReplotting = true;
     mReplotQueued = false;
+    mReplotTick = QCPMemoryBudget::instance().nextTick();
+    updatePipelineVisibility();
 
     if (mOverlay) {
         if (auto* notifLayer = layer(QLatin1String("notification"));
@@ -2145,10 +2167,22 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
     QElapsedTimer replotTimer;
     replotTimer.start();
 
+    QCPFrameProfile* profile = mFrameProfiling ? &mFrameProfile : nullptr;
+    if (profile)
+    {
+        profile->layers.clear();
+        profile->plottables.clear();
+        profile->layersSkipped = 0;
+    }
+
     updateLayout();
+    if (profile)
+        profile->layoutNs = replotTimer.nsecsElapsed();
     ensureAtLeastOneBufferDirty();
     // draw all layered objects (grid, axes, plottables, items, legend,...) into their buffers:
     setupPaintBuffers();
+    if (mFrameProfileHud)
+        updateFrameProfileHud();
     for (auto it = mPlottableRhiLayers.begin(); it != mPlottableRhiLayers.end(); ++it)
     {
         QCPLayer* layer = it.key();
@@ -2186,14 +2220,25 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
             it.value()->clear();
         }
     }
+    mActiveFrameProfile = profile;
     for (auto& layer : mLayers)
     {
-        if (QSharedPointer<QCPAbstractPaintBuffer> pb = layer->mPaintBuffer.toStrongRef();
-            pb && pb->contentDirty() && !layer->canSkipRepaintForTranslation())
+        QSharedPointer<QCPAbstractPaintBuffer> pb = layer->mPaintBuffer.toStrongRef();
+        if (!pb || !pb->contentDirty())
+            continue;
+        if (layer->canSkipRepaintForTranslation())
         {
-            layer->drawToPaintBuffer();
+            if (profile)
+                ++profile->layersSkipped;
+            continue;
         }
+        QElapsedTimer layerTimer;
+        layerTimer.start();
+        layer->drawToPaintBuffer();
+        if (profile)
+            profile->layers.append({layer->name(), layerTimer.nsecsElapsed()});
     }
+    mActiveFrameProfile = nullptr;
     for (auto& buffer : mPaintBuffers)
     {
         buffer->setInvalidated(false);
@@ -2205,6 +2250,8 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
     update();
 
     mReplotTime = replotTimer.nsecsElapsed() * 1e-6;
+    if (profile)
+        profile->replotNs = replotTimer.nsecsElapsed();
 
     if (!qFuzzyIsNull(mReplotTimeAverage))
         mReplotTimeAverage = mReplotTimeAverage * 0.9
@@ -2214,6 +2261,11 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
         mReplotTimeAverage
             = mReplotTime; // no previous replots to average with, so initialize with replot time
 
+    // Caches just built count toward the process-wide budget right away.
+    QCPMemoryBudget& budget = QCPMemoryBudget::instance();
+    if (budget.limit() > 0)
+        budget.enforce();
+
     emit afterReplot();
     mReplotting = false;
 }
@@ -2229,6 +2281,103 @@ double QCustomPlot::replotTime(bool average) const
     return average ? mReplotTimeAverage : mReplotTime;
 }
 
+/*!
+  Sets whether each replot and rendered frame records where its time went: 
+ef updateLayout, the
+  repaint of each layer and the 
+ef QCPAbstractPlottable::draw of each plottable, the layers
+  skipped because they were only translated, and the CPU time and GPU upload volume of the frame.
+  The result of the last replot and frame is returned by 
+ef frameProfile.
+
+  Profiling costs a timer read per layer and plottable, so it can stay enabled in release builds.
+
+  \see setFrameProfileHud
+*/
+void QCustomPlot::setFrameProfiling(bool enabled)
+{
+    mFrameProfiling = enabled;
+    if (!enabled)
+        mFrameProfile = QCPFrameProfile();
+}
+
+/*!
+  Sets whether the summary of the last frame profile (
+ef QCPFrameProfile::summary) is shown on
+  the plot through its 
+ef overlay. Enabling the HUD enables frame profiling. While the HUD is on,
+  it replaces any message shown on the overlay; disabling it clears the overlay.
+
+  The HUD shows the profile of the previous replot and frame, updated on each replot.
+*/
+void QCustomPlot::setFrameProfileHud(bool enabled)
+{
+    if (mFrameProfileHud == enabled)
+        return;
+    mFrameProfileHud = enabled;
+    if (enabled)
+        mFrameProfiling = true;
+    else if (mOverlay)
+        mOverlay->clearMessage();
+    replot(rpQueuedReplot);
+}
+
+/*! \internal
+
+  Puts the current frame profile on the overlay, without queuing another replot, and marks the
+  overlay's paint buffer for repaint. Called by \ref replot once the paint buffers are set up.
+*/
+void QCustomPlot::updateFrameProfileHud()
+{
+    QCPOverlay* hud = overlay();
+    hud->setMessage(mFrameProfile.summary(), QCPOverlay::Info, QCPOverlay::FitContent,
+                    QCPOverlay::Bottom);
+    if (QCPLayer* hudLayer = hud->layer())
+    {
+        if (QSharedPointer<QCPAbstractPaintBuffer> pb = hudLayer->mPaintBuffer.toStrongRef())
+            pb->setContentDirty(true);
+    }
+}
+
+/*!
+  Returns the bytes held by the caches of this plot: its paint buffers, the GPU layers batching
+  plottable lines and scatters, and the axis label caches, plus what each plottable reports through
+  \ref QCPAbstractPlottable::accountMemory. Paint buffers are estimated from their pixel size.
+
+  Accounting only reads sizes, so it is cheap enough to call on every replot, which \ref
+  QCPMemoryBudget does once a limit is set.
+
+  \see QCPMemoryReport::summary
+*/
+QCPMemoryReport QCustomPlot::memoryReport() const
+{
+    QCPMemoryReport report;
+    for (const QSharedPointer<QCPAbstractPaintBuffer>& buffer : mPaintBuffers)
+    {
+        const double dpr = buffer->devicePixelRatio();
+        report.plot.add(QCPMemoryUsage::msPaintBuffers,
+                        quint64(buffer->size().width() * dpr) * quint64(buffer->size().height() * dpr) * 4);
+    }
+    for (const QCPPlottableRhiLayer* layer : mPlottableRhiLayers)
+        report.plot.add(QCPMemoryUsage::msGpuBuffers, layer->memoryBytes());
+    for (const QCPScatterRhiLayer* layer : mScatterRhiLayers)
+        report.plot.add(QCPMemoryUsage::msGpuBuffers, layer->memoryBytes());
+    for (const QCPAxisRect* rect : axisRects())
+    {
+        for (const QCPAxis* axis : rect->axes())
+            report.plot.add(QCPMemoryUsage::msLabelCache, axis->mAxisPainter->labelCacheBytes());
+    }
+
+    report.plottables.reserve(mPlottables.size());
+    for (QCPAbstractPlottable* plottable : mPlottables)
+    {
+        QCPMemoryReport::PlottableUsage entry{plottable, plottable->name(), {}};
+        plottable->accountMemory(entry.usage);
+        report.plottables.append(entry);
+    }
+    return report;
+}
+
 /*!
   Rescales the axes such that all plottables (like graphs) in the plot are fully visible.
 
@@ -2910,14 +3059,30 @@ void QCustomPlot::render(QRhiCommandBuffer* cb)
         return;
     }
 
+    QElapsedTimer renderTimer;
+    renderTimer.start();
+
     const QSize outputSize = renderTarget()->pixelSize();
     QRhiResourceUpdateBatch* updates = mRhi->nextResourceUpdateBatch();
 
     uploadLayerTextures(updates, outputSize);
+    if (mFrameProfiling)
+    {
+        quint64 uploaded = 0;
+        for (auto* prl : std::as_const(mPlottableRhiLayers))
+            uploaded += prl->uploadedBytes();
+        for (auto* srl : std::as_const(mScatterRhiLayers))
+            uploaded += srl->uploadedBytes();
+        for (auto* crl : std::as_const(mColormapRhiLayers))
+            uploaded += crl->ownerVisible() ? crl->uploadedBytes() : 0;
+        mFrameProfile.uploadedBytes = uploaded;
+    }
     ensureCompositePipeline();
     if (!mCompositePipeline)
         return;
     executeRenderPass(cb, updates, outputSize);
+    if (mFrameProfiling)
+        mFrameProfile.renderNs = renderTimer.nsecsElapsed();
 }
 
 /*! \internal
@@ -3011,10 +3176,8 @@ void QCustomPlot::mouseDoubleClickEvent(QMouseEvent* event)
     {
         if (QCPAbstractPlottable* ap = qobject_cast<QCPAbstractPlottable*>(candidates.first()))
         {
-            int dataIndex = 0;
-            if (!details.first().value<QCPDataSelection>().isEmpty())
-                dataIndex = details.first().value<QCPDataSelection>().dataRange().begin();
-            emit plottableDoubleClick(ap, dataIndex, event);
+            emit plottableDoubleClick(
+                ap, signalDataIndex(details.first().value<QCPDataSelection>()), event);
         }
         else if (QCPAxis* ax = qobject_cast<QCPAxis*>(candidates.first()))
             emit axisDoubleClick(ax, details.first().value<QCPAxis::SelectablePart>(), event);
@@ -3173,11 +3336,9 @@ void QCustomPlot::mouseReleaseEvent(QMouseEvent* event)
         // emit specialized click signals of QCustomPlot instance:
         if (QCPAbstractPlottable* ap = qobject_cast<QCPAbstractPlottable*>(mMouseSignalLayerable))
         {
-            int dataIndex = 0;
-            if (!mMouseSignalLayerableDetails.value<QCPDataSelection>().isEmpty())
-                dataIndex
-                    = mMouseSignalLayerableDetails.value<QCPDataSelection>().dataRange().begin();
-            emit plottableClick(ap, dataIndex, event);
+            emit plottableClick(
+                ap, signalDataIndex(mMouseSignalLayerableDetails.value<QCPDataSelection>()),
+                event);
         }
         else if (QCPAxis* ax = qobject_cast<QCPAxis*>(mMouseSignalLayerable))
             emit axisClick(ax, mMouseSignalLayerableDetails.value<QCPAxis::SelectablePart>(),
@@ -3261,6 +3422,72 @@ void QCustomPlot::keyPressEvent(QKeyEvent* event)
     QRhiWidget::keyPressEvent(event);
 }
 
+void QCustomPlot::showEvent(QShowEvent* event)
+{
+    QRhiWidget::showEvent(event);
+    updatePipelineVisibility();
+}
+
+void QCustomPlot::hideEvent(QHideEvent* event)
+{
+    QRhiWidget::hideEvent(event);
+    updatePipelineVisibility();
+}
+
+void QCustomPlot::enterEvent(QEnterEvent* event)
+{
+    QRhiWidget::enterEvent(event);
+    updatePipelineVisibility();
+}
+
+void QCustomPlot::leaveEvent(QEvent* event)
+{
+    QRhiWidget::leaveEvent(event);
+    updatePipelineVisibility();
+}
+
+void QCustomPlot::focusInEvent(QFocusEvent* event)
+{
+    QRhiWidget::focusInEvent(event);
+    updatePipelineVisibility();
+}
+
+void QCustomPlot::focusOutEvent(QFocusEvent* event)
+{
+    QRhiWidget::focusOutEvent(event);
+    updatePipelineVisibility();
+}
+
+/*! \internal
+
+  Ranks this plot's pipeline jobs against those of other plots by how much the user sees of it.
+  Called from the visibility, hover and focus events, and on each replot to catch plots scrolled
+  out of view (which receive no event of their own).
+*/
+void QCustomPlot::updatePipelineVisibility()
+{
+    QCPPipelineScheduler::Visibility visibility = QCPPipelineScheduler::Visible;
+    if (!isVisible() || visibleRegion().isEmpty())
+        visibility = QCPPipelineScheduler::Hidden;
+    else if (underMouse() || hasFocus())
+        visibility = QCPPipelineScheduler::Focused;
+    mPipelineScheduler->setVisibility(visibility);
+}
+
+/*! \internal
+
+  The data index reported by \ref plottableClick, \ref plottableDoubleClick and \ref plottableAt:
+  the first index of \a selection, or 0 if it is empty. Data indices are 64-bit, but these keep
+  their int signature for compatibility, so indices past \c INT_MAX are clamped.
+*/
+int QCustomPlot::signalDataIndex(const QCPDataSelection& selection)
+{
+    if (selection.isEmpty())
+        return 0;
+    return static_cast<int>(
+        std::min<qsizetype>(selection.dataRange().begin(), std::numeric_limits<int>::max()));
+}
+
 /*! \internal
 
   This function draws the entire plot, including background pixmap, with the specified \a painter.
@@ -3594,7 +3821,7 @@ void QCustomPlot::legendRemoved(QCPLegend* legend)
 void QCustomPlot::processRectSelection(QRect rect, QMouseEvent* event)
 {
     using SelectionCandidate = QPair<QCPAbstractPlottable*, QCPDataSelection>;
-    using SelectionCandidates = QMultiMap<int, SelectionCandidate>; // map key is number of selected data points, so we have selections sorted by size
+    using SelectionCandidates = QMultiMap<qsizetype, SelectionCandidate>; // map key is number of selected data points, so we have selections sorted by size
 
     bool selectionStateChanged = false;
 
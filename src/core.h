@@ -28,7 +28,9 @@
 
 #include "axis/axis.h"
 #include "axis/range.h"
+#include "frame-profile.h"
 #include "global.h"
+#include "memory-usage.h"
 #include "painting/paintbuffer.h"
 #include "plottables/plottable.h"
 
@@ -231,6 +233,8 @@ public:
     // pipeline:
     [[nodiscard]] QCPPipelineScheduler* pipelineScheduler() const { return mPipelineScheduler; }
     void setMaxPipelineThreads(int count);
+    void setSharedPipelineScheduling(bool enabled);
+    [[nodiscard]] bool sharedPipelineScheduling() const;
 
     // non-property methods:
     // plottable interface:
@@ -313,6 +317,14 @@ public:
     void toPainter(QCPPainter* painter, int width = 0, int height = 0);
     Q_SLOT void replot(QCustomPlot::RefreshPriority refreshPriority = QCustomPlot::rpImmediateRefresh);
     [[nodiscard]] double replotTime(bool average = false) const;
+    // frame profiling:
+    void setFrameProfiling(bool enabled);
+    [[nodiscard]] bool frameProfiling() const { return mFrameProfiling; }
+    [[nodiscard]] const QCPFrameProfile& frameProfile() const { return mFrameProfile; }
+    void setFrameProfileHud(bool enabled);
+    [[nodiscard]] bool frameProfileHud() const { return mFrameProfileHud; }
+    // memory accounting (see QCPMemoryBudget for the process-wide limit):
+    [[nodiscard]] QCPMemoryReport memoryReport() const;
 
     QCPAxis *xAxis, *yAxis, *xAxis2, *yAxis2;
     QCPLegend* legend;
@@ -380,6 +392,14 @@ protected:
     bool mReplotting;
     bool mReplotQueued;
     double mReplotTime, mReplotTimeAverage;
+    bool mFrameProfiling = false;
+    bool mFrameProfileHud = false;
+    QCPFrameProfile mFrameProfile;
+    // Set while replot() draws the layers, so QCPLayer::draw times plottables.
+    QCPFrameProfile* mActiveFrameProfile = nullptr;
+    // Stamped on each replot; QCPLayer::draw copies it to the plottables it
+    // draws, for QCPMemoryBudget's least-recently-drawn order.
+    quint64 mReplotTick = 0;
     // RHI compositing resources (mRhi cached from rhi() in initialize(); Qt docs only guarantee
     // rhi() during initialize/render/releaseResources, but the pointer is stable in practice):
     QRhi* mRhi = nullptr;
@@ -419,6 +439,12 @@ protected:
     virtual void mouseReleaseEvent(QMouseEvent* event) override;
     virtual void wheelEvent(QWheelEvent* event) override;
     virtual void keyPressEvent(QKeyEvent* event) override;
+    virtual void showEvent(QShowEvent* event) override;
+    virtual void hideEvent(QHideEvent* event) override;
+    virtual void enterEvent(QEnterEvent* event) override;
+    virtual void leaveEvent(QEvent* event) override;
+    virtual void focusInEvent(QFocusEvent* event) override;
+    virtual void focusOutEvent(QFocusEvent* event) override;
 
     // introduced virtual methods:
     virtual void draw(QCPPainter* painter);
@@ -444,6 +470,9 @@ protected:
     QCPAbstractPaintBuffer* createPaintBuffer(const QString& layerName);
     bool hasInvalidatedPaintBuffers();
     void ensureAtLeastOneBufferDirty();
+    void updatePipelineVisibility();
+    void updateFrameProfileHud();
+    static int signalDataIndex(const QCPDataSelection& selection);
     friend class QCPLegend;
     friend class QCPAxis;
     friend class QCPLayer;
@@ -515,7 +544,7 @@ PlottableType* QCustomPlot::plottableAt(const QPointF& pos, bool onlySelectable,
     {
         QCPDataSelection sel = resultDetails.value<QCPDataSelection>();
         if (!sel.isEmpty())
-            *dataIndex = sel.dataRange(0).begin();
+            *dataIndex = signalDataIndex(sel);
     }
     return resultPlottable;
 }
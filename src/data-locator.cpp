@@ -81,7 +81,7 @@ bool QCPDataLocator::locateGraph2(const QPointF& pixelPos)
     if (sel.dataRangeCount() == 0)
         return false;
 
-    int index = sel.dataRange(0).begin();
+    qsizetype index = sel.dataRange(0).begin();
     auto* src = g2->dataSource();
     if (!src || index < 0 || index >= src->size())
         return false;
@@ -154,7 +154,7 @@ bool QCPDataLocator::locateColorMap2(const QPointF& pixelPos)
 
     // findXBegin uses expandedRange (for viewport rendering), so it may be one
     // index before the actual nearest. Compare with neighbor to find true nearest.
-    int xi = std::clamp(src->findXBegin(key), 0, src->xSize() - 1);
+    qsizetype xi = std::clamp<qsizetype>(src->findXBegin(key), 0, src->xSize() - 1);
     if (xi + 1 < src->xSize()
         && std::abs(src->xAt(xi + 1) - key) < std::abs(src->xAt(xi) - key))
         ++xi;
@@ -169,7 +169,7 @@ bool QCPDataLocator::locateColorMap2(const QPointF& pixelPos)
     mKey = key;
     mValue = value;
     mData = src->zAt(xi, yj);
-    mDataIndex = xi * src->ySize() + yj;
+    mDataIndex = xi * static_cast<qsizetype>(src->ySize()) + yj;
     mHitPlottable = mPlottable;
     mValid = true;
     return true;
@@ -217,7 +217,7 @@ bool QCPDataLocator::locateMultiGraph(const QPointF& pixelPos)
     // the index refers to resampled (L2) data rather than the source.
     mKey = map["key"].toDouble();
     mValue = map["value"].toDouble();
-    mDataIndex = map["dataIndex"].toInt();
+    mDataIndex = map["dataIndex"].toLongLong();
     mHitPlottable = mPlottable;
     mValid = true;
     return true;
@@ -291,11 +291,11 @@ bool QCPDataLocator::locateGraph2AtKey(double key)
     if (!src || src->size() == 0)
         return false;
 
-    int idx = src->findEnd(key, false);
-    int lo = std::max(0, idx - 1);
-    int hi = std::min(idx, src->size() - 1);
+    qsizetype idx = src->findEnd(key, false);
+    qsizetype lo = std::max<qsizetype>(0, idx - 1);
+    qsizetype hi = std::min<qsizetype>(idx, src->size() - 1);
 
-    int nearest = lo;
+    qsizetype nearest = lo;
     if (lo != hi && std::abs(src->keyAt(hi) - key) < std::abs(src->keyAt(lo) - key))
         nearest = hi;
 
@@ -314,11 +314,11 @@ bool QCPDataLocator::locateMultiGraphAtKey(double key)
     if (!src || src->size() == 0)
         return false;
 
-    int idx = src->findEnd(key, false);
-    int lo = std::max(0, idx - 1);
-    int hi = std::min(idx, src->size() - 1);
+    qsizetype idx = src->findEnd(key, false);
+    qsizetype lo = std::max<qsizetype>(0, idx - 1);
+    qsizetype hi = std::min<qsizetype>(idx, src->size() - 1);
 
-    int nearest = lo;
+    qsizetype nearest = lo;
     if (lo != hi && std::abs(src->keyAt(hi) - key) < std::abs(src->keyAt(lo) - key))
         nearest = hi;
 
@@ -351,7 +351,7 @@ bool QCPDataLocator::locateColorMap2AtKey(double key, double value)
     if (foundY && (value < yr.lower || value > yr.upper))
         return false;
 
-    int xi = std::clamp(src->findXBegin(key), 0, src->xSize() - 1);
+    qsizetype xi = std::clamp<qsizetype>(src->findXBegin(key), 0, src->xSize() - 1);
     if (xi + 1 < src->xSize()
         && std::abs(src->xAt(xi + 1) - key) < std::abs(src->xAt(xi) - key))
         ++xi;
@@ -367,7 +367,7 @@ bool QCPDataLocator::locateColorMap2AtKey(double key, double value)
     mKey = src->xAt(xi);
     mValue = src->yAt(xi, yj);
     mData = src->zAt(xi, yj);
-    mDataIndex = xi * src->ySize() + yj;
+    mDataIndex = xi * static_cast<qsizetype>(src->ySize()) + yj;
     mHitPlottable = mPlottable;
     mValid = true;
     return true;
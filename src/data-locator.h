@@ -21,7 +21,7 @@ public:
     double key() const { return mKey; }
     double value() const { return mValue; }
     double data() const { return mData; }
-    int dataIndex() const { return mDataIndex; }
+    qsizetype dataIndex() const { return mDataIndex; }
     const QVector<double>& componentValues() const { return mComponentValues; }
     QCPAbstractPlottable* plottable() const { return mPlottable; }
     QCPAbstractPlottable* hitPlottable() const { return mHitPlottable; }
@@ -33,7 +33,7 @@ private:
     double mKey = 0;
     double mValue = 0;
     double mData = std::numeric_limits<double>::quiet_NaN();
-    int mDataIndex = -1;
+    qsizetype mDataIndex = -1;
     QVector<double> mComponentValues;
 
     bool locateGraph(const QPointF& pixelPos);
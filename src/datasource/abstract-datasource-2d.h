@@ -2,29 +2,70 @@
 #include "abstract-datasource.h" // for IndexableNumericRange concept, QCPRange
 #include "global.h"              // for QCP::SignDomain
 
+#include <cstdint>
+#include <type_traits>
+
+// Type-erased pointer to a source's contiguous storage. Hot loops dispatch
+// once on `type` and then index the array in its native element type.
+struct QCPRawArray
+{
+    enum class Type { None, Float64, Float32, Int8, UInt8, Int16, UInt16, Int32, UInt32, Int64, UInt64 };
+
+    const void* data = nullptr;
+    Type type = Type::None;
+
+    template <typename T>
+    static constexpr Type typeOf()
+    {
+        if constexpr (std::is_same_v<T, double>) return Type::Float64;
+        else if constexpr (std::is_same_v<T, float>) return Type::Float32;
+        else if constexpr (std::is_same_v<T, std::int8_t>) return Type::Int8;
+        else if constexpr (std::is_same_v<T, std::uint8_t>) return Type::UInt8;
+        else if constexpr (std::is_same_v<T, std::int16_t>) return Type::Int16;
+        else if constexpr (std::is_same_v<T, std::uint16_t>) return Type::UInt16;
+        else if constexpr (std::is_same_v<T, std::int32_t>) return Type::Int32;
+        else if constexpr (std::is_same_v<T, std::uint32_t>) return Type::UInt32;
+        else if constexpr (std::is_same_v<T, std::int64_t>) return Type::Int64;
+        else if constexpr (std::is_same_v<T, std::uint64_t>) return Type::UInt64;
+        else return Type::None;
+    }
+
+    template <typename T>
+    static QCPRawArray of(const T* p)
+    {
+        constexpr Type t = typeOf<T>();
+        return t == Type::None ? QCPRawArray{} : QCPRawArray{p, t};
+    }
+
+    bool isNull() const { return data == nullptr || type == Type::None; }
+};
+
+// x indices (and the flat x * ySize + y cell index) are qsizetype; the y
+// dimension stays int — it is a channel count, not a sample count.
 class QCPAbstractDataSource2D
 {
 public:
     virtual ~QCPAbstractDataSource2D() = default;
 
-    virtual int xSize() const = 0;
+    virtual qsizetype xSize() const = 0;
     virtual int ySize() const = 0;
     virtual bool yIs2D() const = 0;
 
-    virtual double xAt(int i) const = 0;
-    virtual double yAt(int i, int j) const = 0;
-    virtual double zAt(int i, int j) const = 0;
+    virtual double xAt(qsizetype i) const = 0;
+    virtual double yAt(qsizetype i, int j) const = 0;
+    virtual double zAt(qsizetype i, int j) const = 0;
 
     virtual QCPRange xRange(bool& found, QCP::SignDomain sd = QCP::sdBoth) const = 0;
     virtual QCPRange yRange(bool& found, QCP::SignDomain sd = QCP::sdBoth) const = 0;
-    virtual QCPRange zRange(bool& found, int xBegin = 0, int xEnd = -1) const = 0;
+    virtual QCPRange zRange(bool& found, qsizetype xBegin = 0, qsizetype xEnd = -1) const = 0;
 
-    virtual int findXBegin(double sortKey) const = 0;
-    virtual int findXEnd(double sortKey) const = 0;
+    virtual qsizetype findXBegin(double sortKey) const = 0;
+    virtual qsizetype findXEnd(double sortKey) const = 0;
 
-    // Raw pointer access for hot loops (avoids virtual dispatch per element).
-    // Returns nullptr by default; concrete sources override to expose raw arrays.
-    virtual const double* rawX() const { return nullptr; }
-    virtual const double* rawY() const { return nullptr; }
-    virtual const double* rawZ() const { return nullptr; }
+    // Raw array access for hot loops (avoids virtual dispatch per element),
+    // tagged with the element type so float32/uint16 spectrograms keep their
+    // footprint. Null by default; concrete sources override to expose storage.
+    virtual QCPRawArray rawX() const { return {}; }
+    virtual QCPRawArray rawY() const { return {}; }
+    virtual QCPRawArray rawZ() const { return {}; }
 };
@@ -1,6 +1,7 @@
 #pragma once
 #include "global.h"
 #include "axis/range.h"
+#include "pixel-line.h"
 #include <QPointF>
 #include <QVector>
 #include <algorithm>
@@ -20,13 +21,20 @@ template <typename C>
 concept ContiguousNumericRange = IndexableNumericRange<C>
     && std::ranges::contiguous_range<C>;
 
+// Access-pattern hints for sources backed by paged storage (memory-mapped
+// files): the L1 build announces a sequential scan, the plottables the samples
+// around the viewport. In-memory sources ignore them.
+enum class QCPAccessHint { Normal, Sequential, WillNeed };
+
 // Non-templated abstract base class for all data sources.
 // QCPGraph2 holds a pointer to this; virtual dispatch happens once per render.
+// Sample indices and counts are qsizetype (64-bit on 64-bit platforms): a
+// single series may hold more than 2^31 samples (e.g. memory-mapped archives).
 class QCPAbstractDataSource {
 public:
     virtual ~QCPAbstractDataSource() = default;
 
-    virtual int size() const = 0;
+    virtual qsizetype size() const = 0;
     virtual bool empty() const { return size() == 0; }
 
     // Range queries (for axis auto-scaling)
@@ -51,8 +59,8 @@ public:
         double kLo = std::numeric_limits<double>::infinity(), kHi = -kLo;
         double vLo = kLo, vHi = -kLo;
         bool any = false;
-        const int n = size();
-        for (int i = 0; i < n; ++i)
+        const qsizetype n = size();
+        for (qsizetype i = 0; i < n; ++i)
         {
             const double k = keyAt(i);
             const double v = valueAt(i);
@@ -74,20 +82,100 @@ public:
     // Binary search on sorted keys.
     // expandedRange=true includes one extra point beyond the boundary
     // (needed for correct line rendering at viewport edges).
-    virtual int findBegin(double sortKey, bool expandedRange = true) const = 0;
-    virtual int findEnd(double sortKey, bool expandedRange = true) const = 0;
+    virtual qsizetype findBegin(double sortKey, bool expandedRange = true) const = 0;
+    virtual qsizetype findEnd(double sortKey, bool expandedRange = true) const = 0;
 
     // Per-element access (slow path: selection, tooltips)
-    virtual double keyAt(int i) const = 0;
-    virtual double valueAt(int i) const = 0;
+    virtual double keyAt(qsizetype i) const = 0;
+    virtual double valueAt(qsizetype i) const = 0;
 
     // Processed outputs -- implementations run native-type algorithms internally,
     // cast to double/QPointF only at the pixel-coordinate output step.
     virtual QVector<QPointF> getOptimizedLineData(
-        int begin, int end, int pixelWidth,
+        qsizetype begin, qsizetype end, int pixelWidth,
         QCPAxis* keyAxis, QCPAxis* valueAxis) const = 0;
 
     virtual QVector<QPointF> getLines(
-        int begin, int end,
+        qsizetype begin, qsizetype end,
         QCPAxis* keyAxis, QCPAxis* valueAxis) const = 0;
+
+    // The same two into a float32 line relative to out.origin, which the
+    // caller sets; the points are replaced, the capacity kept. This is the
+    // on-screen draw path; the QPointF variants above remain for export.
+    // Defaults convert the QPointF result; typed sources write directly.
+    virtual void getOptimizedPixelLine(
+        qsizetype begin, qsizetype end, int pixelWidth,
+        QCPAxis* keyAxis, QCPAxis* valueAxis, QCPPixelLine& out) const
+    {
+        out.clear();
+        const QVector<QPointF> pts = getOptimizedLineData(begin, end, pixelWidth, keyAxis, valueAxis);
+        out.reserve(pts.size());
+        for (const QPointF& p : pts)
+            out.append(p);
+    }
+
+    virtual void getPixelLine(
+        qsizetype begin, qsizetype end,
+        QCPAxis* keyAxis, QCPAxis* valueAxis, QCPPixelLine& out) const
+    {
+        out.clear();
+        const QVector<QPointF> pts = getLines(begin, end, keyAxis, valueAxis);
+        out.reserve(pts.size());
+        for (const QPointF& p : pts)
+            out.append(p);
+    }
+
+    // Bulk read: converts samples [begin, end) to double into keys[0..n) and
+    // values[0..n), n = end - begin. Lets block-wise algorithms (2D histogram)
+    // make one virtual call per block; typed sources override with a
+    // native-type copy loop.
+    virtual void readSamples(qsizetype begin, qsizetype end,
+                             double* keys, double* values) const
+    {
+        for (qsizetype i = begin; i < end; ++i)
+        {
+            keys[i - begin] = keyAt(i);
+            values[i - begin] = valueAt(i);
+        }
+    }
+
+    // Min/max binning (L1 resampling): folds samples [begin, end) into the
+    // pairs minMax[2 * bin], minMax[2 * bin + 1] of the grid keyLo + bin * binWidth,
+    // bin = trunc((key - keyLo) / binWidth) clamped to [binBegin, binEnd).
+    // NaN values and non-finite keys are skipped; a NaN slot is an empty bin.
+    // Default goes through keyAt()/valueAt(); typed sources override to bin in
+    // their native types without per-sample dispatch.
+    virtual void accumulateMinMax(qsizetype begin, qsizetype end,
+                                  double keyLo, double binWidth,
+                                  double* minMax, int binBegin, int binEnd) const
+    {
+        for (qsizetype i = begin; i < end; ++i)
+        {
+            const double k = keyAt(i);
+            const double v = valueAt(i);
+            if (std::isnan(v) || !std::isfinite(k))
+                continue;
+            const double pos = (k - keyLo) / binWidth;
+            const int bin = !(pos >= binBegin) ? binBegin
+                          : pos >= binEnd      ? binEnd - 1
+                                               : static_cast<int>(pos);
+            double& mn = minMax[bin * 2 + 0];
+            double& mx = minMax[bin * 2 + 1];
+            if (std::isnan(mn) || v < mn) mn = v;
+            if (std::isnan(mx) || v > mx) mx = v;
+        }
+    }
+
+    // Storage bytes of one (key, value) sample, for scan accounting.
+    virtual qsizetype sampleBytes() const { return 2 * qsizetype(sizeof(double)); }
+
+    // Key span the L1 pyramid's base bins should be a whole multiple of, or 0
+    // for none. A source that bins whole blocks from resident summaries
+    // (QCPChunkedDataSource) returns its block spacing, so that every block
+    // lands in one base bin and the L1 build reads no payload.
+    virtual double l1BinWidthHint() const { return 0; }
+
+    // Hint that samples [begin, end) are about to be read with `hint`'s pattern.
+    virtual void adviseAccess(qsizetype /*begin*/, qsizetype /*end*/,
+                              QCPAccessHint /*hint*/) const {}
 };
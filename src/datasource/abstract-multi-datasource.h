@@ -6,29 +6,29 @@ public:
     virtual ~QCPAbstractMultiDataSource() = default;
 
     virtual int columnCount() const = 0;
-    virtual int size() const = 0;
+    virtual qsizetype size() const = 0;
     virtual bool empty() const { return size() == 0; }
 
-    virtual double keyAt(int i) const = 0;
+    virtual double keyAt(qsizetype i) const = 0;
     virtual QCPRange keyRange(bool& found, QCP::SignDomain sd = QCP::sdBoth) const = 0;
-    virtual int findBegin(double sortKey, bool expandedRange = true) const = 0;
-    virtual int findEnd(double sortKey, bool expandedRange = true) const = 0;
+    virtual qsizetype findBegin(double sortKey, bool expandedRange = true) const = 0;
+    virtual qsizetype findEnd(double sortKey, bool expandedRange = true) const = 0;
 
-    virtual double valueAt(int column, int i) const = 0;
+    virtual double valueAt(int column, qsizetype i) const = 0;
     virtual QCPRange valueRange(int column, bool& found,
                                 QCP::SignDomain sd = QCP::sdBoth,
                                 const QCPRange& inKeyRange = QCPRange()) const = 0;
 
     virtual QVector<QPointF> getOptimizedLineData(
-        int column, int begin, int end, int pixelWidth,
+        int column, qsizetype begin, qsizetype end, int pixelWidth,
         QCPAxis* keyAxis, QCPAxis* valueAxis) const = 0;
 
     virtual QVector<QPointF> getLines(
-        int column, int begin, int end,
+        int column, qsizetype begin, qsizetype end,
         QCPAxis* keyAxis, QCPAxis* valueAxis) const = 0;
 
     virtual void getOptimizedLineDataAll(
-        int begin, int end, int pixelWidth,
+        qsizetype begin, qsizetype end, int pixelWidth,
         QCPAxis* keyAxis, QCPAxis* valueAxis,
         QVector<QPointF>* results, int numColumns) const
     {
@@ -37,7 +37,7 @@ public:
     }
 
     virtual void getLinesAll(
-        int begin, int end,
+        qsizetype begin, qsizetype end,
         QCPAxis* keyAxis, QCPAxis* valueAxis,
         QVector<QPointF>* results, int numColumns) const
     {
@@ -47,4 +47,14 @@ public:
 
     virtual const double* rawKeyData() const { return nullptr; }
     virtual const double* rawColumnData(int /*column*/) const { return nullptr; }
+
+    // Storage bytes of one row (key and every column), for scan accounting.
+    virtual qsizetype sampleBytes() const
+    {
+        return qsizetype(sizeof(double)) * (1 + columnCount());
+    }
+
+    // Hint that rows [begin, end) are about to be read (see QCPAccessHint).
+    virtual void adviseAccess(qsizetype /*begin*/, qsizetype /*end*/,
+                              QCPAccessHint /*hint*/) const {}
 };
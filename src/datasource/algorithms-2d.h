@@ -7,13 +7,13 @@
 namespace qcp::algo2d {
 
 template <IndexableNumericRange XC>
-int findXBegin(const XC& x, double sortKey)
+qsizetype findXBegin(const XC& x, double sortKey)
 {
     return qcp::algo::findBegin(x, sortKey, true);
 }
 
 template <IndexableNumericRange XC>
-int findXEnd(const XC& x, double sortKey)
+qsizetype findXEnd(const XC& x, double sortKey)
 {
     return qcp::algo::findEnd(x, sortKey, true);
 }
@@ -32,22 +32,22 @@ QCPRange yRange(const YC& y, bool& found, QCP::SignDomain sd = QCP::sdBoth)
 }
 
 template <IndexableNumericRange ZC>
-QCPRange zRange(const ZC& z, int ySize, bool& found, int xBegin = 0, int xEnd = -1)
+QCPRange zRange(const ZC& z, int ySize, bool& found, qsizetype xBegin = 0, qsizetype xEnd = -1)
 {
     found = false;
     if (std::ranges::empty(z) || ySize <= 0)
         return {};
 
-    int totalRows = static_cast<int>(std::ranges::size(z)) / ySize;
+    qsizetype totalRows = static_cast<qsizetype>(std::ranges::size(z)) / ySize;
     if (xEnd < 0)
         xEnd = totalRows;
-    xBegin = std::max(0, xBegin);
+    xBegin = std::max<qsizetype>(0, xBegin);
     xEnd = std::min(xEnd, totalRows);
 
     double minVal = std::numeric_limits<double>::max();
     double maxVal = std::numeric_limits<double>::lowest();
 
-    for (int i = xBegin; i < xEnd; ++i)
+    for (qsizetype i = xBegin; i < xEnd; ++i)
     {
         for (int j = 0; j < ySize; ++j)
         {
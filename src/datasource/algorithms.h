@@ -1,5 +1,6 @@
 #pragma once
 #include "abstract-datasource.h"
+#include "minmax-kernels.h"
 #include "axis/axis.h"
 #include "layoutelements/layoutelement-axisrect.h"
 #include "../Profiling.hpp"
@@ -16,21 +17,58 @@ struct GapVector {
     std::vector<uint8_t> data;
     bool hasAnyGap = false;
 
-    explicit GapVector(int count = 0) : data(count, 0) {}
-    uint8_t operator[](int i) const { return data[i]; }
-    void setGap(int i) { data[i] = 1; hasAnyGap = true; }
-    int size() const { return static_cast<int>(data.size()); }
+    explicit GapVector(qsizetype count = 0) : data(count, 0) {}
+    uint8_t operator[](qsizetype i) const { return data[i]; }
+    void setGap(qsizetype i) { data[i] = 1; hasAnyGap = true; }
+    qsizetype size() const { return static_cast<qsizetype>(data.size()); }
+};
+
+// Maps a coordinate to a bin index, evenly spaced in linear or log10 space.
+// For log, callers must have already excluded non-positive coordinates.
+struct BinAxis
+{
+    double lo;       // lower edge in mapped space (coord, or log10(coord))
+    double invWidth; // bins / span, in mapped space
+    int bins;
+    bool log;
+
+    static BinAxis make(const QCPRange& range, int bins, bool log)
+    {
+        // Log bins require a positive range; callers (bin2d via the positive-only
+        // finiteKeyValueBounds + expandIfFlat, resampleL2 via its view check)
+        // must guarantee it. Asserting here
+        // keeps that non-local invariant honest and catches a future regression
+        // before it turns into log10(<=0) -> NaN -> UB in the index cast.
+        Q_ASSERT(!log || (range.lower > 0 && range.upper > 0));
+        const double lo = log ? std::log10(range.lower) : range.lower;
+        const double hi = log ? std::log10(range.upper) : range.upper;
+        const double span = hi - lo;
+        return BinAxis { lo, span > 0 ? bins / span : 0.0, bins, log };
+    }
+
+    int index(double x) const
+    {
+        const double pos = log ? std::log10(x) : x;
+        return std::clamp(static_cast<int>((pos - lo) * invWidth), 0, bins - 1);
+    }
+
+    // Coordinate at fractional bin position `b` (b = 0 is the lower edge).
+    double coord(double b) const
+    {
+        const double pos = lo + b / invWidth;
+        return log ? std::pow(10.0, pos) : pos;
+    }
 };
 
 template <IndexableNumericRange KC>
-GapVector detectKeyGaps(const KC& keys, int begin, int end,
+GapVector detectKeyGaps(const KC& keys, qsizetype begin, qsizetype end,
                                  double threshold = kDefaultGapThreshold)
 {
-    const int count = end - begin;
+    const qsizetype count = end - begin;
     GapVector gapBefore(count);
     if (count < 3 || threshold <= 0) return gapBefore;
 
-    for (int i = 0; i < count - 1; ++i)
+    for (qsizetype i = 0; i < count - 1; ++i)
     {
         double dx = static_cast<double>(keys[begin + i + 1]) - static_cast<double>(keys[begin + i]);
         double refDx = std::numeric_limits<double>::max();
@@ -45,32 +83,32 @@ GapVector detectKeyGaps(const KC& keys, int begin, int end,
 }
 
 template <IndexableNumericRange KC>
-int findBegin(const KC& keys, double sortKey, bool expandedRange = true)
+qsizetype findBegin(const KC& keys, double sortKey, bool expandedRange = true)
 {
-    const int sz = static_cast<int>(std::ranges::size(keys));
+    const qsizetype sz = static_cast<qsizetype>(std::ranges::size(keys));
     if (sz == 0) return 0;
 
     auto it = std::lower_bound(std::ranges::begin(keys), std::ranges::end(keys),
                                 sortKey, [](const auto& elem, double sk) {
                                     return static_cast<double>(elem) < sk;
                                 });
-    int idx = static_cast<int>(it - std::ranges::begin(keys));
+    qsizetype idx = static_cast<qsizetype>(it - std::ranges::begin(keys));
     if (expandedRange && idx > 0)
         --idx;
     return idx;
 }
 
 template <IndexableNumericRange KC>
-int findEnd(const KC& keys, double sortKey, bool expandedRange = true)
+qsizetype findEnd(const KC& keys, double sortKey, bool expandedRange = true)
 {
-    const int sz = static_cast<int>(std::ranges::size(keys));
+    const qsizetype sz = static_cast<qsizetype>(std::ranges::size(keys));
     if (sz == 0) return 0;
 
     auto it = std::upper_bound(std::ranges::begin(keys), std::ranges::end(keys),
                                 sortKey, [](double sk, const auto& elem) {
                                     return sk < static_cast<double>(elem);
                                 });
-    int idx = static_cast<int>(it - std::ranges::begin(keys));
+    qsizetype idx = static_cast<qsizetype>(it - std::ranges::begin(keys));
     if (expandedRange && idx < sz)
         ++idx;
     return idx;
@@ -80,12 +118,12 @@ template <IndexableNumericRange KC>
 QCPRange keyRange(const KC& keys, bool& foundRange, QCP::SignDomain sd = QCP::sdBoth)
 {
     foundRange = false;
-    const int sz = static_cast<int>(std::ranges::size(keys));
+    const qsizetype sz = static_cast<qsizetype>(std::ranges::size(keys));
     if (sz == 0) return {};
 
     double lower = std::numeric_limits<double>::max();
     double upper = std::numeric_limits<double>::lowest();
-    for (int i = 0; i < sz; ++i)
+    for (qsizetype i = 0; i < sz; ++i)
     {
         double k = static_cast<double>(keys[i]);
         if (sd == QCP::sdPositive && k <= 0) continue;
@@ -102,7 +140,7 @@ template <IndexableNumericRange KC>
 QCPRange keyRangeSorted(const KC& keys, bool& foundRange, QCP::SignDomain sd = QCP::sdBoth)
 {
     foundRange = false;
-    const int sz = static_cast<int>(std::ranges::size(keys));
+    const qsizetype sz = static_cast<qsizetype>(std::ranges::size(keys));
     if (sz == 0) return {};
 
     if (sd == QCP::sdBoth)
@@ -144,7 +182,7 @@ QCPRange valueRange(const KC& keys, const VC& values, bool& foundRange,
                     const QCPRange& inKeyRange = QCPRange())
 {
     foundRange = false;
-    const int sz = static_cast<int>(std::ranges::size(values));
+    const qsizetype sz = static_cast<qsizetype>(std::ranges::size(values));
     if (sz == 0) return {};
 
     const bool hasKeyRestriction = inKeyRange.lower != inKeyRange.upper
@@ -153,8 +191,8 @@ QCPRange valueRange(const KC& keys, const VC& values, bool& foundRange,
     // Keys are sorted (data source contract): restrict the scan to the visible
     // window via binary search instead of testing every key. Callers with
     // unsorted keys (histogram scatter) must not pass a key restriction here.
-    int i0 = 0;
-    int i1 = sz;
+    qsizetype i0 = 0;
+    qsizetype i1 = sz;
     if (hasKeyRestriction)
     {
         i0 = findBegin(keys, inKeyRange.lower, false);
@@ -163,7 +201,7 @@ QCPRange valueRange(const KC& keys, const VC& values, bool& foundRange,
 
     double lower = std::numeric_limits<double>::max();
     double upper = std::numeric_limits<double>::lowest();
-    for (int i = i0; i < i1; ++i)
+    for (qsizetype i = i0; i < i1; ++i)
     {
         double v = static_cast<double>(values[i]);
         if (sd == QCP::sdPositive && v <= 0) continue;
@@ -175,6 +213,78 @@ QCPRange valueRange(const KC& keys, const VC& values, bool& foundRange,
     return foundRange ? QCPRange(lower, upper) : QCPRange();
 }
 
+// Folds keys/values [begin, end) into min/max pairs out[2 * bin], out[2 * bin + 1]
+// (see QCPAbstractDataSource::accumulateMinMax for the bin rule). Runs in the
+// containers' native types: a run of same-bin samples is reduced in V and
+// widened to double once per run. Contiguous doubles take the SIMD kernels.
+template <IndexableNumericRange KC, IndexableNumericRange VC>
+void accumulateMinMax(const KC& keys, const VC& values, qsizetype begin, qsizetype end,
+                      double keyLo, double binWidth, double* out, int binBegin, int binEnd)
+{
+    using K = std::ranges::range_value_t<KC>;
+    using V = std::ranges::range_value_t<VC>;
+    if constexpr (std::is_same_v<K, double> && std::is_same_v<V, double>
+                  && ContiguousNumericRange<KC> && ContiguousNumericRange<VC>)
+    {
+        simd::minMaxKernels().accumulate(std::ranges::data(keys), std::ranges::data(values),
+                                         begin, end, keyLo, binWidth, out, binBegin, binEnd);
+    }
+    else
+    {
+        auto fold = [out](int bin, V mn, V mx) {
+            const double lo = static_cast<double>(mn);
+            const double hi = static_cast<double>(mx);
+            if (std::isnan(out[bin * 2 + 0]) || lo < out[bin * 2 + 0]) out[bin * 2 + 0] = lo;
+            if (std::isnan(out[bin * 2 + 1]) || hi > out[bin * 2 + 1]) out[bin * 2 + 1] = hi;
+        };
+
+        // Keys safely inside the run's bin edges (by `slack`, covering the
+        // rounding of the division) continue the run without dividing.
+        int runBin = -1;
+        double runLo = std::numeric_limits<double>::infinity();
+        double runHi = -runLo;
+        V mn {}, mx {};
+        for (qsizetype i = begin; i < end; ++i)
+        {
+            const K k = keys[i];
+            const V v = values[i];
+            if constexpr (std::is_floating_point_v<V>)
+                if (std::isnan(v)) continue;
+            if constexpr (std::is_floating_point_v<K>)
+                if (!std::isfinite(k)) continue;
+
+            const double kd = static_cast<double>(k);
+            if (kd >= runLo && kd <= runHi)
+            {
+                if (v < mn) mn = v;
+                if (v > mx) mx = v;
+                continue;
+            }
+            const double pos = (kd - keyLo) / binWidth;
+            const int bin = !(pos >= binBegin) ? binBegin
+                          : pos >= binEnd      ? binEnd - 1
+                                               : static_cast<int>(pos);
+            if (bin == runBin)
+            {
+                if (v < mn) mn = v;
+                if (v > mx) mx = v;
+                continue;
+            }
+            if (runBin >= 0)
+                fold(runBin, mn, mx);
+            runBin = bin;
+            mn = mx = v;
+            const double edgeLo = keyLo + bin * binWidth;
+            const double edgeHi = keyLo + (bin + 1) * binWidth;
+            const double slack = 1e-13 * (std::abs(keyLo) + std::abs(edgeLo) + std::abs(edgeHi));
+            runLo = bin == binBegin ? std::numeric_limits<double>::lowest() : edgeLo + slack;
+            runHi = bin == binEnd - 1 ? std::numeric_limits<double>::max() : edgeHi - slack;
+        }
+        if (runBin >= 0)
+            fold(runBin, mn, mx);
+    }
+}
+
 // Pre-computed affine transform for coord<->pixel conversion.
 // For linear axes: pixel = coord * scale + offset
 struct AffineTransform {
@@ -229,25 +339,27 @@ struct AffineTransform {
     double toCoord(double pixel) const { return pixel * invScale + invOffset; }
 };
 
-template <IndexableNumericRange KC, IndexableNumericRange VC>
-QVector<QPointF> linesToPixels(const KC& keys, const VC& values,
-                                int begin, int end,
-                                QCPAxis* keyAxis, QCPAxis* valueAxis,
-                                double gapThreshold = kDefaultGapThreshold,
-                                const GapVector* precomputedGaps = nullptr)
+// Pixel polyline of samples [begin, end) into `result`, replacing its points:
+// a QVector<QPointF>, or a QCPPixelLine (float32, relative to its origin).
+template <IndexableNumericRange KC, IndexableNumericRange VC, typename Out>
+void linesToPixelsInto(const KC& keys, const VC& values,
+                       qsizetype begin, qsizetype end,
+                       QCPAxis* keyAxis, QCPAxis* valueAxis, Out& result,
+                       double gapThreshold = kDefaultGapThreshold,
+                       const GapVector* precomputedGaps = nullptr)
 {
     using V = std::ranges::range_value_t<VC>;
-    Q_ASSERT(begin >= 0 && end <= static_cast<int>(std::ranges::size(keys)));
-    Q_ASSERT(begin >= 0 && end <= static_cast<int>(std::ranges::size(values)));
-    const int count = end - begin;
-    if (count <= 0) return {};
+    Q_ASSERT(begin >= 0 && end <= static_cast<qsizetype>(std::ranges::size(keys)));
+    Q_ASSERT(begin >= 0 && end <= static_cast<qsizetype>(std::ranges::size(values)));
+    const qsizetype count = end - begin;
+    result.clear();
+    if (count <= 0) return;
 
     GapVector computedGaps;
     if (!precomputedGaps)
         computedGaps = detectKeyGaps(keys, begin, end, gapThreshold);
     const auto& gaps = precomputedGaps ? *precomputedGaps : computedGaps;
 
-    QVector<QPointF> result;
     result.reserve(count + count / 10);
 
     const bool isVertical = keyAxis->orientation() == Qt::Vertical;
@@ -257,9 +369,9 @@ QVector<QPointF> linesToPixels(const KC& keys, const VC& values,
     const auto valTf = AffineTransform::fromAxis(valueAxis);
     const bool bothLinear = keyTf.isLinear && valTf.isLinear;
 
-    for (int i = begin; i < end; ++i)
+    for (qsizetype i = begin; i < end; ++i)
     {
-        int ri = i - begin;
+        qsizetype ri = i - begin;
         if (gaps.hasAnyGap && gaps[ri])
             result.append(nanPt);
 
@@ -286,21 +398,35 @@ QVector<QPointF> linesToPixels(const KC& keys, const VC& values,
                                       valueAxis->coordToPixel(v)));
         }
     }
-    return result;
 }
 
 template <IndexableNumericRange KC, IndexableNumericRange VC>
-QVector<QPointF> optimizedLineData(const KC& keys, const VC& values,
-                                    int begin, int end,
-                                    int /*pixelWidth*/,
-                                    QCPAxis* keyAxis, QCPAxis* valueAxis,
-                                    const GapVector* precomputedGaps = nullptr)
+QVector<QPointF> linesToPixels(const KC& keys, const VC& values,
+                                qsizetype begin, qsizetype end,
+                                QCPAxis* keyAxis, QCPAxis* valueAxis,
+                                double gapThreshold = kDefaultGapThreshold,
+                                const GapVector* precomputedGaps = nullptr)
+{
+    QVector<QPointF> result;
+    linesToPixelsInto(keys, values, begin, end, keyAxis, valueAxis, result,
+                      gapThreshold, precomputedGaps);
+    return result;
+}
+
+// Pixel-column min/max reduced polyline, into `result` like linesToPixelsInto.
+template <IndexableNumericRange KC, IndexableNumericRange VC, typename Out>
+void optimizedLineDataInto(const KC& keys, const VC& values,
+                           qsizetype begin, qsizetype end,
+                           int /*pixelWidth*/,
+                           QCPAxis* keyAxis, QCPAxis* valueAxis, Out& result,
+                           const GapVector* precomputedGaps = nullptr)
 {
     PROFILE_HERE_N("optimizedLineData");
-    Q_ASSERT(begin >= 0 && end <= static_cast<int>(std::ranges::size(keys)));
-    Q_ASSERT(begin >= 0 && end <= static_cast<int>(std::ranges::size(values)));
-    const int dataCount = end - begin;
-    if (dataCount <= 0) return {};
+    Q_ASSERT(begin >= 0 && end <= static_cast<qsizetype>(std::ranges::size(keys)));
+    Q_ASSERT(begin >= 0 && end <= static_cast<qsizetype>(std::ranges::size(values)));
+    const qsizetype dataCount = end - begin;
+    result.clear();
+    if (dataCount <= 0) return;
 
     double keyPixelSpan = qAbs(keyAxis->coordToPixel(static_cast<double>(keys[begin]))
                                 - keyAxis->coordToPixel(static_cast<double>(keys[end - 1])));
@@ -309,8 +435,11 @@ QVector<QPointF> optimizedLineData(const KC& keys, const VC& values,
         maxCount = int(2 * keyPixelSpan + 2);
 
     if (dataCount < maxCount)
-        return linesToPixels(keys, values, begin, end, keyAxis, valueAxis,
-                             kDefaultGapThreshold, precomputedGaps);
+    {
+        linesToPixelsInto(keys, values, begin, end, keyAxis, valueAxis, result,
+                          kDefaultGapThreshold, precomputedGaps);
+        return;
+    }
 
     GapVector computedGaps;
     if (!precomputedGaps)
@@ -318,7 +447,6 @@ QVector<QPointF> optimizedLineData(const KC& keys, const VC& values,
     const auto& gaps = precomputedGaps ? *precomputedGaps : computedGaps;
     const auto nanPt = QPointF(qQNaN(), qQNaN());
 
-    QVector<QPointF> result;
     result.reserve(maxCount);
 
     const bool isVertical = keyAxis->orientation() == Qt::Vertical;
@@ -341,7 +469,7 @@ QVector<QPointF> optimizedLineData(const KC& keys, const VC& values,
     // samples are skipped without counting, so deriving the closing point as
     // intervalFirst + intervalCount - 1 could land on a NaN and inject a
     // spurious line break into gap-free data.
-    auto flushInterval = [&](int intervalFirst, int intervalLast, int intervalCount,
+    auto flushInterval = [&](qsizetype intervalFirst, qsizetype intervalLast, qsizetype intervalCount,
                               double intervalStartKey, double lastEndKey,
                               double minVal, double maxVal,
                               double epsilon, double nextKey) {
@@ -365,19 +493,19 @@ QVector<QPointF> optimizedLineData(const KC& keys, const VC& values,
         }
     };
 
-    int i = begin;
+    qsizetype i = begin;
     using V = std::ranges::range_value_t<VC>;
     if constexpr (!std::is_integral_v<V>)
     {
         while (i < end && std::isnan(static_cast<double>(values[i])))
             ++i;
     }
-    if (i >= end) return {};
+    if (i >= end) return;
 
     double minValue = static_cast<double>(values[i]);
     double maxValue = minValue;
-    int currentIntervalFirst = i;
-    int currentIntervalLast = i;
+    qsizetype currentIntervalFirst = i;
+    qsizetype currentIntervalLast = i;
     int reversedFactor = keyAxis->pixelOrientation();
     int reversedRound = reversedFactor == -1 ? 1 : 0;
 
@@ -412,7 +540,7 @@ QVector<QPointF> optimizedLineData(const KC& keys, const VC& values,
         keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic;
     }
 
-    int intervalDataCount = 1;
+    qsizetype intervalDataCount = 1;
     ++i;
 
     const uint8_t* gapData = gaps.data.data();
@@ -499,7 +627,18 @@ QVector<QPointF> optimizedLineData(const KC& keys, const VC& values,
                   currentIntervalStartKey, lastIntervalEndKey,
                   minValue, maxValue, keyEpsilon,
                   currentIntervalStartKey + keyEpsilon * 3);
+}
 
+template <IndexableNumericRange KC, IndexableNumericRange VC>
+QVector<QPointF> optimizedLineData(const KC& keys, const VC& values,
+                                    qsizetype begin, qsizetype end,
+                                    int pixelWidth,
+                                    QCPAxis* keyAxis, QCPAxis* valueAxis,
+                                    const GapVector* precomputedGaps = nullptr)
+{
+    QVector<QPointF> result;
+    optimizedLineDataInto(keys, values, begin, end, pixelWidth, keyAxis, valueAxis, result,
+                          precomputedGaps);
     return result;
 }
 
@@ -510,14 +649,14 @@ void optimizedLineDataMulti(const KC& keys,
                              int numColumns,
                              // valueAt(column, dataIndex) -> double
                              auto&& valueAt,
-                             int begin, int end,
+                             qsizetype begin, qsizetype end,
                              QCPAxis* keyAxis, QCPAxis* valueAxis,
                              const GapVector* precomputedGaps,
                              QVector<QPointF>* results)
 {
     PROFILE_HERE_N("optimizedLineDataMulti");
-    Q_ASSERT(begin >= 0 && end <= static_cast<int>(std::ranges::size(keys)));
-    const int dataCount = end - begin;
+    Q_ASSERT(begin >= 0 && end <= static_cast<qsizetype>(std::ranges::size(keys)));
+    const qsizetype dataCount = end - begin;
     if (dataCount <= 0)
     {
         for (int c = 0; c < numColumns; ++c) results[c].clear();
@@ -545,9 +684,9 @@ void optimizedLineDataMulti(const KC& keys,
 
         for (int c = 0; c < numColumns; ++c) { results[c].clear(); results[c].reserve(dataCount + dataCount / 10); }
 
-        for (int i = begin; i < end; ++i)
+        for (qsizetype i = begin; i < end; ++i)
         {
-            int ri = i - begin;
+            qsizetype ri = i - begin;
             bool isGap = gaps.hasAnyGap && gaps[ri];
 
             double k = static_cast<double>(keys[i]);
@@ -591,8 +730,8 @@ void optimizedLineDataMulti(const KC& keys,
     struct ColState {
         double minVal;
         double maxVal;
-        int intervalFirst;
-        int intervalCount;
+        qsizetype intervalFirst;
+        qsizetype intervalCount;
     };
     std::vector<ColState> cs(numColumns);
 
@@ -606,7 +745,7 @@ void optimizedLineDataMulti(const KC& keys,
     double nextBoundary = 0;
     bool keyEpsilonVariable = false;
 
-    int i = begin;
+    qsizetype i = begin;
     if (i >= end)
     {
         for (int c = 0; c < numColumns; ++c) results[c].clear();
@@ -657,7 +796,7 @@ void optimizedLineDataMulti(const KC& keys,
                 results[c].append(toPixel(intervalStartKey + epsilon * 0.75, s.maxVal));
             if (nextKey > intervalStartKey + epsilon * 2)
             {
-                int prev = s.intervalFirst + s.intervalCount - 1;
+                qsizetype prev = s.intervalFirst + s.intervalCount - 1;
                 double lastVal = valueAt(c, prev);
                 if (!std::isnan(lastVal))
                     results[c].append(toPixel(intervalStartKey + epsilon * 0.8, lastVal));
@@ -0,0 +1,147 @@
+#pragma once
+#include "abstract-datasource.h"
+#include "soa-datasource.h"
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+// Growable, append-only SoA storage for streaming acquisition.
+//
+// Readers never see the storage directly: snapshot() hands out an immutable
+// QCPSoADataSource view over the current prefix, whose dataGuard keeps the
+// backing block alive. append() only ever writes past every published
+// snapshot's end (or into a freshly allocated block when capacity runs out),
+// so in-flight pipeline jobs reading an older snapshot are never raced.
+// Capacity grows geometrically — amortized O(1) per appended sample.
+class QCPAbstractAppendableDataSource {
+public:
+    virtual ~QCPAbstractAppendableDataSource() = default;
+
+    virtual qsizetype size() const = 0;
+    virtual std::shared_ptr<QCPAbstractDataSource> snapshot() const = 0;
+};
+
+template <typename K, typename V>
+class QCPAppendableDataSource final : public QCPAbstractAppendableDataSource {
+public:
+    QCPAppendableDataSource() = default;
+
+    // Seeds a store from an existing source (one-time O(n) conversion).
+    // Returns nullptr when a sample's key or value, as reported by
+    // keyAt()/valueAt(), does not survive the conversion to K/V unchanged
+    // (e.g. double data into a float store, or fractional or out-of-range
+    // values into an integer one). NaN and infinities only convert to a
+    // floating-point type.
+    static std::shared_ptr<QCPAppendableDataSource> fromExact(const QCPAbstractDataSource& seed)
+    {
+        auto store = std::make_shared<QCPAppendableDataSource>();
+        const qsizetype n = seed.size();
+        store->reserve(n);
+        for (qsizetype i = 0; i < n; ++i)
+        {
+            const double k = seed.keyAt(i);
+            const double v = seed.valueAt(i);
+            if (!convertsExactly<K>(k) || !convertsExactly<V>(v))
+                return nullptr;
+            store->mBlock->keys[i] = static_cast<K>(k);
+            store->mBlock->values[i] = static_cast<V>(v);
+        }
+        store->mSize = n;
+        return store;
+    }
+
+    qsizetype size() const override { return mSize; }
+
+    // Appends a batch. Keys must continue the sorted order (first new key >=
+    // last stored key); a length mismatch or an out-of-order batch is dropped
+    // with a warning and leaves the storage untouched. Returns true when the
+    // batch was stored.
+    template <IndexableNumericRange KC, IndexableNumericRange VC>
+    bool append(const KC& keys, const VC& values)
+    {
+        const auto n = std::ranges::size(keys);
+        if (n != std::ranges::size(values))
+        {
+            qWarning("QCPAppendableDataSource: keys/values length mismatch (%zu vs %zu) — dropping batch",
+                     static_cast<std::size_t>(n),
+                     static_cast<std::size_t>(std::ranges::size(values)));
+            return false;
+        }
+        if (n == 0)
+            return true;
+        if (!std::ranges::is_sorted(keys)
+            || (mSize > 0 && static_cast<double>(*std::ranges::begin(keys))
+                                 < static_cast<double>(mBlock->keys[mSize - 1])))
+        {
+            qWarning("QCPAppendableDataSource: appended keys are not sorted after the stored data — dropping batch");
+            return false;
+        }
+
+        reserve(mSize + static_cast<qsizetype>(n));
+        std::ranges::transform(keys, mBlock->keys.get() + mSize,
+                               [](auto k) { return static_cast<K>(k); });
+        std::ranges::transform(values, mBlock->values.get() + mSize,
+                               [](auto v) { return static_cast<V>(v); });
+        mSize += static_cast<qsizetype>(n);
+        return true;
+    }
+
+    std::shared_ptr<QCPAbstractDataSource> snapshot() const override
+    {
+        const K* keys = mBlock ? mBlock->keys.get() : nullptr;
+        const V* values = mBlock ? mBlock->values.get() : nullptr;
+        return std::make_shared<QCPSoADataSource<std::span<const K>, std::span<const V>>>(
+            std::span<const K>(keys, mSize), std::span<const V>(values, mSize),
+            std::shared_ptr<const void>(mBlock));
+    }
+
+private:
+    template <typename T>
+    static bool convertsExactly(double x)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            if (!std::isfinite(x))
+                return true;
+            if (std::abs(x) > static_cast<double>(std::numeric_limits<T>::max()))
+                return false;
+        }
+        else if (!(x >= static_cast<double>(std::numeric_limits<T>::lowest())
+                   && x < std::ldexp(1.0, std::numeric_limits<T>::digits)))
+        {
+            return false;
+        }
+        return static_cast<double>(static_cast<T>(x)) == x;
+    }
+
+    struct Block {
+        std::unique_ptr<K[]> keys;
+        std::unique_ptr<V[]> values;
+        qsizetype capacity = 0;
+    };
+
+    void reserve(qsizetype required)
+    {
+        if (mBlock && mBlock->capacity >= required)
+            return;
+        // Never grow in place: older snapshots may still be read by workers,
+        // so a new block is allocated and the prefix copied over.
+        auto block = std::make_shared<Block>();
+        block->capacity = std::max<qsizetype>({required, 1024, mBlock ? mBlock->capacity * 2 : 0});
+        block->keys = std::make_unique_for_overwrite<K[]>(block->capacity);
+        block->values = std::make_unique_for_overwrite<V[]>(block->capacity);
+        if (mBlock)
+        {
+            std::copy_n(mBlock->keys.get(), mSize, block->keys.get());
+            std::copy_n(mBlock->values.get(), mSize, block->values.get());
+        }
+        mBlock = std::move(block);
+    }
+
+    std::shared_ptr<Block> mBlock;
+    qsizetype mSize = 0;
+};
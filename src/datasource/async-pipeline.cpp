@@ -21,6 +21,7 @@ QCPAsyncPipelineBase::QCPAsyncPipelineBase(QCPPipelineScheduler* scheduler,
                                              QObject* parent)
     : QObject(parent)
     , mScheduler(scheduler)
+    , mStatsState(std::make_shared<StatsState>())
     , mDestroyGuard(std::make_shared<DestroyGuard>())
 {
 }
@@ -51,32 +52,87 @@ void QCPAsyncPipelineBase::emitBusyIfNeeded(QMutexLocker<QMutex>& lock)
 void QCPAsyncPipelineBase::onDataChanged()
 {
     PROFILE_HERE_N("Pipeline::onDataChanged");
+    invalidateData(false);
+}
+
+void QCPAsyncPipelineBase::onDataAppended()
+{
+    PROFILE_HERE_N("Pipeline::onDataAppended");
+    invalidateData(true);
+}
+
+void QCPAsyncPipelineBase::invalidateData(bool appended)
+{
     uint64_t gen = ++mGeneration;
     QMutexLocker lock(&mMutex);
-    mCache = std::any{};
+    if (!appended)
+        mCache = std::any{};
+    mPreviewDue = true;
 
     if (mJobRunning)
     {
-        mPending = makeJob(mLastViewport, std::any{}, gen);
+        // Whatever the running job computes is now obsolete; its cache too,
+        // unless the data were only appended to: then the next job carries on
+        // from it.
+        notePendingRequest();
+        if (appended)
+            mRunningToken.cancelResult();
+        else
+            mRunningToken.cancel();
+        mPendingToken = QCPCancellationToken::create();
+        mPending = makeJob(mLastViewport, std::any{}, gen, mPendingToken);
         mPendingViewport = false;
         mPendingPriority = QCPPipelineScheduler::Heavy;
     }
     else
     {
-        auto job = makeJob(mLastViewport, std::any{}, gen);
+        auto token = QCPCancellationToken::create();
+        auto job = makeJob(mLastViewport, std::any{}, gen, token);
         if (!job)
         {
+            mPreviewToken.cancel();
             settleIdle(lock, gen);
             return;
         }
         mJobRunning = true;
         mRunningGeneration = gen;
+        mRunningToken = token;
+        auto preview = takePreviewJob(mLastViewport, gen);
         emitBusyIfNeeded(lock);
-        mScheduler->submit(QCPPipelineScheduler::Heavy, std::move(job));
+        // Preview first: on a busy pool it is the one worth starting early.
+        if (preview)
+            submitJob(QCPPipelineScheduler::Fast, std::move(preview), qcp::monotonicNs());
+        submitJob(QCPPipelineScheduler::Heavy, std::move(job), qcp::monotonicNs());
         return;
     }
 
+    auto preview = mPending ? takePreviewJob(mLastViewport, gen) : std::function<void()>{};
+    emitBusyIfNeeded(lock);
+    if (preview)
+        submitJob(QCPPipelineScheduler::Fast, std::move(preview), qcp::monotonicNs());
+}
+
+void QCPAsyncPipelineBase::requestCache()
+{
+    PROFILE_HERE_N("Pipeline::requestCache");
+    QMutexLocker lock(&mMutex);
+    if (mJobRunning)
+        return;
+    // A fresh generation only orders the result after the one on screen; the
+    // data, and so mPreviewDue, are unchanged.
+    uint64_t gen = ++mGeneration;
+    auto token = QCPCancellationToken::create();
+    auto job = makeJob(mLastViewport, std::move(mCache), gen, token);
+    if (!job)
+    {
+        settleIdle(lock, gen);
+        return;
+    }
+    mJobRunning = true;
+    mRunningGeneration = gen;
+    mRunningToken = token;
     emitBusyIfNeeded(lock);
+    submitJob(QCPPipelineScheduler::Heavy, std::move(job), qcp::monotonicNs());
 }
 
 void QCPAsyncPipelineBase::settleIdle(QMutexLocker<QMutex>& lock, uint64_t gen)
@@ -106,29 +162,157 @@ void QCPAsyncPipelineBase::onViewportChanged(const ViewportParams& vp)
     uint64_t gen = ++mGeneration;
     QMutexLocker lock(&mMutex);
     mLastViewport = vp;
+    auto preview = mPreviewDue ? takePreviewJob(vp, gen) : std::function<void()>{};
 
     if (mJobRunning)
     {
+        // Only the running job's result is obsolete: cache work it does (or a
+        // pending data job's) carries over to the deferred viewport job.
+        notePendingRequest();
+        mRunningToken.cancelResult();
         mPendingViewport = true;
         mPendingPriority = QCPPipelineScheduler::Fast;
     }
     else
     {
         auto cache = std::move(mCache);
-        auto job = makeJob(vp, std::move(cache), gen);
+        auto token = QCPCancellationToken::create();
+        auto job = makeJob(vp, std::move(cache), gen, token);
         if (!job)
         {
+            mPreviewToken.cancel();
             settleIdle(lock, gen);
             return;
         }
         mJobRunning = true;
         mRunningGeneration = gen;
+        mRunningToken = token;
         emitBusyIfNeeded(lock);
-        mScheduler->submit(QCPPipelineScheduler::Fast, std::move(job));
+        if (preview)
+            submitJob(QCPPipelineScheduler::Fast, std::move(preview), qcp::monotonicNs());
+        submitJob(QCPPipelineScheduler::Fast, std::move(job), qcp::monotonicNs());
         return;
     }
 
     emitBusyIfNeeded(lock);
+    if (preview)
+        submitJob(QCPPipelineScheduler::Fast, std::move(preview), qcp::monotonicNs());
+}
+
+std::function<void()> QCPAsyncPipelineBase::takePreviewJob(const ViewportParams& vp,
+                                                           uint64_t generation)
+{
+    mPreviewToken.cancel();
+    auto token = QCPCancellationToken::create();
+    auto job = makePreviewJob(vp, generation, token);
+    if (!job)
+        return {};
+    mPreviewToken = token;
+    mPreviewGeneration = generation;
+    return job;
+}
+
+void QCPAsyncPipelineBase::notePendingRequest()
+{
+    // Called with mMutex held, while a job runs.
+    if (mPending || mPendingViewport)
+    {
+        QMutexLocker lock(&mStatsState->mutex);
+        ++mStatsState->stats.coalesced;
+    }
+    else
+        mPendingSinceNs = qcp::monotonicNs();
+}
+
+void QCPAsyncPipelineBase::submitJob(QCPPipelineScheduler::Priority priority,
+                                     std::function<void()> job, qint64 requestedNs)
+{
+    auto state = mStatsState;
+    {
+        QMutexLocker lock(&state->mutex);
+        ++state->stats.submitted;
+    }
+    mScheduler->submit(priority, [state, requestedNs, job = std::move(job)] {
+        const qint64 waitNs = qcp::monotonicNs() - requestedNs;
+        std::atomic<quint64> bytes{0};
+        {
+            // Forwarded to the scheduler's counter on exit.
+            qcp::ScanCounterScope scope(&bytes, true);
+            job();
+        }
+        QMutexLocker lock(&state->mutex);
+        state->stats.queueWait.add(waitNs);
+        state->stats.bytesScanned += bytes.load(std::memory_order_relaxed);
+    });
+}
+
+void QCPAsyncPipelineBase::recordJob(bool cancelled, qint64 elapsedNs, qint64 doneNs)
+{
+    if (cancelled)
+    {
+        ++mCancellationStats.cancelledJobs;
+        mCancellationStats.cancelledNs += elapsedNs;
+    }
+    else
+        ++mCancellationStats.completedJobs;
+
+    QMutexLocker lock(&mStatsState->mutex);
+    auto& stats = mStatsState->stats;
+    if (cancelled)
+        ++stats.cancelled;
+    else
+        ++stats.completed;
+    stats.execution.add(elapsedNs);
+    stats.delivery.add(qcp::monotonicNs() - doneNs);
+}
+
+QCPPipelineStats QCPAsyncPipelineBase::stats() const
+{
+    QMutexLocker lock(&mStatsState->mutex);
+    return mStatsState->stats;
+}
+
+void QCPAsyncPipelineBase::resetStats()
+{
+    QMutexLocker lock(&mStatsState->mutex);
+    mStatsState->stats = QCPPipelineStats();
+}
+
+void QCPAsyncPipelineBase::deliverPreview(uint64_t generation, std::any result)
+{
+    PROFILE_HERE_N("Pipeline::deliverPreview");
+    // Only worth showing while it is the latest preview and nothing at least
+    // as recent has been displayed: a full result landing first wins.
+    const bool current = generation == mPreviewGeneration && generation > mDisplayedGeneration;
+    if (!current || !applyPreview(std::move(result)))
+    {
+        QMutexLocker statsLock(&mStatsState->mutex);
+        ++mStatsState->stats.dropped;
+        return;
+    }
+    {
+        QMutexLocker statsLock(&mStatsState->mutex);
+        ++mStatsState->stats.previews;
+    }
+    Q_EMIT previewReady(generation);
+}
+
+bool QCPAsyncPipelineBase::inspectCache(const std::function<void(const std::any&)>& fn) const
+{
+    QMutexLocker lock(&mMutex);
+    if (mJobRunning)
+        return false;
+    fn(mCache);
+    return true;
+}
+
+bool QCPAsyncPipelineBase::releaseCache()
+{
+    QMutexLocker lock(&mMutex);
+    if (mJobRunning)
+        return false;
+    mCache = std::any{};
+    return true;
 }
 
 void QCPAsyncPipelineBase::deliverResult(uint64_t generation, std::any cache, std::any result)
@@ -152,13 +336,15 @@ void QCPAsyncPipelineBase::deliverResult(uint64_t generation, std::any cache, st
             // Data change: pre-baked job (cache was cleared)
             job = std::move(mPending);
             mPending = nullptr;
+            mRunningToken = mPendingToken;
         }
         else
         {
             // Viewport change: create job now with the restored cache
             mPendingViewport = false;
             auto jobCache = std::move(mCache);
-            job = makeJob(mLastViewport, std::move(jobCache), mRunningGeneration);
+            mRunningToken = QCPCancellationToken::create();
+            job = makeJob(mLastViewport, std::move(jobCache), mRunningGeneration, mRunningToken);
         }
 
         if (!job)
@@ -170,8 +356,9 @@ void QCPAsyncPipelineBase::deliverResult(uint64_t generation, std::any cache, st
         }
         else
         {
+            const qint64 requestedNs = mPendingSinceNs;
             lock.unlock();
-            mScheduler->submit(priority, std::move(job));
+            submitJob(priority, std::move(job), requestedNs);
         }
     }
     else
@@ -184,9 +371,15 @@ void QCPAsyncPipelineBase::deliverResult(uint64_t generation, std::any cache, st
     if (generation > mDisplayedGeneration)
     {
         mDisplayedGeneration = generation;
-        applyResult(generation, std::move(result));
+        if (applyResult(generation, std::move(result)))
+            mPreviewDue = false;
         Q_EMIT finished(generation);
     }
+    else
+    {
+        QMutexLocker statsLock(&mStatsState->mutex);
+        ++mStatsState->stats.dropped;
+    }
 
     if (idle)
     {
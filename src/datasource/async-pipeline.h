@@ -4,6 +4,7 @@
 #include <QMutexLocker>
 #include <QMetaObject>
 #include <QThread>
+#include <QElapsedTimer>
 #include <axis/range.h>
 #include <functional>
 #include <memory>
@@ -11,6 +12,8 @@
 #include <atomic>
 #include <type_traits>
 #include "pipeline-scheduler.h"
+#include "pipeline-stats.h"
+#include "cancellation-token.h"
 
 class QCPAxis;
 class QCPAxisRect;
@@ -40,17 +43,68 @@ public:
     bool isBusy() const;
 
     void onDataChanged();
+    // The new data extend the old: like onDataChanged(), except that the
+    // cache and any cache work in flight stay valid for the next job.
+    void onDataAppended();
     void onViewportChanged(const ViewportParams& vp);
+    // Rebuilds a cache its owner dropped (see releaseCache) for unchanged
+    // data: unlike onDataChanged() nothing in flight is cancelled and no
+    // preview runs. A no-op while a job runs, as its result brings a cache.
+    void requestCache();
+
+    // Jobs that finished under a cancelled token (superseded while running),
+    // and the worker time they spent, up to bailing out or completing a
+    // transform that doesn't poll. GUI-thread only.
+    struct CancellationStats {
+        quint64 completedJobs = 0;
+        quint64 cancelledJobs = 0;
+        qint64 cancelledNs = 0;
+    };
+    CancellationStats cancellationStats() const { return mCancellationStats; }
+
+    // Requests, coalescing, discarded results, queue-wait (from the request),
+    // execution and GUI-delivery latencies, and source bytes scanned by this
+    // pipeline's jobs. Thread-safe.
+    QCPPipelineStats stats() const;
+    void resetStats();
+
+    // Reads the cache under the pipeline's lock, for memory accounting; false
+    // (and `fn` not called) while a running job holds it. releaseCache drops
+    // it under the same condition, for the next job to rebuild.
+    bool inspectCache(const std::function<void(const std::any&)>& fn) const;
+    bool releaseCache();
 
 Q_SIGNALS:
     void finished(uint64_t generation);
+    // A preview for `generation` was applied; its full result is still due.
+    void previewReady(uint64_t generation);
     void busyChanged(bool busy);
 
 protected:
     virtual std::function<void()> makeJob(
-        const ViewportParams& vp, std::any cache, uint64_t generation) = 0;
-    virtual void applyResult(uint64_t generation, std::any result) = 0;
+        const ViewportParams& vp, std::any cache, uint64_t generation,
+        QCPCancellationToken token) = 0;
+    // Returns whether `result` replaced the displayed one (false for null).
+    virtual bool applyResult(uint64_t generation, std::any result) = 0;
     void deliverResult(uint64_t generation, std::any cache, std::any result);
+    // Preview lane (see QCPAsyncPipeline::setPreviewTransform): no job when no
+    // preview transform is installed.
+    virtual std::function<void()> makePreviewJob(
+        const ViewportParams& /*vp*/, uint64_t /*generation*/, QCPCancellationToken /*token*/)
+    {
+        return {};
+    }
+    virtual bool applyPreview(std::any /*result*/) { return false; }
+    void deliverPreview(uint64_t generation, std::any result);
+    // Supersedes the previous preview; returns the job for `generation`, to
+    // submit once mMutex is released, or nothing. Called with mMutex held.
+    std::function<void()> takePreviewJob(const ViewportParams& vp, uint64_t generation);
+    // `doneNs`: qcp::monotonicNs() when the job finished on its worker.
+    void recordJob(bool cancelled, qint64 elapsedNs, qint64 doneNs);
+    // Hands `job` to the scheduler, timing its wait from `requestedNs`.
+    void submitJob(QCPPipelineScheduler::Priority priority, std::function<void()> job,
+                   qint64 requestedNs);
+    void notePendingRequest();
 
     QCPPipelineScheduler* mScheduler;
     TransformKind mKind = TransformKind::ViewportIndependent;
@@ -64,7 +118,27 @@ protected:
     QCPPipelineScheduler::Priority mPendingPriority = QCPPipelineScheduler::Heavy;
     uint64_t mRunningGeneration = 0;
     bool mJobRunning = false;
+    // Flipped when a newer generation is queued behind the running job.
+    QCPCancellationToken mRunningToken;
+    QCPCancellationToken mPendingToken; // token baked into mPending
+    qint64 mPendingSinceNs = 0; // first request folded into the pending job
+    QCPCancellationToken mPreviewToken; // flipped by the next data change
+    uint64_t mPreviewGeneration = 0;    // request the last preview was made for
+    // Set by a data change, cleared by the first full result shown after it:
+    // until then viewport changes get a preview too (a viewport-dependent
+    // transform's first useful job usually follows the data change).
+    bool mPreviewDue = false;
+    CancellationStats mCancellationStats;
+
+    // Updated from the workers as well: shared so a job outliving the
+    // pipeline (see DestroyGuard) still has somewhere to record.
+    struct StatsState {
+        mutable QMutex mutex;
+        QCPPipelineStats stats;
+    };
+    std::shared_ptr<StatsState> mStatsState;
 
+    void invalidateData(bool appended);
     void emitBusyIfNeeded(QMutexLocker<QMutex>& lock);
     void settleIdle(QMutexLocker<QMutex>& lock, uint64_t gen);
 
@@ -95,10 +169,26 @@ template<typename In, typename Out>
 class QCPAsyncPipeline : public QCPAsyncPipelineBase
 {
 public:
+    // `cancel` fires once a newer generation is queued: the transform may then
+    // return nullptr early instead of finishing a result nobody will see.
+    // Cache-filling work polls cancel.cacheToken() and must leave `cache`
+    // untouched if it bails.
     using TransformFn = std::function<
+        std::shared_ptr<Out>(const In& source,
+                             const ViewportParams& viewport,
+                             std::any& cache,
+                             const QCPCancellationToken& cancel)>;
+    // Transforms that don't poll for cancellation.
+    using SimpleTransformFn = std::function<
         std::shared_ptr<Out>(const In& source,
                              const ViewportParams& viewport,
                              std::any& cache)>;
+    // Cheap stand-in for the transform's result: a strided or low-resolution
+    // pass that never touches the cache.
+    using PreviewFn = std::function<
+        std::shared_ptr<Out>(const In& source,
+                             const ViewportParams& viewport,
+                             const QCPCancellationToken& cancel)>;
 
     explicit QCPAsyncPipeline(QCPPipelineScheduler* scheduler,
                                QObject* parent = nullptr)
@@ -115,6 +205,34 @@ public:
         mTransform = std::move(fn);
     }
 
+    void setTransform(TransformKind kind, SimpleTransformFn fn)
+    {
+        setTransform(kind, [fn = std::move(fn)](const In& source, const ViewportParams& vp,
+                                                std::any& cache, const QCPCancellationToken&) {
+            return fn(source, vp, cache);
+        });
+    }
+
+    // With a preview transform, every data change also runs it on the Fast
+    // lane. Its result is exposed by preview() until a full result replaces
+    // it, so a plottable has something to draw while a heavy job (an L1 over
+    // a multi-GB source) is still running. An empty function removes it.
+    // GUI-thread-only, like setTransform().
+    void setPreviewTransform(PreviewFn fn)
+    {
+        mPreviewTransform = std::move(fn);
+        if (!mPreviewTransform)
+            mPreview.reset();
+    }
+
+    bool hasPreviewTransform() const { return !!mPreviewTransform; }
+
+    // Latest preview not yet superseded by a full (non-null) result, or
+    // nullptr. Transforms whose result lives in the cache rather than in
+    // result() drop it themselves with clearPreview().
+    const Out* preview() const { return mPreview.get(); }
+    void clearPreview() { mPreview.reset(); }
+
     void setSource(std::shared_ptr<const In> source)
     {
         {
@@ -125,6 +243,18 @@ public:
             onDataChanged();
     }
 
+    // `source` holds the current source's data followed by more (an
+    // append-only store's newer snapshot); see onDataAppended().
+    void appendSource(std::shared_ptr<const In> source)
+    {
+        {
+            QMutexLocker lock(&mMutex);
+            mSource = std::move(source);
+        }
+        if (mTransform)
+            onDataAppended();
+    }
+
     const Out* result() const
     {
         if (!mTransform)
@@ -153,7 +283,7 @@ public:
         auto cache = std::move(mCache);
         lock.unlock();
 
-        auto out = transform(*source, vp, cache);
+        auto out = transform(*source, vp, cache, QCPCancellationToken());
 
         lock.relock();
         mCache = std::move(cache);
@@ -161,6 +291,7 @@ public:
 
         if (!out) return false;
         mResult = std::move(out);
+        mPreview.reset();
         return true;
     }
 
@@ -168,12 +299,14 @@ public:
     {
         mTransform = {};
         mResult.reset();
+        mPreview.reset();
         mCache = {};
     }
 
 protected:
     std::function<void()> makeJob(
-        const ViewportParams& vp, std::any cache, uint64_t generation) override
+        const ViewportParams& vp, std::any cache, uint64_t generation,
+        QCPCancellationToken token) override
     {
         if (!mSource || !mTransform) return {};
 
@@ -183,8 +316,17 @@ protected:
         auto* self = this;
 
         return [source, transform, vp, cache = std::move(cache),
-                generation, guard, self]() mutable {
-            auto result = transform(*source, vp, cache);
+                generation, guard, self, token]() mutable {
+            QElapsedTimer timer;
+            timer.start();
+            auto result = transform(*source, vp, cache, token);
+            // A transform that bailed out returned nullptr, which applyResult
+            // ignores; a cache built from replaced data is dropped.
+            const bool cancelled = token.isCancelled();
+            if (token.cacheToken().isCancelled())
+                cache = std::any{};
+            const qint64 elapsedNs = timer.nsecsElapsed();
+            const qint64 doneNs = qcp::monotonicNs();
 
             // Held across check + invoke: the destructor takes the same mutex
             // before flipping `destroyed`, so `self` cannot die in between.
@@ -194,24 +336,70 @@ protected:
             if (guard->destroyed) return;
 
             QMetaObject::invokeMethod(self, [self, result = std::move(result),
-                                              cache = std::move(cache), generation]() mutable {
+                                              cache = std::move(cache), generation,
+                                              cancelled, elapsedNs, doneNs]() mutable {
+                self->recordJob(cancelled, elapsedNs, doneNs);
                 self->deliverResult(generation, std::move(cache),
                                     std::any(std::move(result)));
             }, Qt::QueuedConnection);
         };
     }
 
-    void applyResult(uint64_t, std::any result) override
+    std::function<void()> makePreviewJob(
+        const ViewportParams& vp, uint64_t generation, QCPCancellationToken token) override
+    {
+        if (!mSource || !mTransform || !mPreviewTransform) return {};
+
+        auto source = mSource;
+        auto preview = mPreviewTransform;
+        auto guard = mDestroyGuard;
+        auto* self = this;
+
+        return [source, preview, vp, generation, guard, self, token]() {
+            QElapsedTimer timer;
+            timer.start();
+            auto result = preview(*source, vp, token);
+            const bool cancelled = token.isCancelled();
+            const qint64 elapsedNs = timer.nsecsElapsed();
+            const qint64 doneNs = qcp::monotonicNs();
+
+            // Same destroyed-check as makeJob.
+            QMutexLocker lock(&guard->mutex);
+            if (guard->destroyed) return;
+
+            QMetaObject::invokeMethod(self, [self, result = std::move(result), generation,
+                                              cancelled, elapsedNs, doneNs]() mutable {
+                self->recordJob(cancelled, elapsedNs, doneNs);
+                self->deliverPreview(generation, std::any(std::move(result)));
+            }, Qt::QueuedConnection);
+        };
+    }
+
+    bool applyResult(uint64_t, std::any result) override
     {
-        if (auto* ptr = std::any_cast<std::shared_ptr<Out>>(&result))
-            if (*ptr)
-                mResult = std::move(*ptr);
+        auto* ptr = std::any_cast<std::shared_ptr<Out>>(&result);
+        if (!ptr || !*ptr)
+            return false;
+        mResult = std::move(*ptr);
+        mPreview.reset();
+        return true;
+    }
+
+    bool applyPreview(std::any result) override
+    {
+        auto* ptr = std::any_cast<std::shared_ptr<Out>>(&result);
+        if (!ptr || !*ptr)
+            return false;
+        mPreview = std::move(*ptr);
+        return true;
     }
 
 private:
     std::shared_ptr<const In> mSource;
     TransformFn mTransform;
+    PreviewFn mPreviewTransform;
     std::shared_ptr<Out> mResult;
+    std::shared_ptr<Out> mPreview;
 };
 
 using QCPGraphPipeline = QCPAsyncPipeline<QCPAbstractDataSource, QCPAbstractDataSource>;
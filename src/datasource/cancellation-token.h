@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <memory>
+
+// Cooperative cancellation flag shared between a QCPAsyncPipeline and one of
+// its jobs. The pipeline flips it when a newer generation is queued; long
+// loops poll isCancelled() between chunks and bail out early.
+//
+// Two levels: a newer viewport, or data appended to the old, only obsoletes the
+// job's result, while new data obsoletes everything, cache included. Work that fills the pipeline cache
+// (L1 pyramids, histogram indices) polls cacheToken(), so it keeps running
+// across zooms and the next viewport job picks it up instead of restarting it.
+//
+// A default-constructed token is never cancelled. Copies share the flag.
+class QCPCancellationToken
+{
+public:
+    QCPCancellationToken() = default;
+
+    static QCPCancellationToken create()
+    {
+        QCPCancellationToken token;
+        token.mState = std::make_shared<std::atomic<int>>(0);
+        return token;
+    }
+
+    bool isCancelled() const
+    {
+        return mState && (mState->load(std::memory_order_relaxed) & mMask);
+    }
+
+    // The same flag, ignoring cancelResult().
+    QCPCancellationToken cacheToken() const
+    {
+        QCPCancellationToken token = *this;
+        token.mMask = kInputsStale;
+        return token;
+    }
+
+    // Newer viewport or appended data: the result is obsolete, cache work is not.
+    void cancelResult() const
+    {
+        if (mState)
+            mState->fetch_or(kResultStale, std::memory_order_relaxed);
+    }
+
+    // Newer data: everything the job computes is obsolete.
+    void cancel() const
+    {
+        if (mState)
+            mState->fetch_or(kResultStale | kInputsStale, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int kResultStale = 1;
+    static constexpr int kInputsStale = 2;
+
+    std::shared_ptr<std::atomic<int>> mState;
+    int mMask = kResultStale | kInputsStale;
+};
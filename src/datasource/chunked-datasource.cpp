@@ -0,0 +1,532 @@
+#include "chunked-datasource.h"
+#include "algorithms.h"
+#include "pipeline-scheduler.h"
+#include <QMutex>
+#include <QPointer>
+#include <QWaitCondition>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+constexpr qint64 kBytesPerSample = 2 * sizeof(double);
+
+} // namespace
+
+QCPChunkSummary QCPChunkSummary::of(const double* keys, const double* values, qsizetype count)
+{
+    QCPChunkSummary s;
+    s.count = count;
+    s.keyMin = s.valueMin = std::numeric_limits<double>::infinity();
+    s.keyMax = s.valueMax = -std::numeric_limits<double>::infinity();
+    for (qsizetype i = 0; i < count; ++i)
+    {
+        if (!std::isfinite(keys[i]))
+            continue;
+        s.keyMin = std::min(s.keyMin, keys[i]);
+        s.keyMax = std::max(s.keyMax, keys[i]);
+        if (std::isnan(values[i]))
+            continue;
+        s.valueMin = std::min(s.valueMin, values[i]);
+        s.valueMax = std::max(s.valueMax, values[i]);
+    }
+    return s;
+}
+
+struct QCPChunkedDataSource::State {
+    struct Entry {
+        std::shared_ptr<const QCPChunkPayload> payload;
+        std::list<int>::iterator lru;
+    };
+
+    std::vector<QCPChunkSummary> summaries;
+    std::vector<qsizetype> offsets; // summaries.size() + 1 prefix sums
+    double chunkSpacing = 0; // see l1BinWidthHint()
+    QCPChunkLoader loader;
+
+    mutable QMutex mutex;
+    QWaitCondition loaded;
+    std::unordered_map<int, Entry> resident;
+    std::list<int> lru; // most recently used first
+    std::unordered_set<int> loading; // loader running; readers wait for it
+    std::unordered_set<int> queued;  // prefetch submitted, not started yet
+    qint64 budget = 0;
+    qint64 bytes = 0;
+    QPointer<QCPPipelineScheduler> scheduler;
+    std::function<void(int)> onLoaded;
+
+    qint64 chunkBytes(int c) const { return summaries[c].count * kBytesPerSample; }
+
+    // Calls the loader (unlocked); nullptr on a failed or mis-sized load.
+    std::shared_ptr<const QCPChunkPayload> load(int c) const
+    {
+        std::shared_ptr<const QCPChunkPayload> p = loader ? loader(c) : nullptr;
+        const auto n = static_cast<size_t>(summaries[c].count);
+        if (p && (p->keys.size() != n || p->values.size() != n))
+        {
+            qWarning("QCPChunkedDataSource: chunk %d loaded %zu keys / %zu values, expected %zu",
+                     c, p->keys.size(), p->values.size(), n);
+            p = nullptr;
+        }
+        return p;
+    }
+
+    // Locked. Makes c the most recent entry and evicts past the budget.
+    void insert(int c, std::shared_ptr<const QCPChunkPayload> p)
+    {
+        if (resident.contains(c))
+            return;
+        lru.push_front(c);
+        resident.emplace(c, Entry{std::move(p), lru.begin()});
+        bytes += chunkBytes(c);
+        evict();
+    }
+
+    // Locked. Never evicts the most recent chunk.
+    void evict()
+    {
+        while (bytes > budget && lru.size() > 1)
+        {
+            const int victim = lru.back();
+            lru.pop_back();
+            resident.erase(victim);
+            bytes -= chunkBytes(victim);
+        }
+    }
+
+    // Stand-in for a chunk whose load failed: keys spread over the summary's
+    // range (so searches stay consistent), NaN values. Not cached.
+    std::shared_ptr<const QCPChunkPayload> placeholder(int c) const
+    {
+        const auto& s = summaries[c];
+        auto p = std::make_shared<QCPChunkPayload>();
+        p->keys.resize(s.count);
+        p->values.assign(s.count, std::numeric_limits<double>::quiet_NaN());
+        const double step = s.count > 1 && s.keyMin <= s.keyMax ? (s.keyMax - s.keyMin) / double(s.count - 1) : 0.0;
+        for (qsizetype i = 0; i < s.count; ++i)
+            p->keys[i] = s.keyMin <= s.keyMax ? s.keyMin + step * double(i) : s.keyMin;
+        if (s.count > 0 && s.keyMin <= s.keyMax)
+            p->keys.back() = s.keyMax;
+        return p;
+    }
+
+    // Payload of chunk c, loading it synchronously unless resident. Concurrent
+    // readers (and a running prefetch) of the same chunk share one load; a
+    // prefetch still queued doesn't make readers wait.
+    std::shared_ptr<const QCPChunkPayload> payload(int c)
+    {
+        QMutexLocker lock(&mutex);
+        for (;;)
+        {
+            if (auto it = resident.find(c); it != resident.end())
+            {
+                lru.splice(lru.begin(), lru, it->second.lru);
+                return it->second.payload;
+            }
+            if (!loading.contains(c))
+                break;
+            loaded.wait(&mutex);
+        }
+        loading.insert(c);
+        lock.unlock();
+        auto p = load(c);
+        lock.relock();
+        loading.erase(c);
+        if (p)
+            insert(c, p);
+        loaded.wakeAll();
+        return p ? p : placeholder(c);
+    }
+};
+
+QCPChunkedDataSource::QCPChunkedDataSource(std::vector<QCPChunkSummary> summaries,
+                                           QCPChunkLoader loader, qint64 memoryBudgetBytes)
+    : mState(std::make_shared<State>())
+{
+    std::erase_if(summaries, [](const QCPChunkSummary& s) { return s.count <= 0; });
+    mState->summaries = std::move(summaries);
+    mState->offsets.reserve(mState->summaries.size() + 1);
+    mState->offsets.push_back(0);
+    for (const auto& s : mState->summaries)
+        mState->offsets.push_back(mState->offsets.back() + s.count);
+    mState->loader = std::move(loader);
+    mState->budget = std::max<qint64>(0, memoryBudgetBytes);
+
+    // Chunks without a finite key don't occupy any bin.
+    const QCPChunkSummary* previous = nullptr;
+    for (const auto& s : mState->summaries)
+    {
+        if (s.keyMin > s.keyMax)
+            continue;
+        if (previous)
+            mState->chunkSpacing = std::max(mState->chunkSpacing, s.keyMin - previous->keyMin);
+        previous = &s;
+    }
+}
+
+QCPChunkedDataSource::~QCPChunkedDataSource() = default;
+
+int QCPChunkedDataSource::chunkCount() const
+{
+    return static_cast<int>(mState->summaries.size());
+}
+
+const QCPChunkSummary& QCPChunkedDataSource::chunkSummary(int index) const
+{
+    return mState->summaries[index];
+}
+
+qsizetype QCPChunkedDataSource::chunkOffset(int index) const
+{
+    return mState->offsets[index];
+}
+
+void QCPChunkedDataSource::setMemoryBudget(qint64 bytes)
+{
+    QMutexLocker lock(&mState->mutex);
+    mState->budget = std::max<qint64>(0, bytes);
+    mState->evict();
+}
+
+qint64 QCPChunkedDataSource::memoryBudget() const
+{
+    QMutexLocker lock(&mState->mutex);
+    return mState->budget;
+}
+
+qint64 QCPChunkedDataSource::residentBytes() const
+{
+    QMutexLocker lock(&mState->mutex);
+    return mState->bytes;
+}
+
+bool QCPChunkedDataSource::isResident(int index) const
+{
+    QMutexLocker lock(&mState->mutex);
+    return mState->resident.contains(index);
+}
+
+void QCPChunkedDataSource::setScheduler(QCPPipelineScheduler* scheduler)
+{
+    QMutexLocker lock(&mState->mutex);
+    mState->scheduler = scheduler;
+}
+
+void QCPChunkedDataSource::setChunkLoadedCallback(std::function<void(int index)> callback)
+{
+    QMutexLocker lock(&mState->mutex);
+    mState->onLoaded = std::move(callback);
+}
+
+int QCPChunkedDataSource::chunkOf(qsizetype i) const
+{
+    const auto& offsets = mState->offsets;
+    return static_cast<int>(std::upper_bound(offsets.begin(), offsets.end(), i) - offsets.begin()) - 1;
+}
+
+qsizetype QCPChunkedDataSource::size() const
+{
+    return mState->offsets.back();
+}
+
+QCPRange QCPChunkedDataSource::keyRange(bool& foundRange, QCP::SignDomain sd) const
+{
+    const auto& summaries = mState->summaries;
+    foundRange = false;
+    if (summaries.empty())
+        return {};
+    if (sd == QCP::sdBoth)
+    {
+        foundRange = true;
+        return QCPRange(summaries.front().keyMin, summaries.back().keyMax);
+    }
+    const qsizetype n = size();
+    if (sd == QCP::sdPositive)
+    {
+        const qsizetype i = findEnd(0, false);
+        if (i >= n)
+            return {};
+        foundRange = true;
+        return QCPRange(keyAt(i), summaries.back().keyMax);
+    }
+    const qsizetype i = findBegin(0, false);
+    if (i <= 0)
+        return {};
+    foundRange = true;
+    return QCPRange(summaries.front().keyMin, keyAt(i - 1));
+}
+
+QCPRange QCPChunkedDataSource::valueRange(bool& foundRange, QCP::SignDomain sd,
+                                          const QCPRange& inKeyRange) const
+{
+    foundRange = false;
+    const qsizetype n = size();
+    if (n == 0)
+        return {};
+
+    qsizetype begin = 0, end = n;
+    const bool restrictKeys = inKeyRange != QCPRange();
+    if (restrictKeys)
+    {
+        begin = findBegin(inKeyRange.lower, false);
+        end = findEnd(inKeyRange.upper, false);
+    }
+
+    double lower = (std::numeric_limits<double>::max)();
+    double upper = std::numeric_limits<double>::lowest();
+    auto add = [&](double v) {
+        lower = std::min(lower, v);
+        upper = std::max(upper, v);
+        foundRange = true;
+    };
+    const auto& offsets = mState->offsets;
+    for (int c = begin < end ? chunkOf(begin) : chunkCount(); c < chunkCount() && offsets[c] < end; ++c)
+    {
+        const auto& s = mState->summaries[c];
+        const qsizetype cb = std::max(begin, offsets[c]);
+        const qsizetype ce = std::min(end, offsets[c + 1]);
+        const bool whole = cb == offsets[c] && ce == offsets[c + 1] && s.keyMin <= s.keyMax;
+        const bool signOk = sd == QCP::sdBoth || (sd == QCP::sdPositive && s.valueMin > 0)
+                            || (sd == QCP::sdNegative && s.valueMax < 0);
+        if (whole && signOk)
+        {
+            if (s.valueMin <= s.valueMax)
+            {
+                add(s.valueMin);
+                add(s.valueMax);
+            }
+            continue;
+        }
+        const auto p = mState->payload(c);
+        for (qsizetype i = cb - offsets[c]; i < ce - offsets[c]; ++i)
+        {
+            const double k = p->keys[i];
+            const double v = p->values[i];
+            if (restrictKeys && (k < inKeyRange.lower || k > inKeyRange.upper))
+                continue;
+            if (std::isnan(v))
+                continue;
+            if ((sd == QCP::sdPositive && v <= 0) || (sd == QCP::sdNegative && v >= 0))
+                continue;
+            add(v);
+        }
+    }
+    return foundRange ? QCPRange(lower, upper) : QCPRange();
+}
+
+qsizetype QCPChunkedDataSource::findBegin(double sortKey, bool expandedRange) const
+{
+    const auto& summaries = mState->summaries;
+    const qsizetype n = size();
+    if (n == 0)
+        return 0;
+    // First chunk holding a key >= sortKey; every earlier key is smaller.
+    const auto it = std::partition_point(summaries.begin(), summaries.end(),
+                                         [&](const QCPChunkSummary& s) { return s.keyMax < sortKey; });
+    qsizetype idx = n;
+    if (it != summaries.end())
+    {
+        const int c = static_cast<int>(it - summaries.begin());
+        if (!(it->keyMin < sortKey))
+            idx = mState->offsets[c];
+        else
+            idx = mState->offsets[c] + qcp::algo::findBegin(mState->payload(c)->keys, sortKey, false);
+    }
+    if (expandedRange && idx > 0)
+        --idx;
+    return idx;
+}
+
+qsizetype QCPChunkedDataSource::findEnd(double sortKey, bool expandedRange) const
+{
+    const auto& summaries = mState->summaries;
+    const qsizetype n = size();
+    if (n == 0)
+        return 0;
+    // First chunk holding a key > sortKey.
+    const auto it = std::partition_point(summaries.begin(), summaries.end(),
+                                         [&](const QCPChunkSummary& s) { return !(s.keyMax > sortKey); });
+    qsizetype idx = n;
+    if (it != summaries.end())
+    {
+        const int c = static_cast<int>(it - summaries.begin());
+        if (it->keyMin > sortKey)
+            idx = mState->offsets[c];
+        else
+            idx = mState->offsets[c] + qcp::algo::findEnd(mState->payload(c)->keys, sortKey, false);
+    }
+    if (expandedRange && idx < n)
+        ++idx;
+    return idx;
+}
+
+double QCPChunkedDataSource::keyAt(qsizetype i) const
+{
+    const int c = chunkOf(i);
+    return mState->payload(c)->keys[i - mState->offsets[c]];
+}
+
+double QCPChunkedDataSource::valueAt(qsizetype i) const
+{
+    const int c = chunkOf(i);
+    return mState->payload(c)->values[i - mState->offsets[c]];
+}
+
+void QCPChunkedDataSource::readSamples(qsizetype begin, qsizetype end,
+                                       double* keys, double* values) const
+{
+    const auto& offsets = mState->offsets;
+    for (int c = begin < end ? chunkOf(begin) : chunkCount(); c < chunkCount() && offsets[c] < end; ++c)
+    {
+        const qsizetype cb = std::max(begin, offsets[c]);
+        const qsizetype ce = std::min(end, offsets[c + 1]);
+        const auto p = mState->payload(c);
+        std::copy(p->keys.begin() + (cb - offsets[c]), p->keys.begin() + (ce - offsets[c]), keys + (cb - begin));
+        std::copy(p->values.begin() + (cb - offsets[c]), p->values.begin() + (ce - offsets[c]), values + (cb - begin));
+    }
+}
+
+QVector<QPointF> QCPChunkedDataSource::getOptimizedLineData(qsizetype begin, qsizetype end, int pixelWidth,
+                                                            QCPAxis* keyAxis, QCPAxis* valueAxis) const
+{
+    if (end <= begin)
+        return {};
+    std::vector<double> keys(end - begin), values(end - begin);
+    readSamples(begin, end, keys.data(), values.data());
+    return qcp::algo::optimizedLineData(keys, values, 0, end - begin, pixelWidth, keyAxis, valueAxis);
+}
+
+QVector<QPointF> QCPChunkedDataSource::getLines(qsizetype begin, qsizetype end,
+                                                QCPAxis* keyAxis, QCPAxis* valueAxis) const
+{
+    if (end <= begin)
+        return {};
+    std::vector<double> keys(end - begin), values(end - begin);
+    readSamples(begin, end, keys.data(), values.data());
+    return qcp::algo::linesToPixels(keys, values, 0, end - begin, keyAxis, valueAxis);
+}
+
+void QCPChunkedDataSource::getOptimizedPixelLine(qsizetype begin, qsizetype end, int pixelWidth,
+                                                 QCPAxis* keyAxis, QCPAxis* valueAxis,
+                                                 QCPPixelLine& out) const
+{
+    out.clear();
+    if (end <= begin)
+        return;
+    std::vector<double> keys(end - begin), values(end - begin);
+    readSamples(begin, end, keys.data(), values.data());
+    qcp::algo::optimizedLineDataInto(keys, values, 0, end - begin, pixelWidth, keyAxis, valueAxis, out);
+}
+
+void QCPChunkedDataSource::getPixelLine(qsizetype begin, qsizetype end,
+                                        QCPAxis* keyAxis, QCPAxis* valueAxis,
+                                        QCPPixelLine& out) const
+{
+    out.clear();
+    if (end <= begin)
+        return;
+    std::vector<double> keys(end - begin), values(end - begin);
+    readSamples(begin, end, keys.data(), values.data());
+    qcp::algo::linesToPixelsInto(keys, values, 0, end - begin, keyAxis, valueAxis, out);
+}
+
+void QCPChunkedDataSource::accumulateMinMax(qsizetype begin, qsizetype end, double keyLo, double binWidth,
+                                            double* minMax, int binBegin, int binEnd) const
+{
+    // Same clamped truncation as qcp::algo::accumulateMinMax.
+    auto binOf = [&](double key) {
+        const double pos = (key - keyLo) / binWidth;
+        if (!(pos >= binBegin))
+            return binBegin;
+        if (pos >= binEnd)
+            return binEnd - 1;
+        return static_cast<int>(pos);
+    };
+    const auto& offsets = mState->offsets;
+    for (int c = begin < end ? chunkOf(begin) : chunkCount(); c < chunkCount() && offsets[c] < end; ++c)
+    {
+        const auto& s = mState->summaries[c];
+        const qsizetype cb = std::max(begin, offsets[c]);
+        const qsizetype ce = std::min(end, offsets[c + 1]);
+        const bool whole = cb == offsets[c] && ce == offsets[c + 1] && s.keyMin <= s.keyMax;
+        if (whole && binOf(s.keyMin) == binOf(s.keyMax))
+        {
+            // Every finite-key sample of the chunk lands in one bin: fold the
+            // summary instead of loading the payload.
+            if (s.valueMin <= s.valueMax)
+            {
+                double* slot = minMax + 2 * (binOf(s.keyMin) - binBegin);
+                if (std::isnan(slot[0]) || s.valueMin < slot[0])
+                    slot[0] = s.valueMin;
+                if (std::isnan(slot[1]) || s.valueMax > slot[1])
+                    slot[1] = s.valueMax;
+            }
+            continue;
+        }
+        const auto p = mState->payload(c);
+        qcp::algo::accumulateMinMax(p->keys, p->values, cb - offsets[c], ce - offsets[c],
+                                    keyLo, binWidth, minMax, binBegin, binEnd);
+    }
+}
+
+double QCPChunkedDataSource::l1BinWidthHint() const
+{
+    return mState->chunkSpacing;
+}
+
+void QCPChunkedDataSource::adviseAccess(qsizetype begin, qsizetype end, QCPAccessHint hint) const
+{
+    if (hint != QCPAccessHint::WillNeed || begin >= end)
+        return;
+    const auto& offsets = mState->offsets;
+    QMutexLocker lock(&mState->mutex);
+    QCPPipelineScheduler* scheduler = mState->scheduler;
+    if (!scheduler)
+        return;
+    // Prefetch at most half the budget, so the hinted chunks don't evict each
+    // other (or everything else) before they are read.
+    qint64 planned = 0;
+    std::vector<int> fetch;
+    for (int c = chunkOf(std::max<qsizetype>(begin, 0)); c < chunkCount() && offsets[c] < end; ++c)
+    {
+        if (mState->resident.contains(c) || mState->loading.contains(c) || mState->queued.contains(c))
+            continue;
+        planned += mState->chunkBytes(c);
+        if (planned > mState->budget / 2)
+            break;
+        mState->queued.insert(c);
+        fetch.push_back(c);
+    }
+    lock.unlock();
+
+    for (int c : fetch)
+    {
+        // Dequeues c even when the scheduler drops the job unrun (shutdown).
+        auto ticket = std::shared_ptr<void>(nullptr, [state = mState, c](void*) {
+            QMutexLocker lock(&state->mutex);
+            state->queued.erase(c);
+        });
+        scheduler->submit(QCPPipelineScheduler::Heavy, [state = mState, c, ticket] {
+            QMutexLocker lock(&state->mutex);
+            state->queued.erase(c);
+            if (state->resident.contains(c) || state->loading.contains(c))
+                return;
+            state->loading.insert(c);
+            lock.unlock();
+            auto p = state->load(c);
+            lock.relock();
+            state->loading.erase(c);
+            if (p)
+                state->insert(c, p);
+            state->loaded.wakeAll();
+            const auto callback = state->onLoaded;
+            lock.unlock();
+            if (p && callback)
+                callback(c);
+        });
+    }
+}
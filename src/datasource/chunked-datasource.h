@@ -0,0 +1,98 @@
+#pragma once
+#include "abstract-datasource.h"
+#include <QtGlobal>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class QCPPipelineScheduler;
+
+// Summary of one chunk, resident for the source's lifetime. Must describe the
+// payload exactly as of() computes it: key bounds over the finite keys, value
+// bounds over the samples with a finite key and a non-NaN value (an all-NaN
+// chunk has valueMin > valueMax).
+struct QCPChunkSummary {
+    qsizetype count = 0;
+    double keyMin = 0, keyMax = 0;
+    double valueMin = 0, valueMax = 0;
+
+    static QCPChunkSummary of(const double* keys, const double* values, qsizetype count);
+};
+
+struct QCPChunkPayload {
+    std::vector<double> keys;
+    std::vector<double> values;
+};
+
+// Loads chunk `index`. Called from the scheduler's worker threads and from
+// whichever thread first reads a non-resident chunk, possibly concurrently for
+// different chunks. nullptr (or a payload of the wrong size) is a failed load.
+using QCPChunkLoader = std::function<std::shared_ptr<const QCPChunkPayload>(int index)>;
+
+// Out-of-core graph source: a sorted series split into chunks whose payloads
+// are loaded on demand through a user loader (file, decompressor, cache...)
+// and kept in an LRU cache bounded by a memory budget.
+//
+// Only the chunk summaries are resident. Resampling uses them wherever a
+// whole chunk falls into one bin (zoomed-out views, the L1 build of a long
+// archive, whose grid follows l1BinWidthHint()) and loads payloads only for
+// chunks straddling bins — i.e. those of the visible key range once zoomed in. Key searches load at most the chunk
+// containing the searched key. adviseAccess(WillNeed) — the viewport hint of
+// QCPGraph2 — prefetches the chunks of the hinted rows on the scheduler set
+// with setScheduler(); without one, payloads load synchronously on first use.
+// A failed load reads as NaN values (drawn as a gap) and is retried on the
+// next access.
+class QCPChunkedDataSource final : public QCPAbstractDataSource {
+public:
+    // Empty chunks are dropped; the summaries' key ranges must be sorted and
+    // non-overlapping.
+    QCPChunkedDataSource(std::vector<QCPChunkSummary> summaries, QCPChunkLoader loader,
+                         qint64 memoryBudgetBytes = qint64(1) << 30);
+    ~QCPChunkedDataSource() override;
+
+    int chunkCount() const;
+    const QCPChunkSummary& chunkSummary(int index) const;
+    qsizetype chunkOffset(int index) const;
+
+    // Payload bytes kept resident (16 per sample); least recently used chunks
+    // are evicted past it. The chunk being read is never evicted.
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryBudget() const;
+    qint64 residentBytes() const;
+    bool isResident(int index) const;
+
+    // Scheduler running the prefetches, and a callback invoked (on the loading
+    // thread) after each prefetched chunk lands — typically a queued replot.
+    void setScheduler(QCPPipelineScheduler* scheduler);
+    void setChunkLoadedCallback(std::function<void(int index)> callback);
+
+    qsizetype size() const override;
+    QCPRange keyRange(bool& foundRange, QCP::SignDomain sd = QCP::sdBoth) const override;
+    QCPRange valueRange(bool& foundRange, QCP::SignDomain sd = QCP::sdBoth,
+                        const QCPRange& inKeyRange = QCPRange()) const override;
+    qsizetype findBegin(double sortKey, bool expandedRange = true) const override;
+    qsizetype findEnd(double sortKey, bool expandedRange = true) const override;
+    double keyAt(qsizetype i) const override;
+    double valueAt(qsizetype i) const override;
+    QVector<QPointF> getOptimizedLineData(qsizetype begin, qsizetype end, int pixelWidth,
+                                           QCPAxis* keyAxis, QCPAxis* valueAxis) const override;
+    QVector<QPointF> getLines(qsizetype begin, qsizetype end,
+                               QCPAxis* keyAxis, QCPAxis* valueAxis) const override;
+    void getOptimizedPixelLine(qsizetype begin, qsizetype end, int pixelWidth,
+                               QCPAxis* keyAxis, QCPAxis* valueAxis, QCPPixelLine& out) const override;
+    void getPixelLine(qsizetype begin, qsizetype end,
+                      QCPAxis* keyAxis, QCPAxis* valueAxis, QCPPixelLine& out) const override;
+    void readSamples(qsizetype begin, qsizetype end, double* keys, double* values) const override;
+    void accumulateMinMax(qsizetype begin, qsizetype end, double keyLo, double binWidth,
+                          double* minMax, int binBegin, int binEnd) const override;
+    // Spacing of the chunks' first keys (the largest one): evenly spaced
+    // chunks then fill one L1 bin each.
+    double l1BinWidthHint() const override;
+    void adviseAccess(qsizetype begin, qsizetype end, QCPAccessHint hint) const override;
+
+private:
+    struct State;
+    std::shared_ptr<State> mState; // shared with in-flight prefetch jobs
+
+    int chunkOf(qsizetype i) const;
+};
@@ -3,12 +3,11 @@
 #include "abstract-multi-datasource.h"
 #include "soa-datasource.h"
 #include "async-pipeline.h"
-#include "thread-naming.h"
+#include "cancellation-token.h"
+#include "minmax-kernels.h"
+#include "pipeline-stats.h"
+#include "work-executor.h"
 #include "../Profiling.hpp"
-#include <QAtomicInt>
-#include <QSemaphore>
-#include <QThread>
-#include <QThreadPool>
 
 #include <algorithm>
 #include <cmath>
@@ -18,71 +17,191 @@
 
 namespace qcp::algo {
 
-// innerPool() is a single process-wide shared pool (not one instance per
-// caller), so its size directly bounds total concurrent inner-parallel OS
-// threads regardless of how many outer resample jobs are in flight at once
-// -- callers just queue for the shared slots instead of each spawning their
-// own. Scales with hardware (matches the outer pipeline scheduler's own
-// default sizing in pipeline-scheduler.cpp) rather than a fixed ceiling, so
-// worst case is ~outer_pool_size + inner_pool_size concurrent threads, not a
-// product of the two.
+// Parallel loops split into one chunk per worker of the shared executor and
+// fork them on a QCPTaskGroup: idle workers steal the chunks, and the forking
+// thread runs the last one itself and then helps with the rest, so nested
+// fan-out never oversubscribes the machine however many jobs are in flight.
 inline int innerThreadCount()
 {
-    return std::max(1, QThread::idealThreadCount() / 2);
-}
-
-inline QThreadPool& innerPool()
-{
-    static QThreadPool pool;
-    static bool init = [&] {
-        pool.setMaxThreadCount(innerThreadCount());
-        pool.setExpiryTimeout(-1);
-        return true;
-    }();
-    (void)init;
-    return pool;
+    return QCPWorkExecutor::instance().workerCount();
 }
 
 struct BinResult {
     std::vector<double> keys;
     std::vector<double> values;
+
+    quint64 memoryBytes() const
+    {
+        return (keys.capacity() + values.capacity()) * sizeof(double);
+    }
 };
 
-// Initialize bin keys and values for numBins min/max pairs.
-// keys: (binCenter, binCenter+halfWidth) per bin; values: NaN.
-inline void initBinKeysAndValues(BinResult& out, int numBins, double keyLo, double binWidth)
+// Keys of bins [fromBin, toBin) of the grid starting at keyLo, as
+// (binCenter, binCenter+halfWidth); out.keys must already hold toBin bins.
+inline void setBinKeys(BinResult& out, int fromBin, int toBin, double keyLo, double binWidth)
 {
     const double halfWidth = binWidth * 0.5;
-    out.keys.resize(numBins * 2);
-    out.values.resize(numBins * 2);
-    for (int b = 0; b < numBins; ++b)
+    for (int b = fromBin; b < toBin; ++b)
     {
         double binCenter = keyLo + (b + 0.5) * binWidth;
         out.keys[b * 2 + 0] = binCenter;
         out.keys[b * 2 + 1] = binCenter + halfWidth;
-        out.values[b * 2 + 0] = std::numeric_limits<double>::quiet_NaN();
-        out.values[b * 2 + 1] = std::numeric_limits<double>::quiet_NaN();
     }
 }
 
+// Initialize bin keys and values for numBins min/max pairs; values: NaN.
+inline void initBinKeysAndValues(BinResult& out, int numBins, double keyLo, double binWidth)
+{
+    out.keys.resize(numBins * 2);
+    setBinKeys(out, 0, numBins, keyLo, binWidth);
+    out.values.assign(numBins * 2, std::numeric_limits<double>::quiet_NaN());
+}
+
 struct L1ViewportBounds {
-    int begin;
-    int end;
+    qsizetype begin;
+    qsizetype end;
 };
 
+// One level of the min/max pyramid: the points of a BinResult, held in blocks
+// of kBlockBins bins (the last one may be shorter). Copies share the blocks and
+// writers go through mutableBlock(), which first clones a block another copy
+// still holds, so an L1 extended by an append shares every block the append
+// left alone with the L1 it was extended from.
+class PyramidLevel
+{
+public:
+    static constexpr int kBlockBins = 1 << 14;
+    static constexpr qsizetype kBlockPoints = 2 * qsizetype(kBlockBins);
+
+    static PyramidLevel fromBins(BinResult bins)
+    {
+        PyramidLevel level;
+        level.mBins = static_cast<int>(bins.keys.size() / 2);
+        if (level.mBins <= kBlockBins)
+        {
+            if (level.mBins > 0)
+                level.mBlocks.push_back(std::make_shared<BinResult>(std::move(bins)));
+            return level;
+        }
+        for (qsizetype p = 0; p < level.size(); p += kBlockPoints)
+        {
+            const qsizetype end = std::min(level.size(), p + kBlockPoints);
+            auto block = std::make_shared<BinResult>();
+            block->keys.assign(bins.keys.begin() + p, bins.keys.begin() + end);
+            block->values.assign(bins.values.begin() + p, bins.values.begin() + end);
+            level.mBlocks.push_back(std::move(block));
+        }
+        return level;
+    }
+
+    // Contiguous copy of the points.
+    BinResult toBins() const
+    {
+        BinResult out;
+        out.keys.reserve(size());
+        out.values.reserve(size());
+        for (const auto& block : mBlocks)
+        {
+            out.keys.insert(out.keys.end(), block->keys.begin(), block->keys.end());
+            out.values.insert(out.values.end(), block->values.begin(), block->values.end());
+        }
+        return out;
+    }
+
+    int bins() const { return mBins; }
+    qsizetype size() const { return 2 * qsizetype(mBins); } // points
+    bool empty() const { return mBins == 0; }
+    double key(qsizetype i) const { return mBlocks[i / kBlockPoints]->keys[i % kBlockPoints]; }
+    double value(qsizetype i) const { return mBlocks[i / kBlockPoints]->values[i % kBlockPoints]; }
+
+    int blockCount() const { return static_cast<int>(mBlocks.size()); }
+    const BinResult& block(int b) const { return *mBlocks[b]; }
+    BinResult& mutableBlock(int b)
+    {
+        auto& block = mBlocks[b];
+        if (block.use_count() > 1)
+            block = std::make_shared<BinResult>(*block);
+        return *block;
+    }
+
+    // Appends empty (NaN) bins up to `bins` bins on the grid starting at
+    // keyLo with bins of binWidth (keys as setBinKeys).
+    void grow(int bins, double keyLo, double binWidth)
+    {
+        const double halfWidth = binWidth * 0.5;
+        while (mBins < bins)
+        {
+            if (mBlocks.empty() || mBlocks.back()->keys.size() == std::size_t(kBlockPoints))
+                mBlocks.push_back(std::make_shared<BinResult>());
+            BinResult& last = mutableBlock(blockCount() - 1);
+            const int first = static_cast<int>(last.keys.size() / 2);
+            const int count = std::min(bins - mBins, kBlockBins - first);
+            last.keys.resize(2 * std::size_t(first + count));
+            last.values.resize(2 * std::size_t(first + count), std::numeric_limits<double>::quiet_NaN());
+            for (int b = 0; b < count; ++b)
+            {
+                const double binCenter = keyLo + (mBins + b + 0.5) * binWidth;
+                last.keys[(first + b) * 2 + 0] = binCenter;
+                last.keys[(first + b) * 2 + 1] = binCenter + halfWidth;
+            }
+            mBins += count;
+        }
+    }
+
+    quint64 memoryBytes() const
+    {
+        quint64 bytes = 0;
+        for (const auto& block : mBlocks)
+            bytes += block->memoryBytes();
+        return bytes;
+    }
+
+private:
+    std::vector<std::shared_ptr<BinResult>> mBlocks;
+    int mBins = 0;
+};
+
+// Point range [begin, end) of a level around the keys in view, snapped to
+// even bin-pair boundaries; beginIdx/endIdx are the lower/upper bounds of the
+// view's ends.
+inline L1ViewportBounds snapViewportBounds(qsizetype beginIdx, qsizetype endIdx, qsizetype size)
+{
+    qsizetype l1Begin = std::max<qsizetype>(0, beginIdx - 1);
+    qsizetype l1End = std::min<qsizetype>(size, endIdx + 1);
+
+    l1Begin = l1Begin & ~1;
+    l1End = (l1End + 1) & ~1;
+    l1End = std::min(l1End, size);
+    return {l1Begin, l1End};
+}
+
 // Find the L1 index range covering the viewport, snapped to even bin-pair boundaries.
 inline L1ViewportBounds l1ViewportBounds(
-    const std::vector<double>& l1Keys, int l1Size, const QCPRange& keyRange)
+    const std::vector<double>& l1Keys, qsizetype l1Size, const QCPRange& keyRange)
 {
     auto beginIt = std::lower_bound(l1Keys.begin(), l1Keys.end(), keyRange.lower);
     auto endIt = std::upper_bound(l1Keys.begin(), l1Keys.end(), keyRange.upper);
-    int l1Begin = std::max(0, static_cast<int>(beginIt - l1Keys.begin()) - 1);
-    int l1End = std::min(l1Size, static_cast<int>(endIt - l1Keys.begin()) + 1);
+    return snapViewportBounds(beginIt - l1Keys.begin(), endIt - l1Keys.begin(), l1Size);
+}
 
-    l1Begin = l1Begin & ~1;
-    l1End = (l1End + 1) & ~1;
-    l1End = std::min(l1End, l1Size);
-    return {l1Begin, l1End};
+inline L1ViewportBounds l1ViewportBounds(const PyramidLevel& level, const QCPRange& keyRange)
+{
+    // First point whose key fails `below`, by bisection over the blocks' keys.
+    auto partitionPoint = [&](auto below) {
+        qsizetype lo = 0, hi = level.size();
+        while (lo < hi)
+        {
+            const qsizetype mid = lo + (hi - lo) / 2;
+            if (below(level.key(mid)))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    };
+    const qsizetype beginIdx = partitionPoint([&](double k) { return k < keyRange.lower; });
+    const qsizetype endIdx = partitionPoint([&](double k) { return !(keyRange.upper < k); });
+    return snapViewportBounds(beginIdx, endIdx, level.size());
 }
 
 // Bin source[begin..end) into numBins min/max pairs.
@@ -91,7 +210,7 @@ inline L1ViewportBounds l1ViewportBounds(
 inline BinResult binMinMax(
     const std::vector<double>& srcKeys,
     const std::vector<double>& srcValues,
-    int begin, int end,
+    qsizetype begin, qsizetype end,
     const QCPRange& keyRange,
     int numBins)
 {
@@ -102,29 +221,15 @@ inline BinResult binMinMax(
     const double binWidth = keyRange.size() / numBins;
     const double keyLo = keyRange.lower;
     initBinKeysAndValues(out, numBins, keyLo, binWidth);
-
-    for (int i = begin; i < end; ++i)
-    {
-        double k = srcKeys[i];
-        double v = srcValues[i];
-        if (std::isnan(v) || !std::isfinite(k)) continue;
-
-        int bin = static_cast<int>((k - keyLo) / binWidth);
-        bin = std::clamp(bin, 0, numBins - 1);
-
-        double& mn = out.values[bin * 2 + 0];
-        double& mx = out.values[bin * 2 + 1];
-        if (std::isnan(mn) || v < mn) mn = v;
-        if (std::isnan(mx) || v > mx) mx = v;
-    }
-
+    simd::minMaxKernels().accumulate(srcKeys.data(), srcValues.data(), begin, end,
+                                     keyLo, binWidth, out.values.data(), 0, numBins);
     return out;
 }
 
-// Overload that bins directly from a QCPAbstractDataSource (no intermediate copy).
+// binMinMax over the points [begin, end) of a pyramid level, block by block.
 inline BinResult binMinMax(
-    const QCPAbstractDataSource& src,
-    int begin, int end,
+    const PyramidLevel& level,
+    qsizetype begin, qsizetype end,
     const QCPRange& keyRange,
     int numBins)
 {
@@ -135,39 +240,43 @@ inline BinResult binMinMax(
     const double binWidth = keyRange.size() / numBins;
     const double keyLo = keyRange.lower;
     initBinKeysAndValues(out, numBins, keyLo, binWidth);
-
-    for (int i = begin; i < end; ++i)
+    const auto& kernels = simd::minMaxKernels();
+    for (int b = static_cast<int>(begin / PyramidLevel::kBlockPoints);
+         b < level.blockCount() && b * PyramidLevel::kBlockPoints < end; ++b)
     {
-        double k = src.keyAt(i);
-        double v = src.valueAt(i);
-        if (std::isnan(v) || !std::isfinite(k)) continue;
-
-        int bin = static_cast<int>((k - keyLo) / binWidth);
-        bin = std::clamp(bin, 0, numBins - 1);
-
-        double& mn = out.values[bin * 2 + 0];
-        double& mx = out.values[bin * 2 + 1];
-        if (std::isnan(mn) || v < mn) mn = v;
-        if (std::isnan(mx) || v > mx) mx = v;
+        const BinResult& block = level.block(b);
+        const qsizetype offset = b * PyramidLevel::kBlockPoints;
+        const qsizetype blockSize = static_cast<qsizetype>(block.keys.size());
+        kernels.accumulate(block.keys.data(), block.values.data(),
+                           std::max<qsizetype>(0, begin - offset),
+                           std::min(blockSize, end - offset),
+                           keyLo, binWidth, out.values.data(), 0, numBins);
     }
-
     return out;
 }
 
-// Parallel Level 1 binning: splits source into N chunks with bin-aligned
-// boundaries so each thread writes to disjoint output bins (zero synchronization).
-// Falls back to single-threaded binMinMax when threadCount <= 1.
-inline BinResult binMinMaxParallel(
+// Fold source[begin..end) into existing min/max pairs (2 doubles per bin) of a
+// grid starting at keyLo with bins of binWidth. Bin indices are clamped to
+// [binBegin, binEnd), so a caller owning that slice of `values` can run this
+// concurrently with other callers owning disjoint slices. Dispatches once to
+// the source, which bins in its native types (QCPSoADataSource).
+inline void accumulateMinMax(
     const QCPAbstractDataSource& src,
-    int begin, int end,
+    qsizetype begin, qsizetype end,
+    double keyLo, double binWidth,
+    double* values, int binBegin, int binEnd)
+{
+    src.accumulateMinMax(begin, end, keyLo, binWidth, values, binBegin, binEnd);
+    countScannedBytes(quint64(end - begin) * quint64(src.sampleBytes()));
+}
+
+// Overload that bins directly from a QCPAbstractDataSource (no intermediate copy).
+inline BinResult binMinMax(
+    const QCPAbstractDataSource& src,
+    qsizetype begin, qsizetype end,
     const QCPRange& keyRange,
     int numBins)
 {
-    PROFILE_HERE_N("binMinMaxParallel");
-    int threadCount = innerThreadCount();
-    if (threadCount <= 1 || (end - begin) < 1'000'000)
-        return binMinMax(src, begin, end, keyRange, numBins);
-
     BinResult out;
     if (numBins <= 0 || keyRange.size() <= 0)
         return out;
@@ -175,67 +284,119 @@ inline BinResult binMinMaxParallel(
     const double binWidth = keyRange.size() / numBins;
     const double keyLo = keyRange.lower;
     initBinKeysAndValues(out, numBins, keyLo, binWidth);
+    accumulateMinMax(src, begin, end, keyLo, binWidth, out.values.data(), 0, numBins);
+    return out;
+}
 
-    // Clamp thread count to available bins
-    threadCount = std::min(threadCount, numBins);
-
-    // Worker: iterate source[srcBegin..srcEnd), update bins[binBegin..binEnd)
-    auto worker = [&](int srcBegin, int srcEnd, int binBegin, int binEnd) {
-        for (int i = srcBegin; i < srcEnd; ++i)
-        {
-            double k = src.keyAt(i);
-            double v = src.valueAt(i);
-            if (std::isnan(v) || !std::isfinite(k)) continue;
+// Samples binned between two polls of the cancellation token.
+constexpr qsizetype kCancelPollSamples = qsizetype(1) << 20;
 
-            int bin = static_cast<int>((k - keyLo) / binWidth);
-            bin = std::clamp(bin, binBegin, binEnd - 1);
+// accumulateMinMax in kCancelPollSamples slices, stopping at the first slice
+// boundary after `cancel` fires (the bins are then incomplete).
+inline void accumulateMinMaxPolling(
+    const QCPAbstractDataSource& src,
+    qsizetype begin, qsizetype end,
+    double keyLo, double binWidth,
+    double* values, int binBegin, int binEnd,
+    const QCPCancellationToken& cancel)
+{
+    for (qsizetype b = begin; b < end && !cancel.isCancelled(); b += kCancelPollSamples)
+        accumulateMinMax(src, b, std::min(end, b + kCancelPollSamples), keyLo, binWidth,
+                         values, binBegin, binEnd);
+}
 
-            double& mn = out.values[bin * 2 + 0];
-            double& mx = out.values[bin * 2 + 1];
-            if (std::isnan(mn) || v < mn) mn = v;
-            if (std::isnan(mx) || v > mx) mx = v;
-        }
-    };
+// Parallel form of accumulateMinMax over the bin slice [binBegin, binEnd):
+// splits it into per-thread chunks with bin-aligned source boundaries so each
+// thread writes to disjoint output bins (zero synchronization). Runs on the
+// calling thread alone when threadCount <= 1 or the source range is small.
+inline void accumulateMinMaxParallel(
+    const QCPAbstractDataSource& src,
+    qsizetype begin, qsizetype end,
+    double keyLo, double binWidth,
+    double* values, int binBegin, int binEnd,
+    const QCPCancellationToken& cancel = {})
+{
+    int threadCount = std::min(innerThreadCount(), binEnd - binBegin);
+    if (threadCount <= 1 || (end - begin) < 1'000'000)
+    {
+        accumulateMinMaxPolling(src, begin, end, keyLo, binWidth, values, binBegin, binEnd, cancel);
+        return;
+    }
 
     // Partition bins evenly across threads, binary-search source for chunk boundaries
-    int binsPerChunk = numBins / threadCount;
-    QAtomicInt remaining(threadCount - 1);
-    QSemaphore done;
+    const int binsPerChunk = (binEnd - binBegin) / threadCount;
+    QCPTaskGroup group;
 
     for (int t = 0; t < threadCount; ++t)
     {
-        int binBegin = t * binsPerChunk;
-        int binEnd = (t == threadCount - 1) ? numBins : (t + 1) * binsPerChunk;
+        int chunkBinBegin = binBegin + t * binsPerChunk;
+        int chunkBinEnd = (t == threadCount - 1) ? binEnd : chunkBinBegin + binsPerChunk;
 
         // Find source indices that map to this chunk's bin range
-        double chunkKeyLo = keyLo + binBegin * binWidth;
-        double chunkKeyHi = keyLo + binEnd * binWidth;
-        int srcBegin_ = (t == 0) ? begin : src.findBegin(chunkKeyLo, false);
-        int srcEnd_ = (t == threadCount - 1) ? end : src.findEnd(chunkKeyHi, false);
+        double chunkKeyLo = keyLo + chunkBinBegin * binWidth;
+        double chunkKeyHi = keyLo + chunkBinEnd * binWidth;
+        qsizetype srcBegin_ = (t == 0) ? begin : src.findBegin(chunkKeyLo, false);
+        // Chunk t+1 starts at the same lower bound: a key on the boundary
+        // belongs to exactly one chunk.
+        qsizetype srcEnd_ = (t == threadCount - 1) ? end : src.findBegin(chunkKeyHi, false);
         srcBegin_ = std::clamp(srcBegin_, begin, end);
         srcEnd_ = std::clamp(srcEnd_, begin, end);
 
         if (t < threadCount - 1)
-            innerPool().start([&, srcBegin_, srcEnd_, binBegin, binEnd] {
-                nameThisPoolThreadOnce("binWorker");
-                worker(srcBegin_, srcEnd_, binBegin, binEnd);
-                if (remaining.fetchAndSubRelaxed(1) == 1)
-                    done.release();
+            group.run([&, srcBegin_, srcEnd_, chunkBinBegin, chunkBinEnd] {
+                accumulateMinMaxPolling(src, srcBegin_, srcEnd_, keyLo, binWidth,
+                                        values, chunkBinBegin, chunkBinEnd, cancel);
             });
-        else
-            worker(srcBegin_, srcEnd_, binBegin, binEnd); // current thread does last chunk
+        else // current thread does last chunk
+            accumulateMinMaxPolling(src, srcBegin_, srcEnd_, keyLo, binWidth,
+                                    values, chunkBinBegin, chunkBinEnd, cancel);
     }
+    group.wait();
+}
 
-    if (remaining.loadRelaxed() > 0)
-        done.acquire();
+// Parallel Level 1 binning: splits source into N chunks with bin-aligned
+// boundaries so each thread writes to disjoint output bins (zero synchronization).
+// Falls back to single-threaded binMinMax when threadCount <= 1.
+// Bins are incomplete if `cancel` fires; callers check it before using them.
+inline BinResult binMinMaxParallel(
+    const QCPAbstractDataSource& src,
+    qsizetype begin, qsizetype end,
+    const QCPRange& keyRange,
+    int numBins,
+    const QCPCancellationToken& cancel = {})
+{
+    PROFILE_HERE_N("binMinMaxParallel");
+    BinResult out;
+    if (numBins <= 0 || keyRange.size() <= 0)
+        return out;
 
+    const double binWidth = keyRange.size() / numBins;
+    const double keyLo = keyRange.lower;
+    initBinKeysAndValues(out, numBins, keyLo, binWidth);
+    accumulateMinMaxParallel(src, begin, end, keyLo, binWidth, out.values.data(), 0, numBins, cancel);
     return out;
 }
 
 struct GraphResamplerCache {
-    BinResult level1;
+    // Finest level of the min/max pyramid, binned from the source.
+    PyramidLevel level1;
+    // Coarser pyramid levels derived from level1, each kPyramidFactor times
+    // coarser than the previous one (coarseLevels[0] is level1 / factor).
+    std::vector<PyramidLevel> coarseLevels;
     QCPRange cachedKeyRange;
-    int sourceSize = 0;
+    qsizetype sourceSize = 0;
+    // L1 grid: level1.bins() bins of l1BinWidth starting at
+    // cachedKeyRange.lower. After an incremental extension the grid may reach
+    // past cachedKeyRange.upper (it grows in whole bins).
+    double l1BinWidth = 0;
+
+    quint64 memoryBytes() const
+    {
+        quint64 bytes = level1.memoryBytes();
+        for (const PyramidLevel& level : coarseLevels)
+            bytes += level.memoryBytes();
+        return bytes;
+    }
 };
 
 struct MultiColumnBinResult {
@@ -243,18 +404,24 @@ struct MultiColumnBinResult {
     std::vector<double> values;  // N * 2 * numBins, column-major
     int numColumns = 0;
     int stride() const { return static_cast<int>(keys.size()); }
+    quint64 memoryBytes() const
+    {
+        return (keys.capacity() + values.capacity()) * sizeof(double);
+    }
 };
 
 struct MultiGraphResamplerCache {
     MultiColumnBinResult level1;
     QCPRange cachedKeyRange;
-    int sourceSize = 0;
+    qsizetype sourceSize = 0;
     int columnCount = 0;
+
+    quint64 memoryBytes() const { return level1.memoryBytes(); }
 };
 
 inline MultiColumnBinResult binMinMaxMulti(
     const QCPAbstractMultiDataSource& src,
-    int begin, int end,
+    qsizetype begin, qsizetype end,
     const QCPRange& keyRange,
     int numBins)
 {
@@ -282,8 +449,8 @@ inline MultiColumnBinResult binMinMaxMulti(
     // Pre-compute bin indices for all source points (keys are shared across columns)
     const double* rawKeys = src.rawKeyData();
     std::vector<int> bins(end - begin);
-    int validCount = 0;
-    for (int i = begin; i < end; ++i)
+    qsizetype validCount = 0;
+    for (qsizetype i = begin; i < end; ++i)
     {
         double k = rawKeys ? rawKeys[i] : src.keyAt(i);
         if (!std::isfinite(k)) { bins[i - begin] = -1; continue; }
@@ -292,12 +459,28 @@ inline MultiColumnBinResult binMinMaxMulti(
     }
     if (validCount == 0) return out;
 
+    std::vector<const double*> rawCols(N);
+    bool allRaw = true;
+    for (int c = 0; c < N; ++c)
+    {
+        rawCols[c] = src.rawColumnData(c);
+        allRaw = allRaw && rawCols[c] != nullptr;
+        if (rawCols[c])
+            rawCols[c] += begin;
+    }
+    if (allRaw)
+    {
+        simd::minMaxKernels().accumulateBinned(bins.data(), end - begin, rawCols.data(), N,
+                                               out.values.data(), s);
+        return out;
+    }
+
     // Outer loop over columns: each column's output region is contiguous in memory
     for (int c = 0; c < N; ++c)
     {
         double* colOut = out.values.data() + c * s;
         const double* rawCol = src.rawColumnData(c);
-        for (int i = begin; i < end; ++i)
+        for (qsizetype i = begin; i < end; ++i)
         {
             int bin = bins[i - begin];
             if (bin < 0) continue;
@@ -316,7 +499,7 @@ inline MultiColumnBinResult binMinMaxMulti(
 
 inline MultiColumnBinResult binMinMaxMultiParallel(
     const QCPAbstractMultiDataSource& src,
-    int begin, int end,
+    qsizetype begin, qsizetype end,
     const QCPRange& keyRange,
     int numBins)
 {
@@ -350,25 +533,39 @@ inline MultiColumnBinResult binMinMaxMultiParallel(
 
     const double* rawKeys = src.rawKeyData();
     std::vector<const double*> rawCols(N);
+    bool allRaw = true;
     for (int c = 0; c < N; ++c)
+    {
         rawCols[c] = src.rawColumnData(c);
+        allRaw = allRaw && rawCols[c] != nullptr;
+    }
 
-    auto worker = [&](int srcBegin, int srcEnd, int binBegin, int binEnd) {
+    auto worker = [&](qsizetype srcBegin, qsizetype srcEnd, int binBegin, int binEnd) {
         // Pre-compute bin indices for this chunk
-        int count = srcEnd - srcBegin;
+        qsizetype count = srcEnd - srcBegin;
         std::vector<int> bins(count);
-        for (int i = 0; i < count; ++i)
+        for (qsizetype i = 0; i < count; ++i)
         {
             double k = rawKeys ? rawKeys[srcBegin + i] : src.keyAt(srcBegin + i);
             if (!std::isfinite(k)) { bins[i] = -1; continue; }
             bins[i] = std::clamp(static_cast<int>((k - keyLo) / binWidth), binBegin, binEnd - 1);
         }
 
+        if (allRaw)
+        {
+            std::vector<const double*> chunkCols(N);
+            for (int c = 0; c < N; ++c)
+                chunkCols[c] = rawCols[c] + srcBegin;
+            simd::minMaxKernels().accumulateBinned(bins.data(), count, chunkCols.data(), N,
+                                                   out.values.data(), s);
+            return;
+        }
+
         for (int c = 0; c < N; ++c)
         {
             double* colOut = out.values.data() + c * s;
             const double* rawCol = rawCols[c];
-            for (int i = 0; i < count; ++i)
+            for (qsizetype i = 0; i < count; ++i)
             {
                 int bin = bins[i];
                 if (bin < 0) continue;
@@ -384,8 +581,7 @@ inline MultiColumnBinResult binMinMaxMultiParallel(
     };
 
     int binsPerChunk = numBins / threadCount;
-    QAtomicInt remaining(threadCount - 1);
-    QSemaphore done;
+    QCPTaskGroup group;
 
     for (int t = 0; t < threadCount; ++t)
     {
@@ -394,41 +590,211 @@ inline MultiColumnBinResult binMinMaxMultiParallel(
 
         double chunkKeyLo = keyLo + binBegin * binWidth;
         double chunkKeyHi = keyLo + binEnd * binWidth;
-        int srcBegin_ = (t == 0) ? begin : src.findBegin(chunkKeyLo, false);
-        int srcEnd_ = (t == threadCount - 1) ? end : src.findEnd(chunkKeyHi, false);
+        qsizetype srcBegin_ = (t == 0) ? begin : src.findBegin(chunkKeyLo, false);
+        // Chunk t+1 starts at the same lower bound: a key on the boundary
+        // belongs to exactly one chunk.
+        qsizetype srcEnd_ = (t == threadCount - 1) ? end : src.findBegin(chunkKeyHi, false);
         srcBegin_ = std::clamp(srcBegin_, begin, end);
         srcEnd_ = std::clamp(srcEnd_, begin, end);
 
         if (t < threadCount - 1)
-            innerPool().start([&, srcBegin_, srcEnd_, binBegin, binEnd] {
-                nameThisPoolThreadOnce("binWorker");
+            group.run([&, srcBegin_, srcEnd_, binBegin, binEnd] {
                 worker(srcBegin_, srcEnd_, binBegin, binEnd);
-                if (remaining.fetchAndSubRelaxed(1) == 1)
-                    done.release();
             });
         else
             worker(srcBegin_, srcEnd_, binBegin, binEnd);
     }
-
-    if (remaining.loadRelaxed() > 0)
-        done.acquire();
+    group.wait();
 
     return out;
 }
 
 constexpr int kLevel1TargetBins = 100'000;
+// Graph L1 pyramid base: ~kLevel1SamplesPerBin source samples per bin, capped
+// at kLevel1MaxBins (4M bins = 128 MiB of keys + values) so that deep zooms on
+// very large series still land on pre-binned data. An appended grid grows bin
+// by bin up to the same cap, then halves its resolution by merging bin pairs,
+// i.e. it re-grids once per key range doubling.
+constexpr int kLevel1SamplesPerBin = 16;
+constexpr int kLevel1MaxBins = 1 << 22;
+// Coarser levels are kPyramidFactor times smaller, down to kPyramidMinBins.
+constexpr int kPyramidFactor = 8;
+constexpr int kPyramidMinBins = 1024;
 constexpr int kResampleThreshold = 100'000;
 constexpr int kLevel2PixelMultiplier = 4;
+// Log-key L2 bins narrower than a level1 bin are filled from raw samples, as
+// long as that costs at most this many samples per L2 bin on average.
+constexpr int kLevel2MaxRawSamplesPerBin = 32;
+
+// (Re)derives the coarse pyramid levels of `cache` from its level1. Only the
+// coarse bins covering level1 bins >= fromBin are recomputed — the others are
+// assumed valid (incremental extension). O(level1 bins / (factor - 1)).
+inline void updatePyramid(GraphResamplerCache& cache, int fromBin = 0)
+{
+    const double keyLo = cache.cachedKeyRange.lower;
+    double binWidth = cache.l1BinWidth;
+    int fineBins = cache.level1.bins();
+    std::size_t level = 0;
+    while (fineBins / kPyramidFactor >= kPyramidMinBins)
+    {
+        const int bins = (fineBins + kPyramidFactor - 1) / kPyramidFactor;
+        binWidth *= kPyramidFactor;
+        fromBin /= kPyramidFactor;
+        if (level == cache.coarseLevels.size())
+        {
+            cache.coarseLevels.emplace_back();
+            fromBin = 0;
+        }
+        // resolved after emplace_back, which may reallocate coarseLevels
+        const PyramidLevel& fine = level == 0 ? cache.level1 : cache.coarseLevels[level - 1];
+        PyramidLevel& coarse = cache.coarseLevels[level];
+        coarse.grow(bins, keyLo, binWidth);
+        // Only the blocks holding recomputed bins are written (and unshared).
+        for (int block = fromBin / PyramidLevel::kBlockBins; block < coarse.blockCount(); ++block)
+        {
+            BinResult& out = coarse.mutableBlock(block);
+            const int blockBegin = block * PyramidLevel::kBlockBins;
+            const int blockEnd = std::min(bins, blockBegin + PyramidLevel::kBlockBins);
+            for (int b = std::max(fromBin, blockBegin); b < blockEnd; ++b)
+            {
+                double mn = std::numeric_limits<double>::quiet_NaN();
+                double mx = mn;
+                const int hi = std::min((b + 1) * kPyramidFactor, fineBins);
+                // fmin/fmax ignore a NaN operand, so empty bins merge transparently
+                for (int f = b * kPyramidFactor; f < hi; ++f)
+                {
+                    mn = std::fmin(mn, fine.value(qsizetype(f) * 2 + 0));
+                    mx = std::fmax(mx, fine.value(qsizetype(f) * 2 + 1));
+                }
+                out.values[(b - blockBegin) * 2 + 0] = mn;
+                out.values[(b - blockBegin) * 2 + 1] = mx;
+            }
+        }
+        fineBins = bins;
+        ++level;
+    }
+    cache.coarseLevels.resize(level);
+}
+
+// Incremental L1 for append-only sources: reuses the bins of `prev` (built
+// from a prefix of `src`) and only bins the appended tail [prev.sourceSize,
+// srcSize). The grid keeps its origin and bin width and grows by whole bins;
+// when it would exceed kLevel1MaxBins, adjacent bin pairs are merged (min of
+// mins, max of maxes) until it fits. `prev` is still on screen and shared, so
+// the new L1 shares its pyramid blocks and only the blocks holding bins from
+// the first appended key on are copied and written. Returns false when `prev`
+// cannot be extended (range start moved, source shrank, a key jump too far to
+// merge down to) — caller rebuilds from scratch.
+inline bool extendL1Cache(
+    const QCPAbstractDataSource& src,
+    const GraphResamplerCache& prev,
+    qsizetype srcSize, const QCPRange& fullKeyRange,
+    GraphResamplerCache& out)
+{
+    PROFILE_HERE_N("extendL1Cache");
+    int numBins = prev.level1.bins();
+    double binWidth = prev.l1BinWidth;
+    if (numBins == 0 || binWidth <= 0 || prev.sourceSize <= 0 || prev.sourceSize > srcSize
+        || fullKeyRange.lower != prev.cachedKeyRange.lower
+        || fullKeyRange.upper < prev.cachedKeyRange.upper)
+        return false;
+
+    const double keyLo = fullKeyRange.lower;
+    // Counted in double: a far key jump would overflow int. Past twice the cap,
+    // a fresh grid over the whole range beats merging over and over.
+    auto binsNeeded = [&] { return std::ceil((fullKeyRange.upper - keyLo) / binWidth); };
+    if (!(binsNeeded() <= 2.0 * kLevel1MaxBins))
+        return false;
+
+    int needed = std::max(numBins, static_cast<int>(std::max(1.0, binsNeeded())));
+    const bool regridded = needed > kLevel1MaxBins;
+    PyramidLevel l1;
+    if (!regridded)
+        l1 = prev.level1; // shares every block
+    else
+    {
+        // Every bin moves: merge over a contiguous copy, once per key range
+        // doubling.
+        BinResult merged = prev.level1.toBins();
+        while (needed > kLevel1MaxBins)
+        {
+            const int half = (numBins + 1) / 2;
+            for (int b = 0; b < half; ++b)
+            {
+                const int lo = 2 * b, hi = std::min(2 * b + 1, numBins - 1);
+                // fmin/fmax ignore a NaN operand, so empty bins merge transparently
+                merged.values[b * 2 + 0] = std::fmin(merged.values[lo * 2 + 0], merged.values[hi * 2 + 0]);
+                merged.values[b * 2 + 1] = std::fmax(merged.values[lo * 2 + 1], merged.values[hi * 2 + 1]);
+            }
+            numBins = half;
+            binWidth *= 2;
+            needed = std::max(numBins, static_cast<int>(std::max(1.0, binsNeeded())));
+        }
+        merged.values.resize(numBins * 2);
+        merged.keys.resize(numBins * 2);
+        setBinKeys(merged, 0, numBins, keyLo, binWidth);
+        l1 = PyramidLevel::fromBins(std::move(merged));
+    }
+    // New bins start empty.
+    l1.grow(needed, keyLo, binWidth);
+
+    int firstBin = numBins;
+    if (srcSize > prev.sourceSize)
+    {
+        const double firstKey = src.keyAt(prev.sourceSize);
+        firstBin = std::isfinite(firstKey)
+            ? std::clamp(static_cast<int>((firstKey - keyLo) / binWidth), 0, needed - 1)
+            : 0;
+        // Sources bin into one array indexed from the grid origin: fold the
+        // tail into a scratch spanning the grid of which only bins from
+        // firstBin on are ever written (the pages before them are never
+        // touched), then copy those bins back into their blocks.
+        const auto scratch = std::make_unique_for_overwrite<double[]>(2 * std::size_t(needed));
+        const int firstBlock = firstBin / PyramidLevel::kBlockBins;
+        auto binsOfBlock = [&](int block, auto&& fn) {
+            const int blockBegin = block * PyramidLevel::kBlockBins;
+            const int from = std::max(firstBin, blockBegin);
+            const int to = std::min(needed, blockBegin + PyramidLevel::kBlockBins);
+            fn(2 * std::size_t(from - blockBegin), 2 * std::size_t(from), 2 * std::size_t(to - from));
+        };
+        for (int block = firstBlock; block < l1.blockCount(); ++block)
+            binsOfBlock(block, [&](std::size_t local, std::size_t global, std::size_t n) {
+                std::copy_n(l1.block(block).values.begin() + local, n, scratch.get() + global);
+            });
+        accumulateMinMaxParallel(src, prev.sourceSize, srcSize, keyLo, binWidth,
+                                 scratch.get(), firstBin, needed);
+        for (int block = firstBlock; block < l1.blockCount(); ++block)
+            binsOfBlock(block, [&](std::size_t local, std::size_t global, std::size_t n) {
+                std::copy_n(scratch.get() + global, n, l1.mutableBlock(block).values.begin() + local);
+            });
+    }
+
+    out.level1 = std::move(l1);
+    out.cachedKeyRange = fullKeyRange;
+    out.sourceSize = srcSize;
+    out.l1BinWidth = binWidth;
+    // Coarse levels only change above the first touched base bin, unless the
+    // base was re-gridded.
+    if (!regridded)
+        out.coarseLevels = prev.coarseLevels;
+    updatePyramid(out, regridded ? 0 : firstBin);
+    return true;
+}
 
 // L1 build only — heavy, meant for async pipeline.
 // Returns the L1 cache via the std::any, result is nullptr (L2 is done synchronously).
+// When `previous` is an L1 built from a prefix of `src` (append-only data),
+// only the appended tail is binned (see extendL1Cache). A full build polls
+// `cancel` and leaves `cache` untouched when it fires.
 inline std::shared_ptr<QCPAbstractDataSource> buildL1Cache(
     const QCPAbstractDataSource& src,
     const ViewportParams& /*vp*/,
-    std::any& cache)
+    std::any& cache,
+    const GraphResamplerCache* previous = nullptr,
+    const QCPCancellationToken& cancel = {})
 {
     PROFILE_HERE_N("buildL1Cache");
-    const int srcSize = src.size();
+    const qsizetype srcSize = src.size();
     if (srcSize == 0 || srcSize < kResampleThreshold)
         return nullptr;
 
@@ -443,43 +809,140 @@ inline std::shared_ptr<QCPAbstractDataSource> buildL1Cache(
     auto* c = std::any_cast<GraphResamplerCache>(&cache);
     if (c && c->sourceSize == srcSize && c->cachedKeyRange == fullKeyRange)
         return nullptr; // L1 already valid
-    int numBins = std::min(kLevel1TargetBins, srcSize / 10);
 
     GraphResamplerCache newCache;
-    newCache.level1 = binMinMaxParallel(src, 0, srcSize, fullKeyRange, numBins);
+    if (previous && extendL1Cache(src, *previous, srcSize, fullKeyRange, newCache))
+    {
+        cache = std::move(newCache);
+        return nullptr;
+    }
+
+    // One pass over the source for the base level; coarser levels are
+    // derived from it.
+    int numBins = static_cast<int>(std::min<qsizetype>(kLevel1MaxBins, srcSize / kLevel1SamplesPerBin));
+    double binWidth = fullKeyRange.size() / numBins;
+    if (const double hint = src.l1BinWidthHint(); hint > 0 && std::isfinite(hint))
+    {
+        // At most as many bins, each a whole multiple of the hint; the grid
+        // may then reach past the last key.
+        binWidth = hint * std::max(1.0, std::ceil(fullKeyRange.size() / hint / numBins));
+        numBins = std::max(1, static_cast<int>(std::ceil(fullKeyRange.size() / binWidth)));
+    }
+    BinResult level1;
+    src.adviseAccess(0, srcSize, QCPAccessHint::Sequential);
+    initBinKeysAndValues(level1, numBins, fullKeyRange.lower, binWidth);
+    accumulateMinMaxParallel(src, 0, srcSize, fullKeyRange.lower, binWidth,
+                             level1.values.data(), 0, numBins, cancel);
+    src.adviseAccess(0, srcSize, QCPAccessHint::Normal);
+    if (cancel.isCancelled())
+        return nullptr;
+    newCache.level1 = PyramidLevel::fromBins(std::move(level1));
     newCache.cachedKeyRange = fullKeyRange;
     newCache.sourceSize = srcSize;
+    newCache.l1BinWidth = binWidth;
+    updatePyramid(newCache);
     cache = std::move(newCache);
     return nullptr;
 }
 
-// L2 viewport resampling — fast, runs synchronously on the main thread.
-// Takes a shared L1 cache (read-only) and the current viewport.
-inline std::shared_ptr<QCPAbstractDataSource> resampleL2(
-    const GraphResamplerCache& l1Cache,
-    const ViewportParams& vp)
+// Newest L1 of one graph's append-only series, handed from one extension job
+// to the next: a job extends whatever the one before it finished, whether or
+// not that result has reached the screen yet, so appends arriving faster than
+// an extension runs never re-bin the same tail. Held weakly — the graph owns
+// its L1s.
+class L1ExtensionChain
 {
-    PROFILE_HERE_N("resampleL2");
-    if (vp.keyLogScale)
-        return nullptr;
+public:
+    explicit L1ExtensionChain(std::shared_ptr<const GraphResamplerCache> base)
+        : mLatest(std::move(base)) {}
 
-    int l2Bins = vp.plotWidthPx * kLevel2PixelMultiplier;
-    if (l2Bins <= 0) l2Bins = 3200;
+    std::shared_ptr<const GraphResamplerCache> latest() const
+    {
+        QMutexLocker lock(&mMutex);
+        return mLatest.lock();
+    }
 
-    const auto& l1 = l1Cache.level1;
-    int l1Size = static_cast<int>(l1.keys.size());
-    if (l1Size == 0) return nullptr;
+    // Keeps `l1` if it covers more of the series than the latest one.
+    void offer(const std::shared_ptr<const GraphResamplerCache>& l1)
+    {
+        QMutexLocker lock(&mMutex);
+        auto latest = mLatest.lock();
+        if (l1 && (!latest || l1->sourceSize > latest->sourceSize))
+            mLatest = l1;
+    }
 
-    auto [l1Begin, l1End] = l1ViewportBounds(l1.keys, l1Size, vp.keyRange);
-    if (l1End <= l1Begin)
-        return nullptr;
+private:
+    mutable QMutex mMutex;
+    std::weak_ptr<const GraphResamplerCache> mLatest;
+};
 
-    // Skip L2 binning when visible points are sparse enough to draw directly
-    if (l1End - l1Begin <= l2Bins)
+// buildL1Cache extending the latest L1 of `chain` (a full build when it is
+// gone). The new L1 goes to `cache` as a std::shared_ptr<const
+// GraphResamplerCache> and is offered to the chain.
+inline std::shared_ptr<QCPAbstractDataSource> buildChainedL1Cache(
+    const QCPAbstractDataSource& src,
+    const ViewportParams& vp,
+    std::any& cache,
+    L1ExtensionChain& chain,
+    const QCPCancellationToken& cancel = {})
+{
+    const auto previous = chain.latest();
+    if (previous && previous->sourceSize == src.size())
+    {
+        cache = previous; // already caught up with this snapshot
         return nullptr;
+    }
+    auto result = buildL1Cache(src, vp, cache, previous.get(), cancel);
+    if (auto* built = std::any_cast<GraphResamplerCache>(&cache))
+    {
+        auto shared = std::make_shared<const GraphResamplerCache>(std::move(*built));
+        chain.offer(shared);
+        cache = std::move(shared);
+    }
+    return result;
+}
 
-    auto l2 = binMinMax(l1.keys, l1.values, l1Begin, l1End, vp.keyRange, l2Bins);
+// Samples around the viewport the plottables hint as WillNeed: past this many
+// the draw comes from the L1 pyramid and the hint would only queue reads of
+// pages that are never touched.
+constexpr qsizetype kViewportAdviseMaxSamples = 4 * 1024 * 1024;
 
+// WillNeed hint for the view plus the one-view margin on each side that the
+// line cache reads (QCPGraph2/QCPMultiGraph::draw).
+template <typename Source>
+void adviseViewport(const Source& src, const QCPRange& keyRange)
+{
+    const double margin = keyRange.size();
+    const qsizetype begin = src.findBegin(keyRange.lower - margin);
+    const qsizetype end = src.findEnd(keyRange.upper + margin);
+    if (end > begin && end - begin <= kViewportAdviseMaxSamples)
+        src.adviseAccess(begin, end, QCPAccessHint::WillNeed);
+}
+
+// Picks the coarsest pyramid level that still has more than `l2Bins` points
+// in view, and its visible [begin, end) point range. Falls back to level1
+// when no coarse level is fine enough; returns nullptr when level1 has no
+// point in view.
+inline const PyramidLevel* selectPyramidLevel(
+    const GraphResamplerCache& l1Cache, const QCPRange& keyRange, int l2Bins,
+    L1ViewportBounds& bounds)
+{
+    for (auto it = l1Cache.coarseLevels.rbegin(); it != l1Cache.coarseLevels.rend(); ++it)
+    {
+        bounds = l1ViewportBounds(*it, keyRange);
+        if (bounds.end - bounds.begin > l2Bins)
+            return &*it;
+    }
+    const auto& l1 = l1Cache.level1;
+    if (l1.empty())
+        return nullptr;
+    bounds = l1ViewportBounds(l1, keyRange);
+    return &l1;
+}
+
+// Drops the empty (NaN) points of an L2 result and wraps the rest in a source.
+inline std::shared_ptr<QCPAbstractDataSource> compactL2(const BinResult& l2)
+{
     std::vector<double> outKeys, outVals;
     outKeys.reserve(l2.keys.size());
     outVals.reserve(l2.values.size());
@@ -499,6 +962,190 @@ inline std::shared_ptr<QCPAbstractDataSource> resampleL2(
         std::move(outKeys), std::move(outVals));
 }
 
+// Preview of an L1 still being built: kPreviewBlocks evenly spaced runs of
+// kPreviewBlockSamples contiguous samples, binned min/max into kPreviewBins
+// over the full key range. Contiguous runs keep a paged (mmap) source to a
+// few hundred page faults rather than one per page, and the runs are few
+// enough to finish in milliseconds at any source size. Bins between runs stay
+// empty and are dropped, so the line bridges them; the first and last runs
+// sit at the source ends so the preview spans the whole key range.
+constexpr int kPreviewBins = 4096;
+constexpr qsizetype kPreviewBlocks = 256;
+constexpr qsizetype kPreviewBlockSamples = 2048;
+
+inline std::shared_ptr<QCPAbstractDataSource> buildPreview(
+    const QCPAbstractDataSource& src,
+    const ViewportParams& /*vp*/,
+    const QCPCancellationToken& cancel = {})
+{
+    PROFILE_HERE_N("buildPreview");
+    const qsizetype srcSize = src.size();
+    // A source hinting its L1 grid bins it from summaries, about as fast as
+    // the preview would be and without reading any sample.
+    if (srcSize < kResampleThreshold || src.l1BinWidthHint() > 0)
+        return nullptr;
+
+    bool foundRange = false;
+    const QCPRange fullKeyRange = src.keyRange(foundRange);
+    if (!foundRange || fullKeyRange.size() <= 0)
+        return nullptr;
+
+    BinResult bins;
+    const double binWidth = fullKeyRange.size() / kPreviewBins;
+    initBinKeysAndValues(bins, kPreviewBins, fullKeyRange.lower, binWidth);
+
+    const qsizetype runs = std::min(kPreviewBlocks, srcSize / kPreviewBlockSamples);
+    const qsizetype runLength = srcSize / runs;
+    const qsizetype block = std::min(kPreviewBlockSamples, runLength);
+    for (qsizetype r = 0; r < runs; ++r)
+    {
+        if (cancel.isCancelled())
+            return nullptr;
+        // Run r is the tail of the r-th of `runs` equal slices.
+        const qsizetype end = r + 1 == runs ? srcSize : (r + 1) * runLength;
+        const qsizetype begin = end - block;
+        accumulateMinMax(src, begin, end, fullKeyRange.lower, binWidth,
+                         bins.values.data(), 0, kPreviewBins);
+    }
+    // Plus the head of the first slice, for the left edge.
+    if (runLength > block)
+        accumulateMinMax(src, 0, block, fullKeyRange.lower, binWidth,
+                         bins.values.data(), 0, kPreviewBins);
+    return compactL2(bins);
+}
+
+// Log-key L2: bins are uniform in log10(key), but the pyramid is uniform in
+// linear key — an L2 bin starting at key x is x * growth wide, so which level
+// resolves it depends on x. The view is split at pyramid bin edges into
+// segments, each binned from the coarsest level whose bins still fit in the
+// L2 bins there, which keeps the cost O(l2Bins) at any zoom. The low-key
+// prefix where even level1 is too coarse is binned from the raw samples of
+// `src` (when given and within kLevel2MaxRawSamplesPerBin), else from level1.
+inline std::shared_ptr<QCPAbstractDataSource> resampleL2Log(
+    const GraphResamplerCache& l1Cache, const ViewportParams& vp, int l2Bins,
+    const QCPAbstractDataSource* src)
+{
+    const QCPRange& range = vp.keyRange;
+    const PyramidLevel& l1 = l1Cache.level1;
+    const double width1 = l1Cache.l1BinWidth;
+    if (range.lower <= 0 || range.upper <= range.lower || l1.empty() || width1 <= 0)
+        return nullptr;
+
+    // Same sparseness cut-off as the linear path
+    const L1ViewportBounds visible = l1ViewportBounds(l1, range);
+    if (visible.end - visible.begin <= l2Bins)
+        return nullptr;
+
+    const BinAxis axis = BinAxis::make(range, l2Bins, true);
+    const double growth = std::pow(10.0, 1.0 / axis.invWidth) - 1.0;
+
+    BinResult l2;
+    l2.keys.resize(l2Bins * 2);
+    l2.values.assign(l2Bins * 2, std::numeric_limits<double>::quiet_NaN());
+    for (int b = 0; b < l2Bins; ++b)
+    {
+        l2.keys[b * 2 + 0] = axis.coord(b + 0.5);
+        l2.keys[b * 2 + 1] = axis.coord(b + 1.0);
+    }
+    auto fold = [&](double k, double v) {
+        if (std::isnan(v) || !(k > 0) || !std::isfinite(k)) return;
+        const int bin = axis.index(k);
+        double& mn = l2.values[bin * 2 + 0];
+        double& mx = l2.values[bin * 2 + 1];
+        if (std::isnan(mn) || v < mn) mn = v;
+        if (std::isnan(mx) || v > mx) mx = v;
+    };
+
+    // Segment boundaries are counted in level1 bins from the grid origin.
+    const double origin = l1Cache.cachedKeyRange.lower;
+    const qsizetype l1Bins = l1.bins();
+    auto toBin = [&](double key) {
+        return std::clamp((key - origin) / width1, 0.0, static_cast<double>(l1Bins));
+    };
+    const qsizetype viewBegin = static_cast<qsizetype>(std::floor(toBin(range.lower)));
+    const qsizetype viewEnd = static_cast<qsizetype>(std::ceil(toBin(range.upper)));
+    // First edge of a level made of `span`-level1-bin bins from which those
+    // bins are no wider than the L2 bins.
+    auto fitsFrom = [&](qsizetype span) {
+        const double b = std::ceil(toBin(span * width1 / growth) / span) * span;
+        return std::clamp(static_cast<qsizetype>(b), viewBegin, viewEnd);
+    };
+
+    qsizetype segBegin = fitsFrom(1);
+    if (segBegin > viewBegin && src)
+    {
+        const qsizetype rawBegin = src->findBegin(range.lower, false);
+        const qsizetype rawEnd = src->findBegin(origin + segBegin * width1, false);
+        if (rawEnd - rawBegin <= static_cast<qsizetype>(kLevel2MaxRawSamplesPerBin) * l2Bins)
+        {
+            for (qsizetype i = rawBegin; i < rawEnd; ++i)
+                fold(src->keyAt(i), src->valueAt(i));
+        }
+        else
+            segBegin = viewBegin;
+    }
+    else
+        segBegin = viewBegin;
+
+    // Segments overlap by at most one coarse bin at their edges; folding a
+    // point twice into a min/max is harmless.
+    const std::size_t levelCount = l1Cache.coarseLevels.size() + 1;
+    qsizetype span = 1;
+    for (std::size_t k = 0; k < levelCount && segBegin < viewEnd; ++k)
+    {
+        const PyramidLevel& level = k == 0 ? l1 : l1Cache.coarseLevels[k - 1];
+        const qsizetype segEnd = k + 1 < levelCount
+            ? std::max(segBegin, fitsFrom(span * kPyramidFactor))
+            : viewEnd;
+        const qsizetype n = level.size();
+        const qsizetype first = std::min(segBegin / span * 2, n);
+        const qsizetype last = std::min((segEnd + span - 1) / span * 2, n);
+        for (qsizetype i = first; i < last; ++i)
+            fold(level.key(i), level.value(i));
+        segBegin = segEnd;
+        span *= kPyramidFactor;
+    }
+
+    return compactL2(l2);
+}
+
+// L2 viewport resampling — fast, runs synchronously on the main thread.
+// Takes a shared L1 cache (read-only) and the current viewport; bins the
+// coarsest pyramid level that still resolves the viewport, so the cost is
+// O(plotWidthPx) at any zoom level rather than O(visible L1 bins).
+// On a log key axis the bins are log-spaced (see resampleL2Log); `src`, the
+// source the cache was built from, is then used for the low-key end.
+inline std::shared_ptr<QCPAbstractDataSource> resampleL2(
+    const GraphResamplerCache& l1Cache,
+    const ViewportParams& vp,
+    const QCPAbstractDataSource* src = nullptr)
+{
+    PROFILE_HERE_N("resampleL2");
+    int l2Bins = vp.plotWidthPx * kLevel2PixelMultiplier;
+    if (l2Bins <= 0) l2Bins = 3200;
+
+    if (vp.keyLogScale)
+        return resampleL2Log(l1Cache, vp, l2Bins, src);
+
+    L1ViewportBounds bounds{0, 0};
+    const PyramidLevel* level = selectPyramidLevel(l1Cache, vp.keyRange, l2Bins, bounds);
+    if (!level || bounds.end <= bounds.begin)
+        return nullptr;
+
+    // Skip L2 binning when visible points are sparse enough to draw directly,
+    // unless the raw samples behind them are still too many to draw (an L1
+    // coarser than kLevel1SamplesPerBin, e.g. one following l1BinWidthHint()).
+    if (bounds.end - bounds.begin <= l2Bins)
+    {
+        const double samplesPerPoint =
+            double(l1Cache.sourceSize) / double(std::max<qsizetype>(1, l1Cache.level1.size()));
+        if ((bounds.end - bounds.begin) * samplesPerPoint <= double(kViewportAdviseMaxSamples))
+            return nullptr;
+    }
+
+    return compactL2(binMinMax(*level, bounds.begin, bounds.end, vp.keyRange, l2Bins));
+}
+
 // L1 build for multi-column sources — heavy, meant for async pipeline.
 // Stores the L1 cache in the std::any; returns nullptr (L2 is done synchronously).
 inline std::shared_ptr<QCPAbstractMultiDataSource> buildL1CacheMulti(
@@ -507,7 +1154,7 @@ inline std::shared_ptr<QCPAbstractMultiDataSource> buildL1CacheMulti(
     std::any& cache)
 {
     PROFILE_HERE_N("buildL1CacheMulti");
-    const int srcSize = src.size();
+    const qsizetype srcSize = src.size();
     const int N = src.columnCount();
     if (srcSize == 0 || N == 0)
         return nullptr;
@@ -521,10 +1168,13 @@ inline std::shared_ptr<QCPAbstractMultiDataSource> buildL1CacheMulti(
     if (c && c->sourceSize == srcSize && c->columnCount == N
         && c->cachedKeyRange == fullKeyRange)
         return nullptr;
-    int numBins = std::min(kLevel1TargetBins, srcSize / 10);
+    int numBins = static_cast<int>(std::min<qsizetype>(kLevel1TargetBins, srcSize / 10));
 
     MultiGraphResamplerCache newCache;
+    src.adviseAccess(0, srcSize, QCPAccessHint::Sequential);
     newCache.level1 = binMinMaxMultiParallel(src, 0, srcSize, fullKeyRange, numBins);
+    src.adviseAccess(0, srcSize, QCPAccessHint::Normal);
+    countScannedBytes(quint64(srcSize) * quint64(src.sampleBytes()));
     newCache.cachedKeyRange = fullKeyRange;
     newCache.sourceSize = srcSize;
     newCache.columnCount = N;
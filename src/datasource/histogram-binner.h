@@ -1,40 +1,20 @@
 #pragma once
 #include "abstract-datasource.h"
+#include "algorithms.h"
+#include "graph-resampler.h" // innerThreadCount()
+#include "cancellation-token.h"
+#include "pipeline-stats.h"
+#include "../Profiling.hpp"
 #include <plottables/plottable-colormap.h>
 #include <cmath>
 #include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
 
 namespace qcp::algo {
 
-// Maps a coordinate to a bin index, evenly spaced in linear or log10 space.
-// For log, callers must have already excluded non-positive coordinates.
-struct BinAxis
-{
-    double lo;       // lower edge in mapped space (coord, or log10(coord))
-    double invWidth; // bins / span, in mapped space
-    int bins;
-    bool log;
-
-    static BinAxis make(const QCPRange& range, int bins, bool log)
-    {
-        // Log bins require a positive range; callers (bin2d via the positive-only
-        // finiteKeyValueBounds + expandIfFlat) must guarantee it. Asserting here
-        // keeps that non-local invariant honest and catches a future regression
-        // before it turns into log10(<=0) -> NaN -> UB in the index cast.
-        Q_ASSERT(!log || (range.lower > 0 && range.upper > 0));
-        const double lo = log ? std::log10(range.lower) : range.lower;
-        const double hi = log ? std::log10(range.upper) : range.upper;
-        const double span = hi - lo;
-        return BinAxis { lo, span > 0 ? bins / span : 0.0, bins, log };
-    }
-
-    int index(double x) const
-    {
-        const double pos = log ? std::log10(x) : x;
-        return std::clamp(static_cast<int>((pos - lo) * invWidth), 0, bins - 1);
-    }
-};
-
 // Widen a zero-width range so binning has a non-degenerate span. Log ranges
 // (lower > 0, guaranteed by the positive-only bounds) widen multiplicatively.
 inline void expandIfFlat(QCPRange& range, bool log)
@@ -54,27 +34,175 @@ inline void expandIfFlat(QCPRange& range, bool log)
     }
 }
 
+// Samples are read kBin2dBlock at a time through readSamples(): one virtual
+// call per block, converted from the source's native types.
+constexpr qsizetype kBin2dBlock = 1024;
+// Below this many samples bin2d stays on the calling thread.
+constexpr qsizetype kBin2dParallelThreshold = 1'000'000;
+// Bound on the per-thread count grids (cells summed over all threads).
+constexpr qsizetype kBin2dMaxLocalCells = 16 * 1024 * 1024;
+
+// Runs body(t, begin, end) for slice t of threadCount contiguous slices of
+// [0, count): all but the last forked, the last on the calling thread.
+template <typename Body>
+void runSlices(qsizetype count, int threadCount, Body&& body)
+{
+    const qsizetype perSlice = count / threadCount;
+    QCPTaskGroup group;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        const qsizetype begin = t * perSlice;
+        const qsizetype end = (t == threadCount - 1) ? count : begin + perSlice;
+        if (t < threadCount - 1)
+            group.run([&, t, begin, end] { body(t, begin, end); });
+        else
+            body(t, begin, end);
+    }
+    group.wait();
+}
+
+// Calls f(i, k, v) for every sample i of [begin, end), placeable or not.
+// Stops at the next block once `cancel` fires.
+template <typename F>
+void forEachSample(const QCPAbstractDataSource& src, qsizetype begin, qsizetype end, F&& f,
+                   const QCPCancellationToken& cancel = {})
+{
+    std::vector<double> keys(kBin2dBlock), values(kBin2dBlock);
+    for (qsizetype b = begin; b < end && !cancel.isCancelled(); b += kBin2dBlock)
+    {
+        const qsizetype e = std::min(end, b + kBin2dBlock);
+        src.readSamples(b, e, keys.data(), values.data());
+        countScannedBytes(quint64(e - b) * quint64(src.sampleBytes()));
+        for (qsizetype i = 0; i < e - b; ++i)
+            f(b + i, keys[i], values[i]);
+    }
+}
+
+// Calls f(k, v) for the samples of [begin, end) that can be placed: finite
+// pairs, and on a log axis only positive coordinates. Histogram input is
+// scattered, not sorted by key, and may contain NaN/Inf. Stops at the next
+// block once `cancel` fires.
+template <typename F>
+void forEachBinnableSample(const QCPAbstractDataSource& src, qsizetype begin, qsizetype end,
+                           bool keyLog, bool valueLog, F&& f,
+                           const QCPCancellationToken& cancel = {})
+{
+    forEachSample(src, begin, end, [&](qsizetype, double k, double v) {
+        if (!std::isfinite(k) || !std::isfinite(v))
+            return;
+        if ((keyLog && k <= 0) || (valueLog && v <= 0))
+            return;
+        f(k, v);
+    }, cancel);
+}
+
+struct SampleBounds {
+    double kLo = std::numeric_limits<double>::infinity(), kHi = -kLo;
+    double vLo = kLo, vHi = -kLo;
+
+    bool empty() const { return !(kLo <= kHi); }
+    void add(double k, double v)
+    {
+        kLo = std::min(kLo, k); kHi = std::max(kHi, k);
+        vLo = std::min(vLo, v); vHi = std::max(vHi, v);
+    }
+    void merge(const SampleBounds& o)
+    {
+        kLo = std::min(kLo, o.kLo); kHi = std::max(kHi, o.kHi);
+        vLo = std::min(vLo, o.vLo); vHi = std::max(vHi, o.vHi);
+    }
+};
+
+// Threads for binning n samples into `cells` cells: one below the parallel
+// threshold, and never more than kBin2dMaxLocalCells allows.
+inline int bin2dThreadCount(qsizetype n, qsizetype cells)
+{
+    const int threadCount = n < kBin2dParallelThreshold ? 1 : innerThreadCount();
+    return static_cast<int>(std::clamp<qsizetype>(kBin2dMaxLocalCells / cells, 1, threadCount));
+}
+
+// Counts samples [0, n) into out[0..cells): visit(begin, end, add) calls
+// add(cell) for each sample of its slice that lands in a cell. Each thread
+// counts into its own integer grid (32-bit unless a single slice could
+// overflow them); the grids are summed into `out` at the end, so there are
+// no shared writes while counting.
+template <typename Visit>
+void countCells(qsizetype n, int threadCount, qsizetype cells, double* out, Visit&& visit)
+{
+    auto count = [&]<typename Count>(std::vector<std::vector<Count>>& grids) {
+        runSlices(n, threadCount, [&](int t, qsizetype begin, qsizetype end) {
+            std::vector<Count>& grid = grids[t];
+            grid.assign(cells, 0); // first touch on the counting thread
+            visit(begin, end, [&grid](qsizetype cell) { ++grid[cell]; });
+        });
+        runSlices(cells, threadCount, [&](int, qsizetype begin, qsizetype end) {
+            for (qsizetype c = begin; c < end; ++c)
+            {
+                std::uint64_t sum = 0;
+                for (const auto& grid : grids)
+                    sum += grid[c];
+                out[c] = static_cast<double>(sum);
+            }
+        });
+    };
+    if (n / threadCount < std::numeric_limits<std::uint32_t>::max())
+    {
+        std::vector<std::vector<std::uint32_t>> grids(threadCount);
+        count(grids);
+    }
+    else
+    {
+        std::vector<std::vector<std::uint64_t>> grids(threadCount);
+        count(grids);
+    }
+}
+
+// Counts (key, value) samples into a keyBins x valueBins grid spanning the
+// finite (and, on log axes, positive) samples.
+//
+// Two parallel sweeps over the same slices: the first reduces per-thread
+// bounds (the grid depends on them, so counting cannot start before they are
+// merged), the second counts into per-thread integer grids. nullptr once
+// `cancel` fires.
 inline QCPColorMapData* bin2d(const QCPAbstractDataSource& src, int keyBins, int valueBins,
-                              bool keyLog = false, bool valueLog = false)
+                              bool keyLog = false, bool valueLog = false,
+                              const QCPCancellationToken& cancel = {})
 {
-    const int n = src.size();
+    PROFILE_HERE_N("bin2d");
+    const qsizetype n = src.size();
     if (n == 0 || keyBins <= 0 || valueBins <= 0)
         return nullptr;
 
-    // Histogram input is scattered, not sorted by key, and may contain NaN/Inf.
-    // finiteKeyValueBounds() gives the true min/max over finite (key, value)
-    // pairs -- never the first/last sample. On a log axis, non-positive samples
-    // can't be placed, so they are excluded from the bounds too. No qualifying
-    // pair => no histogram.
-    QCPRange keyRange, valRange;
-    if (!src.finiteKeyValueBounds(keyRange, valRange, keyLog, valueLog))
+    const qsizetype cells = static_cast<qsizetype>(keyBins) * valueBins;
+    const int threadCount = bin2dThreadCount(n, cells);
+
+    // The bounds are the true min/max over the qualifying pairs, as in
+    // finiteKeyValueBounds().
+    std::vector<SampleBounds> partial(threadCount);
+    runSlices(n, threadCount, [&](int t, qsizetype begin, qsizetype end) {
+        SampleBounds b;
+        forEachBinnableSample(src, begin, end, keyLog, valueLog,
+                              [&b](double k, double v) { b.add(k, v); }, cancel);
+        partial[t] = b;
+    });
+    if (cancel.isCancelled())
+        return nullptr;
+    SampleBounds all;
+    for (const SampleBounds& b : partial)
+        all.merge(b);
+    if (all.empty()) // no qualifying pair => no histogram
         return nullptr;
 
+    QCPRange keyRange(all.kLo, all.kHi), valRange(all.vLo, all.vHi);
     expandIfFlat(keyRange, keyLog);
     expandIfFlat(valRange, valueLog);
 
     auto* data = new QCPColorMapData(keyBins, valueBins, keyRange, valRange);
-    data->fill(0);
+    if (!data->rawData())
+    {
+        delete data;
+        return nullptr;
+    }
 
     // Bins are evenly spaced in log space when requested, so the grid's linear
     // coordinate extent [min, max] is preserved (the renderer stretches cells
@@ -82,18 +210,313 @@ inline QCPColorMapData* bin2d(const QCPAbstractDataSource& src, int keyBins, int
     const BinAxis kAxis = BinAxis::make(keyRange, keyBins, keyLog);
     const BinAxis vAxis = BinAxis::make(valRange, valueBins, valueLog);
 
-    for (int i = 0; i < n; ++i)
+    // Cells share QCPColorMapData's layout (valueIndex * keyBins + keyIndex).
+    countCells(n, threadCount, cells, data->rawData(),
+               [&](qsizetype begin, qsizetype end, auto&& add) {
+                   forEachBinnableSample(src, begin, end, keyLog, valueLog, [&](double k, double v) {
+                       add(static_cast<qsizetype>(vAxis.index(v)) * keyBins + kAxis.index(k));
+                   }, cancel);
+               });
+    if (cancel.isCancelled())
     {
-        double k = src.keyAt(i);
-        double v = src.valueAt(i);
-        if (!std::isfinite(k) || !std::isfinite(v))
-            continue;
-        if ((keyLog && k <= 0) || (valueLog && v <= 0))
+        delete data;
+        return nullptr;
+    }
+
+    data->recalculateDataBounds();
+    return data;
+}
+
+// Finite samples grouped by key for viewport re-binning: equal-width key
+// buckets, so the samples of any key range are one contiguous slice (plus at
+// most a bucket of spill at either end). The samples within a bucket are in
+// no particular key order. Built once per data change.
+//
+// A source whose finite keys are already sorted is indexed in place: bucket b
+// is its rows [bucketOffsets[b], bucketOffsets[b + 1]), and the index costs a
+// few hundred KiB at most. Scattered samples are copied into keys/values by a
+// counting sort (16 bytes per finite sample), up to a cap past which the
+// source is not indexed at all and is binned whole instead.
+struct Histogram2DIndex {
+    enum class Storage {
+        Copied,     // bucket b is keys/values[bucketOffsets[b], bucketOffsets[b + 1])
+        SourceRows, // bucket b is source rows [bucketOffsets[b], bucketOffsets[b + 1])
+        None        // scattered source too large to copy: no buckets
+    };
+
+    Storage storage = Storage::Copied;
+    SampleBounds bounds;              // finite samples
+    double minPositiveKey = std::numeric_limits<double>::infinity();
+    double minPositiveValue = std::numeric_limits<double>::infinity();
+    double bucketLo = 0;
+    double bucketInvWidth = 0;
+    std::vector<qsizetype> bucketOffsets; // bucket b is [offsets[b], offsets[b + 1])
+    std::vector<double> keys, values;
+
+    // Samples (Copied) or source rows (SourceRows) spanned by the buckets.
+    qsizetype size() const
+    {
+        return bucketOffsets.empty() ? 0 : bucketOffsets.back() - bucketOffsets.front();
+    }
+    int bucketCount() const { return static_cast<int>(bucketOffsets.size()) - 1; }
+    int bucketOf(double k) const
+    {
+        const double q = (k - bucketLo) * bucketInvWidth;
+        if (!(q >= 0))
+            return 0;
+        return static_cast<int>(std::min<double>(q, bucketCount() - 1));
+    }
+    quint64 memoryBytes() const
+    {
+        return bucketOffsets.capacity() * sizeof(qsizetype)
+            + (keys.capacity() + values.capacity()) * sizeof(double);
+    }
+};
+
+// Average samples per key bucket, and the bucket count cap.
+constexpr qsizetype kHistogramIndexBucketSize = 256;
+constexpr qsizetype kHistogramIndexMaxBuckets = 1 << 16;
+// Scattered sources with more samples are not copied into an index (512 MiB).
+constexpr qsizetype kHistogramIndexMaxCopiedSamples = qsizetype(1) << 25;
+
+// Parallel sweeps over the source: bounds and key order, then either the
+// first row of each bucket (sorted keys) or per-thread bucket counts and a
+// scatter through per-thread bucket offsets (stable within a bucket).
+// nullptr once `cancel` fires.
+inline std::shared_ptr<const Histogram2DIndex> buildHistogram2DIndex(
+    const QCPAbstractDataSource& src, const QCPCancellationToken& cancel = {},
+    qsizetype maxCopiedSamples = kHistogramIndexMaxCopiedSamples)
+{
+    PROFILE_HERE_N("buildHistogram2DIndex");
+    using Storage = Histogram2DIndex::Storage;
+    auto index = std::make_shared<Histogram2DIndex>();
+    const qsizetype n = src.size();
+    const int threadCount = n < kBin2dParallelThreshold ? 1 : innerThreadCount();
+
+    struct Partial {
+        SampleBounds bounds;
+        double minPositiveKey = std::numeric_limits<double>::infinity();
+        double minPositiveValue = std::numeric_limits<double>::infinity();
+        // Order of the finite keys, which alone decide the buckets.
+        bool sorted = true;
+        double firstKey = std::numeric_limits<double>::quiet_NaN();
+        double lastKey = std::numeric_limits<double>::quiet_NaN();
+        std::vector<qsizetype> counts;
+    };
+    std::vector<Partial> partial(threadCount);
+    runSlices(n, threadCount, [&](int t, qsizetype begin, qsizetype end) {
+        Partial& p = partial[t];
+        forEachSample(src, begin, end, [&p](qsizetype, double k, double v) {
+            if (!std::isfinite(k))
+                return;
+            if (std::isnan(p.firstKey))
+                p.firstKey = k;
+            else if (k < p.lastKey)
+                p.sorted = false;
+            p.lastKey = k;
+            if (!std::isfinite(v))
+                return;
+            p.bounds.add(k, v);
+            if (k > 0) p.minPositiveKey = std::min(p.minPositiveKey, k);
+            if (v > 0) p.minPositiveValue = std::min(p.minPositiveValue, v);
+        }, cancel);
+    });
+    if (cancel.isCancelled())
+        return nullptr;
+    bool sorted = true;
+    double lastKey = -std::numeric_limits<double>::infinity();
+    for (const Partial& p : partial)
+    {
+        index->bounds.merge(p.bounds);
+        index->minPositiveKey = std::min(index->minPositiveKey, p.minPositiveKey);
+        index->minPositiveValue = std::min(index->minPositiveValue, p.minPositiveValue);
+        if (std::isnan(p.firstKey))
             continue;
+        sorted = sorted && p.sorted && !(p.firstKey < lastKey);
+        lastKey = p.lastKey;
+    }
+    if (index->bounds.empty())
+    {
+        index->bucketOffsets.assign(2, 0);
+        return index;
+    }
+    if (!sorted && n > maxCopiedSamples)
+    {
+        index->storage = Storage::None;
+        return index;
+    }
 
-        const int kb = kAxis.index(k);
-        const int vb = vAxis.index(v);
-        data->setCell(kb, vb, data->cell(kb, vb) + 1.0);
+    const int buckets = static_cast<int>(std::clamp<qsizetype>(
+        n / kHistogramIndexBucketSize, 1, kHistogramIndexMaxBuckets));
+    const double span = index->bounds.kHi - index->bounds.kLo;
+    index->bucketLo = index->bounds.kLo;
+    index->bucketInvWidth = span > 0 ? buckets / span : 0.0;
+    index->bucketOffsets.assign(buckets + 1, 0);
+
+    if (sorted)
+    {
+        // Each thread records the first row of every bucket its slice starts;
+        // a bucket no finite key falls in starts where the next one does.
+        index->storage = Storage::SourceRows;
+        runSlices(n, threadCount, [&](int t, qsizetype begin, qsizetype end) {
+            std::vector<qsizetype>& firstRows = partial[t].counts;
+            firstRows.assign(buckets, n);
+            int current = -1;
+            forEachSample(src, begin, end, [&](qsizetype i, double k, double) {
+                if (!std::isfinite(k))
+                    return;
+                const int b = index->bucketOf(k);
+                if (b != current)
+                    firstRows[b] = std::min(firstRows[b], i);
+                current = b;
+            }, cancel);
+        });
+        if (cancel.isCancelled())
+            return nullptr;
+        index->bucketOffsets[buckets] = n;
+        for (int b = buckets - 1; b >= 0; --b)
+        {
+            qsizetype first = index->bucketOffsets[b + 1];
+            for (const Partial& p : partial)
+                first = std::min(first, p.counts[b]);
+            index->bucketOffsets[b] = first;
+        }
+        return index;
+    }
+
+    runSlices(n, threadCount, [&](int t, qsizetype begin, qsizetype end) {
+        std::vector<qsizetype>& counts = partial[t].counts;
+        counts.assign(buckets, 0);
+        forEachBinnableSample(src, begin, end, false, false,
+                              [&](double k, double) { ++counts[index->bucketOf(k)]; }, cancel);
+    });
+    if (cancel.isCancelled())
+        return nullptr;
+
+    // Thread t writes bucket b at offsets[b] + (bucket b's count in threads < t).
+    qsizetype total = 0;
+    for (int b = 0; b < buckets; ++b)
+    {
+        index->bucketOffsets[b] = total;
+        for (Partial& p : partial)
+        {
+            const qsizetype c = p.counts[b];
+            p.counts[b] = total;
+            total += c;
+        }
+    }
+    index->bucketOffsets[buckets] = total;
+    index->keys.resize(total);
+    index->values.resize(total);
+
+    runSlices(n, threadCount, [&](int t, qsizetype begin, qsizetype end) {
+        std::vector<qsizetype>& cursor = partial[t].counts;
+        forEachBinnableSample(src, begin, end, false, false, [&](double k, double v) {
+            const qsizetype at = cursor[index->bucketOf(k)]++;
+            index->keys[at] = k;
+            index->values[at] = v;
+        }, cancel);
+    });
+    if (cancel.isCancelled())
+        return nullptr;
+    return index;
+}
+
+// Counts the indexed samples inside the view keyRange x valueRange, binned at
+// keyBins x valueBins across the whole view. The grid only spans the part of
+// the view covered by data (positive data on a log axis), keeping that bin
+// density; samples outside the view are dropped rather than clamped into the
+// edge bins. Visits only the key buckets overlapping the view:
+// O(visible samples + cells). `src` is the source the index was built from,
+// read for SourceRows buckets. Returns nullptr when view and data don't
+// overlap, when the source is not indexed (Storage::None), or once `cancel`
+// fires.
+inline QCPColorMapData* bin2dViewport(const QCPAbstractDataSource& src,
+                                      const Histogram2DIndex& index,
+                                      const QCPRange& keyRange, const QCPRange& valueRange,
+                                      int keyBins, int valueBins,
+                                      bool keyLog = false, bool valueLog = false,
+                                      const QCPCancellationToken& cancel = {})
+{
+    PROFILE_HERE_N("bin2dViewport");
+    if (index.size() == 0 || keyBins <= 0 || valueBins <= 0)
+        return nullptr;
+
+    const SampleBounds& b = index.bounds;
+    QCPRange keyOut(std::max(keyRange.lower, keyLog ? index.minPositiveKey : b.kLo),
+                    std::min(keyRange.upper, b.kHi));
+    QCPRange valOut(std::max(valueRange.lower, valueLog ? index.minPositiveValue : b.vLo),
+                    std::min(valueRange.upper, b.vHi));
+    if (!(keyOut.lower <= keyOut.upper) || !(valOut.lower <= valOut.upper))
+        return nullptr;
+    if ((keyLog && keyOut.lower <= 0) || (valueLog && valOut.lower <= 0))
+        return nullptr;
+
+    // Fraction of the view covered, measured in the axis' own scale.
+    auto binsOver = [](const QCPRange& view, const QCPRange& out, int viewBins, bool log) {
+        auto map = [log](double x) { return log ? std::log10(x) : x; };
+        const double viewSpan = (log && view.lower <= 0) ? 0.0 : map(view.upper) - map(view.lower);
+        if (!(viewSpan > 0))
+            return viewBins;
+        const double frac = (map(out.upper) - map(out.lower)) / viewSpan;
+        return std::clamp(static_cast<int>(std::ceil(viewBins * frac)), 1, viewBins);
+    };
+    keyBins = binsOver(keyRange, keyOut, keyBins, keyLog);
+    valueBins = binsOver(valueRange, valOut, valueBins, valueLog);
+
+    // The view filter uses the unexpanded ranges: a flat extent only widens
+    // the grid, it doesn't admit more samples.
+    const QCPRange keyView = keyOut, valView = valOut;
+    expandIfFlat(keyOut, keyLog);
+    expandIfFlat(valOut, valueLog);
+
+    auto* data = new QCPColorMapData(keyBins, valueBins, keyOut, valOut);
+    if (!data->rawData())
+    {
+        delete data;
+        return nullptr;
+    }
+
+    const BinAxis kAxis = BinAxis::make(keyOut, keyBins, keyLog);
+    const BinAxis vAxis = BinAxis::make(valOut, valueBins, valueLog);
+
+    const qsizetype first = index.bucketOffsets[index.bucketOf(keyView.lower)];
+    const qsizetype last = index.bucketOffsets[index.bucketOf(keyView.upper) + 1];
+    const qsizetype n = last - first;
+    const qsizetype cells = static_cast<qsizetype>(keyBins) * valueBins;
+    const int threadCount = bin2dThreadCount(n, cells);
+    auto addInView = [&](double k, double v, auto&& add) {
+        if (k < keyView.lower || k > keyView.upper || v < valView.lower || v > valView.upper)
+            return;
+        add(static_cast<qsizetype>(vAxis.index(v)) * keyBins + kAxis.index(k));
+    };
+    if (index.storage == Histogram2DIndex::Storage::SourceRows)
+    {
+        countCells(n, threadCount, cells, data->rawData(),
+                   [&](qsizetype begin, qsizetype end, auto&& add) {
+                       forEachBinnableSample(src, first + begin, first + end, false, false,
+                                             [&](double k, double v) { addInView(k, v, add); },
+                                             cancel);
+                   });
+    }
+    else
+    {
+        const double* keys = index.keys.data() + first;
+        const double* values = index.values.data() + first;
+        countCells(n, threadCount, cells, data->rawData(),
+                   [&](qsizetype begin, qsizetype end, auto&& add) {
+                       for (qsizetype block = begin; block < end && !cancel.isCancelled(); block += kBin2dBlock)
+                       {
+                           const qsizetype blockEnd = std::min(end, block + kBin2dBlock);
+                           for (qsizetype i = block; i < blockEnd; ++i)
+                               addInView(keys[i], values[i], add);
+                       }
+                   });
+    }
+    if (cancel.isCancelled())
+    {
+        delete data;
+        return nullptr;
     }
 
     data->recalculateDataBounds();
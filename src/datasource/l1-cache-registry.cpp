@@ -0,0 +1,147 @@
+#include "l1-cache-registry.h"
+#include "graph-resampler.h"
+#include "work-executor.h"
+
+namespace {
+
+// Poll interval of a waiter with nothing to help with, so its own
+// cancellation and the builder's fan-out are noticed.
+constexpr unsigned long kWaitPollMs = 5;
+
+bool matches(const QCPL1CacheRegistry::Cache& cache, const QCPAbstractDataSource& source,
+             const QCPRange& keyRange)
+{
+    return cache.sourceSize == source.size() && cache.cachedKeyRange == keyRange;
+}
+
+} // namespace
+
+QCPL1CacheRegistry& QCPL1CacheRegistry::instance()
+{
+    static QCPL1CacheRegistry registry;
+    return registry;
+}
+
+std::shared_ptr<const QCPL1CacheRegistry::Cache> QCPL1CacheRegistry::acquire(
+    const QCPAbstractDataSource& source, const QCPRange& keyRange,
+    const QCPCancellationToken& cancel, const Builder& build)
+{
+    QMutexLocker lock(&mMutex);
+    while (true)
+    {
+        Entry& entry = mEntries[&source];
+        entry.observed = true;
+        if (auto cache = entry.ready.lock(); cache && matches(*cache, source, keyRange))
+        {
+            ++mShares;
+            return cache;
+        }
+        if (!entry.building)
+        {
+            const quint64 generation = entry.generation;
+            entry.building = true;
+            entry.ready.reset();
+            lock.unlock();
+            std::shared_ptr<const Cache> cache = build();
+            lock.relock();
+            ++mBuilds;
+            // The entry may have been invalidated (and rebuilt by someone
+            // else) meanwhile: only publish into the generation we read.
+            Entry& current = mEntries[&source];
+            if (current.generation == generation)
+            {
+                current.building = false;
+                if (cache)
+                    current.ready = cache;
+            }
+            pruneLocked();
+            mChanged.wakeAll();
+            return cache;
+        }
+        if (cancel.isCancelled())
+            return nullptr;
+        // Waiters usually sit on executor workers: lend them to the build's
+        // parallel binning rather than leaving it a worker short per waiter.
+        lock.unlock();
+        const bool helped = QCPWorkExecutor::current().helpOnce();
+        lock.relock();
+        if (!helped)
+            mChanged.wait(&mMutex, kWaitPollMs);
+    }
+}
+
+void QCPL1CacheRegistry::invalidate(const QCPAbstractDataSource* source)
+{
+    QMutexLocker lock(&mMutex);
+    auto it = mEntries.find(source);
+    if (it == mEntries.end())
+        return;
+    Entry& entry = it->second;
+    entry.ready.reset();
+    if (!entry.observed)
+        return;
+    ++entry.generation;
+    entry.observed = false;
+    // A build still running reads stale data: let the next caller start over.
+    entry.building = false;
+    mChanged.wakeAll();
+}
+
+quint64 QCPL1CacheRegistry::buildCount() const
+{
+    QMutexLocker lock(&mMutex);
+    return mBuilds;
+}
+
+quint64 QCPL1CacheRegistry::shareCount() const
+{
+    QMutexLocker lock(&mMutex);
+    return mShares;
+}
+
+void QCPL1CacheRegistry::pruneLocked()
+{
+    // Entries of sources nobody displays anymore. Dropping an entry forgets
+    // its generation, which is harmless: it holds no cache to go stale.
+    for (auto it = mEntries.begin(); it != mEntries.end();)
+    {
+        if (!it->second.building && it->second.ready.expired())
+            it = mEntries.erase(it);
+        else
+            ++it;
+    }
+}
+
+namespace qcp::algo {
+
+std::shared_ptr<QCPAbstractDataSource> buildSharedL1Cache(
+    const QCPAbstractDataSource& src, const ViewportParams& vp, std::any& cache,
+    const QCPCancellationToken& cancel)
+{
+    const qsizetype srcSize = src.size();
+    if (srcSize == 0 || srcSize < kResampleThreshold)
+        return nullptr;
+    bool foundRange = false;
+    const QCPRange fullKeyRange = src.keyRange(foundRange);
+    if (!foundRange || fullKeyRange.size() <= 0)
+        return nullptr;
+
+    using Shared = std::shared_ptr<const GraphResamplerCache>;
+    if (auto* c = std::any_cast<Shared>(&cache); c && *c && matches(**c, src, fullKeyRange))
+        return nullptr; // L1 already valid
+
+    Shared shared = QCPL1CacheRegistry::instance().acquire(
+        src, fullKeyRange, cancel, [&]() -> Shared {
+            std::any built;
+            buildL1Cache(src, vp, built, nullptr, cancel);
+            auto* c = std::any_cast<GraphResamplerCache>(&built);
+            if (!c)
+                return nullptr;
+            return std::make_shared<const GraphResamplerCache>(std::move(*c));
+        });
+    if (shared)
+        cache = std::move(shared);
+    return nullptr;
+}
+
+} // namespace qcp::algo
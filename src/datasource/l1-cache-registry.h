@@ -0,0 +1,83 @@
+#pragma once
+#include "cancellation-token.h"
+#include "axis/range.h"
+#include <QMutex>
+#include <QWaitCondition>
+#include <QtGlobal>
+#include <any>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+class QCPAbstractDataSource;
+struct ViewportParams;
+
+namespace qcp::algo {
+struct GraphResamplerCache;
+}
+
+// Process-wide table of the L1 pyramids built from each data source, so the
+// graphs sharing one source bin it once and share the result read-only.
+//
+// Entries are keyed on the source's identity and a per-source generation that
+// invalidate() bumps when the source's data changes in place. Finished caches
+// are held weakly: an L1 lives as long as some graph displays it. A pipeline
+// asking for an L1 that another one is building waits for it instead of
+// binning the source again, running queued executor subtasks (the build's
+// own fan-out among them) meanwhile; if that build is cancelled, one of the
+// waiters takes over.
+class QCPL1CacheRegistry
+{
+public:
+    using Cache = qcp::algo::GraphResamplerCache;
+    using Builder = std::function<std::shared_ptr<const Cache>()>;
+
+    static QCPL1CacheRegistry& instance();
+
+    // The current L1 of `source`: the shared one when it is ready and still
+    // matches the source's size and key range, else the one being built by
+    // another caller once it lands, else the result of `build`, run on the
+    // calling thread and published. nullptr when `build` fails or `cancel`
+    // fires while waiting.
+    std::shared_ptr<const Cache> acquire(const QCPAbstractDataSource& source,
+                                         const QCPRange& keyRange,
+                                         const QCPCancellationToken& cancel,
+                                         const Builder& build);
+
+    // The source's data changed in place: its L1s built so far are stale.
+    // Calls made before any build read the current data coalesce into one
+    // generation, so notifying every graph of a shared source is cheap.
+    void invalidate(const QCPAbstractDataSource* source);
+
+    // Builds run and L1s handed out to a caller other than their builder.
+    quint64 buildCount() const;
+    quint64 shareCount() const;
+
+private:
+    struct Entry {
+        quint64 generation = 0;
+        bool observed = false; // some build has read this generation
+        bool building = false;
+        std::weak_ptr<const Cache> ready;
+    };
+
+    void pruneLocked();
+
+    mutable QMutex mMutex;
+    QWaitCondition mChanged;
+    std::unordered_map<const QCPAbstractDataSource*, Entry> mEntries;
+    quint64 mBuilds = 0;
+    quint64 mShares = 0;
+};
+
+namespace qcp::algo {
+
+// buildL1Cache through QCPL1CacheRegistry::instance(): leaves a
+// std::shared_ptr<const GraphResamplerCache> in `cache`, shared with every
+// other pipeline of the same source. Returns nullptr (L2 is done
+// synchronously).
+std::shared_ptr<QCPAbstractDataSource> buildSharedL1Cache(
+    const QCPAbstractDataSource& src, const ViewportParams& vp, std::any& cache,
+    const QCPCancellationToken& cancel = {});
+
+} // namespace qcp::algo
@@ -0,0 +1,48 @@
+// AVX2 min/max binning kernels. Built with -mavx2 (/arch:AVX2) in its own
+// library and only called after a runtime CPU check — see minmax-kernels.h.
+#include "minmax-kernels-impl.h"
+#include <immintrin.h>
+
+namespace qcp::algo::simd {
+namespace {
+
+struct Avx2Ops {
+    using V = __m256d;
+    static constexpr int kLanes = 4;
+    static constexpr int kIntLanes = 8;
+
+    static V load(const double* p) { return _mm256_loadu_pd(p); }
+    static V set1(double x) { return _mm256_set1_pd(x); }
+    static bool allInside(V k, V lo, V hi)
+    {
+        const V in = _mm256_and_pd(_mm256_cmp_pd(k, lo, _CMP_GE_OQ),
+                                   _mm256_cmp_pd(k, hi, _CMP_LT_OQ));
+        return _mm256_movemask_pd(in) == 0xF;
+    }
+    // minpd/maxpd return the second operand when either is NaN, so a NaN
+    // sample leaves the accumulator untouched.
+    static V min(V acc, V x) { return _mm256_min_pd(x, acc); }
+    static V max(V acc, V x) { return _mm256_max_pd(x, acc); }
+    static double hmin(V v)
+    {
+        __m128d m = _mm_min_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+        return _mm_cvtsd_f64(_mm_min_sd(m, _mm_unpackhi_pd(m, m)));
+    }
+    static double hmax(V v)
+    {
+        __m128d m = _mm_max_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+        return _mm_cvtsd_f64(_mm_max_sd(m, _mm_unpackhi_pd(m, m)));
+    }
+    static bool allEqual(const int* p, int b)
+    {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        return _mm256_movemask_epi8(_mm256_cmpeq_epi32(x, _mm256_set1_epi32(b))) == -1;
+    }
+};
+
+} // namespace
+
+const MinMaxKernels kAvx2MinMaxKernels = {
+    Isa::Avx2, "avx2", &accumulateImpl<Avx2Ops>, &accumulateBinnedImpl<Avx2Ops>};
+
+} // namespace qcp::algo::simd
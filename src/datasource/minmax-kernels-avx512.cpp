@@ -0,0 +1,43 @@
+// AVX-512 min/max binning kernels. Built with -mavx512f (/arch:AVX512) in its
+// own library and only called after a runtime CPU check — see minmax-kernels.h.
+#include "minmax-kernels-impl.h"
+#include <immintrin.h>
+
+// GCC's own _mm512_* wrappers seed their pass-through operand from
+// _mm512_undefined_pd(), which trips -Wmaybe-uninitialized once inlined.
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+namespace qcp::algo::simd {
+namespace {
+
+struct Avx512Ops {
+    using V = __m512d;
+    static constexpr int kLanes = 8;
+    static constexpr int kIntLanes = 16;
+
+    static V load(const double* p) { return _mm512_loadu_pd(p); }
+    static V set1(double x) { return _mm512_set1_pd(x); }
+    static bool allInside(V k, V lo, V hi)
+    {
+        return (_mm512_cmp_pd_mask(k, lo, _CMP_GE_OQ) & _mm512_cmp_pd_mask(k, hi, _CMP_LT_OQ))
+               == 0xFF;
+    }
+    // Like minpd/maxpd, the second operand is returned when either is NaN.
+    static V min(V acc, V x) { return _mm512_min_pd(x, acc); }
+    static V max(V acc, V x) { return _mm512_max_pd(x, acc); }
+    static double hmin(V v) { return _mm512_reduce_min_pd(v); }
+    static double hmax(V v) { return _mm512_reduce_max_pd(v); }
+    static bool allEqual(const int* p, int b)
+    {
+        return _mm512_cmpeq_epi32_mask(_mm512_loadu_si512(p), _mm512_set1_epi32(b)) == 0xFFFF;
+    }
+};
+
+} // namespace
+
+const MinMaxKernels kAvx512MinMaxKernels = {
+    Isa::Avx512, "avx512", &accumulateImpl<Avx512Ops>, &accumulateBinnedImpl<Avx512Ops>};
+
+} // namespace qcp::algo::simd
@@ -0,0 +1,161 @@
+#pragma once
+// Generic min/max binning drivers, instantiated once per instruction set by
+// the kernel translation units with a vector-ops struct providing:
+//   V, kLanes, load, set1, allInside(k, lo, hi)  — lo <= k < hi in every lane,
+//   min/max(acc, x) — ignoring NaN lanes of x, hmin/hmax — horizontal reduce,
+//   kIntLanes, allEqual(const int* p, int b).
+// Only included by those units. The drivers have internal linkage so the
+// ISA-specific instantiations are never merged across units by the linker.
+#include "minmax-kernels.h"
+// Constants only (see minmax-kernels.h): nothing from these may be called at run time.
+#include <cfloat>
+#include <limits>
+
+namespace qcp::algo::simd {
+
+// Defined by the x86 kernel units when the build enables them (meson.build).
+extern const MinMaxKernels kAvx2MinMaxKernels;
+extern const MinMaxKernels kAvx512MinMaxKernels;
+
+namespace {
+
+constexpr double kInf = std::numeric_limits<double>::infinity();
+
+inline bool isNaN(double x) { return x != x; }
+inline bool isFinite(double x) { return x - x == 0.0; }
+inline double absOf(double x) { return x < 0 ? -x : x; }
+
+// trunc((k - keyLo) / binWidth) clamped to [binBegin, binEnd). Clamping
+// before the cast keeps positions outside the int range defined.
+inline int binOf(double k, double keyLo, double binWidth, int binBegin, int binEnd)
+{
+    const double q = (k - keyLo) / binWidth;
+    if (!(q >= binBegin))
+        return binBegin;
+    if (q >= binEnd)
+        return binEnd - 1;
+    return static_cast<int>(q);
+}
+
+inline void foldInto(double* slot, double mn, double mx)
+{
+    if (isNaN(slot[0]) || mn < slot[0]) slot[0] = mn;
+    if (isNaN(slot[1]) || mx > slot[1]) slot[1] = mx;
+}
+
+// Min/max of the non-NaN values of p[0..n); mn > mx when there is none.
+template <typename Ops>
+inline void reduceRun(const double* p, std::ptrdiff_t n, double& mn, double& mx)
+{
+    mn = kInf;
+    mx = -kInf;
+    std::ptrdiff_t i = 0;
+    if (n >= Ops::kLanes)
+    {
+        auto vmn = Ops::set1(kInf);
+        auto vmx = Ops::set1(-kInf);
+        for (; i + Ops::kLanes <= n; i += Ops::kLanes)
+        {
+            const auto x = Ops::load(p + i);
+            vmn = Ops::min(vmn, x);
+            vmx = Ops::max(vmx, x);
+        }
+        mn = Ops::hmin(vmn);
+        mx = Ops::hmax(vmx);
+    }
+    // NaN compares false, so it never replaces a bound
+    for (; i < n; ++i)
+    {
+        if (p[i] < mn) mn = p[i];
+        if (p[i] > mx) mx = p[i];
+    }
+}
+
+template <typename Ops>
+void accumulateImpl(const double* keys, const double* values,
+                    std::ptrdiff_t begin, std::ptrdiff_t end,
+                    double keyLo, double binWidth,
+                    double* out, int binBegin, int binEnd)
+{
+    constexpr int W = Ops::kLanes;
+    std::ptrdiff_t i = begin;
+    while (i < end)
+    {
+        const double k0 = keys[i];
+        const double v0 = values[i];
+        ++i;
+        if (isNaN(v0) || !isFinite(k0))
+            continue;
+
+        // A run: the following samples of the same bin. Keys at least `slack`
+        // inside the bin edges are in the bin whatever the rounding of binOf,
+        // so whole vectors are tested against the edges without a division;
+        // samples near an edge take the exact scalar test.
+        const int bin = binOf(k0, keyLo, binWidth, binBegin, binEnd);
+        const double edgeLo = keyLo + bin * binWidth;
+        const double edgeHi = keyLo + (bin + 1) * binWidth;
+        const double slack = 1e-13 * (absOf(keyLo) + absOf(edgeLo) + absOf(edgeHi));
+        const auto lo = Ops::set1(bin == binBegin ? -DBL_MAX : edgeLo + slack);
+        const auto hi = Ops::set1(bin == binEnd - 1 ? DBL_MAX : edgeHi - slack);
+
+        double mn = v0, mx = v0;
+        auto vmn = Ops::set1(kInf);
+        auto vmx = Ops::set1(-kInf);
+        for (;;)
+        {
+            while (end - i >= W && Ops::allInside(Ops::load(keys + i), lo, hi))
+            {
+                const auto x = Ops::load(values + i);
+                vmn = Ops::min(vmn, x);
+                vmx = Ops::max(vmx, x);
+                i += W;
+            }
+            if (i >= end)
+                break;
+            const double k = keys[i];
+            if (!isFinite(k) || binOf(k, keyLo, binWidth, binBegin, binEnd) != bin)
+                break;
+            const double v = values[i];
+            if (v < mn) mn = v;
+            if (v > mx) mx = v;
+            ++i;
+        }
+        const double rmn = Ops::hmin(vmn);
+        const double rmx = Ops::hmax(vmx);
+        if (rmn < mn) mn = rmn;
+        if (rmx > mx) mx = rmx;
+        foldInto(out + bin * 2, mn, mx);
+    }
+}
+
+template <typename Ops>
+void accumulateBinnedImpl(const int* bins, std::ptrdiff_t count,
+                          const double* const* columns, int columnCount,
+                          double* out, std::ptrdiff_t columnStride)
+{
+    std::ptrdiff_t i = 0;
+    while (i < count)
+    {
+        const int bin = bins[i];
+        std::ptrdiff_t j = i + 1;
+        while (count - j >= Ops::kIntLanes && Ops::allEqual(bins + j, bin))
+            j += Ops::kIntLanes;
+        while (j < count && bins[j] == bin)
+            ++j;
+
+        if (bin >= 0)
+        {
+            for (int c = 0; c < columnCount; ++c)
+            {
+                double mn, mx;
+                reduceRun<Ops>(columns[c] + i, j - i, mn, mx);
+                if (mn <= mx)
+                    foldInto(out + c * columnStride + bin * 2, mn, mx);
+            }
+        }
+        i = j;
+    }
+}
+
+} // namespace
+} // namespace qcp::algo::simd
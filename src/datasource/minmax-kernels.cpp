@@ -0,0 +1,190 @@
+#include "minmax-kernels.h"
+#include "minmax-kernels-impl.h"
+#include "neoqcp_config.h"
+#include <QtGlobal>
+#include <atomic>
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#  include <arm_neon.h>
+#  define QCP_MINMAX_NEON
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+#  include <intrin.h>
+#endif
+
+namespace qcp::algo::simd {
+namespace {
+
+// Reference implementation; every vector kernel must match it bit for bit.
+void accumulateScalar(const double* keys, const double* values,
+                      std::ptrdiff_t begin, std::ptrdiff_t end,
+                      double keyLo, double binWidth,
+                      double* out, int binBegin, int binEnd)
+{
+    for (std::ptrdiff_t i = begin; i < end; ++i)
+    {
+        const double k = keys[i];
+        const double v = values[i];
+        if (isNaN(v) || !isFinite(k))
+            continue;
+        foldInto(out + binOf(k, keyLo, binWidth, binBegin, binEnd) * 2, v, v);
+    }
+}
+
+void accumulateBinnedScalar(const int* bins, std::ptrdiff_t count,
+                            const double* const* columns, int columnCount,
+                            double* out, std::ptrdiff_t columnStride)
+{
+    for (int c = 0; c < columnCount; ++c)
+    {
+        double* colOut = out + c * columnStride;
+        for (std::ptrdiff_t i = 0; i < count; ++i)
+        {
+            const double v = columns[c][i];
+            if (bins[i] < 0 || isNaN(v))
+                continue;
+            foldInto(colOut + bins[i] * 2, v, v);
+        }
+    }
+}
+
+const MinMaxKernels kScalarKernels = {
+    Isa::Scalar, "scalar", &accumulateScalar, &accumulateBinnedScalar};
+
+#ifdef QCP_MINMAX_NEON
+// NEON is baseline on AArch64: no runtime check, no separate unit.
+struct NeonOps {
+    using V = float64x2_t;
+    static constexpr int kLanes = 2;
+    static constexpr int kIntLanes = 4;
+
+    static V load(const double* p) { return vld1q_f64(p); }
+    static V set1(double x) { return vdupq_n_f64(x); }
+    static bool allInside(V k, V lo, V hi)
+    {
+        const uint64x2_t in = vandq_u64(vcgeq_f64(k, lo), vcltq_f64(k, hi));
+        return vminvq_u32(vreinterpretq_u32_u64(in)) != 0;
+    }
+    // minnm/maxnm return the number when one operand is NaN
+    static V min(V acc, V x) { return vminnmq_f64(acc, x); }
+    static V max(V acc, V x) { return vmaxnmq_f64(acc, x); }
+    static double hmin(V v) { return vminnmvq_f64(v); }
+    static double hmax(V v) { return vmaxnmvq_f64(v); }
+    static bool allEqual(const int* p, int b)
+    {
+        return vminvq_u32(vceqq_s32(vld1q_s32(p), vdupq_n_s32(b))) != 0;
+    }
+};
+
+const MinMaxKernels kNeonKernels = {
+    Isa::Neon, "neon", &accumulateImpl<NeonOps>, &accumulateBinnedImpl<NeonOps>};
+#endif
+
+#if defined(NEOQCP_HAVE_AVX2_KERNELS) || defined(NEOQCP_HAVE_AVX512_KERNELS)
+#  if defined(_MSC_VER) && !defined(__clang__)
+// CPUID leaf 7 feature bit, plus the OS having enabled the register state.
+bool cpuHas(int leaf7EbxBit, unsigned long long xcr0Mask)
+{
+    int regs[4];
+    __cpuid(regs, 1);
+    const bool osxsave = regs[2] & (1 << 27);
+    if (!osxsave || (_xgetbv(0) & xcr0Mask) != xcr0Mask)
+        return false;
+    __cpuidex(regs, 7, 0);
+    return regs[1] & (1 << leaf7EbxBit);
+}
+#    define QCP_CPU_HAS_AVX2() cpuHas(5, 0x6)
+#    define QCP_CPU_HAS_AVX512() cpuHas(16, 0xE6)
+#  else
+#    define QCP_CPU_HAS_AVX2() (__builtin_cpu_init(), __builtin_cpu_supports("avx2"))
+#    define QCP_CPU_HAS_AVX512() (__builtin_cpu_init(), __builtin_cpu_supports("avx512f"))
+#  endif
+#endif
+
+// Upper bound set by NEOQCP_SIMD, or Avx512 (no cap).
+Isa environmentCap()
+{
+    const QByteArray name = qgetenv("NEOQCP_SIMD").toLower();
+    if (name.isEmpty() || name == "avx512")
+        return Isa::Avx512;
+    if (name == "scalar")
+        return Isa::Scalar;
+    if (name == "neon")
+        return Isa::Neon;
+    if (name == "avx2")
+        return Isa::Avx2;
+    qWarning("NEOQCP_SIMD: unknown instruction set \"%s\" — ignored", name.constData());
+    return Isa::Avx512;
+}
+
+const MinMaxKernels* bestKernels()
+{
+    const Isa cap = environmentCap();
+    for (Isa isa : {Isa::Avx512, Isa::Avx2, Isa::Neon})
+    {
+        if (isa > cap)
+            continue;
+        if (const MinMaxKernels* kernels = minMaxKernelsFor(isa))
+            return kernels;
+    }
+    return &kScalarKernels;
+}
+
+std::atomic<const MinMaxKernels*>& activeKernels()
+{
+    static std::atomic<const MinMaxKernels*> kernels {bestKernels()};
+    return kernels;
+}
+
+} // namespace
+
+const MinMaxKernels* minMaxKernelsFor(Isa isa)
+{
+    switch (isa)
+    {
+        case Isa::Scalar:
+            return &kScalarKernels;
+        case Isa::Neon:
+#ifdef QCP_MINMAX_NEON
+            return &kNeonKernels;
+#else
+            return nullptr;
+#endif
+        case Isa::Avx2:
+        {
+#ifdef NEOQCP_HAVE_AVX2_KERNELS
+            static const bool supported = QCP_CPU_HAS_AVX2();
+            return supported ? &kAvx2MinMaxKernels : nullptr;
+#else
+            return nullptr;
+#endif
+        }
+        case Isa::Avx512:
+        {
+#ifdef NEOQCP_HAVE_AVX512_KERNELS
+            static const bool supported = QCP_CPU_HAS_AVX512();
+            return supported ? &kAvx512MinMaxKernels : nullptr;
+#else
+            return nullptr;
+#endif
+        }
+    }
+    return nullptr;
+}
+
+const MinMaxKernels& minMaxKernels()
+{
+    return *activeKernels().load(std::memory_order_relaxed);
+}
+
+bool setMinMaxIsa(Isa isa)
+{
+    const MinMaxKernels* kernels = minMaxKernelsFor(isa);
+    if (!kernels)
+        return false;
+    activeKernels().store(kernels, std::memory_order_relaxed);
+    return true;
+}
+
+} // namespace qcp::algo::simd
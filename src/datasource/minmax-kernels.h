@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+
+// Min/max binning kernels for the L1/L2 resamplers, vectorized per
+// instruction set and selected at runtime (best the CPU supports).
+//
+// The kernel translation units are compiled with ISA-specific flags
+// (-mavx2, -mavx512f...) and must not call inline functions of Qt or other
+// headers, or the linker may keep an AVX copy of a shared inline function for
+// everyone — hence std::ptrdiff_t instead of qsizetype here. Headers used
+// only for macros and constant expressions emit no code and are fine: <cfloat>,
+// and <limits> while numeric_limits stays in constexpr initializers.
+//
+// Every kernel produces bit-identical results to the scalar reference:
+// samples with a NaN value or a non-finite key are skipped, the bin index is
+// trunc((key - keyLo) / binWidth) clamped to [binBegin, binEnd), and a NaN
+// min/max slot means "empty bin".
+namespace qcp::algo::simd {
+
+enum class Isa { Scalar, Neon, Avx2, Avx512 };
+
+// Folds keys/values [begin, end) into min/max pairs out[2 * bin], out[2 * bin + 1].
+// Keys need not be sorted; sorted keys form runs of samples in the same bin,
+// which are reduced a full vector at a time.
+using AccumulateFn = void (*)(const double* keys, const double* values,
+                              std::ptrdiff_t begin, std::ptrdiff_t end,
+                              double keyLo, double binWidth,
+                              double* out, int binBegin, int binEnd);
+
+// Multi-column form over precomputed bin indices (bins[i] < 0: skip sample i).
+// columns[c] points at the chunk's first sample of column c; column c's
+// min/max pairs start at out + c * columnStride. Runs of equal bin indices
+// are detected once and reduced for every column.
+using AccumulateBinnedFn = void (*)(const int* bins, std::ptrdiff_t count,
+                                    const double* const* columns, int columnCount,
+                                    double* out, std::ptrdiff_t columnStride);
+
+struct MinMaxKernels {
+    Isa isa;
+    const char* name;
+    AccumulateFn accumulate;
+    AccumulateBinnedFn accumulateBinned;
+};
+
+// Kernels in use: the best ISA supported by both the build and the CPU,
+// capped by the NEOQCP_SIMD environment variable (scalar|neon|avx2|avx512)
+// or by setMinMaxIsa().
+const MinMaxKernels& minMaxKernels();
+
+// Kernels for `isa`, or nullptr when the build or the CPU lacks it.
+const MinMaxKernels* minMaxKernelsFor(Isa isa);
+
+// Switches the kernels in use (benchmarks, tests). Returns false and keeps
+// the current kernels when `isa` is unavailable.
+bool setMinMaxIsa(Isa isa);
+
+} // namespace qcp::algo::simd
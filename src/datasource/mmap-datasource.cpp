@@ -0,0 +1,467 @@
+#include "mmap-datasource.h"
+#include "soa-datasource.h"
+#include "soa-multi-datasource.h"
+#include "row-major-multi-datasource.h"
+#include <QByteArray>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <utility>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+std::shared_ptr<QCPMappedFile> QCPMappedFile::open(const QString& path)
+{
+    std::shared_ptr<QCPMappedFile> file(new QCPMappedFile(path));
+    if (!file->mFile.open(QIODevice::ReadOnly))
+    {
+        qWarning("QCPMappedFile: cannot open %s: %s", qPrintable(path),
+                 qPrintable(file->mFile.errorString()));
+        return nullptr;
+    }
+    file->mSize = file->mFile.size();
+    if (file->mSize <= 0)
+    {
+        qWarning("QCPMappedFile: %s is empty", qPrintable(path));
+        return nullptr;
+    }
+    file->mData = file->mFile.map(0, file->mSize);
+    if (!file->mData)
+    {
+        qWarning("QCPMappedFile: cannot map %s: %s", qPrintable(path),
+                 qPrintable(file->mFile.errorString()));
+        return nullptr;
+    }
+    return file;
+}
+
+QCPMappedFile::~QCPMappedFile()
+{
+    if (mData)
+        mFile.unmap(mData);
+}
+
+void QCPMappedFile::advise(qint64 offset, qint64 length, QCPAccessHint hint) const
+{
+#ifdef Q_OS_UNIX
+    offset = std::max<qint64>(offset, 0);
+    length = std::min(length, mSize - offset);
+    if (!mData || length <= 0)
+        return;
+    static const qint64 pageSize = sysconf(_SC_PAGESIZE);
+    // The mapping starts on a page boundary, so aligning the offset aligns the address.
+    const qint64 first = offset - offset % pageSize;
+    int advice = POSIX_MADV_NORMAL;
+    switch (hint)
+    {
+        case QCPAccessHint::Normal: advice = POSIX_MADV_NORMAL; break;
+        case QCPAccessHint::Sequential: advice = POSIX_MADV_SEQUENTIAL; break;
+        case QCPAccessHint::WillNeed: advice = POSIX_MADV_WILLNEED; break;
+    }
+    posix_madvise(mData + first, static_cast<size_t>(offset + length - first), advice);
+#else
+    Q_UNUSED(offset)
+    Q_UNUSED(length)
+    Q_UNUSED(hint)
+#endif
+}
+
+int qcpDTypeSize(QCPDType type)
+{
+    switch (type)
+    {
+        case QCPDType::Int8:
+        case QCPDType::UInt8: return 1;
+        case QCPDType::Int16:
+        case QCPDType::UInt16: return 2;
+        case QCPDType::Int32:
+        case QCPDType::UInt32:
+        case QCPDType::Float32: return 4;
+        case QCPDType::Int64:
+        case QCPDType::UInt64:
+        case QCPDType::Float64: return 8;
+    }
+    return 0;
+}
+
+void qcp::detail::adviseRegions(const std::vector<MappedRegion>& regions,
+                                qsizetype begin, qsizetype end, QCPAccessHint hint)
+{
+    if (end <= begin)
+        return;
+    for (const MappedRegion& r : regions)
+        r.file->advise(r.offset + begin * r.rowBytes, (end - begin) * r.rowBytes, hint);
+}
+
+namespace {
+
+template <typename T>
+struct TypeTag { using type = T; };
+
+// Column types the views are instantiated for (one QCPSoADataSource /
+// multi-source instantiation per key x value pair, so the lists stay short).
+template <typename F>
+bool visitKeyType(QCPDType type, F&& f)
+{
+    switch (type)
+    {
+        case QCPDType::Float64: f(TypeTag<double>{}); return true;
+        case QCPDType::Float32: f(TypeTag<float>{}); return true;
+        case QCPDType::Int64: f(TypeTag<std::int64_t>{}); return true;
+        default: return false;
+    }
+}
+
+template <typename F>
+bool visitValueType(QCPDType type, F&& f)
+{
+    switch (type)
+    {
+        case QCPDType::Float64: f(TypeTag<double>{}); return true;
+        case QCPDType::Float32: f(TypeTag<float>{}); return true;
+        case QCPDType::Int64: f(TypeTag<std::int64_t>{}); return true;
+        case QCPDType::Int32: f(TypeTag<std::int32_t>{}); return true;
+        case QCPDType::Int16: f(TypeTag<std::int16_t>{}); return true;
+        case QCPDType::UInt16: f(TypeTag<std::uint16_t>{}); return true;
+        case QCPDType::Int8: f(TypeTag<std::int8_t>{}); return true;
+        case QCPDType::UInt8: f(TypeTag<std::uint8_t>{}); return true;
+        default: return false;
+    }
+}
+
+struct MappedColumns {
+    std::shared_ptr<QCPMappedFile> keyFile;
+    std::shared_ptr<QCPMappedFile> valueFile;
+    QCPMmapLayout layout;
+
+    std::shared_ptr<const void> guard() const
+    {
+        return std::make_shared<std::pair<std::shared_ptr<QCPMappedFile>,
+                                          std::shared_ptr<QCPMappedFile>>>(keyFile, valueFile);
+    }
+
+    std::vector<qcp::detail::MappedRegion> regions() const
+    {
+        const qint64 vs = qcpDTypeSize(layout.valueType);
+        std::vector<qcp::detail::MappedRegion> r;
+        r.push_back({keyFile, layout.keyOffset, qcpDTypeSize(layout.keyType)});
+        if (layout.rowMajor)
+            r.push_back({valueFile, layout.valueOffset, vs * layout.columns});
+        else
+            for (int c = 0; c < layout.columns; ++c)
+                r.push_back({valueFile, layout.valueOffset + c * layout.rows * vs, vs});
+        return r;
+    }
+
+    template <typename T>
+    const T* at(const QCPMappedFile& file, qint64 offset) const
+    {
+        return reinterpret_cast<const T*>(file.data() + offset);
+    }
+};
+
+// Bytes [offset, offset + count * elementSize) fit in a file of `size` bytes.
+bool fits(qint64 offset, qint64 count, qint64 elementSize, qint64 size)
+{
+    return offset >= 0 && count >= 0 && offset <= size && count <= (size - offset) / elementSize;
+}
+
+bool validate(const MappedColumns& m, const char* who)
+{
+    const QCPMmapLayout& l = m.layout;
+    const qint64 ks = qcpDTypeSize(l.keyType);
+    const qint64 vs = qcpDTypeSize(l.valueType);
+    if (!visitKeyType(l.keyType, [](auto) {}) || !visitValueType(l.valueType, [](auto) {}))
+    {
+        qWarning("%s: unsupported key/value types (%d, %d)", who,
+                 static_cast<int>(l.keyType), static_cast<int>(l.valueType));
+        return false;
+    }
+    if (l.rows < 0 || l.columns < 1)
+    {
+        qWarning("%s: invalid shape (rows=%lld, columns=%d)", who,
+                 static_cast<long long>(l.rows), l.columns);
+        return false;
+    }
+    // Typed access through the mapping needs naturally aligned columns.
+    if (l.keyOffset % ks != 0 || l.valueOffset % vs != 0)
+    {
+        qWarning("%s: column offsets (%lld, %lld) are not aligned to their element size", who,
+                 static_cast<long long>(l.keyOffset), static_cast<long long>(l.valueOffset));
+        return false;
+    }
+    const bool valuesFit = l.rows == 0
+        || (l.rows <= std::numeric_limits<qint64>::max() / l.columns
+            && fits(l.valueOffset, l.rows * l.columns, vs, m.valueFile->size()));
+    if (!fits(l.keyOffset, l.rows, ks, m.keyFile->size()) || !valuesFit)
+    {
+        qWarning("%s: %lld rows x %d columns don't fit in the mapped file(s)", who,
+                 static_cast<long long>(l.rows), l.columns);
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<QCPAbstractDataSource> makeView(const MappedColumns& m)
+{
+    std::unique_ptr<QCPAbstractDataSource> view;
+    const QCPMmapLayout& l = m.layout;
+    visitKeyType(l.keyType, [&]<typename KT>(TypeTag<KT>) {
+        visitValueType(l.valueType, [&]<typename VT>(TypeTag<VT>) {
+            view = std::make_unique<QCPSoADataSource<std::span<const KT>, std::span<const VT>>>(
+                std::span<const KT>(m.at<KT>(*m.keyFile, l.keyOffset), l.rows),
+                std::span<const VT>(m.at<VT>(*m.valueFile, l.valueOffset), l.rows),
+                m.guard());
+        });
+    });
+    return view;
+}
+
+std::unique_ptr<QCPAbstractMultiDataSource> makeMultiView(const MappedColumns& m)
+{
+    std::unique_ptr<QCPAbstractMultiDataSource> view;
+    const QCPMmapLayout& l = m.layout;
+    visitKeyType(l.keyType, [&]<typename KT>(TypeTag<KT>) {
+        visitValueType(l.valueType, [&]<typename VT>(TypeTag<VT>) {
+            const std::span<const KT> keys(m.at<KT>(*m.keyFile, l.keyOffset), l.rows);
+            const VT* values = m.at<VT>(*m.valueFile, l.valueOffset);
+            if (l.rowMajor)
+            {
+                view = std::make_unique<QCPRowMajorMultiDataSource<KT, VT>>(
+                    keys, values, l.rows, l.columns, l.columns, m.guard());
+                return;
+            }
+            std::vector<std::span<const VT>> columns;
+            for (int c = 0; c < l.columns; ++c)
+                columns.emplace_back(values + c * l.rows, l.rows);
+            view = std::make_unique<QCPSoAMultiDataSource<std::span<const KT>, std::span<const VT>>>(
+                keys, std::move(columns), m.guard());
+        });
+    });
+    return view;
+}
+
+// --- NumPy .npy (format versions 1-3) ---
+
+struct NpyArray {
+    QCPDType type = QCPDType::Float64;
+    qint64 dataOffset = 0;
+    qsizetype rows = 0;
+    int columns = 1;
+    bool fortranOrder = false;
+};
+
+// Value text following `'key':` in the header dict, or an empty array.
+QByteArray npyField(const QByteArray& header, const char* key)
+{
+    const QByteArray quoted = QByteArray("'") + key + "'";
+    qsizetype at = header.indexOf(quoted);
+    if (at < 0)
+        return {};
+    at = header.indexOf(':', at + quoted.size());
+    if (at < 0)
+        return {};
+    return header.mid(at + 1).trimmed();
+}
+
+bool parseNpyDescr(const QByteArray& field, QCPDType& type)
+{
+    // '<f8', '|u1', '<M8[ns]' ...
+    if (field.size() < 5 || field[0] != '\'')
+        return false;
+    const char order = field[1];
+    const char kind = field[2];
+    const int size = field[3] - '0';
+    if (field.size() > 4 && field[4] != '\'' && field[4] != '[')
+        return false; // multi-digit sizes (complex, structured) aren't numeric columns
+    if (order == '>' && size > 1)
+        return false; // big-endian data
+    if (order != '<' && order != '|' && order != '=' && order != '>')
+        return false;
+    if (Q_BYTE_ORDER != Q_LITTLE_ENDIAN && order == '<' && size > 1)
+        return false;
+    switch (kind)
+    {
+        case 'f':
+            if (size == 4) { type = QCPDType::Float32; return true; }
+            if (size == 8) { type = QCPDType::Float64; return true; }
+            return false;
+        case 'i':
+        case 'u':
+        {
+            const bool s = kind == 'i';
+            switch (size)
+            {
+                case 1: type = s ? QCPDType::Int8 : QCPDType::UInt8; return true;
+                case 2: type = s ? QCPDType::Int16 : QCPDType::UInt16; return true;
+                case 4: type = s ? QCPDType::Int32 : QCPDType::UInt32; return true;
+                case 8: type = s ? QCPDType::Int64 : QCPDType::UInt64; return true;
+                default: return false;
+            }
+        }
+        case 'M': // datetime64
+        case 'm': // timedelta64
+            if (size == 8) { type = QCPDType::Int64; return true; }
+            return false;
+        default:
+            return false;
+    }
+}
+
+bool parseNpy(const QCPMappedFile& file, NpyArray& out)
+{
+    const uchar* d = file.data();
+    const qint64 size = file.size();
+    if (size < 10 || std::memcmp(d, "\x93NUMPY", 6) != 0)
+    {
+        qWarning("QCPMmapDataSource: %s is not a .npy file", qPrintable(file.fileName()));
+        return false;
+    }
+    const int major = d[6];
+    qint64 headerLen = 0, headerStart = 0;
+    if (major == 1)
+    {
+        headerLen = d[8] | (d[9] << 8);
+        headerStart = 10;
+    }
+    else if ((major == 2 || major == 3) && size >= 12)
+    {
+        headerLen = qint64(d[8]) | (qint64(d[9]) << 8) | (qint64(d[10]) << 16) | (qint64(d[11]) << 24);
+        headerStart = 12;
+    }
+    else
+    {
+        qWarning("QCPMmapDataSource: %s: unsupported .npy version %d", qPrintable(file.fileName()), major);
+        return false;
+    }
+    if (headerLen > size - headerStart)
+    {
+        qWarning("QCPMmapDataSource: %s: truncated .npy header", qPrintable(file.fileName()));
+        return false;
+    }
+    const QByteArray header(reinterpret_cast<const char*>(d + headerStart), headerLen);
+
+    if (!parseNpyDescr(npyField(header, "descr"), out.type))
+    {
+        qWarning("QCPMmapDataSource: %s: unsupported dtype in header %s",
+                 qPrintable(file.fileName()), header.constData());
+        return false;
+    }
+    out.fortranOrder = npyField(header, "fortran_order").startsWith("True");
+
+    const QByteArray shape = npyField(header, "shape");
+    const qsizetype close = shape.indexOf(')');
+    if (!shape.startsWith('(') || close < 0)
+    {
+        qWarning("QCPMmapDataSource: %s: malformed shape", qPrintable(file.fileName()));
+        return false;
+    }
+    std::vector<qint64> dims;
+    for (const QByteArray& part : shape.mid(1, close - 1).split(','))
+    {
+        const QByteArray t = part.trimmed();
+        if (t.isEmpty())
+            continue;
+        bool ok = false;
+        dims.push_back(t.toLongLong(&ok));
+        if (!ok || dims.back() < 0)
+        {
+            qWarning("QCPMmapDataSource: %s: malformed shape", qPrintable(file.fileName()));
+            return false;
+        }
+    }
+    if (dims.empty() || dims.size() > 2 || (dims.size() == 2 && dims[1] > std::numeric_limits<int>::max()))
+    {
+        qWarning("QCPMmapDataSource: %s: expected a 1-D or 2-D array", qPrintable(file.fileName()));
+        return false;
+    }
+    out.rows = dims[0];
+    out.columns = dims.size() == 2 ? static_cast<int>(dims[1]) : 1;
+    out.dataOffset = headerStart + headerLen;
+    return true;
+}
+
+// Opens a keys .npy and a values .npy as mapped columns; values may be 2-D.
+bool openNpyColumns(const QString& keysPath, const QString& valuesPath, MappedColumns& m)
+{
+    m.keyFile = QCPMappedFile::open(keysPath);
+    m.valueFile = QCPMappedFile::open(valuesPath);
+    if (!m.keyFile || !m.valueFile)
+        return false;
+    NpyArray keys, values;
+    if (!parseNpy(*m.keyFile, keys) || !parseNpy(*m.valueFile, values))
+        return false;
+    if (keys.columns != 1 || keys.rows != values.rows)
+    {
+        qWarning("QCPMmapDataSource: keys (%lld x %d) don't match values (%lld rows)",
+                 static_cast<long long>(keys.rows), keys.columns,
+                 static_cast<long long>(values.rows));
+        return false;
+    }
+    m.layout.rows = keys.rows;
+    m.layout.columns = values.columns;
+    m.layout.keyType = keys.type;
+    m.layout.keyOffset = keys.dataOffset;
+    m.layout.valueType = values.type;
+    m.layout.valueOffset = values.dataOffset;
+    // A 1-D array is both; a 2-D C-order array stores rows contiguously.
+    m.layout.rowMajor = values.columns > 1 && !values.fortranOrder;
+    return true;
+}
+
+} // namespace
+
+std::shared_ptr<QCPMmapDataSource> QCPMmapDataSource::openRaw(const QString& path,
+                                                              const QCPMmapLayout& layout)
+{
+    MappedColumns m;
+    m.keyFile = m.valueFile = QCPMappedFile::open(path);
+    m.layout = layout;
+    if (!m.keyFile || !validate(m, "QCPMmapDataSource"))
+        return nullptr;
+    if (layout.columns != 1)
+    {
+        qWarning("QCPMmapDataSource: %d value columns — use QCPMmapMultiDataSource", layout.columns);
+        return nullptr;
+    }
+    return std::shared_ptr<QCPMmapDataSource>(new QCPMmapDataSource(makeView(m), m.regions()));
+}
+
+std::shared_ptr<QCPMmapDataSource> QCPMmapDataSource::openNpy(const QString& keysPath,
+                                                              const QString& valuesPath)
+{
+    MappedColumns m;
+    if (!openNpyColumns(keysPath, valuesPath, m) || !validate(m, "QCPMmapDataSource"))
+        return nullptr;
+    if (m.layout.columns != 1)
+    {
+        qWarning("QCPMmapDataSource: %d value columns — use QCPMmapMultiDataSource", m.layout.columns);
+        return nullptr;
+    }
+    return std::shared_ptr<QCPMmapDataSource>(new QCPMmapDataSource(makeView(m), m.regions()));
+}
+
+std::shared_ptr<QCPMmapMultiDataSource> QCPMmapMultiDataSource::openRaw(const QString& path,
+                                                                        const QCPMmapLayout& layout)
+{
+    MappedColumns m;
+    m.keyFile = m.valueFile = QCPMappedFile::open(path);
+    m.layout = layout;
+    if (!m.keyFile || !validate(m, "QCPMmapMultiDataSource"))
+        return nullptr;
+    return std::shared_ptr<QCPMmapMultiDataSource>(
+        new QCPMmapMultiDataSource(makeMultiView(m), m.regions()));
+}
+
+std::shared_ptr<QCPMmapMultiDataSource> QCPMmapMultiDataSource::openNpy(const QString& keysPath,
+                                                                        const QString& valuesPath)
+{
+    MappedColumns m;
+    if (!openNpyColumns(keysPath, valuesPath, m) || !validate(m, "QCPMmapMultiDataSource"))
+        return nullptr;
+    return std::shared_ptr<QCPMmapMultiDataSource>(
+        new QCPMmapMultiDataSource(makeMultiView(m), m.regions()));
+}
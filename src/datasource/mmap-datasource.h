@@ -0,0 +1,183 @@
+#pragma once
+#include "abstract-datasource.h"
+#include "abstract-multi-datasource.h"
+#include <QFile>
+#include <QString>
+#include <QtGlobal>
+#include <memory>
+#include <vector>
+
+// Read-only memory-mapped file. Shared as the dataGuard of the zero-copy
+// views over it: the mapping lives as long as any view (or in-flight
+// pipeline job holding one).
+class QCPMappedFile {
+public:
+    // nullptr (with a warning) when the file can't be opened or mapped.
+    static std::shared_ptr<QCPMappedFile> open(const QString& path);
+    ~QCPMappedFile();
+
+    const uchar* data() const { return mData; }
+    qint64 size() const { return mSize; }
+    QString fileName() const { return mFile.fileName(); }
+
+    // Page-cache hint for bytes [offset, offset + length), widened to whole
+    // pages. posix_madvise() where available, a no-op elsewhere.
+    void advise(qint64 offset, qint64 length, QCPAccessHint hint) const;
+
+private:
+    explicit QCPMappedFile(const QString& path) : mFile(path) {}
+
+    QFile mFile;
+    uchar* mData = nullptr;
+    qint64 mSize = 0;
+};
+
+// Element type of a mapped column. Int64 also carries NumPy datetime64 /
+// timedelta64 arrays (raw ticks, no unit conversion).
+enum class QCPDType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Int64, UInt64, Float32, Float64 };
+
+int qcpDTypeSize(QCPDType type);
+
+// Shape of a flat binary file: `rows` keys at keyOffset, and `columns` value
+// columns at valueOffset — one after the other (column-major), or
+// interleaved row by row when rowMajor. Offsets are in bytes and must be
+// aligned to their element size.
+//
+// Mapped keys may be Float64, Float32 or Int64; values any type but UInt32 /
+// UInt64. Keys must be sorted, as for every graph source.
+struct QCPMmapLayout {
+    qsizetype rows = 0;
+    int columns = 1;
+    QCPDType keyType = QCPDType::Float64;
+    qint64 keyOffset = 0;
+    QCPDType valueType = QCPDType::Float64;
+    qint64 valueOffset = 0;
+    bool rowMajor = false;
+};
+
+namespace qcp::detail {
+
+// Bytes of a mapped file holding rows [0, rows): row i spans
+// [offset + i * rowBytes, offset + (i + 1) * rowBytes).
+struct MappedRegion {
+    std::shared_ptr<QCPMappedFile> file;
+    qint64 offset = 0;
+    qint64 rowBytes = 0;
+};
+
+void adviseRegions(const std::vector<MappedRegion>& regions,
+                   qsizetype begin, qsizetype end, QCPAccessHint hint);
+
+} // namespace qcp::detail
+
+// Graph source over memory-mapped columns, without copying: a typed
+// QCPSoADataSource view over the mapping (picked once from the column types),
+// plus madvise() hints translated from adviseAccess() row ranges.
+class QCPMmapDataSource final : public QCPAbstractDataSource {
+public:
+    // layout.columns must be 1 (column `column` of a multi-column file can be
+    // viewed through QCPMmapMultiDataSource). nullptr on any error.
+    static std::shared_ptr<QCPMmapDataSource> openRaw(const QString& path, const QCPMmapLayout& layout);
+    // keysPath: 1-D array; valuesPath: 1-D array of the same length.
+    static std::shared_ptr<QCPMmapDataSource> openNpy(const QString& keysPath, const QString& valuesPath);
+
+    qsizetype size() const override { return mView->size(); }
+    bool empty() const override { return mView->empty(); }
+    QCPRange keyRange(bool& foundRange, QCP::SignDomain sd = QCP::sdBoth) const override
+    { return mView->keyRange(foundRange, sd); }
+    QCPRange valueRange(bool& foundRange, QCP::SignDomain sd = QCP::sdBoth,
+                        const QCPRange& inKeyRange = QCPRange()) const override
+    { return mView->valueRange(foundRange, sd, inKeyRange); }
+    bool finiteKeyValueBounds(QCPRange& keyOut, QCPRange& valueOut,
+                              bool keyPositiveOnly = false,
+                              bool valuePositiveOnly = false) const override
+    { return mView->finiteKeyValueBounds(keyOut, valueOut, keyPositiveOnly, valuePositiveOnly); }
+    qsizetype findBegin(double sortKey, bool expandedRange = true) const override
+    { return mView->findBegin(sortKey, expandedRange); }
+    qsizetype findEnd(double sortKey, bool expandedRange = true) const override
+    { return mView->findEnd(sortKey, expandedRange); }
+    double keyAt(qsizetype i) const override { return mView->keyAt(i); }
+    double valueAt(qsizetype i) const override { return mView->valueAt(i); }
+    QVector<QPointF> getOptimizedLineData(qsizetype begin, qsizetype end, int pixelWidth,
+                                           QCPAxis* keyAxis, QCPAxis* valueAxis) const override
+    { return mView->getOptimizedLineData(begin, end, pixelWidth, keyAxis, valueAxis); }
+    QVector<QPointF> getLines(qsizetype begin, qsizetype end,
+                               QCPAxis* keyAxis, QCPAxis* valueAxis) const override
+    { return mView->getLines(begin, end, keyAxis, valueAxis); }
+    void getOptimizedPixelLine(qsizetype begin, qsizetype end, int pixelWidth,
+                               QCPAxis* keyAxis, QCPAxis* valueAxis, QCPPixelLine& out) const override
+    { mView->getOptimizedPixelLine(begin, end, pixelWidth, keyAxis, valueAxis, out); }
+    void getPixelLine(qsizetype begin, qsizetype end,
+                      QCPAxis* keyAxis, QCPAxis* valueAxis, QCPPixelLine& out) const override
+    { mView->getPixelLine(begin, end, keyAxis, valueAxis, out); }
+    void readSamples(qsizetype begin, qsizetype end, double* keys, double* values) const override
+    { mView->readSamples(begin, end, keys, values); }
+    void accumulateMinMax(qsizetype begin, qsizetype end, double keyLo, double binWidth,
+                          double* minMax, int binBegin, int binEnd) const override
+    { mView->accumulateMinMax(begin, end, keyLo, binWidth, minMax, binBegin, binEnd); }
+
+    qsizetype sampleBytes() const override { return mView->sampleBytes(); }
+
+    void adviseAccess(qsizetype begin, qsizetype end, QCPAccessHint hint) const override
+    { qcp::detail::adviseRegions(mRegions, begin, end, hint); }
+
+private:
+    QCPMmapDataSource(std::unique_ptr<QCPAbstractDataSource> view,
+                      std::vector<qcp::detail::MappedRegion> regions)
+        : mView(std::move(view)), mRegions(std::move(regions)) {}
+
+    std::unique_ptr<QCPAbstractDataSource> mView;
+    std::vector<qcp::detail::MappedRegion> mRegions;
+};
+
+// Multi-column counterpart for QCPMultiGraph: column-major values are viewed
+// as one span per column, row-major values through strided column views.
+class QCPMmapMultiDataSource final : public QCPAbstractMultiDataSource {
+public:
+    static std::shared_ptr<QCPMmapMultiDataSource> openRaw(const QString& path, const QCPMmapLayout& layout);
+    // keysPath: 1-D array; valuesPath: 1-D or 2-D (rows x columns, C or
+    // Fortran order) array with as many rows as keys.
+    static std::shared_ptr<QCPMmapMultiDataSource> openNpy(const QString& keysPath, const QString& valuesPath);
+
+    int columnCount() const override { return mView->columnCount(); }
+    qsizetype size() const override { return mView->size(); }
+    bool empty() const override { return mView->empty(); }
+    double keyAt(qsizetype i) const override { return mView->keyAt(i); }
+    QCPRange keyRange(bool& found, QCP::SignDomain sd = QCP::sdBoth) const override
+    { return mView->keyRange(found, sd); }
+    qsizetype findBegin(double sortKey, bool expandedRange = true) const override
+    { return mView->findBegin(sortKey, expandedRange); }
+    qsizetype findEnd(double sortKey, bool expandedRange = true) const override
+    { return mView->findEnd(sortKey, expandedRange); }
+    double valueAt(int column, qsizetype i) const override { return mView->valueAt(column, i); }
+    QCPRange valueRange(int column, bool& found, QCP::SignDomain sd = QCP::sdBoth,
+                        const QCPRange& inKeyRange = QCPRange()) const override
+    { return mView->valueRange(column, found, sd, inKeyRange); }
+    QVector<QPointF> getOptimizedLineData(int column, qsizetype begin, qsizetype end, int pixelWidth,
+                                           QCPAxis* keyAxis, QCPAxis* valueAxis) const override
+    { return mView->getOptimizedLineData(column, begin, end, pixelWidth, keyAxis, valueAxis); }
+    QVector<QPointF> getLines(int column, qsizetype begin, qsizetype end,
+                               QCPAxis* keyAxis, QCPAxis* valueAxis) const override
+    { return mView->getLines(column, begin, end, keyAxis, valueAxis); }
+    void getOptimizedLineDataAll(qsizetype begin, qsizetype end, int pixelWidth,
+                                  QCPAxis* keyAxis, QCPAxis* valueAxis,
+                                  QVector<QPointF>* results, int numColumns) const override
+    { mView->getOptimizedLineDataAll(begin, end, pixelWidth, keyAxis, valueAxis, results, numColumns); }
+    void getLinesAll(qsizetype begin, qsizetype end, QCPAxis* keyAxis, QCPAxis* valueAxis,
+                     QVector<QPointF>* results, int numColumns) const override
+    { mView->getLinesAll(begin, end, keyAxis, valueAxis, results, numColumns); }
+    const double* rawKeyData() const override { return mView->rawKeyData(); }
+    const double* rawColumnData(int column) const override { return mView->rawColumnData(column); }
+    qsizetype sampleBytes() const override { return mView->sampleBytes(); }
+
+    void adviseAccess(qsizetype begin, qsizetype end, QCPAccessHint hint) const override
+    { qcp::detail::adviseRegions(mRegions, begin, end, hint); }
+
+private:
+    QCPMmapMultiDataSource(std::unique_ptr<QCPAbstractMultiDataSource> view,
+                           std::vector<qcp::detail::MappedRegion> regions)
+        : mView(std::move(view)), mRegions(std::move(regions)) {}
+
+    std::unique_ptr<QCPAbstractMultiDataSource> mView;
+    std::vector<qcp::detail::MappedRegion> mRegions;
+};
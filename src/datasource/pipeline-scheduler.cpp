@@ -1,90 +1,144 @@
 #include "pipeline-scheduler.h"
-#include "thread-naming.h"
+#include "work-executor.h"
 #include <QThread>
 #include <algorithm>
 
+namespace {
+
+// Executor group key of the shared schedulers; its limit is set on first use.
+const void* sharedGroup()
+{
+    static const char key = 0;
+    static const bool init = [] {
+        QCPWorkExecutor::instance().setGroupLimit(&key,
+                                                  std::max(1, QThread::idealThreadCount() / 2));
+        return true;
+    }();
+    (void)init;
+    return &key;
+}
+
+} // namespace
+
 QCPPipelineScheduler::QCPPipelineScheduler(int maxThreads, QObject* parent)
     : QObject(parent)
 {
-    int threads = maxThreads > 0 ? maxThreads
+    mMaxThreads = maxThreads > 0 ? maxThreads
                                  : std::max(1, QThread::idealThreadCount() / 2);
-    mPool.setMaxThreadCount(threads);
-    mPool.setExpiryTimeout(-1);
+    auto& executor = QCPWorkExecutor::instance();
+    executor.registerOwner(this, mMaxThreads);
+    executor.setOwnerRank(this, mVisibility);
 }
 
 QCPPipelineScheduler::~QCPPipelineScheduler()
 {
     // Queued jobs belong to plottables that may already be deleted by the time
-    // the scheduler dies (~QCustomPlot destroys plottables first): drop them
-    // before joining, otherwise a finishing task's epilogue would start them.
+    // the scheduler dies (~QCustomPlot destroys plottables first): they are
+    // dropped, and only the running ones are waited for.
+    QCPWorkExecutor::instance().unregisterOwner(this);
+}
+
+void QCPPipelineScheduler::submit(Priority priority, std::function<void()> work)
+{
+    // Jobs only run while this scheduler is registered with the executor (the
+    // destructor waits for running ones), so the wrapper may use `this`.
+    const qint64 queuedNs = qcp::monotonicNs();
+    auto job = [this, queuedNs, work = std::move(work)] {
+        const qint64 startNs = qcp::monotonicNs();
+        {
+            qcp::ScanCounterScope scope(&mBytesScanned);
+            work();
+        }
+        recordRun(queuedNs, startNs, qcp::monotonicNs());
+    };
+    const bool queued = QCPWorkExecutor::instance().submit(
+        this, priority == Fast ? QCPWorkExecutor::Fast : QCPWorkExecutor::Heavy,
+        std::move(job));
+
+    QMutexLocker lock(&mStatsMutex);
+    ++mStats.submitted;
+    if (!queued)
+        ++mStats.dropped;
+}
+
+void QCPPipelineScheduler::recordRun(qint64 queuedNs, qint64 startNs, qint64 endNs)
+{
+    QMutexLocker lock(&mStatsMutex);
+    ++mStats.completed;
+    mStats.queueWait.add(startNs - queuedNs);
+    mStats.execution.add(endNs - startNs);
+}
+
+QCPPipelineStats QCPPipelineScheduler::stats() const
+{
+    QCPPipelineStats out;
     {
-        QMutexLocker lock(&mMutex);
-        mShuttingDown = true;
-        mFastQueue.clear();
-        mHeavyQueue.clear();
+        QMutexLocker lock(&mStatsMutex);
+        out = mStats;
     }
-    mPool.waitForDone();
+    auto& executor = QCPWorkExecutor::instance();
+    out.queuedFast = executor.queuedJobs(this, QCPWorkExecutor::Fast);
+    out.queuedHeavy = executor.queuedJobs(this, QCPWorkExecutor::Heavy);
+    out.bytesScanned = mBytesScanned.load(std::memory_order_relaxed);
+    return out;
 }
 
-void QCPPipelineScheduler::submit(Priority priority, std::function<void()> work)
+void QCPPipelineScheduler::resetStats()
+{
+    QMutexLocker lock(&mStatsMutex);
+    mStats = QCPPipelineStats();
+    mBytesScanned.store(0, std::memory_order_relaxed);
+}
+
+void QCPPipelineScheduler::setMaxThreads(int count)
 {
     QMutexLocker lock(&mMutex);
-    if (mShuttingDown)
+    mMaxThreads = std::max(1, count);
+    QCPWorkExecutor::instance().setOwnerLimit(this, mMaxThreads);
+}
+
+int QCPPipelineScheduler::maxThreads() const
+{
+    QMutexLocker lock(&mMutex);
+    return mMaxThreads;
+}
+
+void QCPPipelineScheduler::setVisibility(Visibility visibility)
+{
+    QMutexLocker lock(&mMutex);
+    if (mVisibility == visibility)
         return;
-    if (priority == Fast)
-        mFastQueue.push_back(std::move(work));
-    else
-        mHeavyQueue.push_back(std::move(work));
+    mVisibility = visibility;
+    QCPWorkExecutor::instance().setOwnerRank(this, visibility);
+}
 
-    lock.unlock();
-    scheduleNext();
+QCPPipelineScheduler::Visibility QCPPipelineScheduler::visibility() const
+{
+    QMutexLocker lock(&mMutex);
+    return mVisibility;
 }
 
-void QCPPipelineScheduler::scheduleNext()
+void QCPPipelineScheduler::setShared(bool shared)
 {
     QMutexLocker lock(&mMutex);
-    if (mShuttingDown)
+    if (mShared == shared)
         return;
-    while (mRunning < mPool.maxThreadCount())
-    {
-        std::function<void()> work;
-        if (!mFastQueue.empty())
-        {
-            work = std::move(mFastQueue.front());
-            mFastQueue.pop_front();
-        }
-        else if (!mHeavyQueue.empty())
-        {
-            work = std::move(mHeavyQueue.front());
-            mHeavyQueue.pop_front();
-        }
-        else
-            break;
-
-        ++mRunning;
-        auto* self = this;
-        mPool.start([self, work = std::move(work)]() mutable {
-            qcp::nameThisPoolThreadOnce("pipeSched");
-            try { work(); } catch (...) { }
-            {
-                QMutexLocker lock(&self->mMutex);
-                --self->mRunning;
-            }
-            self->scheduleNext();
-        });
-    }
+    mShared = shared;
+    QCPWorkExecutor::instance().setOwnerGroup(this, shared ? sharedGroup() : nullptr);
 }
 
-void QCPPipelineScheduler::setMaxThreads(int count)
+bool QCPPipelineScheduler::isShared() const
 {
-    {
-        QMutexLocker lock(&mMutex);
-        mPool.setMaxThreadCount(std::max(1, count));
-    }
-    scheduleNext();
+    QMutexLocker lock(&mMutex);
+    return mShared;
 }
 
-int QCPPipelineScheduler::maxThreads() const
+void QCPPipelineScheduler::setSharedMaxThreads(int count)
+{
+    QCPWorkExecutor::instance().setGroupLimit(sharedGroup(), count);
+}
+
+int QCPPipelineScheduler::sharedMaxThreads()
 {
-    return mPool.maxThreadCount();
+    return QCPWorkExecutor::instance().groupLimit(sharedGroup());
 }
@@ -1,17 +1,34 @@
 #pragma once
 #include <QObject>
-#include <QThreadPool>
 #include <QMutex>
-#include <QRunnable>
+#include <atomic>
 #include <functional>
-#include <deque>
+#include "pipeline-stats.h"
 
+// Per-plot front-end of QCPWorkExecutor::instance(): its jobs are one owner
+// there, served round-robin with the other plots' jobs and capped at
+// maxThreads() running at once. Parallel loops inside a job fan out over all
+// the executor's workers.
+//
+// visibility() ranks the plot against the others: jobs of a Focused plot
+// (under the mouse or holding keyboard focus) are taken before those of
+// Visible plots, and Hidden plots (not shown, or scrolled out of view) only
+// get workers no visible plot wants. Within a rank, plots take turns.
+//
+// Shared schedulers (setShared()) additionally draw from one process-wide
+// budget of sharedMaxThreads() running jobs, so a dashboard of many plots
+// behaves like a single scheduler instead of one per plot.
+//
+// stats() reports what went through it since construction (or resetStats()):
+// job counts, queue depth, queue-wait and execution times, and the source
+// bytes its jobs scanned. Recording costs two short locks per job.
 class QCPPipelineScheduler : public QObject
 {
     Q_OBJECT
 
 public:
     enum Priority { Fast, Heavy };
+    enum Visibility { Hidden, Visible, Focused };
 
     explicit QCPPipelineScheduler(int maxThreads = 0, QObject* parent = nullptr);
     ~QCPPipelineScheduler() override;
@@ -20,13 +37,28 @@ public:
     void setMaxThreads(int count);
     int maxThreads() const;
 
+    void setVisibility(Visibility visibility);
+    Visibility visibility() const;
+
+    void setShared(bool shared);
+    bool isShared() const;
+
+    // Running-job budget of all shared schedulers together. Defaults to
+    // idealThreadCount() / 2, the default of a single plot.
+    static void setSharedMaxThreads(int count);
+    static int sharedMaxThreads();
+
+    QCPPipelineStats stats() const;
+    void resetStats();
+
 private:
-    void scheduleNext();
-
-    QThreadPool mPool;
-    QMutex mMutex;
-    std::deque<std::function<void()>> mFastQueue;
-    std::deque<std::function<void()>> mHeavyQueue;
-    int mRunning = 0;
-    bool mShuttingDown = false;
+    void recordRun(qint64 queuedNs, qint64 startNs, qint64 endNs);
+
+    mutable QMutex mMutex;
+    mutable QMutex mStatsMutex;
+    QCPPipelineStats mStats;
+    std::atomic<quint64> mBytesScanned{0};
+    int mMaxThreads = 1;
+    Visibility mVisibility = Hidden;
+    bool mShared = false;
 };
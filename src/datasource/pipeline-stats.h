@@ -0,0 +1,149 @@
+#pragma once
+#include <QtGlobal>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+
+// Latency distribution in power-of-two buckets of microseconds: bucket 0
+// holds samples under 2 us, bucket i (i >= 1) [2^i, 2^(i+1)) us, and the
+// last bucket everything from ~4 s up. Adding a sample is a few integer ops,
+// so histograms stay on in release builds.
+struct QCPLatencyHistogram {
+    static constexpr int kBuckets = 23;
+
+    std::array<quint64, kBuckets> buckets{};
+    quint64 count = 0;
+    qint64 totalNs = 0;
+    qint64 maxNs = 0;
+
+    static int bucketOf(qint64 ns)
+    {
+        const quint64 us = ns > 0 ? quint64(ns) / 1000 : 0;
+        int b = 0;
+        while (b < kBuckets - 1 && (us >> (b + 1)) != 0)
+            ++b;
+        return b;
+    }
+
+    // Exclusive upper bound of bucket `b`, in nanoseconds.
+    static qint64 bucketUpperNs(int b) { return (qint64(2) << b) * 1000; }
+
+    void add(qint64 ns)
+    {
+        ns = std::max<qint64>(ns, 0);
+        ++buckets[bucketOf(ns)];
+        ++count;
+        totalNs += ns;
+        maxNs = std::max(maxNs, ns);
+    }
+
+    void merge(const QCPLatencyHistogram& other)
+    {
+        for (int b = 0; b < kBuckets; ++b)
+            buckets[b] += other.buckets[b];
+        count += other.count;
+        totalNs += other.totalNs;
+        maxNs = std::max(maxNs, other.maxNs);
+    }
+
+    qint64 meanNs() const { return count ? totalNs / qint64(count) : 0; }
+
+    // Upper bound of the bucket holding the q-quantile (0 < q <= 1), capped
+    // at the largest sample; 0 when empty.
+    qint64 quantileNs(double q) const
+    {
+        if (count == 0)
+            return 0;
+        const quint64 rank = std::max<quint64>(1, quint64(q * double(count) + 0.5));
+        quint64 seen = 0;
+        for (int b = 0; b < kBuckets; ++b)
+        {
+            seen += buckets[b];
+            if (seen >= rank)
+                return std::min(bucketUpperNs(b), maxNs);
+        }
+        return maxNs;
+    }
+};
+
+// Runtime counters of a QCPPipelineScheduler (all plottables of a plot) or of
+// one QCPAsyncPipeline. Fields a level doesn't track stay zero.
+struct QCPPipelineStats {
+    // Jobs handed to the scheduler.
+    quint64 submitted = 0;
+    // Requests folded into a job already waiting behind the running one
+    // (pipeline only).
+    quint64 coalesced = 0;
+    // Jobs that never ran (scheduler) or whose result arrived superseded and
+    // was discarded (pipeline).
+    quint64 dropped = 0;
+    // Jobs run to the end, and those whose token was cancelled meanwhile.
+    quint64 completed = 0;
+    quint64 cancelled = 0;
+    // Preview results shown ahead of their full result (pipeline only).
+    quint64 previews = 0;
+    // Jobs waiting for a worker right now (scheduler only).
+    int queuedFast = 0;
+    int queuedHeavy = 0;
+
+    // From submission (pipeline: from the request) to a worker starting it.
+    QCPLatencyHistogram queueWait;
+    // Worker time per job.
+    QCPLatencyHistogram execution;
+    // From the job's end to its result being applied on the GUI thread
+    // (pipeline only).
+    QCPLatencyHistogram delivery;
+    // Source storage read by the resampling and binning kernels.
+    quint64 bytesScanned = 0;
+};
+
+namespace qcp {
+
+// Steady-clock timestamp, comparable across threads (a job is queued, run and
+// delivered on different ones).
+inline qint64 monotonicNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Byte counter of the job the calling thread is working for, or nullptr.
+// QCPTaskGroup hands it on to the subtasks a job forks.
+inline thread_local std::atomic<quint64>* tScanCounter = nullptr;
+
+inline void countScannedBytes(quint64 bytes)
+{
+    if (auto* counter = tScanCounter)
+        counter->fetch_add(bytes, std::memory_order_relaxed);
+}
+
+// Points the calling thread's byte counter at `counter` for its lifetime.
+// With `forward`, the bytes counted are added to the enclosing counter on
+// exit, so a pipeline job's scan also shows in its scheduler's stats.
+class ScanCounterScope
+{
+public:
+    explicit ScanCounterScope(std::atomic<quint64>* counter, bool forward = false)
+        : mCounter(counter), mPrevious(tScanCounter), mForward(forward)
+    {
+        tScanCounter = counter;
+    }
+    ~ScanCounterScope()
+    {
+        tScanCounter = mPrevious;
+        if (mForward && mPrevious && mCounter)
+            mPrevious->fetch_add(mCounter->load(std::memory_order_relaxed),
+                                 std::memory_order_relaxed);
+    }
+    ScanCounterScope(const ScanCounterScope&) = delete;
+    ScanCounterScope& operator=(const ScanCounterScope&) = delete;
+
+private:
+    std::atomic<quint64>* mCounter;
+    std::atomic<quint64>* mPrevious;
+    bool mForward;
+};
+
+} // namespace qcp
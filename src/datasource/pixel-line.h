@@ -0,0 +1,61 @@
+#pragma once
+#include <QPointF>
+#include <QVector>
+#include <QtNumeric>
+#include <vector>
+
+// Pixel-space polyline in float32, stored relative to `origin` (the axis
+// rect's top-left corner): offsets stay within a few thousand pixels of zero,
+// where float32 still resolves well below a pixel, at half the footprint of
+// QPointF. NaN pairs mark gaps, as in the QPointF lines.
+//
+// Owned by a plottable across frames: the lines are rebuilt in place and
+// clear() keeps the capacity, so a rebuild of similar size allocates nothing.
+struct QCPPixelLine
+{
+    std::vector<float> xy; // x0, y0, x1, y1, ... relative to origin
+    QPointF origin;
+
+    qsizetype size() const { return static_cast<qsizetype>(xy.size() / 2); }
+    bool isEmpty() const { return xy.empty(); }
+    void clear() { xy.clear(); }
+    void reserve(qsizetype points) { xy.reserve(static_cast<std::size_t>(points) * 2); }
+    quint64 capacityBytes() const { return xy.capacity() * sizeof(float); }
+
+    // Absolute pixel position; a NaN point appends a gap.
+    void append(const QPointF& p)
+    {
+        xy.push_back(static_cast<float>(p.x() - origin.x()));
+        xy.push_back(static_cast<float>(p.y() - origin.y()));
+    }
+
+    // Absolute pixel position of point i.
+    QPointF operator[](qsizetype i) const
+    {
+        return {origin.x() + xy[2 * i], origin.y() + xy[2 * i + 1]};
+    }
+
+    // Double-precision copy, for the paths that take QPointF lines.
+    QVector<QPointF> toPointF() const
+    {
+        QVector<QPointF> pts;
+        pts.reserve(size());
+        for (qsizetype i = 0; i < size(); ++i)
+            pts.append((*this)[i]);
+        return pts;
+    }
+
+    // NaN gaps compare equal to each other.
+    bool operator==(const QCPPixelLine& other) const
+    {
+        if (origin != other.origin || xy.size() != other.xy.size())
+            return false;
+        for (std::size_t i = 0; i < xy.size(); ++i)
+        {
+            if (xy[i] != other.xy[i] && !(qIsNaN(xy[i]) && qIsNaN(other.xy[i])))
+                return false;
+        }
+        return true;
+    }
+    bool operator!=(const QCPPixelLine& other) const { return !(*this == other); }
+};
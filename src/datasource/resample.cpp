@@ -1,16 +1,17 @@
 #include "resample.h"
 #include "abstract-datasource-2d.h"
 #include "Profiling.hpp"
-#include "graph-resampler.h" // qcp::algo::innerPool(), innerThreadCount()
+#include "graph-resampler.h" // qcp::algo::innerThreadCount()
+#include "pipeline-stats.h"
+#include "work-executor.h"
 #include <axis/range.h>
 #include <plottables/plottable-colormap.h> // for QCPColorMapData
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <limits>
+#include <type_traits>
 #include <vector>
-#include <QAtomicInt>
-#include <QSemaphore>
-#include <QThread>
 
 namespace qcp::algo2d {
 
@@ -59,13 +60,14 @@ std::vector<double> generateBinEdges(const std::vector<double>& centers)
     return edges;
 }
 
-int lowerBoundRaw(const double* x, int begin, int end, double value)
+template <typename X>
+qsizetype lowerBoundRaw(const X* x, qsizetype begin, qsizetype end, double value)
 {
-    int lo = begin, hi = end;
+    qsizetype lo = begin, hi = end;
     while (lo < hi)
     {
-        int mid = lo + (hi - lo) / 2;
-        if (x[mid] < value)
+        qsizetype mid = lo + (hi - lo) / 2;
+        if (static_cast<double>(x[mid]) < value)
             lo = mid + 1;
         else
             hi = mid;
@@ -73,12 +75,12 @@ int lowerBoundRaw(const double* x, int begin, int end, double value)
     return lo;
 }
 
-int lowerBoundVirtual(const QCPAbstractDataSource2D& src, int begin, int end, double value)
+qsizetype lowerBoundVirtual(const QCPAbstractDataSource2D& src, qsizetype begin, qsizetype end, double value)
 {
-    int lo = begin, hi = end;
+    qsizetype lo = begin, hi = end;
     while (lo < hi)
     {
-        int mid = lo + (hi - lo) / 2;
+        qsizetype mid = lo + (hi - lo) / 2;
         if (src.xAt(mid) < value)
             lo = mid + 1;
         else
@@ -110,19 +112,24 @@ int findBinFloor(double value, const std::vector<double>& axis)
 }
 
 // Accessors that use raw pointers when available, virtual calls otherwise.
+// RawAccessor reads the arrays in their native element types.
+template <typename X, typename Y, typename Z>
 struct RawAccessor
 {
-    const double* x;
-    const double* y;
-    const double* z;
+    const X* x;
+    const Y* y;
+    const Z* z;
     int ys;
     bool yIs2D;
 
-    double xAt(int i) const { return x[i]; }
-    double yAt(int i, int j) const { return yIs2D ? y[i * ys + j] : y[j]; }
-    double zAt(int i, int j) const { return z[i * ys + j]; }
+    double xAt(qsizetype i) const { return static_cast<double>(x[i]); }
+    double yAt(qsizetype i, int j) const
+    {
+        return static_cast<double>(yIs2D ? y[i * ys + j] : y[j]);
+    }
+    double zAt(qsizetype i, int j) const { return static_cast<double>(z[i * ys + j]); }
 
-    int lowerBound(int begin, int end, double value) const
+    qsizetype lowerBound(qsizetype begin, qsizetype end, double value) const
     {
         return lowerBoundRaw(x, begin, end, value);
     }
@@ -134,16 +141,26 @@ struct VirtualAccessor
     int ys;
     bool yIs2D;
 
-    double xAt(int i) const { return src.xAt(i); }
-    double yAt(int i, int j) const { return src.yAt(i, j); }
-    double zAt(int i, int j) const { return src.zAt(i, j); }
+    double xAt(qsizetype i) const { return src.xAt(i); }
+    double yAt(qsizetype i, int j) const { return src.yAt(i, j); }
+    double zAt(qsizetype i, int j) const { return src.zAt(i, j); }
 
-    int lowerBound(int begin, int end, double value) const
+    qsizetype lowerBound(qsizetype begin, qsizetype end, double value) const
     {
         return lowerBoundVirtual(src, begin, end, value);
     }
 };
 
+// Calls f(const T*) for the first of Ts matching the array's element type;
+// returns what f returned, or false when no T matches.
+template <typename... Ts, typename F>
+bool visitRawArray(const QCPRawArray& a, F&& f)
+{
+    if (a.isNull())
+        return false;
+    return ((a.type == QCPRawArray::typeOf<Ts>() && f(static_cast<const Ts*>(a.data))) || ...);
+}
+
 struct BinRange { int lo, hi; };
 
 // Processes target bins [xbBegin, xbEnd) only, writing into the shared
@@ -152,20 +169,22 @@ struct BinRange { int lo, hi; };
 // safe to call from multiple threads concurrently with no locking, as long
 // as each thread owns a non-overlapping [xbBegin, xbEnd) partition -- each
 // worker seeds its own local srcCursor and yBinRanges rather than sharing
-// the sequential-scan state the single-chunk case relies on.
+// the sequential-scan state the single-chunk case relies on. Polls `cancel`
+// once per target column and leaves the remaining ones unfilled.
 template <typename Accessor>
 void resampleRange(
     const Accessor& acc,
     int xbBegin, int xbEnd,
-    int xBegin, int xEnd, int ctxBegin, int ctxCount,
+    qsizetype xBegin, qsizetype xEnd, qsizetype ctxBegin, qsizetype ctxCount,
     const std::vector<double>& xAxis, const std::vector<double>& xEdges,
     const std::vector<bool>& gapBetween,
     const std::vector<double>& yAxis,
     int ny, int ys,
     bool yLogScale, bool variableY,
-    double* accum, uint32_t* counts)
+    double* accum, uint32_t* counts,
+    const QCPCancellationToken& cancel)
 {
-    auto computeYBinRanges = [&](int col, std::vector<BinRange>& ranges) {
+    auto computeYBinRanges = [&](qsizetype col, std::vector<BinRange>& ranges) {
         for (int yj = 0; yj < ys; ++yj)
         {
             double yVal = acc.yAt(col, yj);
@@ -204,22 +223,22 @@ void resampleRange(
     // as the single-threaded scan); for any other chunk, a binary search at
     // the chunk's first bin edge (mirrors qcp::algo::binMinMaxParallel's
     // per-chunk findBegin seeding).
-    int srcCursor = (xbBegin == 0) ? xBegin : acc.lowerBound(xBegin, xEnd, xEdges[xbBegin]);
+    qsizetype srcCursor = (xbBegin == 0) ? xBegin : acc.lowerBound(xBegin, xEnd, xEdges[xbBegin]);
 
-    for (int xb = xbBegin; xb < xbEnd; ++xb)
+    for (int xb = xbBegin; xb < xbEnd && !cancel.isCancelled(); ++xb)
     {
         double binLo = xEdges[xb];
         double binHi = xEdges[xb + 1];
 
-        int colBegin = acc.lowerBound(srcCursor, xEnd, binLo);
+        qsizetype colBegin = acc.lowerBound(srcCursor, xEnd, binLo);
         if (colBegin > xBegin) --colBegin;
 
-        int colEnd = acc.lowerBound(colBegin, xEnd, binHi);
+        qsizetype colEnd = acc.lowerBound(colBegin, xEnd, binHi);
         if (colEnd < xEnd) ++colEnd;
 
-        for (int xi = colBegin; xi < colEnd; ++xi)
+        for (qsizetype xi = colBegin; xi < colEnd; ++xi)
         {
-            int ci = xi - ctxBegin;
+            qsizetype ci = xi - ctxBegin;
             double xVal = acc.xAt(xi);
 
             bool gapLeft = (ci > 0) && gapBetween[ci - 1];
@@ -284,10 +303,11 @@ void resampleRange(
     }
 }
 
+// Returns false (output not written) once `cancel` fires.
 template <typename Accessor>
-void resampleImpl(
+bool resampleImpl(
     const Accessor& acc,
-    int xBegin, int xEnd, int ctxBegin, int ctxEnd,
+    qsizetype xBegin, qsizetype xEnd, qsizetype ctxBegin, qsizetype ctxEnd,
     const std::vector<double>& xAxis, const std::vector<double>& yAxis,
     const std::vector<double>& xEdges,
     int nx, int ny, int ys,
@@ -295,9 +315,10 @@ void resampleImpl(
     double gapThreshold,
     double* outData,
     ResampleCache* cache,
-    bool forceSerial)
+    bool forceSerial,
+    const QCPCancellationToken& cancel)
 {
-    int ctxCount = ctxEnd - ctxBegin;
+    qsizetype ctxCount = ctxEnd - ctxBegin;
 
     std::vector<bool> localGapBetween;
     std::vector<bool>& gapBetween = cache ? cache->gapBetween : localGapBetween;
@@ -306,7 +327,7 @@ void resampleImpl(
     // Gap detection
     if (gapThreshold > 0 && ctxCount > 2)
     {
-        for (int i = 0; i < ctxCount - 1; ++i)
+        for (qsizetype i = 0; i < ctxCount - 1; ++i)
         {
             double dx = acc.xAt(ctxBegin + i + 1) - acc.xAt(ctxBegin + i);
             double refDx = std::numeric_limits<double>::max();
@@ -331,7 +352,7 @@ void resampleImpl(
     auto worker = [&](int xbBegin, int xbEnd) {
         resampleRange(acc, xbBegin, xbEnd, xBegin, xEnd, ctxBegin, ctxCount,
                       xAxis, xEdges, gapBetween, yAxis, ny, ys, yLogScale, variableY,
-                      accum.data(), counts.data());
+                      accum.data(), counts.data(), cancel);
     };
 
     // Parallelize by target-bin range: each thread's writes land in disjoint
@@ -343,33 +364,29 @@ void resampleImpl(
     int threadCount = forceSerial ? 1 : qcp::algo::innerThreadCount();
     threadCount = std::min(threadCount, nx);
     // Splits [0, count) into `threadCount` contiguous chunks and runs `body`
-    // on each -- threadCount-1 chunks on the pool, the last on the calling
-    // thread. Only used once the job is large enough to amortize dispatch.
+    // on each -- threadCount-1 chunks forked, the last on the calling thread.
+    // Only used once the job is large enough to amortize dispatch.
     auto dispatchParallel = [](int count, int threadCount, auto&& body) {
         int perChunk = count / threadCount;
-        QAtomicInt remaining(threadCount - 1);
-        QSemaphore done;
+        QCPTaskGroup group;
         for (int t = 0; t < threadCount; ++t)
         {
             int begin = t * perChunk;
             int end = (t == threadCount - 1) ? count : (t + 1) * perChunk;
             if (t < threadCount - 1)
-                qcp::algo::innerPool().start([&, begin, end] {
-                    body(begin, end);
-                    if (remaining.fetchAndSubRelaxed(1) == 1)
-                        done.release();
-                });
+                group.run([&, begin, end] { body(begin, end); });
             else
                 body(begin, end); // current thread does the last chunk
         }
-        if (remaining.loadRelaxed() > 0)
-            done.acquire();
+        group.wait();
     };
 
     if (threadCount <= 1 || cellBudget < 1'000'000)
         worker(0, nx);
     else
         dispatchParallel(nx, threadCount, worker);
+    if (cancel.isCancelled())
+        return false;
 
     // Write directly to output array (layout: valueIndex * keySize + keyIndex).
     // O(nx*ny) -- independent of source size, so gate on the output grid
@@ -392,22 +409,24 @@ void resampleImpl(
         writeOutput(0, nx);
     else
         dispatchParallel(nx, threadCount, writeOutput);
+    return true;
 }
 
 } // anonymous namespace
 
 QCPColorMapData* resample(
     const QCPAbstractDataSource2D& src,
-    int xBegin, int xEnd,
+    qsizetype xBegin, qsizetype xEnd,
     const QCPRange& xRange, const QCPRange& yRange,
     int targetWidth, int targetHeight,
     bool yLogScale,
     double gapThreshold,
     ResampleCache* cache,
-    bool forceSerial)
+    bool forceSerial,
+    const QCPCancellationToken& cancel)
 {
     PROFILE_HERE_N("resample");
-    int srcCount = xEnd - xBegin;
+    qsizetype srcCount = xEnd - xBegin;
     if (srcCount < 2 || targetWidth < 1 || targetHeight < 1)
         return nullptr;
     if (xRange.lower >= xRange.upper || yRange.lower >= yRange.upper)
@@ -449,32 +468,123 @@ QCPColorMapData* resample(
         return nullptr;
     }
 
-    int ctxBegin = std::max(0, xBegin - 1);
-    int ctxEnd = std::min(src.xSize(), xEnd + 1);
+    qsizetype ctxBegin = std::max<qsizetype>(0, xBegin - 1);
+    qsizetype ctxEnd = std::min(src.xSize(), xEnd + 1);
 
     auto xEdges = generateBinEdges(xAxis);
 
-    const double* rawX = src.rawX();
-    const double* rawY = src.rawY();
-    const double* rawZ = src.rawZ();
+    bool completed = false;
+    // Bytes are counted per column read: one x, ys cells and, for 2-D y, ys
+    // y values, at the storage widths the accessor reads.
+    auto run = [&](const auto& acc, std::size_t xBytes, std::size_t yBytes, std::size_t zBytes) {
+        completed = resampleImpl(acc, xBegin, xEnd, ctxBegin, ctxEnd,
+                                 xAxis, yAxis, xEdges, nx, ny, ys, yLogScale, variableY,
+                                 gapThreshold, data->rawData(), cache, forceSerial, cancel);
+        const std::size_t columnBytes = xBytes + ys * (zBytes + (variableY ? yBytes : 0));
+        qcp::countScannedBytes(quint64(ctxEnd - ctxBegin) * columnBytes
+                               + (variableY ? 0 : quint64(ys) * yBytes));
+        return true;
+    };
 
-    if (rawX && rawY && rawZ)
+    // One dispatch per job over the supported storage types (double keys;
+    // double/float axes; double, float32 and 16-bit integer cells), each an
+    // instantiation of the raw loop. Anything else goes through the virtuals.
+    const QCPRawArray rawY = src.rawY();
+    const QCPRawArray rawZ = src.rawZ();
+    const bool raw = visitRawArray<double>(src.rawX(), [&](const auto* x) {
+        return visitRawArray<double, float>(rawY, [&](const auto* y) {
+            return visitRawArray<double, float, std::uint16_t, std::int16_t>(rawZ, [&](const auto* z) {
+                using X = std::remove_cvref_t<decltype(*x)>;
+                using Y = std::remove_cvref_t<decltype(*y)>;
+                using Z = std::remove_cvref_t<decltype(*z)>;
+                return run(RawAccessor<X, Y, Z>{x, y, z, ys, variableY},
+                           sizeof(X), sizeof(Y), sizeof(Z));
+            });
+        });
+    });
+    if (!raw)
+        run(VirtualAccessor{src, ys, variableY}, sizeof(double), sizeof(double),
+            sizeof(double));
+    if (!completed)
     {
-        RawAccessor acc{rawX, rawY, rawZ, ys, variableY};
-        resampleImpl(acc, xBegin, xEnd, ctxBegin, ctxEnd,
-                     xAxis, yAxis, xEdges, nx, ny, ys,
-                     yLogScale, variableY, gapThreshold, data->rawData(), cache, forceSerial);
-    }
-    else
-    {
-        VirtualAccessor acc{src, ys, variableY};
-        resampleImpl(acc, xBegin, xEnd, ctxBegin, ctxEnd,
-                     xAxis, yAxis, xEdges, nx, ny, ys,
-                     yLogScale, variableY, gapThreshold, data->rawData(), cache, forceSerial);
+        delete data;
+        return nullptr;
     }
 
     data->recalculateDataBounds();
     return data;
 }
 
+namespace {
+
+// Every `stride`-th column of `src`, starting at column `first`.
+class StridedColumns : public QCPAbstractDataSource2D
+{
+public:
+    StridedColumns(const QCPAbstractDataSource2D& src, qsizetype first, qsizetype stride)
+        : mSrc(src), mFirst(first), mStride(stride)
+        , mSize((src.xSize() - first + stride - 1) / stride)
+    {
+    }
+
+    qsizetype xSize() const override { return mSize; }
+    int ySize() const override { return mSrc.ySize(); }
+    bool yIs2D() const override { return mSrc.yIs2D(); }
+
+    double xAt(qsizetype i) const override { return mSrc.xAt(column(i)); }
+    double yAt(qsizetype i, int j) const override { return mSrc.yAt(column(i), j); }
+    double zAt(qsizetype i, int j) const override { return mSrc.zAt(column(i), j); }
+
+    QCPRange xRange(bool& found, QCP::SignDomain sd) const override { return mSrc.xRange(found, sd); }
+    QCPRange yRange(bool& found, QCP::SignDomain sd) const override { return mSrc.yRange(found, sd); }
+    QCPRange zRange(bool& found, qsizetype xBegin, qsizetype xEnd) const override
+    {
+        if (xEnd < 0)
+            xEnd = mSize;
+        return mSrc.zRange(found, column(xBegin), xEnd > xBegin ? column(xEnd - 1) + 1 : column(xBegin));
+    }
+
+    qsizetype findXBegin(double sortKey) const override { return fromColumn(mSrc.findXBegin(sortKey)); }
+    qsizetype findXEnd(double sortKey) const override { return fromColumn(mSrc.findXEnd(sortKey)); }
+
+    // First view index at or after source column `c`.
+    qsizetype fromColumn(qsizetype c) const
+    {
+        return std::clamp<qsizetype>((c - mFirst + mStride - 1) / mStride, 0, mSize);
+    }
+
+private:
+    qsizetype column(qsizetype i) const { return mFirst + i * mStride; }
+
+    const QCPAbstractDataSource2D& mSrc;
+    qsizetype mFirst;
+    qsizetype mStride;
+    qsizetype mSize;
+};
+
+} // namespace
+
+QCPColorMapData* resamplePreview(
+    const QCPAbstractDataSource2D& src,
+    qsizetype xBegin, qsizetype xEnd,
+    const QCPRange& xRange, const QCPRange& yRange,
+    int targetWidth, int targetHeight,
+    bool yLogScale,
+    double gapThreshold,
+    const QCPCancellationToken& cancel)
+{
+    PROFILE_HERE_N("resamplePreview");
+    const qsizetype maxColumns = std::max<qsizetype>(2, qsizetype(targetWidth) * kPreviewColumnsPerBin);
+    const qsizetype stride = std::max<qsizetype>(1, (xEnd - xBegin + maxColumns - 1) / maxColumns);
+    if (stride == 1)
+        return resample(src, xBegin, xEnd, xRange, yRange, targetWidth, targetHeight,
+                        yLogScale, gapThreshold, nullptr, false, cancel);
+
+    // Aligned so xBegin is a view column and the columns around the visible
+    // range stay available as context.
+    const StridedColumns view(src, xBegin % stride, stride);
+    return resample(view, view.fromColumn(xBegin), view.fromColumn(xEnd), xRange, yRange,
+                    targetWidth, targetHeight, yLogScale, gapThreshold, nullptr, false, cancel);
+}
+
 } // namespace qcp::algo2d
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "cancellation-token.h"
+#include <QtGlobal>
 #include <cstdint>
 #include <vector>
 
@@ -23,6 +25,12 @@ struct ResampleCache
     std::vector<double> accum;
     std::vector<uint32_t> counts;
     std::vector<bool> gapBetween;
+
+    quint64 memoryBytes() const
+    {
+        return (yAxis.capacity() + accum.capacity()) * sizeof(double)
+            + counts.capacity() * sizeof(uint32_t) + gapBetween.capacity() / 8;
+    }
 };
 
 // Core resampling algorithm.
@@ -37,15 +45,34 @@ struct ResampleCache
 // job is large enough to amortize dispatch cost; each thread's writes land
 // in disjoint output slices, so no locking is needed. forceSerial is a
 // test-only knob to get a single-threaded reference for correctness
-// comparisons; production callers should leave it false.
+// comparisons; production callers should leave it false. Returns nullptr once
+// `cancel` fires (polled once per target column).
 QCPColorMapData* resample(
     const QCPAbstractDataSource2D& src,
-    int xBegin, int xEnd,
+    qsizetype xBegin, qsizetype xEnd,
     const QCPRange& xRange, const QCPRange& yRange,
     int targetWidth, int targetHeight,
     bool yLogScale,
     double gapThreshold,
     ResampleCache* cache = nullptr,
-    bool forceSerial = false);
+    bool forceSerial = false,
+    const QCPCancellationToken& cancel = {});
+
+// Source columns read per target column by resamplePreview.
+constexpr int kPreviewColumnsPerBin = 2;
+
+// Quick, coarse resample for showing something while the full one runs: the
+// accumulation cost is O(visible source cells), so besides taking a small
+// target grid this reads only every k-th source column, k chosen to keep
+// about kPreviewColumnsPerBin columns per target column. Same contract as
+// resample() otherwise; no cache.
+QCPColorMapData* resamplePreview(
+    const QCPAbstractDataSource2D& src,
+    qsizetype xBegin, qsizetype xEnd,
+    const QCPRange& xRange, const QCPRange& yRange,
+    int targetWidth, int targetHeight,
+    bool yLogScale,
+    double gapThreshold,
+    const QCPCancellationToken& cancel = {});
 
 } // namespace qcp::algo2d
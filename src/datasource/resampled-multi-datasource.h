@@ -12,11 +12,11 @@ public:
         : mBins(std::move(bins)) {}
 
     int columnCount() const override { return mBins.numColumns; }
-    int size() const override { return static_cast<int>(mBins.keys.size()); }
+    qsizetype size() const override { return static_cast<qsizetype>(mBins.keys.size()); }
 
-    double keyAt(int i) const override { return mBins.keys[i]; }
+    double keyAt(qsizetype i) const override { return mBins.keys[i]; }
 
-    double valueAt(int column, int i) const override
+    double valueAt(int column, qsizetype i) const override
     {
         return mBins.values[column * mBins.stride() + i];
     }
@@ -49,29 +49,29 @@ public:
         return found ? QCPRange(lo, hi) : QCPRange();
     }
 
-    int findBegin(double sortKey, bool expandedRange = true) const override
+    qsizetype findBegin(double sortKey, bool expandedRange = true) const override
     {
         return qcp::algo::findBegin(mBins.keys, sortKey, expandedRange);
     }
 
-    int findEnd(double sortKey, bool expandedRange = true) const override
+    qsizetype findEnd(double sortKey, bool expandedRange = true) const override
     {
         return qcp::algo::findEnd(mBins.keys, sortKey, expandedRange);
     }
 
-    QVector<QPointF> getOptimizedLineData(int column, int begin, int end, int /*pixelWidth*/,
+    QVector<QPointF> getOptimizedLineData(int column, qsizetype begin, qsizetype end, int /*pixelWidth*/,
                                            QCPAxis* keyAxis, QCPAxis* valueAxis) const override
     {
         return getLines(column, begin, end, keyAxis, valueAxis);
     }
 
-    QVector<QPointF> getLines(int column, int begin, int end,
+    QVector<QPointF> getLines(int column, qsizetype begin, qsizetype end,
                                QCPAxis* keyAxis, QCPAxis* valueAxis) const override
     {
         if (column < 0 || column >= mBins.numColumns) return {};
         int s = mBins.stride();
         const bool keyIsVertical = keyAxis->orientation() == Qt::Vertical;
-        const int count = end - begin;
+        const qsizetype count = end - begin;
         ensureGapCache(begin, end);
         const auto nanPt = QPointF(qQNaN(), qQNaN());
         const auto keyTf = qcp::algo::AffineTransform::fromAxis(keyAxis);
@@ -80,7 +80,7 @@ public:
 
         QVector<QPointF> lines;
         lines.reserve(count + count / 10);
-        for (int i = begin; i < end; ++i)
+        for (qsizetype i = begin; i < end; ++i)
         {
             if (mGapCache.gaps.hasAnyGap && mGapCache.gaps[i - begin])
                 lines.append(nanPt);
@@ -103,14 +103,14 @@ public:
         return lines;
     }
 
-    void getOptimizedLineDataAll(int begin, int end, int /*pixelWidth*/,
+    void getOptimizedLineDataAll(qsizetype begin, qsizetype end, int /*pixelWidth*/,
                                   QCPAxis* keyAxis, QCPAxis* valueAxis,
                                   QVector<QPointF>* results, int numColumns) const override
     {
         getLinesAll(begin, end, keyAxis, valueAxis, results, numColumns);
     }
 
-    void getLinesAll(int begin, int end,
+    void getLinesAll(qsizetype begin, qsizetype end,
                      QCPAxis* keyAxis, QCPAxis* valueAxis,
                      QVector<QPointF>* results, int numColumns) const override
     {
@@ -118,7 +118,7 @@ public:
         const int N = std::min(numColumns, mBins.numColumns);
         const int s = mBins.stride();
         const bool keyIsVertical = keyAxis->orientation() == Qt::Vertical;
-        const int count = end - begin;
+        const qsizetype count = end - begin;
         const auto nanPt = QPointF(qQNaN(), qQNaN());
         const auto keyTf = qcp::algo::AffineTransform::fromAxis(keyAxis);
         const auto valTf = qcp::algo::AffineTransform::fromAxis(valueAxis);
@@ -126,7 +126,7 @@ public:
 
         for (int c = 0; c < N; ++c) { results[c].clear(); results[c].reserve(count + count / 10); }
 
-        for (int i = begin; i < end; ++i)
+        for (qsizetype i = begin; i < end; ++i)
         {
             bool isGap = mGapCache.gaps.hasAnyGap && mGapCache.gaps[i - begin];
             double k = mBins.keys[i];
@@ -151,7 +151,7 @@ public:
     }
 
 private:
-    void ensureGapCache(int begin, int end) const
+    void ensureGapCache(qsizetype begin, qsizetype end) const
     {
         if (mGapCache.begin != begin || mGapCache.end != end)
         {
@@ -162,24 +162,28 @@ private:
     }
 
     qcp::algo::MultiColumnBinResult mBins;
-    mutable struct { int begin = -1; int end = -1; qcp::algo::GapVector gaps; } mGapCache;
+    mutable struct { qsizetype begin = -1; qsizetype end = -1; qcp::algo::GapVector gaps; } mGapCache;
 };
 
 namespace qcp::algo {
 
+// On a log key axis the L2 bins are uniform in log10(key). The multi-column
+// L1 is a single linear grid, so at the low-key end of a wide log view the
+// output is limited to L1 resolution.
 inline std::shared_ptr<QCPResampledMultiDataSource> resampleL2Multi(
     const MultiGraphResamplerCache& l1Cache,
     const ViewportParams& vp)
 {
     PROFILE_HERE_N("resampleL2Multi");
-    if (vp.keyLogScale)
+    const bool keyLog = vp.keyLogScale;
+    if (keyLog && vp.keyRange.lower <= 0)
         return nullptr;
 
     int l2Bins = vp.plotWidthPx * kLevel2PixelMultiplier;
     if (l2Bins <= 0) l2Bins = 3200;
 
     const auto& l1 = l1Cache.level1;
-    int l1Size = static_cast<int>(l1.keys.size());
+    qsizetype l1Size = static_cast<qsizetype>(l1.keys.size());
     if (l1Size == 0 || l1.numColumns == 0) return nullptr;
 
     auto [l1Begin, l1End] = l1ViewportBounds(l1.keys, l1Size, vp.keyRange);
@@ -200,6 +204,7 @@ inline std::shared_ptr<QCPResampledMultiDataSource> resampleL2Multi(
     const double halfWidth = binWidth * 0.5;
     const double keyLo = vp.keyRange.lower;
     const double invBinWidth = 1.0 / binWidth;
+    const BinAxis logAxis = keyLog ? BinAxis::make(vp.keyRange, l2Bins, true) : BinAxis{};
     int l2Stride = l2Bins * 2;
 
     l2.values.resize(N * l2Stride);
@@ -220,11 +225,14 @@ inline std::shared_ptr<QCPResampledMultiDataSource> resampleL2Multi(
     std::vector<bool> binHasData(l2Bins, false);
 
     // Single pass over L1 points: compute bin index once, scatter into all columns
-    int l1Count = l1End - l1Begin;
-    for (int i = 0; i < l1Count; ++i)
+    qsizetype l1Count = l1End - l1Begin;
+    for (qsizetype i = 0; i < l1Count; ++i)
     {
         double k = l1.keys[l1Begin + i];
-        int bin = std::clamp(static_cast<int>((k - keyLo) * invBinWidth), 0, l2Bins - 1);
+        if (keyLog && !(k > 0))
+            continue;
+        int bin = keyLog ? logAxis.index(k)
+                         : std::clamp(static_cast<int>((k - keyLo) * invBinWidth), 0, l2Bins - 1);
         int slot = bin * 2;
 
         bool anyValid = false;
@@ -251,10 +259,10 @@ inline std::shared_ptr<QCPResampledMultiDataSource> resampleL2Multi(
     {
         if (!binHasData[b]) continue;
 
-        double binCenter = keyLo + (b + 0.5) * binWidth;
+        double binCenter = keyLog ? logAxis.coord(b + 0.5) : keyLo + (b + 0.5) * binWidth;
         int srcSlot = b * 2;
         l2.keys[outSize] = binCenter;
-        l2.keys[outSize + 1] = binCenter + halfWidth;
+        l2.keys[outSize + 1] = keyLog ? logAxis.coord(b + 1.0) : binCenter + halfWidth;
         for (int c = 0; c < N; ++c)
         {
             double* colOut = l2.values.data() + c * l2Stride;
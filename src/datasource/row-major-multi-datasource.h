@@ -15,7 +15,7 @@ namespace qcp::detail {
 template <typename V>
 class StridedColumnView {
 public:
-    StridedColumnView(const V* base, int count, int stride)
+    StridedColumnView(const V* base, qsizetype count, int stride)
         : mBase(base), mCount(count), mStride(stride) { Q_ASSERT(stride > 0); }
 
     struct Iterator {
@@ -26,7 +26,7 @@ public:
         using reference = const V&;
 
         const V* base = nullptr;
-        int index = 0;
+        qsizetype index = 0;
         int stride = 0;
 
         const V& operator*() const { return base[static_cast<std::ptrdiff_t>(index) * stride]; }
@@ -34,10 +34,10 @@ public:
         Iterator operator++(int) { auto t = *this; ++index; return t; }
         Iterator& operator--() { --index; return *this; }
         Iterator operator--(int) { auto t = *this; --index; return t; }
-        Iterator& operator+=(difference_type n) { index += static_cast<int>(n); return *this; }
-        Iterator& operator-=(difference_type n) { index -= static_cast<int>(n); return *this; }
-        Iterator operator+(difference_type n) const { return {base, index + static_cast<int>(n), stride}; }
-        Iterator operator-(difference_type n) const { return {base, index - static_cast<int>(n), stride}; }
+        Iterator& operator+=(difference_type n) { index += static_cast<qsizetype>(n); return *this; }
+        Iterator& operator-=(difference_type n) { index -= static_cast<qsizetype>(n); return *this; }
+        Iterator operator+(difference_type n) const { return {base, index + static_cast<qsizetype>(n), stride}; }
+        Iterator operator-(difference_type n) const { return {base, index - static_cast<qsizetype>(n), stride}; }
         difference_type operator-(const Iterator& o) const { return index - o.index; }
         const V& operator[](difference_type n) const { return base[static_cast<std::ptrdiff_t>(index + n) * stride]; }
         auto operator<=>(const Iterator& o) const { return index <=> o.index; }
@@ -49,12 +49,12 @@ public:
 
     Iterator begin() const { return {mBase, 0, mStride}; }
     Iterator end() const { return {mBase, mCount, mStride}; }
-    int size() const { return mCount; }
-    const V& operator[](int i) const { return mBase[static_cast<std::ptrdiff_t>(i) * mStride]; }
+    qsizetype size() const { return mCount; }
+    const V& operator[](qsizetype i) const { return mBase[static_cast<std::ptrdiff_t>(i) * mStride]; }
 
 private:
     const V* mBase;
-    int mCount;
+    qsizetype mCount;
     int mStride;
 };
 
@@ -72,7 +72,7 @@ public:
     // underlying memory from being freed.
     QCPRowMajorMultiDataSource(std::span<const K> keys,
                                 const V* values,
-                                int rows,
+                                qsizetype rows,
                                 int columns,
                                 int stride,
                                 std::shared_ptr<const void> dataGuard = {})
@@ -82,15 +82,15 @@ public:
         // Shape lies from callers must degrade to an empty source, not become
         // OOB reads (release) or aborts (debug) — this is a public entry point.
         const bool valid = rows > 0 && columns >= 0 && stride > 0 && stride >= columns
-            && static_cast<int>(keys.size()) == rows && values != nullptr;
+            && static_cast<qsizetype>(keys.size()) == rows && values != nullptr;
         if (!valid)
         {
             // Genuinely empty input (rows == 0, no keys) stays silent; any
             // other combination is a shape lie worth a diagnostic.
             if (rows != 0 || !keys.empty())
-                qWarning("QCPRowMajorMultiDataSource: invalid shape (rows=%d, columns=%d, "
+                qWarning("QCPRowMajorMultiDataSource: invalid shape (rows=%lld, columns=%d, "
                          "stride=%d, keys=%zu, values=%p) — dropping data",
-                         rows, columns, stride, keys.size(),
+                         static_cast<long long>(rows), columns, stride, keys.size(),
                          static_cast<const void*>(values));
             mKeys = {};
             mValues = nullptr;
@@ -101,15 +101,15 @@ public:
     }
 
     int columnCount() const override { return mColumns; }
-    int size() const override { return mRows; }
+    qsizetype size() const override { return mRows; }
 
-    double keyAt(int i) const override
+    double keyAt(qsizetype i) const override
     {
         Q_ASSERT(i >= 0 && i < mRows);
         return static_cast<double>(mKeys[i]);
     }
 
-    double valueAt(int column, int i) const override
+    double valueAt(int column, qsizetype i) const override
     {
         Q_ASSERT(column >= 0 && column < mColumns);
         Q_ASSERT(i >= 0 && i < mRows);
@@ -129,17 +129,17 @@ public:
         return qcp::algo::valueRange(mKeys, colView, found, sd, inKeyRange);
     }
 
-    int findBegin(double sortKey, bool expandedRange = true) const override
+    qsizetype findBegin(double sortKey, bool expandedRange = true) const override
     {
         return qcp::algo::findBegin(mKeys, sortKey, expandedRange);
     }
 
-    int findEnd(double sortKey, bool expandedRange = true) const override
+    qsizetype findEnd(double sortKey, bool expandedRange = true) const override
     {
         return qcp::algo::findEnd(mKeys, sortKey, expandedRange);
     }
 
-    QVector<QPointF> getOptimizedLineData(int column, int begin, int end, int pixelWidth,
+    QVector<QPointF> getOptimizedLineData(int column, qsizetype begin, qsizetype end, int pixelWidth,
                                            QCPAxis* keyAxis, QCPAxis* valueAxis) const override
     {
         Q_ASSERT(column >= 0 && column < mColumns);
@@ -149,7 +149,7 @@ public:
                                              keyAxis, valueAxis, &mGapCache.gaps);
     }
 
-    QVector<QPointF> getLines(int column, int begin, int end,
+    QVector<QPointF> getLines(int column, qsizetype begin, qsizetype end,
                                QCPAxis* keyAxis, QCPAxis* valueAxis) const override
     {
         Q_ASSERT(column >= 0 && column < mColumns);
@@ -159,7 +159,7 @@ public:
                                          qcp::algo::kDefaultGapThreshold, &mGapCache.gaps);
     }
 
-    void getOptimizedLineDataAll(int begin, int end, int /*pixelWidth*/,
+    void getOptimizedLineDataAll(qsizetype begin, qsizetype end, int /*pixelWidth*/,
                                   QCPAxis* keyAxis, QCPAxis* valueAxis,
                                   QVector<QPointF>* results, int numColumns) const override
     {
@@ -169,14 +169,19 @@ public:
         const int stride = mStride;
         qcp::algo::optimizedLineDataMulti(
             mKeys, N,
-            [vals, stride](int c, int i) -> double {
+            [vals, stride](int c, qsizetype i) -> double {
                 return static_cast<double>(vals[static_cast<std::ptrdiff_t>(i) * stride + c]);
             },
             begin, end, keyAxis, valueAxis, &mGapCache.gaps, results);
     }
 
+    qsizetype sampleBytes() const override
+    {
+        return qsizetype(sizeof(K)) + qsizetype(mColumns) * qsizetype(sizeof(V));
+    }
+
 private:
-    void ensureGapCache(int begin, int end) const
+    void ensureGapCache(qsizetype begin, qsizetype end) const
     {
         if (mGapCache.begin != begin || mGapCache.end != end)
         {
@@ -188,9 +193,9 @@ private:
 
     std::span<const K> mKeys;
     const V* mValues;
-    int mRows;
+    qsizetype mRows;
     int mColumns;
     int mStride;
     std::shared_ptr<const void> mDataGuard;
-    mutable struct { int begin = -1; int end = -1; qcp::algo::GapVector gaps; } mGapCache;
+    mutable struct { qsizetype begin = -1; qsizetype end = -1; qcp::algo::GapVector gaps; } mGapCache;
 };
@@ -48,19 +48,19 @@ public:
     const YC& y() const { return mY; }
     const ZC& z() const { return mZ; }
 
-    int xSize() const override { return static_cast<int>(std::ranges::size(mX)); }
+    qsizetype xSize() const override { return static_cast<qsizetype>(std::ranges::size(mX)); }
     int ySize() const override { return mYSize; }
     bool yIs2D() const override { return mYIs2D; }
 
-    double xAt(int i) const override { return static_cast<double>(mX[i]); }
+    double xAt(qsizetype i) const override { return static_cast<double>(mX[i]); }
 
-    double yAt(int i, int j) const override
+    double yAt(qsizetype i, int j) const override
     {
         return mYIs2D ? static_cast<double>(mY[i * mYSize + j])
                       : static_cast<double>(mY[j]);
     }
 
-    double zAt(int i, int j) const override
+    double zAt(qsizetype i, int j) const override
     {
         return static_cast<double>(mZ[i * mYSize + j]);
     }
@@ -75,46 +75,35 @@ public:
         return qcp::algo2d::yRange(mY, found, sd);
     }
 
-    QCPRange zRange(bool& found, int xBegin = 0, int xEnd = -1) const override
+    QCPRange zRange(bool& found, qsizetype xBegin = 0, qsizetype xEnd = -1) const override
     {
         return qcp::algo2d::zRange(mZ, mYSize, found, xBegin, xEnd);
     }
 
-    int findXBegin(double sortKey) const override
+    qsizetype findXBegin(double sortKey) const override
     {
         return qcp::algo2d::findXBegin(mX, sortKey);
     }
 
-    int findXEnd(double sortKey) const override
+    qsizetype findXEnd(double sortKey) const override
     {
         return qcp::algo2d::findXEnd(mX, sortKey);
     }
 
-    const double* rawX() const override
-    {
-        if constexpr (std::is_same_v<X, double>)
-            return std::ranges::data(mX);
-        else
-            return nullptr;
-    }
+    QCPRawArray rawX() const override { return rawArray(mX); }
+    QCPRawArray rawY() const override { return rawArray(mY); }
+    QCPRawArray rawZ() const override { return rawArray(mZ); }
 
-    const double* rawY() const override
-    {
-        if constexpr (std::is_same_v<Y, double>)
-            return std::ranges::data(mY);
-        else
-            return nullptr;
-    }
-
-    const double* rawZ() const override
+private:
+    template <typename C>
+    static QCPRawArray rawArray(const C& c)
     {
-        if constexpr (std::is_same_v<Z, double>)
-            return std::ranges::data(mZ);
+        if constexpr (ContiguousNumericRange<C>)
+            return QCPRawArray::of(std::ranges::data(c));
         else
-            return nullptr;
+            return {};
     }
 
-private:
     XC mX;
     YC mY;
     ZC mZ;
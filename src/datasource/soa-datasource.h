@@ -31,18 +31,18 @@ public:
     const KeyContainer& keys() const { return mKeys; }
     const ValueContainer& values() const { return mValues; }
 
-    int size() const override
+    qsizetype size() const override
     {
-        return static_cast<int>(std::ranges::size(mKeys));
+        return static_cast<qsizetype>(std::ranges::size(mKeys));
     }
 
-    double keyAt(int i) const override
+    double keyAt(qsizetype i) const override
     {
         Q_ASSERT(i >= 0 && i < size());
         return static_cast<double>(mKeys[i]);
     }
 
-    double valueAt(int i) const override
+    double valueAt(qsizetype i) const override
     {
         Q_ASSERT(i >= 0 && i < size());
         return static_cast<double>(mValues[i]);
@@ -66,11 +66,11 @@ public:
                               bool valuePositiveOnly = false) const override
     {
         PROFILE_HERE_N("SoA::finiteKeyValueBounds");
-        const int n = static_cast<int>(std::ranges::size(mKeys));
+        const qsizetype n = static_cast<qsizetype>(std::ranges::size(mKeys));
         double kLo = std::numeric_limits<double>::infinity(), kHi = -kLo;
         double vLo = kLo, vHi = -kLo;
         bool any = false;
-        for (int i = 0; i < n; ++i)
+        for (qsizetype i = 0; i < n; ++i)
         {
             const double k = static_cast<double>(mKeys[i]);
             const double v = static_cast<double>(mValues[i]);
@@ -89,17 +89,17 @@ public:
         return true;
     }
 
-    int findBegin(double sortKey, bool expandedRange = true) const override
+    qsizetype findBegin(double sortKey, bool expandedRange = true) const override
     {
         return qcp::algo::findBegin(mKeys, sortKey, expandedRange);
     }
 
-    int findEnd(double sortKey, bool expandedRange = true) const override
+    qsizetype findEnd(double sortKey, bool expandedRange = true) const override
     {
         return qcp::algo::findEnd(mKeys, sortKey, expandedRange);
     }
 
-    QVector<QPointF> getOptimizedLineData(int begin, int end, int pixelWidth,
+    QVector<QPointF> getOptimizedLineData(qsizetype begin, qsizetype end, int pixelWidth,
                                            QCPAxis* keyAxis, QCPAxis* valueAxis) const override
     {
         ensureGapCache(begin, end);
@@ -107,7 +107,7 @@ public:
                                              keyAxis, valueAxis, &mGapCache.gaps);
     }
 
-    QVector<QPointF> getLines(int begin, int end,
+    QVector<QPointF> getLines(qsizetype begin, qsizetype end,
                                QCPAxis* keyAxis, QCPAxis* valueAxis) const override
     {
         ensureGapCache(begin, end);
@@ -115,8 +115,42 @@ public:
                                          qcp::algo::kDefaultGapThreshold, &mGapCache.gaps);
     }
 
+    void getOptimizedPixelLine(qsizetype begin, qsizetype end, int pixelWidth,
+                               QCPAxis* keyAxis, QCPAxis* valueAxis, QCPPixelLine& out) const override
+    {
+        ensureGapCache(begin, end);
+        qcp::algo::optimizedLineDataInto(mKeys, mValues, begin, end, pixelWidth,
+                                         keyAxis, valueAxis, out, &mGapCache.gaps);
+    }
+
+    void getPixelLine(qsizetype begin, qsizetype end,
+                      QCPAxis* keyAxis, QCPAxis* valueAxis, QCPPixelLine& out) const override
+    {
+        ensureGapCache(begin, end);
+        qcp::algo::linesToPixelsInto(mKeys, mValues, begin, end, keyAxis, valueAxis, out,
+                                     qcp::algo::kDefaultGapThreshold, &mGapCache.gaps);
+    }
+
+    void readSamples(qsizetype begin, qsizetype end, double* keys, double* values) const override
+    {
+        for (qsizetype i = begin; i < end; ++i)
+        {
+            keys[i - begin] = static_cast<double>(mKeys[i]);
+            values[i - begin] = static_cast<double>(mValues[i]);
+        }
+    }
+
+    void accumulateMinMax(qsizetype begin, qsizetype end, double keyLo, double binWidth,
+                          double* minMax, int binBegin, int binEnd) const override
+    {
+        qcp::algo::accumulateMinMax(mKeys, mValues, begin, end, keyLo, binWidth,
+                                    minMax, binBegin, binEnd);
+    }
+
+    qsizetype sampleBytes() const override { return qsizetype(sizeof(K) + sizeof(V)); }
+
 private:
-    void ensureGapCache(int begin, int end) const
+    void ensureGapCache(qsizetype begin, qsizetype end) const
     {
         if (mGapCache.begin != begin || mGapCache.end != end)
         {
@@ -129,5 +163,5 @@ private:
     KeyContainer mKeys;
     ValueContainer mValues;
     std::shared_ptr<const void> mDataGuard;
-    mutable struct { int begin = -1; int end = -1; qcp::algo::GapVector gaps; } mGapCache;
+    mutable struct { qsizetype begin = -1; qsizetype end = -1; qcp::algo::GapVector gaps; } mGapCache;
 };
@@ -33,15 +33,15 @@ public:
     }
 
     int columnCount() const override { return static_cast<int>(mValues.size()); }
-    int size() const override { return static_cast<int>(std::ranges::size(mKeys)); }
+    qsizetype size() const override { return static_cast<qsizetype>(std::ranges::size(mKeys)); }
 
-    double keyAt(int i) const override
+    double keyAt(qsizetype i) const override
     {
         Q_ASSERT(i >= 0 && i < size());
         return static_cast<double>(mKeys[i]);
     }
 
-    double valueAt(int column, int i) const override
+    double valueAt(int column, qsizetype i) const override
     {
         Q_ASSERT(column >= 0 && column < columnCount());
         Q_ASSERT(i >= 0 && i < size());
@@ -60,17 +60,17 @@ public:
         return qcp::algo::valueRange(mKeys, mValues[column], found, sd, inKeyRange);
     }
 
-    int findBegin(double sortKey, bool expandedRange = true) const override
+    qsizetype findBegin(double sortKey, bool expandedRange = true) const override
     {
         return qcp::algo::findBegin(mKeys, sortKey, expandedRange);
     }
 
-    int findEnd(double sortKey, bool expandedRange = true) const override
+    qsizetype findEnd(double sortKey, bool expandedRange = true) const override
     {
         return qcp::algo::findEnd(mKeys, sortKey, expandedRange);
     }
 
-    QVector<QPointF> getOptimizedLineData(int column, int begin, int end, int pixelWidth,
+    QVector<QPointF> getOptimizedLineData(int column, qsizetype begin, qsizetype end, int pixelWidth,
                                            QCPAxis* keyAxis, QCPAxis* valueAxis) const override
     {
         Q_ASSERT(column >= 0 && column < columnCount());
@@ -79,7 +79,7 @@ public:
                                              keyAxis, valueAxis, &mGapCache.gaps);
     }
 
-    QVector<QPointF> getLines(int column, int begin, int end,
+    QVector<QPointF> getLines(int column, qsizetype begin, qsizetype end,
                                QCPAxis* keyAxis, QCPAxis* valueAxis) const override
     {
         Q_ASSERT(column >= 0 && column < columnCount());
@@ -88,7 +88,7 @@ public:
                                          qcp::algo::kDefaultGapThreshold, &mGapCache.gaps);
     }
 
-    void getOptimizedLineDataAll(int begin, int end, int /*pixelWidth*/,
+    void getOptimizedLineDataAll(qsizetype begin, qsizetype end, int /*pixelWidth*/,
                                   QCPAxis* keyAxis, QCPAxis* valueAxis,
                                   QVector<QPointF>* results, int numColumns) const override
     {
@@ -96,7 +96,7 @@ public:
         const int N = std::min(numColumns, columnCount());
         qcp::algo::optimizedLineDataMulti(
             mKeys, N,
-            [this](int c, int i) -> double { return static_cast<double>(mValues[c][i]); },
+            [this](int c, qsizetype i) -> double { return static_cast<double>(mValues[c][i]); },
             begin, end, keyAxis, valueAxis, &mGapCache.gaps, results);
     }
 
@@ -118,8 +118,13 @@ public:
         return nullptr;
     }
 
+    qsizetype sampleBytes() const override
+    {
+        return qsizetype(sizeof(K)) + qsizetype(columnCount()) * qsizetype(sizeof(V));
+    }
+
 private:
-    void ensureGapCache(int begin, int end) const
+    void ensureGapCache(qsizetype begin, qsizetype end) const
     {
         if (mGapCache.begin != begin || mGapCache.end != end)
         {
@@ -132,5 +137,5 @@ private:
     KeyContainer mKeys;
     std::vector<ValueContainer> mValues;
     std::shared_ptr<const void> mDataGuard;
-    mutable struct { int begin = -1; int end = -1; qcp::algo::GapVector gaps; } mGapCache;
+    mutable struct { qsizetype begin = -1; qsizetype end = -1; qcp::algo::GapVector gaps; } mGapCache;
 };
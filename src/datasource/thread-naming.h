@@ -7,10 +7,9 @@
 namespace qcp
 {
 
-// QThreadPool gives no per-thread init hook (unlike BS::thread_pool), so
-// pool worker threads name themselves once, the first time they run any
-// task -- makes them show up as e.g. "binWorker" instead of generic
-// "QThread"/"Thread (pooled)" in /proc, `ps -T`, thread_cpu_top.hot_threads().
+// Worker threads name themselves once, when they start -- makes them show up
+// as e.g. "qcpWorker" instead of the process name in /proc, `ps -T`,
+// thread_cpu_top.hot_threads().
 inline void nameThisPoolThreadOnce(const char* name) noexcept
 {
 #ifdef __linux__
@@ -0,0 +1,358 @@
+#include "work-executor.h"
+#include "pipeline-stats.h"
+#include "thread-naming.h"
+#include <QThread>
+#include <algorithm>
+
+namespace {
+
+struct WorkerIdentity {
+    QCPWorkExecutor* executor = nullptr;
+    int index = -1;
+};
+thread_local WorkerIdentity tWorker;
+
+} // namespace
+
+QCPWorkExecutor::QCPWorkExecutor(int workerCount)
+{
+    QMutexLocker lock(&mMutex);
+    addWorkersLocked(std::max(1, workerCount));
+}
+
+QCPWorkExecutor::~QCPWorkExecutor()
+{
+    {
+        QMutexLocker lock(&mMutex);
+        mStopping = true;
+        mWake.wakeAll();
+    }
+    for (auto& worker : mWorkers)
+        worker->thread.join();
+}
+
+QCPWorkExecutor& QCPWorkExecutor::instance()
+{
+    static QCPWorkExecutor executor(std::max(2, QThread::idealThreadCount()));
+    return executor;
+}
+
+QCPWorkExecutor& QCPWorkExecutor::current()
+{
+    return tWorker.executor ? *tWorker.executor : instance();
+}
+
+int QCPWorkExecutor::workerCount() const
+{
+    QMutexLocker lock(&mMutex);
+    return static_cast<int>(mWorkers.size());
+}
+
+void QCPWorkExecutor::addWorkersLocked(int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const int index = static_cast<int>(mWorkers.size());
+        mWorkers.push_back(std::make_unique<Worker>());
+        mWorkers.back()->thread = std::thread([this, index] { workerLoop(index); });
+    }
+}
+
+int QCPWorkExecutor::clampLimitLocked(int maxRunning) const
+{
+    // A limit is a cap on the fixed worker set, never a reason to spawn more
+    // threads: nothing would retire them once the limit drops again.
+    return std::clamp(maxRunning, 1, static_cast<int>(mWorkers.size()));
+}
+
+void QCPWorkExecutor::registerOwner(const void* owner, int maxRunning)
+{
+    QMutexLocker lock(&mMutex);
+    mOwners[owner];
+    lock.unlock();
+    setOwnerLimit(owner, maxRunning);
+}
+
+void QCPWorkExecutor::setOwnerLimit(const void* owner, int maxRunning)
+{
+    QMutexLocker lock(&mMutex);
+    auto it = mOwners.find(owner);
+    if (it == mOwners.end())
+        return;
+    it->second.maxRunning = clampLimitLocked(maxRunning);
+    mWake.wakeAll();
+}
+
+void QCPWorkExecutor::unregisterOwner(const void* owner)
+{
+    QMutexLocker lock(&mMutex);
+    auto it = mOwners.find(owner);
+    if (it == mOwners.end())
+        return;
+    // Queued jobs may belong to objects already gone: drop, don't run them.
+    for (auto& lane : it->second.lanes)
+        lane.clear();
+    while (it->second.running > 0)
+        mWake.wait(&mMutex);
+    mOwners.erase(it);
+}
+
+void QCPWorkExecutor::setOwnerRank(const void* owner, int rank)
+{
+    QMutexLocker lock(&mMutex);
+    auto it = mOwners.find(owner);
+    if (it == mOwners.end() || it->second.rank == rank)
+        return;
+    it->second.rank = rank;
+    mWake.wakeAll();
+}
+
+void QCPWorkExecutor::setOwnerGroup(const void* owner, const void* group)
+{
+    QMutexLocker lock(&mMutex);
+    auto it = mOwners.find(owner);
+    if (it == mOwners.end() || it->second.group == group)
+        return;
+    // Running jobs are accounted to the group the owner is in when they end.
+    if (Group* old = groupOf(it->second))
+        old->running -= it->second.running;
+    it->second.group = group;
+    if (Group* joined = groupOf(it->second))
+        joined->running += it->second.running;
+    mWake.wakeAll();
+}
+
+void QCPWorkExecutor::setGroupLimit(const void* group, int maxRunning)
+{
+    QMutexLocker lock(&mMutex);
+    Group& g = mGroups[group];
+    g.maxRunning = clampLimitLocked(maxRunning);
+    mWake.wakeAll();
+}
+
+int QCPWorkExecutor::groupLimit(const void* group) const
+{
+    QMutexLocker lock(&mMutex);
+    auto it = mGroups.find(group);
+    return it == mGroups.end() ? std::numeric_limits<int>::max() : it->second.maxRunning;
+}
+
+QCPWorkExecutor::Group* QCPWorkExecutor::groupOf(const Owner& owner)
+{
+    if (!owner.group)
+        return nullptr;
+    return &mGroups[owner.group];
+}
+
+bool QCPWorkExecutor::canRun(const Owner& owner) const
+{
+    if (owner.running >= owner.maxRunning)
+        return false;
+    if (!owner.group)
+        return true;
+    auto it = mGroups.find(owner.group);
+    return it == mGroups.end() || it->second.running < it->second.maxRunning;
+}
+
+bool QCPWorkExecutor::submit(const void* owner, Lane lane, std::function<void()> job)
+{
+    QMutexLocker lock(&mMutex);
+    auto it = mOwners.find(owner);
+    if (it == mOwners.end() || mStopping)
+        return false;
+    it->second.lanes[lane].push_back(std::move(job));
+    mWake.wakeAll();
+    return true;
+}
+
+int QCPWorkExecutor::queuedJobs(const void* owner, Lane lane) const
+{
+    QMutexLocker lock(&mMutex);
+    auto it = mOwners.find(owner);
+    return it == mOwners.end() ? 0 : static_cast<int>(it->second.lanes[lane].size());
+}
+
+bool QCPWorkExecutor::takeJob(Lane lane, std::function<void()>& job, const void*& owner)
+{
+    bool any = false;
+    int topRank = std::numeric_limits<int>::min();
+    for (const auto& [key, o] : mOwners)
+    {
+        if (!o.lanes[lane].empty() && canRun(o))
+        {
+            any = true;
+            topRank = std::max(topRank, o.rank);
+        }
+    }
+    if (!any)
+        return false;
+
+    // Round-robin among the top rank: resume after the owner served last in
+    // this lane.
+    auto tryOwner = [&](std::map<const void*, Owner>::iterator it) {
+        Owner& o = it->second;
+        if (o.rank != topRank || o.lanes[lane].empty() || !canRun(o))
+            return false;
+        job = std::move(o.lanes[lane].front());
+        o.lanes[lane].pop_front();
+        ++o.running;
+        if (Group* g = groupOf(o))
+            ++g->running;
+        owner = it->first;
+        mLastServed[lane] = it->first;
+        return true;
+    };
+    const auto start = mOwners.upper_bound(mLastServed[lane]);
+    for (auto it = start; it != mOwners.end(); ++it)
+        if (tryOwner(it))
+            return true;
+    for (auto it = mOwners.begin(); it != start; ++it)
+        if (tryOwner(it))
+            return true;
+    return false;
+}
+
+bool QCPWorkExecutor::takeSubtask(int self, bool steal, Subtask& out)
+{
+    if (!steal)
+    {
+        if (self < 0 || mWorkers[self]->subtasks.empty())
+            return false;
+        out = std::move(mWorkers[self]->subtasks.back());
+        mWorkers[self]->subtasks.pop_back();
+        return true;
+    }
+    if (!mInjected.empty())
+    {
+        out = std::move(mInjected.front());
+        mInjected.pop_front();
+        return true;
+    }
+    const int n = static_cast<int>(mWorkers.size());
+    for (int i = 1; i <= n; ++i)
+    {
+        const int victim = (std::max(self, 0) + i) % n;
+        if (victim == self || mWorkers[victim]->subtasks.empty())
+            continue;
+        out = std::move(mWorkers[victim]->subtasks.front());
+        mWorkers[victim]->subtasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void QCPWorkExecutor::runSubtask(QMutexLocker<QMutex>& lock, Subtask& task)
+{
+    lock.unlock();
+    try { task.fn(); } catch (...) { }
+    task.fn = nullptr; // captures die outside the lock
+    lock.relock();
+    if (--task.group->mPending == 0)
+        mWake.wakeAll();
+}
+
+void QCPWorkExecutor::workerLoop(int index)
+{
+    tWorker = {this, index};
+    qcp::nameThisPoolThreadOnce("qcpWorker");
+
+    QMutexLocker lock(&mMutex);
+    while (!mStopping)
+    {
+        // Own subtasks first (their forker waits on them), then new
+        // latency-sensitive jobs, then other workers' subtasks, then heavy
+        // jobs.
+        Subtask task;
+        if (takeSubtask(index, false, task))
+        {
+            runSubtask(lock, task);
+            continue;
+        }
+        std::function<void()> job;
+        const void* owner = nullptr;
+        bool gotJob = takeJob(Fast, job, owner);
+        if (!gotJob)
+        {
+            if (takeSubtask(index, true, task))
+            {
+                runSubtask(lock, task);
+                continue;
+            }
+            gotJob = takeJob(Heavy, job, owner);
+        }
+        if (!gotJob)
+        {
+            mWake.wait(&mMutex);
+            continue;
+        }
+
+        lock.unlock();
+        try { job(); } catch (...) { }
+        job = nullptr;
+        lock.relock();
+        // unregisterOwner() waits for running jobs, so the owner is still here.
+        Owner& o = mOwners.find(owner)->second;
+        --o.running;
+        if (Group* g = groupOf(o))
+            --g->running;
+        mWake.wakeAll();
+    }
+}
+
+void QCPWorkExecutor::fork(QCPTaskGroup* group, std::function<void()> fn)
+{
+    QMutexLocker lock(&mMutex);
+    ++group->mPending;
+    Subtask task{std::move(fn), group};
+    if (tWorker.executor == this)
+        mWorkers[tWorker.index]->subtasks.push_back(std::move(task));
+    else
+        mInjected.push_back(std::move(task));
+    mWake.wakeAll();
+}
+
+void QCPWorkExecutor::join(QCPTaskGroup* group)
+{
+    const int self = tWorker.executor == this ? tWorker.index : -1;
+    QMutexLocker lock(&mMutex);
+    while (group->mPending > 0)
+    {
+        Subtask task;
+        if (takeSubtask(self, false, task) || takeSubtask(self, true, task))
+        {
+            runSubtask(lock, task);
+            continue;
+        }
+        mWake.wait(&mMutex);
+    }
+}
+
+bool QCPWorkExecutor::helpOnce()
+{
+    const int self = tWorker.executor == this ? tWorker.index : -1;
+    QMutexLocker lock(&mMutex);
+    Subtask task;
+    if (!takeSubtask(self, false, task) && !takeSubtask(self, true, task))
+        return false;
+    runSubtask(lock, task);
+    return true;
+}
+
+void QCPTaskGroup::run(std::function<void()> fn)
+{
+    if (!mExecutor)
+        mExecutor = &QCPWorkExecutor::current();
+    // Whoever runs the subtask scans on behalf of the forking job.
+    if (auto* counter = qcp::tScanCounter)
+        fn = [counter, fn = std::move(fn)] {
+            qcp::ScanCounterScope scope(counter);
+            fn();
+        };
+    mExecutor->fork(this, std::move(fn));
+}
+
+void QCPTaskGroup::wait()
+{
+    if (mExecutor)
+        mExecutor->join(this);
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <QMutex>
+#include <QWaitCondition>
+#include <QtGlobal>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class QCPTaskGroup;
+
+// Process-wide executor shared by the outer pipeline jobs of every plot
+// (QCPPipelineScheduler) and by the parallel loops inside them (QCPTaskGroup).
+//
+// Outer jobs are queued per owner (one owner per QCPPipelineScheduler, i.e.
+// per plot) in two priority lanes; a worker serves the Fast lane first and,
+// within a lane, the owners of the highest rank with work, rotating between
+// them. Each owner is capped at its own number of running jobs, and owners
+// may join a group whose members share one cap. Subtasks forked by a running job go to the forking
+// worker's own deque: it pops them LIFO, idle workers steal them FIFO, and a
+// thread waiting on its group executes queued subtasks instead of blocking.
+// One set of idealThreadCount() workers thus serves everything, and a lone
+// heavy job fans out over all of them.
+//
+// Tasks are coarse (a binning chunk, a pipeline job): one mutex guards all
+// queues.
+class QCPWorkExecutor
+{
+public:
+    enum Lane { Fast, Heavy };
+
+    explicit QCPWorkExecutor(int workerCount);
+    ~QCPWorkExecutor();
+
+    // The shared instance, with max(2, idealThreadCount()) workers.
+    static QCPWorkExecutor& instance();
+    // The executor running the calling thread, else instance().
+    static QCPWorkExecutor& current();
+
+    int workerCount() const;
+
+    // Owners must be registered before submitting and unregistered before
+    // they die. maxRunning caps the owner's concurrently running jobs; it is
+    // clamped to workerCount(), which never changes after construction.
+    void registerOwner(const void* owner, int maxRunning);
+    void setOwnerLimit(const void* owner, int maxRunning);
+    // Drops the owner's queued jobs, waits for its running ones, forgets it.
+    void unregisterOwner(const void* owner);
+
+    // Higher ranks are served first; equal ranks round-robin. Default 0.
+    void setOwnerRank(const void* owner, int rank);
+    // Moves the owner into `group` (nullptr: none). A group's members share
+    // its running-job cap, on top of their own; groups without a limit set
+    // are uncapped.
+    void setOwnerGroup(const void* owner, const void* group);
+    void setGroupLimit(const void* group, int maxRunning);
+    int groupLimit(const void* group) const;
+
+    // Queues an outer job; false (job dropped) if the owner isn't registered.
+    bool submit(const void* owner, Lane lane, std::function<void()> job);
+    int queuedJobs(const void* owner, Lane lane) const;
+
+    // Runs one queued subtask of any group on the calling thread; false if
+    // none was queued. Lets a thread blocked on another job's result lend
+    // itself to that job's fan-out instead of idling.
+    bool helpOnce();
+
+private:
+    friend class QCPTaskGroup;
+
+    struct Subtask {
+        std::function<void()> fn;
+        QCPTaskGroup* group = nullptr;
+    };
+    struct Group {
+        int running = 0;
+        int maxRunning = std::numeric_limits<int>::max();
+    };
+    struct Owner {
+        std::deque<std::function<void()>> lanes[2];
+        int running = 0;
+        int maxRunning = 1;
+        int rank = 0;
+        const void* group = nullptr;
+    };
+    struct Worker {
+        std::deque<Subtask> subtasks;
+        std::thread thread;
+    };
+
+    void fork(QCPTaskGroup* group, std::function<void()> fn);
+    void join(QCPTaskGroup* group);
+
+    void addWorkersLocked(int count);
+    int clampLimitLocked(int maxRunning) const;
+    bool canRun(const Owner& owner) const;
+    Group* groupOf(const Owner& owner);
+    void workerLoop(int index);
+    bool takeSubtask(int self, bool steal, Subtask& out);
+    bool takeJob(Lane lane, std::function<void()>& job, const void*& owner);
+    void runSubtask(QMutexLocker<QMutex>& lock, Subtask& task);
+
+    mutable QMutex mMutex;
+    QWaitCondition mWake;
+    std::vector<std::unique_ptr<Worker>> mWorkers;
+    std::deque<Subtask> mInjected; // forked from non-worker threads
+    std::map<const void*, Owner> mOwners;
+    std::map<const void*, Group> mGroups;
+    const void* mLastServed[2] = {nullptr, nullptr};
+    bool mStopping = false;
+};
+
+// Fork/join scope on the executor running the calling thread (else on
+// QCPWorkExecutor::instance()). run() forks a subtask;
+// wait() (also called by the destructor) returns once every forked subtask
+// has finished, helping to execute queued subtasks meanwhile. Subtasks may
+// open nested groups. Exceptions escaping a subtask are swallowed.
+class QCPTaskGroup
+{
+public:
+    QCPTaskGroup() = default;
+    ~QCPTaskGroup() { wait(); }
+    QCPTaskGroup(const QCPTaskGroup&) = delete;
+    QCPTaskGroup& operator=(const QCPTaskGroup&) = delete;
+
+    void run(std::function<void()> fn);
+    void wait();
+
+private:
+    friend class QCPWorkExecutor;
+    QCPWorkExecutor* mExecutor = nullptr;
+    int mPending = 0; // guarded by the executor's mutex
+};
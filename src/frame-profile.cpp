@@ -0,0 +1,49 @@
+#include "frame-profile.h"
+
+#include <algorithm>
+
+namespace {
+
+QString ms(qint64 ns)
+{
+    return QString::number(ns * 1e-6, 'f', 2) + QLatin1String(" ms");
+}
+
+QString byteSize(quint64 bytes)
+{
+    if (bytes >= (quint64(1) << 20))
+        return QString::number(bytes / double(1 << 20), 'f', 1) + QLatin1String(" MiB");
+    if (bytes >= (quint64(1) << 10))
+        return QString::number(bytes / double(1 << 10), 'f', 1) + QLatin1String(" KiB");
+    return QString::number(bytes) + QLatin1String(" B");
+}
+
+} // namespace
+
+QVector<QCPFrameProfile::PlottableTiming> QCPFrameProfile::slowestPlottables(int count) const
+{
+    QVector<PlottableTiming> sorted = plottables;
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const PlottableTiming& a, const PlottableTiming& b) {
+                         return a.drawNs > b.drawNs;
+                     });
+    if (sorted.size() > count)
+        sorted.resize(std::max(0, count));
+    return sorted;
+}
+
+QString QCPFrameProfile::summary(int maxPlottables) const
+{
+    QStringList lines;
+    lines << QStringLiteral("replot %1 (layout %2, %3 layers drawn, %4 skipped)")
+                 .arg(ms(replotNs), ms(layoutNs))
+                 .arg(layers.size())
+                 .arg(layersSkipped);
+    lines << QStringLiteral("render %1, %2 uploaded").arg(ms(renderNs), byteSize(uploadedBytes));
+    for (const PlottableTiming& p : slowestPlottables(maxPlottables))
+    {
+        const QString name = p.name.isEmpty() ? QStringLiteral("(unnamed)") : p.name;
+        lines << QStringLiteral("%1: %2").arg(name, ms(p.drawNs));
+    }
+    return lines.join(QLatin1Char('\n'));
+}
@@ -0,0 +1,47 @@
+#ifndef QCP_FRAME_PROFILE_H
+#define QCP_FRAME_PROFILE_H
+
+#include "global.h"
+#include "plottables/plottable.h"
+
+#include <QPointer>
+#include <QVector>
+
+// Where the time of a frame went, filled in by QCustomPlot while frame
+// profiling is on (QCustomPlot::setFrameProfiling). The replot fields describe
+// the last replot, the render fields the last frame the compositor drew;
+// both are overwritten by the next one. All times are in nanoseconds.
+struct QCP_LIB_DECL QCPFrameProfile
+{
+    struct LayerTiming {
+        QString name;
+        qint64 drawNs = 0;
+    };
+    struct PlottableTiming {
+        QPointer<QCPAbstractPlottable> plottable;
+        QString name;
+        qint64 drawNs = 0;
+    };
+
+    // replot(): total, updateLayout(), and each repainted layer's
+    // drawToPaintBuffer() with the draw() of the plottables on it.
+    qint64 replotNs = 0;
+    qint64 layoutNs = 0;
+    QVector<LayerTiming> layers;
+    QVector<PlottableTiming> plottables;
+    // Dirty layers whose repaint was skipped because the compositor only
+    // shifts their previous texture (QCPLayer::canSkipRepaintForTranslation).
+    int layersSkipped = 0;
+
+    // render(): CPU time recording the frame, and the bytes the GPU plottable,
+    // scatter and colormap layers queued for upload in it.
+    qint64 renderNs = 0;
+    quint64 uploadedBytes = 0;
+
+    // The `count` slowest plottables of the last replot, slowest first.
+    QVector<PlottableTiming> slowestPlottables(int count) const;
+    // A few lines of text for the on-plot HUD (QCustomPlot::setFrameProfileHud).
+    QString summary(int maxPlottables = 3) const;
+};
+
+#endif // QCP_FRAME_PROFILE_H
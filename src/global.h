@@ -219,6 +219,11 @@ enum PlottingHint
     ,
     phCacheLabels = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps,
                           ///< increasing replot performance.
+    ,
+    phGpuLineExtrusion = 0x008 ///< <tt>0x008</tt> lines drawn through the GPU path are extruded
+                               ///< in the vertex shader from the raw points, instead of into
+                               ///< triangles on the CPU. Needs instanced drawing; without it the
+                               ///< CPU extruder is used.
 };
 Q_DECLARE_FLAGS(PlottingHints, PlottingHint)
 
@@ -33,6 +33,8 @@
 #include "items/item.h"
 #include "plottables/plottable.h"
 
+#include <QElapsedTimer>
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPLayer
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -202,23 +204,34 @@ void QCPLayer::setMode(QCPLayer::LayerMode mode)
 void QCPLayer::draw(QCPPainter* painter)
 {
     PROFILE_HERE_N("QCPLayer::draw");
+    // Only set while QCustomPlot::replot draws with frame profiling enabled.
+    QCPFrameProfile* profile = mParentPlot ? mParentPlot->mActiveFrameProfile : nullptr;
     for (QCPLayerable* child : mChildren)
     {
         if (child->realVisibility())
         {
             painter->save();
             painter->setClipRect(child->clipRect().translated(0, -1));
+            auto* plottable = qobject_cast<QCPAbstractPlottable*>(child);
             // Apply busy fade for plottables (suppress during vector export)
-            if (!painter->modes().testFlag(QCPPainter::pmVectorized))
+            if (plottable && !painter->modes().testFlag(QCPPainter::pmVectorized))
             {
-                if (auto* plottable = qobject_cast<QCPAbstractPlottable*>(child))
-                {
-                    if (plottable->visuallyBusy())
-                        painter->setOpacity(plottable->effectiveBusyFadeAlpha());
-                }
+                if (plottable->visuallyBusy())
+                    painter->setOpacity(plottable->effectiveBusyFadeAlpha());
             }
             child->applyDefaultAntialiasingHint(painter);
-            child->draw(painter);
+            // Recency for QCPMemoryBudget's least-recently-drawn eviction.
+            if (plottable && mParentPlot)
+                plottable->mLastDrawTick = mParentPlot->mReplotTick;
+            if (profile && plottable)
+            {
+                QElapsedTimer drawTimer;
+                drawTimer.start();
+                child->draw(painter);
+                profile->plottables.append({plottable, plottable->name(), drawTimer.nsecsElapsed()});
+            }
+            else
+                child->draw(painter);
             painter->restore();
         }
     }
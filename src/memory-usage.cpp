@@ -0,0 +1,175 @@
+#include "memory-usage.h"
+#include "core.h"
+
+#include <algorithm>
+
+namespace {
+
+QString byteSize(quint64 bytes)
+{
+    if (bytes >= (quint64(1) << 30))
+        return QString::number(bytes / double(1 << 30), 'f', 2) + QLatin1String(" GiB");
+    if (bytes >= (quint64(1) << 20))
+        return QString::number(bytes / double(1 << 20), 'f', 1) + QLatin1String(" MiB");
+    if (bytes >= (quint64(1) << 10))
+        return QString::number(bytes / double(1 << 10), 'f', 1) + QLatin1String(" KiB");
+    return QString::number(bytes) + QLatin1String(" B");
+}
+
+} // namespace
+
+void QCPMemoryUsage::addShared(Subsystem subsystem, quint64 n, long holders)
+{
+    const quint64 share = n / quint64(std::max(holders, 1L));
+    bytes[subsystem] += share;
+    if (holders > 1)
+        shared += share;
+}
+
+quint64 QCPMemoryUsage::total() const
+{
+    quint64 sum = 0;
+    for (quint64 b : bytes)
+        sum += b;
+    return sum;
+}
+
+QCPMemoryUsage& QCPMemoryUsage::operator+=(const QCPMemoryUsage& other)
+{
+    for (int i = 0; i < msSubsystemCount; ++i)
+        bytes[i] += other.bytes[i];
+    shared += other.shared;
+    return *this;
+}
+
+QString QCPMemoryUsage::subsystemName(Subsystem subsystem)
+{
+    switch (subsystem)
+    {
+        case msL1Cache: return QStringLiteral("L1 caches");
+        case msResampled: return QStringLiteral("resampled data");
+        case msLineCache: return QStringLiteral("line caches");
+        case msExtrusion: return QStringLiteral("extruded vertices");
+        case msScatter: return QStringLiteral("scatter points");
+        case msColormap: return QStringLiteral("colormap grids");
+        case msGpuBuffers: return QStringLiteral("GPU buffers");
+        case msPaintBuffers: return QStringLiteral("paint buffers");
+        case msLabelCache: return QStringLiteral("label caches");
+        case msSubsystemCount: break;
+    }
+    return {};
+}
+
+QCPMemoryUsage QCPMemoryReport::total() const
+{
+    QCPMemoryUsage sum = plot;
+    for (const PlottableUsage& p : plottables)
+        sum += p.usage;
+    return sum;
+}
+
+QString QCPMemoryReport::summary(int maxPlottables) const
+{
+    const QCPMemoryUsage sum = total();
+    QStringList lines;
+    lines << QStringLiteral("caches %1").arg(byteSize(sum.total()));
+    for (int i = 0; i < QCPMemoryUsage::msSubsystemCount; ++i)
+    {
+        if (sum.bytes[i] == 0)
+            continue;
+        lines << QStringLiteral("  %1: %2")
+                     .arg(QCPMemoryUsage::subsystemName(QCPMemoryUsage::Subsystem(i)),
+                          byteSize(sum.bytes[i]));
+    }
+    QVector<PlottableUsage> sorted = plottables;
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const PlottableUsage& a, const PlottableUsage& b) {
+                         return a.usage.total() > b.usage.total();
+                     });
+    for (int i = 0; i < std::min<qsizetype>(maxPlottables, sorted.size()); ++i)
+    {
+        if (sorted[i].usage.total() == 0)
+            break;
+        const QString name = sorted[i].name.isEmpty() ? QStringLiteral("(unnamed)") : sorted[i].name;
+        lines << QStringLiteral("%1: %2").arg(name, byteSize(sorted[i].usage.total()));
+    }
+    return lines.join(QLatin1Char('\n'));
+}
+
+QCPMemoryBudget& QCPMemoryBudget::instance()
+{
+    static QCPMemoryBudget budget;
+    return budget;
+}
+
+void QCPMemoryBudget::setLimit(quint64 bytes)
+{
+    mLimit = bytes;
+    if (mLimit > 0)
+        enforce();
+}
+
+void QCPMemoryBudget::registerPlot(QCustomPlot* plot)
+{
+    mPlots.append(plot);
+}
+
+void QCPMemoryBudget::unregisterPlot(QCustomPlot* plot)
+{
+    mPlots.removeOne(plot);
+}
+
+quint64 QCPMemoryBudget::enforce()
+{
+    struct Candidate {
+        QCPAbstractPlottable* plottable;
+        quint64 lastDrawTick;
+        quint64 reclaimable;
+        bool shared;
+    };
+    QVector<Candidate> candidates;
+    auto count = [this](QVector<Candidate>* candidates) {
+        quint64 total = 0;
+        for (QCustomPlot* plot : std::as_const(mPlots))
+        {
+            const QCPMemoryReport report = plot->memoryReport();
+            total += report.total().total();
+            if (!candidates)
+                continue;
+            const bool plotHidden = !plot->isVisible() || plot->visibleRegion().isEmpty();
+            for (const QCPMemoryReport::PlottableUsage& p : report.plottables)
+            {
+                if (!p.plottable || p.usage.total() == 0)
+                    continue;
+                if (plotHidden || !p.plottable->realVisibility())
+                    candidates->append({p.plottable, p.plottable->mLastDrawTick,
+                                        p.usage.reclaimable(), p.usage.shared > 0});
+            }
+        }
+        return total;
+    };
+    quint64 total = count(&candidates);
+
+    if (mLimit > 0 && total > mLimit)
+    {
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [](const Candidate& a, const Candidate& b) {
+                             return a.lastDrawTick < b.lastDrawTick;
+                         });
+        for (const Candidate& c : std::as_const(candidates))
+        {
+            if (total <= mLimit)
+                break;
+            c.plottable->releaseCaches();
+            ++mEvictions;
+            // A shared cache is freed by whichever holder lets go last, and the
+            // shares of the others grow meanwhile: count again.
+            if (c.shared)
+                total = count(nullptr);
+            else
+                total -= std::min(total, c.reclaimable);
+        }
+    }
+    mLastTotal = total;
+    return total;
+}
@@ -0,0 +1,107 @@
+#ifndef QCP_MEMORY_USAGE_H
+#define QCP_MEMORY_USAGE_H
+
+#include "global.h"
+#include "plottables/plottable.h"
+
+#include <QPointer>
+#include <QVector>
+
+class QCustomPlot;
+
+// Bytes held by caches, by the subsystem holding them. A cache is anything
+// rebuildable from the data: dropping it costs time, never content. Sizes are
+// allocated capacities; an L1 shared by several graphs is split evenly
+// between them, so per-plottable figures add up to the process total.
+// `shared` is the part of bytes[] that other holders keep alive: releasing
+// it frees nothing until the last of them lets go.
+struct QCP_LIB_DECL QCPMemoryUsage
+{
+    enum Subsystem {
+        msL1Cache,      // L1 min/max pyramids and 2D histogram indexes
+        msResampled,    // viewport resampling results (L2, binned grids)
+        msLineCache,    // pixel-space polylines reused across pans
+        msExtrusion,    // extruded line vertices reused across pans
+        msScatter,      // scatter point staging
+        msColormap,     // colormap scratch grids and images
+        msGpuBuffers,   // RHI layer staging and the GPU buffers it feeds
+        msPaintBuffers, // per-layer paint buffers
+        msLabelCache,   // axis tick label pixmaps
+        msSubsystemCount
+    };
+
+    quint64 bytes[msSubsystemCount] = {};
+    quint64 shared = 0;
+
+    void add(Subsystem subsystem, quint64 n) { bytes[subsystem] += n; }
+    // This holder's share of `n` bytes held by `holders` owners.
+    void addShared(Subsystem subsystem, quint64 n, long holders);
+    quint64 total() const;
+    // What releasing these caches frees right away.
+    quint64 reclaimable() const { return total() - shared; }
+    QCPMemoryUsage& operator+=(const QCPMemoryUsage& other);
+
+    static QString subsystemName(Subsystem subsystem);
+};
+
+// Cache memory of one plot (QCustomPlot::memoryReport): the plot's own paint
+// buffers, GPU layers and label caches, and each plottable's caches.
+struct QCP_LIB_DECL QCPMemoryReport
+{
+    struct PlottableUsage {
+        QPointer<QCPAbstractPlottable> plottable;
+        QString name;
+        QCPMemoryUsage usage;
+    };
+
+    QCPMemoryUsage plot;
+    QVector<PlottableUsage> plottables;
+
+    // Plot and plottables together.
+    QCPMemoryUsage total() const;
+    // One line per non-empty subsystem, then the `maxPlottables` largest plottables.
+    QString summary(int maxPlottables = 5) const;
+};
+
+// Process-wide cap on the cache memory of all QCustomPlot instances.
+//
+// With a limit set, each replot ends by counting the caches of every live
+// plot; past the limit, the plottables not on screen (hidden, or in a plot
+// whose widget is hidden) release their caches, least recently drawn first,
+// until the total is back under it. They rebuild lazily the next time they
+// are drawn. What is on screen is never released, so a budget smaller than the
+// visible set is exceeded rather than thrashed. GUI thread only.
+class QCP_LIB_DECL QCPMemoryBudget
+{
+public:
+    static QCPMemoryBudget& instance();
+
+    // 0 (the default) disables eviction; accounting works either way.
+    void setLimit(quint64 bytes);
+    quint64 limit() const { return mLimit; }
+
+    // Counts every live plot and evicts as described above. Returns the total
+    // after eviction. Called by QCustomPlot::replot when a limit is set.
+    quint64 enforce();
+
+    // Total counted by the last enforce(), and plottables evicted so far.
+    quint64 lastTotal() const { return mLastTotal; }
+    quint64 evictionCount() const { return mEvictions; }
+
+private:
+    QCPMemoryBudget() = default;
+
+    void registerPlot(QCustomPlot* plot);
+    void unregisterPlot(QCustomPlot* plot);
+    quint64 nextTick() { return ++mTick; }
+
+    QVector<QCustomPlot*> mPlots;
+    quint64 mLimit = 0;
+    quint64 mLastTotal = 0;
+    quint64 mEvictions = 0;
+    quint64 mTick = 0;
+
+    friend class QCustomPlot;
+};
+
+#endif // QCP_MEMORY_USAGE_H
@@ -12,6 +12,14 @@ QCPOverlay::QCPOverlay(QCustomPlot* parentPlot)
 
 void QCPOverlay::showMessage(const QString& text, Level level,
                               SizeMode sizeMode, Position position)
+{
+    setMessage(text, level, sizeMode, position);
+    if (mParentPlot)
+        mParentPlot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void QCPOverlay::setMessage(const QString& text, Level level,
+                             SizeMode sizeMode, Position position)
 {
     mText = text;
     mLevel = level;
@@ -19,8 +27,6 @@ void QCPOverlay::showMessage(const QString& text, Level level,
     mPosition = position;
     setVisible(!text.isEmpty());
     emit messageChanged(mText, mLevel);
-    if (mParentPlot)
-        mParentPlot->replot(QCustomPlot::rpQueuedReplot);
 }
 
 void QCPOverlay::clearMessage()
@@ -63,11 +63,16 @@ private:
     qreal mOpacity = 1.0;
     QFont mFont;
 
+    // showMessage() without the queued replot, for QCustomPlot's frame
+    // profile HUD which updates from inside replot().
+    void setMessage(const QString& text, Level level, SizeMode sizeMode, Position position);
     QColor levelColor() const;
     QRect computeRect() const;
     QRect collapseHandleRect() const;
 
     Q_DISABLE_COPY(QCPOverlay)
+
+    friend class QCustomPlot;
 };
 
 #endif // QCP_OVERLAY_H
@@ -7,6 +7,7 @@
 #include <core.h>
 #include <layoutelements/layoutelement-axisrect.h>
 #include <layer.h>
+#include <memory-usage.h>
 #include <Profiling.hpp>
 #include <utility>
 #include <vector>
@@ -150,6 +151,21 @@ const QImage& QCPColormapRenderer::flippedMapImage(Qt::Orientations flips)
     return mFlippedMapImage;
 }
 
+void QCPColormapRenderer::accountMemory(QCPMemoryUsage& usage) const
+{
+    usage.add(QCPMemoryUsage::msColormap, quint64(mMapImage.sizeInBytes()));
+    // Unflipped, the copy shares the map image's pixels.
+    if (mFlippedMapImage.cacheKey() != mMapImage.cacheKey())
+        usage.add(QCPMemoryUsage::msColormap, quint64(mFlippedMapImage.sizeInBytes()));
+    if (mRhiLayer)
+        usage.add(QCPMemoryUsage::msGpuBuffers, mRhiLayer->memoryBytes());
+}
+
+void QCPColormapRenderer::releaseCaches()
+{
+    mFlippedMapImage = QImage();
+}
+
 void QCPColormapRenderer::setContourLines(QVector<float> uvVertices, const QColor& color)
 {
     if (mRhiLayer)
@@ -12,6 +12,7 @@ class QCPColorMapData;
 class QCPColormapRhiLayer;
 class QCPPainter;
 class QCustomPlot;
+struct QCPMemoryUsage;
 
 class QCPColormapRenderer
 {
@@ -48,6 +49,12 @@ public:
     const QImage& mapImage() const { return mMapImage; }
     QImage& mapImage() { return mMapImage; }
 
+    // Memory accounting (the owner's QCPAbstractPlottable::accountMemory):
+    // the colour-mapped images and the GPU layer. releaseCaches drops the
+    // flipped copy, rebuilt by the next draw.
+    void accountMemory(QCPMemoryUsage& usage) const;
+    void releaseCaches();
+
     // Contour lines (UV-space vertices)
     void setContourLines(QVector<float> uvVertices, const QColor& color);
     void clearContour();
@@ -298,6 +298,7 @@ void QCPColormapRhiLayer::uploadResources(QRhiResourceUpdateBatch* updates,
                                             QRhiBuffer* compositeUbo)
 {
     PROFILE_HERE_N("QCPColormapRhiLayer::uploadResources");
+    mUploadedBytes = 0;
     if (mStagingImage.isNull())
         return;
 
@@ -308,6 +309,7 @@ void QCPColormapRhiLayer::uploadResources(QRhiResourceUpdateBatch* updates,
     {
         updates->uploadTexture(mTexture, QRhiTextureUploadDescription(
             QRhiTextureUploadEntry(0, 0, QRhiTextureSubresourceUploadDescription(mStagingImage))));
+        mUploadedBytes += quint64(mStagingImage.sizeInBytes());
         mTextureDirty = false;
     }
 
@@ -328,6 +330,7 @@ void QCPColormapRhiLayer::uploadResources(QRhiResourceUpdateBatch* updates,
                 if (!mLineVbo->create()) { delete mLineVbo; mLineVbo = nullptr; mLineVertexCount = 0; return; }
             }
             updates->updateDynamicBuffer(mLineVbo, 0, byteSize, mContourUvVertices.constData());
+            mUploadedBytes += quint64(byteSize);
         }
         mContourLinesDirty = false;
     }
@@ -346,6 +349,7 @@ void QCPColormapRhiLayer::uploadResources(QRhiResourceUpdateBatch* updates,
         ubo.ndcMax[0] = mNdcX1;
         ubo.ndcMax[1] = mNdcY1;
         updates->updateDynamicBuffer(mLineUbo, 0, sizeof(ubo), &ubo);
+        mUploadedBytes += sizeof(ubo);
         mContourUboDirty = false;
     }
 }
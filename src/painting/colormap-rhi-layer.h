@@ -45,6 +45,16 @@ public:
     // Exposed for tests: true when the next uploadResources() call will
     // actually re-upload the staged image to the GPU texture.
     bool textureUploadPending() const { return mTextureDirty; }
+    // Bytes handed to the update batch by the last uploadResources().
+    quint64 uploadedBytes() const { return mUploadedBytes; }
+    // Contour vertices, and the texture (RGBA8) and vertex buffer uploaded to.
+    // The staged image is left out: it shares the renderer's pixels.
+    quint64 memoryBytes() const
+    {
+        return quint64(mContourUvVertices.capacity()) * sizeof(float)
+            + quint64(mTextureSize.width()) * quint64(mTextureSize.height()) * 4
+            + quint64(mLineVboSize);
+    }
     void clear();
 
 private:
@@ -57,6 +67,7 @@ private:
     QRectF mQuadPixelRect;
     QRect mScissorRect;
     bool mTextureDirty = false;
+    quint64 mUploadedBytes = 0;
     bool mGeometryDirty = false;
 
     // CPU staging — contour lines (UV [0,1] space, 2 floats per vertex)
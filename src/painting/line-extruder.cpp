@@ -1,8 +1,7 @@
 #include "line-extruder.h"
-#include "rhi-utils.h"
 #include "Profiling.hpp"
+#include "datasource/pixel-line.h"
 #include <QtMath>
-#include <array>
 #include <cstring>
 
 namespace QCPLineExtruder
@@ -15,28 +14,37 @@ constexpr float MITER_LIMIT = 4.0f;
 
 // Write cursor: tracks position in a pre-allocated float buffer.
 // All vertex writes go through this — no per-float append() calls.
+// With ArcLength, each vertex also carries the distance along its polyline
+// (dashed pens); otherwise `s` is ignored and never computed.
+template <bool ArcLength>
 struct WriteCursor
 {
+    static constexpr bool kArcLength = ArcLength;
+    static constexpr int kStride = ArcLength ? kDashedFloatsPerVertex : kFloatsPerVertex;
+
     float* data;
     int pos = 0;
 
-    void vertex(float x, float y, const std::array<float, 4>& rgba)
+    void vertex(float x, float y, double s)
     {
         float* p = data + pos;
         p[0] = x;  p[1] = y;
-        p[2] = rgba[0];  p[3] = rgba[1];  p[4] = rgba[2];  p[5] = rgba[3];
-        pos += 6;
+        if constexpr (ArcLength)
+            p[2] = static_cast<float>(s);
+        pos += kStride;
     }
 
-    void quad(QPointF tl, QPointF tr, QPointF br, QPointF bl,
-              const std::array<float, 4>& rgba)
+    void vertex(const QPointF& p, double s) { vertex(p.x(), p.y(), s); }
+
+    // tl/bl at arc length s0, tr/br at s1
+    void quad(QPointF tl, QPointF tr, QPointF br, QPointF bl, double s0, double s1)
     {
-        vertex(tl.x(), tl.y(), rgba);
-        vertex(tr.x(), tr.y(), rgba);
-        vertex(br.x(), br.y(), rgba);
-        vertex(tl.x(), tl.y(), rgba);
-        vertex(br.x(), br.y(), rgba);
-        vertex(bl.x(), bl.y(), rgba);
+        vertex(tl, s0);
+        vertex(tr, s1);
+        vertex(br, s1);
+        vertex(tl, s0);
+        vertex(br, s1);
+        vertex(bl, s0);
     }
 };
 
@@ -72,7 +80,9 @@ struct SegmentData
     int endIdx;
 };
 
-QVector<SegmentData> splitByNonFinite(const QVector<QPointF>& points)
+// Points: QVector<QPointF>, or QCPPixelLine (indexing yields absolute QPointF).
+template <typename Points>
+QVector<SegmentData> splitByNonFinite(const Points& points)
 {
     QVector<SegmentData> segments;
     int start = 0;
@@ -90,12 +100,27 @@ QVector<SegmentData> splitByNonFinite(const QVector<QPointF>& points)
     return segments;
 }
 
-void extrudeSegment(WriteCursor& cur, const QVector<QPointF>& points,
-                    int start, int end, float halfWidth, const std::array<float, 4>& rgba)
+template <typename Cursor, typename Points>
+void extrudeSegment(Cursor& cur, const Points& points,
+                    int start, int end, float halfWidth)
 {
     int count = end - start;
     if (count < 2) return;
 
+    // Arc length restarts at every gap, as QPainter restarts the dash pattern
+    // for each polyline drawn between NaN breaks.
+    double prevArc = 0.0;
+    auto arcAt = [&](int i) {
+        if constexpr (Cursor::kArcLength)
+        {
+            const QPointF d = points[start + i] - points[start + i - 1];
+            const double len = qSqrt(d.x() * d.x() + d.y() * d.y());
+            return qIsFinite(len) ? prevArc + len : prevArc;
+        }
+        else
+            return 0.0;
+    };
+
     // Sliding window: only previous and current normal/left/right needed.
     QPointF prevNormal = perp(normalized(points[start + 1] - points[start]));
     QPointF prevLeft = points[start] + prevNormal * halfWidth;
@@ -103,6 +128,7 @@ void extrudeSegment(WriteCursor& cur, const QVector<QPointF>& points,
 
     for (int i = 1; i < count - 1; ++i)
     {
+        const double arc = arcAt(i);
         QPointF curNormal = perp(normalized(points[start + i + 1] - points[start + i]));
         QPointF mo = miterOffset(prevNormal, curNormal, halfWidth);
 
@@ -115,20 +141,20 @@ void extrudeSegment(WriteCursor& cur, const QVector<QPointF>& points,
             QPointF leftNext = p + curNormal * halfWidth;
             QPointF rightNext = p - curNormal * halfWidth;
 
-            cur.quad(prevLeft, leftPrev, rightPrev, prevRight, rgba);
+            cur.quad(prevLeft, leftPrev, rightPrev, prevRight, prevArc, arc);
 
             double cross = prevNormal.x() * curNormal.y() - prevNormal.y() * curNormal.x();
             if (cross > 0)
             {
-                cur.vertex(rightPrev.x(), rightPrev.y(), rgba);
-                cur.vertex(rightNext.x(), rightNext.y(), rgba);
-                cur.vertex(p.x(), p.y(), rgba);
+                cur.vertex(rightPrev, arc);
+                cur.vertex(rightNext, arc);
+                cur.vertex(p, arc);
             }
             else
             {
-                cur.vertex(leftPrev.x(), leftPrev.y(), rgba);
-                cur.vertex(leftNext.x(), leftNext.y(), rgba);
-                cur.vertex(p.x(), p.y(), rgba);
+                cur.vertex(leftPrev, arc);
+                cur.vertex(leftNext, arc);
+                cur.vertex(p, arc);
             }
 
             curLeft = leftNext;
@@ -138,101 +164,123 @@ void extrudeSegment(WriteCursor& cur, const QVector<QPointF>& points,
         {
             curLeft = points[start + i] + mo;
             curRight = points[start + i] - mo;
-            cur.quad(prevLeft, curLeft, curRight, prevRight, rgba);
+            cur.quad(prevLeft, curLeft, curRight, prevRight, prevArc, arc);
         }
 
         prevLeft = curLeft;
         prevRight = curRight;
         prevNormal = curNormal;
+        prevArc = arc;
     }
 
     QPointF lastLeft = points[start + count - 1] + prevNormal * halfWidth;
     QPointF lastRight = points[start + count - 1] - prevNormal * halfWidth;
-    cur.quad(prevLeft, lastLeft, lastRight, prevRight, rgba);
+    cur.quad(prevLeft, lastLeft, lastRight, prevRight, prevArc, arcAt(count - 1));
 }
 
 // Upper bound on floats written by extrudePolyline for N input points.
-// Each segment of K points produces at most (K-1) quads (6 verts × 6 floats = 36)
-// plus (K-2) bevel triangles (3 verts × 6 floats = 18).
-// Worst case per point: 36 + 18 = 54 floats. We round up to 6*6*2 = 72.
-int maxExtrusionFloats(int pointCount)
+// Each segment of K points produces at most (K-1) quads (6 verts)
+// plus (K-2) bevel triangles (3 verts): 9 vertices per point, rounded up to 12.
+int maxExtrusionFloats(int pointCount, int floatsPerVertex)
 {
-    return pointCount * 72;
+    return pointCount * 12 * floatsPerVertex;
 }
 
-} // anonymous namespace
-
-void extrudePolyline(const QVector<QPointF>& points, float penWidth,
-                     const QColor& color, std::vector<float>& out)
+template <bool ArcLength, typename Points>
+void extrudeInto(const Points& points, float penWidth, std::vector<float>& out)
 {
-    PROFILE_HERE_N("extrudePolyline");
+    using Cursor = WriteCursor<ArcLength>;
     out.clear();
     if (points.size() < 2 || penWidth <= 0.0f)
         return;
     PROFILE_PASS_VALUE(points.size());
 
-    auto rgba = qcp::rhi::premultipliedColor(color);
     float halfWidth = penWidth / 2.0f;
 
     auto segments = splitByNonFinite(points);
 
     // Pre-allocate worst case — the vector retains capacity across frames
-    int maxFloats = maxExtrusionFloats(points.size());
+    int maxFloats = maxExtrusionFloats(points.size(), Cursor::kStride);
     out.resize(maxFloats);
 
-    WriteCursor cur{out.data()};
+    Cursor cur{out.data()};
     for (const auto& seg : segments)
-        extrudeSegment(cur, points, seg.startIdx, seg.endIdx, halfWidth, rgba);
+        extrudeSegment(cur, points, seg.startIdx, seg.endIdx, halfWidth);
 
     out.resize(cur.pos); // trim to actual size (no realloc — smaller than capacity)
 }
 
-QVector<float> extrudePolyline(const QVector<QPointF>& points, float penWidth,
-                                const QColor& color)
+} // anonymous namespace
+
+void extrudePolyline(const QVector<QPointF>& points, float penWidth, std::vector<float>& out)
+{
+    PROFILE_HERE_N("extrudePolyline");
+    extrudeInto<false>(points, penWidth, out);
+}
+
+void extrudePolyline(const QCPPixelLine& points, float penWidth, std::vector<float>& out)
+{
+    PROFILE_HERE_N("extrudePolyline");
+    extrudeInto<false>(points, penWidth, out);
+}
+
+void extrudeDashedPolyline(const QVector<QPointF>& points, float penWidth,
+                           std::vector<float>& out)
+{
+    PROFILE_HERE_N("extrudeDashedPolyline");
+    extrudeInto<true>(points, penWidth, out);
+}
+
+void extrudeDashedPolyline(const QCPPixelLine& points, float penWidth, std::vector<float>& out)
+{
+    PROFILE_HERE_N("extrudeDashedPolyline");
+    extrudeInto<true>(points, penWidth, out);
+}
+
+QVector<float> extrudePolyline(const QVector<QPointF>& points, float penWidth)
 {
     PROFILE_HERE_N("extrudePolyline");
     if (points.size() < 2 || penWidth <= 0.0f)
         return {};
     PROFILE_PASS_VALUE(points.size());
 
-    auto rgba = qcp::rhi::premultipliedColor(color);
     float halfWidth = penWidth / 2.0f;
 
     auto segments = splitByNonFinite(points);
 
-    int maxFloats = maxExtrusionFloats(points.size());
+    int maxFloats = maxExtrusionFloats(points.size(), kFloatsPerVertex);
     QVector<float> out(maxFloats);
 
-    WriteCursor cur{out.data()};
+    WriteCursor<false> cur{out.data()};
     for (const auto& seg : segments)
-        extrudeSegment(cur, points, seg.startIdx, seg.endIdx, halfWidth, rgba);
+        extrudeSegment(cur, points, seg.startIdx, seg.endIdx, halfWidth);
 
     out.resize(cur.pos);
     return out;
 }
 
-QVector<float> tessellateFillPolygon(const QPolygonF& polygon, const QColor& color)
+QVector<float> tessellateFillPolygon(const QPolygonF& polygon)
 {
     PROFILE_HERE_N("tessellateFillPolygon");
     if (polygon.size() < 4)
         return {};
     PROFILE_PASS_VALUE(polygon.size());
 
-    auto rgba = qcp::rhi::premultipliedColor(color);
     int curveCount = polygon.size() - 2;
 
-    int maxFloats = (curveCount < 2) ? 18 : ((curveCount - 1) * 36 + 2 * 18);
+    int maxVertices = (curveCount < 2) ? 3 : ((curveCount - 1) * 6 + 2 * 3);
+    int maxFloats = maxVertices * kFloatsPerVertex;
     QVector<float> out(maxFloats);
-    WriteCursor cur{out.data()};
+    WriteCursor<false> cur{out.data()};
 
     const QPointF base0 = polygon.first();
     const QPointF base1 = polygon.last();
 
     if (curveCount < 2)
     {
-        cur.vertex(base0.x(), base0.y(), rgba);
-        cur.vertex(polygon[1].x(), polygon[1].y(), rgba);
-        cur.vertex(base1.x(), base1.y(), rgba);
+        cur.vertex(base0.x(), base0.y(), 0.0);
+        cur.vertex(polygon[1].x(), polygon[1].y(), 0.0);
+        cur.vertex(base1.x(), base1.y(), 0.0);
         out.resize(cur.pos);
         return out;
     }
@@ -247,9 +295,9 @@ QVector<float> tessellateFillPolygon(const QPolygonF& polygon, const QColor& col
     };
 
     QPointF proj0 = projectToBaseline(polygon[1]);
-    cur.vertex(base0.x(), base0.y(), rgba);
-    cur.vertex(polygon[1].x(), polygon[1].y(), rgba);
-    cur.vertex(proj0.x(), proj0.y(), rgba);
+    cur.vertex(base0.x(), base0.y(), 0.0);
+    cur.vertex(polygon[1].x(), polygon[1].y(), 0.0);
+    cur.vertex(proj0.x(), proj0.y(), 0.0);
 
     for (int i = 1; i < curveCount; ++i)
     {
@@ -258,13 +306,13 @@ QVector<float> tessellateFillPolygon(const QPolygonF& polygon, const QColor& col
         QPointF p0 = projectToBaseline(c0);
         QPointF p1 = projectToBaseline(c1);
 
-        cur.quad(c0, c1, p1, p0, rgba);
+        cur.quad(c0, c1, p1, p0, 0.0, 0.0);
     }
 
     QPointF projLast = projectToBaseline(polygon[polygon.size() - 2]);
-    cur.vertex(polygon[polygon.size() - 2].x(), polygon[polygon.size() - 2].y(), rgba);
-    cur.vertex(base1.x(), base1.y(), rgba);
-    cur.vertex(projLast.x(), projLast.y(), rgba);
+    cur.vertex(polygon[polygon.size() - 2].x(), polygon[polygon.size() - 2].y(), 0.0);
+    cur.vertex(base1.x(), base1.y(), 0.0);
+    cur.vertex(projLast.x(), projLast.y(), 0.0);
 
     out.resize(cur.pos);
     return out;
@@ -1,28 +1,41 @@
 #pragma once
 
-#include <QColor>
 #include <QPointF>
 #include <QPolygonF>
 #include <QVector>
 #include <vector>
 
+struct QCPPixelLine;
+
 namespace QCPLineExtruder
 {
 
+// Vertices are positions only: (x, y) — 2 floats. A polyline has one color,
+// which QCPPlottableRhiLayer::addPlottable takes per draw.
+constexpr int kFloatsPerVertex = 2;
+
 // Extrude a polyline into a triangle-list vertex buffer.
-// Each vertex: (x, y, r, g, b, a) — 6 floats.
 // NaN points in the input create gaps.
 // Miter joins with bevel fallback at sharp angles.
-QVector<float> extrudePolyline(const QVector<QPointF>& points, float penWidth,
-                                const QColor& color);
+QVector<float> extrudePolyline(const QVector<QPointF>& points, float penWidth);
 
 // Same, but writes into caller-owned buffer (retains capacity across frames → zero alloc on reuse).
-void extrudePolyline(const QVector<QPointF>& points, float penWidth,
-                     const QColor& color, std::vector<float>& out);
+void extrudePolyline(const QVector<QPointF>& points, float penWidth, std::vector<float>& out);
+
+// Same, from a float32 pixel line (the on-screen draw path).
+void extrudePolyline(const QCPPixelLine& points, float penWidth, std::vector<float>& out);
+
+// Dashed pens: same geometry with the arc length along the polyline as a third
+// float per vertex, (x, y, s), restarting at 0 after every gap. The dash
+// pattern itself is applied per fragment (QCPPlottableRhiLayer::addDashedPlottable).
+constexpr int kDashedFloatsPerVertex = 3;
+void extrudeDashedPolyline(const QVector<QPointF>& points, float penWidth,
+                           std::vector<float>& out);
+void extrudeDashedPolyline(const QCPPixelLine& points, float penWidth, std::vector<float>& out);
 
 // Tessellate a baseline fill polygon into a triangle-list vertex buffer.
 // The polygon structure is: basePoint0, curvePoint0..N, basePoint1.
 // Uses trapezoid decomposition between consecutive curve points.
-QVector<float> tessellateFillPolygon(const QPolygonF& polygon, const QColor& color);
+QVector<float> tessellateFillPolygon(const QPolygonF& polygon);
 
 } // namespace QCPLineExtruder
@@ -1,8 +1,24 @@
 #include "plottable-rhi-layer.h"
 #include "rhi-utils.h"
+#include "line-extruder.h"
 #include "Profiling.hpp"
 #include "embedded_shaders.h"
 #include <cstring>
+#include <limits>
+
+namespace {
+
+// Per-segment vertex table for polyline.vert: (endpoint, side, kind). Two
+// triangles spanning the segment, then the bevel triangle at p1 (collapsed by
+// the shader where the joint is mitered).
+constexpr float kSegmentCorners[] = {
+    0, +1, 0,   1, +1, 0,   1, -1, 0,
+    0, +1, 0,   1, -1, 0,   0, -1, 0,
+    0,  0, 1,   1,  0, 1,   0,  0, 2,
+};
+constexpr int kSegmentVertexCount = 9;
+
+} // namespace
 
 QCPPlottableRhiLayer::QCPPlottableRhiLayer(QRhi* rhi)
     : mRhi(rhi)
@@ -12,16 +28,25 @@ QCPPlottableRhiLayer::QCPPlottableRhiLayer(QRhi* rhi)
 QCPPlottableRhiLayer::~QCPPlottableRhiLayer()
 {
     delete mPipeline;
+    delete mLinePipeline;
+    delete mDashPipeline;
     delete mSrb;
     delete mUniformBuffer;
     delete mVertexBuffer;
-    std::free(mStagingData);
+    delete mCornerBuffer;
 }
 
 void QCPPlottableRhiLayer::invalidatePipeline()
 {
     delete mPipeline;
     mPipeline = nullptr;
+    delete mLinePipeline;
+    mLinePipeline = nullptr;
+    delete mDashPipeline;
+    mDashPipeline = nullptr;
+    delete mCornerBuffer;
+    mCornerBuffer = nullptr;
+    mCornerUploaded = false;
     delete mSrb;
     mSrb = nullptr;
     delete mUniformBuffer;
@@ -31,7 +56,7 @@ void QCPPlottableRhiLayer::invalidatePipeline()
 
 void QCPPlottableRhiLayer::clear()
 {
-    mStagingSize = 0;          // preserve allocation
+    mVertices.beginFrame();    // keyed ranges survive until not re-added
     mDrawEntries.resize(0);    // preserve capacity
     mDirty = true;
 }
@@ -51,47 +76,86 @@ int QCPPlottableRhiLayer::ubufStride() const
     return mRhi->ubufAligned(sizeof(PerDrawUniforms));
 }
 
-void QCPPlottableRhiLayer::stagingAppend(const float* src, int count)
+void QCPPlottableRhiLayer::appendEntry(DrawEntry entry, const QColor& color,
+                                        const QRect& clipRect, double dpr,
+                                        int outputHeight, float offsetX, float offsetY)
 {
-    if (mStagingSize + count > mStagingCapacity)
-    {
-        mStagingCapacity = std::max(mStagingCapacity * 2, mStagingSize + count);
-        mStagingData = static_cast<float*>(
-            std::realloc(mStagingData, mStagingCapacity * sizeof(float)));
-    }
-    std::memcpy(mStagingData + mStagingSize, src, count * sizeof(float));
-    mStagingSize += count;
+    entry.scissorRect = qcp::rhi::computeScissor(clipRect, dpr, outputHeight);
+    entry.offsetX = offsetX;
+    entry.offsetY = offsetY;
+    entry.color = qcp::rhi::premultipliedColor(color);
+
+    mDrawEntries.append(entry);
+    mDirty = true;
 }
 
 void
-QCPPlottableRhiLayer::addPlottable(std::span<const float> fillVerts,
-                                    std::span<const float> strokeVerts,
+QCPPlottableRhiLayer::addPlottable(std::span<const float> verts, const QColor& color,
                                     const QRect& clipRect, double dpr,
                                     int outputHeight,
-                                    float offsetX, float offsetY)
+                                    float offsetX, float offsetY,
+                                    quint64 key, bool geometryChanged)
 {
     PROFILE_HERE_N("QCPPlottableRhiLayer::addPlottable");
+    if (verts.empty())
+        return;
+
     DrawEntry entry;
-    entry.scissorRect = qcp::rhi::computeScissor(clipRect, dpr, outputHeight);
-    entry.offsetX = offsetX;
-    entry.offsetY = offsetY;
+    entry.floatOffset = mVertices.write(key, verts, geometryChanged);
+    entry.vertexCount = static_cast<int>(verts.size()) / QCPLineExtruder::kFloatsPerVertex;
+    appendEntry(entry, color, clipRect, dpr, outputHeight, offsetX, offsetY);
+}
 
-    if (!fillVerts.empty())
-    {
-        entry.fillOffset = mStagingSize / 6;
-        entry.fillVertexCount = static_cast<int>(fillVerts.size()) / 6;
-        stagingAppend(fillVerts.data(), static_cast<int>(fillVerts.size()));
-    }
+void
+QCPPlottableRhiLayer::addDashedPlottable(std::span<const float> verts, const QColor& color,
+                                          const DashPattern& dash,
+                                          const QRect& clipRect, double dpr,
+                                          int outputHeight,
+                                          float offsetX, float offsetY,
+                                          quint64 key, bool geometryChanged)
+{
+    PROFILE_HERE_N("QCPPlottableRhiLayer::addDashedPlottable");
+    if (verts.empty() || dash.count <= 0 || dash.count > kMaxDashes)
+        return;
+
+    DrawEntry entry;
+    entry.kind = DrawEntry::DashedTriangles;
+    entry.dash = dash;
+    entry.floatOffset = mVertices.write(key, verts, geometryChanged);
+    entry.vertexCount = static_cast<int>(verts.size()) / QCPLineExtruder::kDashedFloatsPerVertex;
+    appendEntry(entry, color, clipRect, dpr, outputHeight, offsetX, offsetY);
+}
 
-    if (!strokeVerts.empty())
+void
+QCPPlottableRhiLayer::addPolyline(std::span<const float> points, const QColor& color,
+                                   float penWidth, const QRect& clipRect, double dpr,
+                                   int outputHeight,
+                                   float offsetX, float offsetY,
+                                   quint64 key, bool geometryChanged)
+{
+    PROFILE_HERE_N("QCPPlottableRhiLayer::addPolyline");
+    const int pointCount = static_cast<int>(points.size()) / 2;
+    if (pointCount < 2 || penWidth <= 0.0f)
+        return;
+
+    DrawEntry entry;
+    entry.kind = DrawEntry::Polyline;
+    entry.halfWidth = penWidth / 2.0f;
+    entry.vertexCount = pointCount - 1;
+
+    // NaN sentinels on both ends: the first and last segments see a gap as
+    // their outer neighbour and get square ends, as on the CPU.
+    const int floatCount = pointCount * 2;
+    bool fill = false;
+    entry.floatOffset = mVertices.acquire(key, floatCount + 4, geometryChanged, fill);
+    if (fill)
     {
-        entry.strokeOffset = mStagingSize / 6;
-        entry.strokeVertexCount = static_cast<int>(strokeVerts.size()) / 6;
-        stagingAppend(strokeVerts.data(), static_cast<int>(strokeVerts.size()));
+        float* dst = mVertices.data() + entry.floatOffset;
+        dst[0] = dst[1] = std::numeric_limits<float>::quiet_NaN();
+        std::memcpy(dst + 2, points.data(), floatCount * sizeof(float));
+        dst[floatCount + 2] = dst[floatCount + 3] = std::numeric_limits<float>::quiet_NaN();
     }
-
-    mDrawEntries.append(entry);
-    mDirty = true;
+    appendEntry(entry, color, clipRect, dpr, outputHeight, offsetX, offsetY);
 }
 
 bool QCPPlottableRhiLayer::ensurePipeline(QRhiRenderPassDescriptor* rpDesc,
@@ -132,7 +196,8 @@ bool QCPPlottableRhiLayer::ensurePipeline(QRhiRenderPassDescriptor* rpDesc,
     mSrb = mRhi->newShaderResourceBindings();
     mSrb->setBindings({
         QRhiShaderResourceBinding::uniformBufferWithDynamicOffset(
-            0, QRhiShaderResourceBinding::VertexStage, mUniformBuffer, sizeof(PerDrawUniforms))
+            0, QRhiShaderResourceBinding::VertexStage | QRhiShaderResourceBinding::FragmentStage,
+            mUniformBuffer, sizeof(PerDrawUniforms))
     });
     if (!mSrb->create())
     {
@@ -146,12 +211,11 @@ bool QCPPlottableRhiLayer::ensurePipeline(QRhiRenderPassDescriptor* rpDesc,
         {QRhiShaderStage::Fragment, fragShader}
     });
 
-    // Vertex layout: (x, y) float2 + (r, g, b, a) float4
+    // Vertex layout: (x, y) float2; the color comes from the per-draw UBO
     QRhiVertexInputLayout inputLayout;
-    inputLayout.setBindings({{6 * sizeof(float)}});
+    inputLayout.setBindings({{QCPLineExtruder::kFloatsPerVertex * sizeof(float)}});
     inputLayout.setAttributes({
-        {0, 0, QRhiVertexInputAttribute::Float2, 0},
-        {0, 1, QRhiVertexInputAttribute::Float4, 2 * sizeof(float)}
+        {0, 0, QRhiVertexInputAttribute::Float2, 0}
     });
     mPipeline->setVertexInputLayout(inputLayout);
 
@@ -171,15 +235,127 @@ bool QCPPlottableRhiLayer::ensurePipeline(QRhiRenderPassDescriptor* rpDesc,
         return false;
     }
 
+    if (mRhi->isFeatureSupported(QRhi::Instancing) && !mLinePipelineFailed
+        && !createLinePipeline(rpDesc, sampleCount, fragShader))
+    {
+        // Not fatal: supportsShaderExtrusion() turns false, callers extrude on the CPU
+        qDebug() << "Failed to create polyline pipeline, using CPU extrusion";
+        mLinePipelineFailed = true;
+    }
+
+    if (!mDashPipelineFailed && !createDashPipeline(rpDesc, sampleCount))
+    {
+        // Not fatal: supportsDashes() turns false, dashed pens go through QPainter
+        qDebug() << "Failed to create dashed line pipeline";
+        mDashPipelineFailed = true;
+    }
+
     mLastSampleCount = sampleCount;
     return true;
 }
 
+bool QCPPlottableRhiLayer::createDashPipeline(QRhiRenderPassDescriptor* rpDesc, int sampleCount)
+{
+    auto vertShader = qcp::rhi::loadEmbeddedShader(plottable_dash_vert_qsb_data,
+                                                   plottable_dash_vert_qsb_data_len);
+    auto fragShader = qcp::rhi::loadEmbeddedShader(plottable_dash_frag_qsb_data,
+                                                   plottable_dash_frag_qsb_data_len);
+    if (!vertShader.isValid() || !fragShader.isValid())
+        return false;
+
+    mDashPipeline = mRhi->newGraphicsPipeline();
+    mDashPipeline->setShaderStages({
+        {QRhiShaderStage::Vertex, vertShader},
+        {QRhiShaderStage::Fragment, fragShader}
+    });
+
+    // Vertex layout: (x, y) float2 + arc length float
+    QRhiVertexInputLayout inputLayout;
+    inputLayout.setBindings({{QCPLineExtruder::kDashedFloatsPerVertex * sizeof(float)}});
+    inputLayout.setAttributes({
+        {0, 0, QRhiVertexInputAttribute::Float2, 0},
+        {0, 1, QRhiVertexInputAttribute::Float, 2 * sizeof(float)}
+    });
+    mDashPipeline->setVertexInputLayout(inputLayout);
+
+    mDashPipeline->setTargetBlends({qcp::rhi::premultipliedAlphaBlend()});
+    mDashPipeline->setFlags(QRhiGraphicsPipeline::UsesScissor);
+    mDashPipeline->setTopology(QRhiGraphicsPipeline::Triangles);
+    mDashPipeline->setSampleCount(sampleCount);
+    mDashPipeline->setRenderPassDescriptor(rpDesc);
+    mDashPipeline->setShaderResourceBindings(mSrb);
+
+    if (!mDashPipeline->create())
+    {
+        delete mDashPipeline;
+        mDashPipeline = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool QCPPlottableRhiLayer::createLinePipeline(QRhiRenderPassDescriptor* rpDesc,
+                                               int sampleCount, const QShader& fragShader)
+{
+    auto vertShader = qcp::rhi::loadEmbeddedShader(polyline_vert_qsb_data, polyline_vert_qsb_data_len);
+    if (!vertShader.isValid())
+        return false;
+
+    mCornerBuffer = mRhi->newBuffer(QRhiBuffer::Immutable, QRhiBuffer::VertexBuffer,
+                                    sizeof(kSegmentCorners));
+    if (!mCornerBuffer->create())
+        return false;
+    mCornerUploaded = false;
+
+    mLinePipeline = mRhi->newGraphicsPipeline();
+    mLinePipeline->setShaderStages({
+        {QRhiShaderStage::Vertex, vertShader},
+        {QRhiShaderStage::Fragment, fragShader}
+    });
+
+    // Binding 0: segment corner table (PerVertex). Bindings 1-4: the point
+    // stream (PerInstance), bound at four consecutive point offsets so that
+    // instance i sees points i..i+3 as prev, p0, p1, next.
+    constexpr quint32 pointStride = 2 * sizeof(float);
+    QRhiVertexInputLayout inputLayout;
+    inputLayout.setBindings({
+        {3 * static_cast<quint32>(sizeof(float)), QRhiVertexInputBinding::PerVertex},
+        {pointStride, QRhiVertexInputBinding::PerInstance},
+        {pointStride, QRhiVertexInputBinding::PerInstance},
+        {pointStride, QRhiVertexInputBinding::PerInstance},
+        {pointStride, QRhiVertexInputBinding::PerInstance}
+    });
+    inputLayout.setAttributes({
+        {0, 0, QRhiVertexInputAttribute::Float3, 0}, // corner
+        {1, 1, QRhiVertexInputAttribute::Float2, 0}, // prev
+        {2, 2, QRhiVertexInputAttribute::Float2, 0}, // p0
+        {3, 3, QRhiVertexInputAttribute::Float2, 0}, // p1
+        {4, 4, QRhiVertexInputAttribute::Float2, 0}  // next
+    });
+    mLinePipeline->setVertexInputLayout(inputLayout);
+
+    mLinePipeline->setTargetBlends({qcp::rhi::premultipliedAlphaBlend()});
+    mLinePipeline->setFlags(QRhiGraphicsPipeline::UsesScissor);
+    mLinePipeline->setTopology(QRhiGraphicsPipeline::Triangles);
+    mLinePipeline->setSampleCount(sampleCount);
+    mLinePipeline->setRenderPassDescriptor(rpDesc);
+    mLinePipeline->setShaderResourceBindings(mSrb);
+
+    if (!mLinePipeline->create())
+    {
+        delete mLinePipeline;
+        mLinePipeline = nullptr;
+        return false;
+    }
+    return true;
+}
+
 void QCPPlottableRhiLayer::uploadResources(QRhiResourceUpdateBatch* updates,
                                             const QSize& outputSize, float dpr,
                                             bool isYUpInNDC)
 {
     PROFILE_HERE_N("QCPPlottableRhiLayer::uploadResources");
+    mUploadedBytes = 0;
 
     if (mDrawEntries.isEmpty() || !mUniformBuffer)
         return;
@@ -213,36 +389,45 @@ void QCPPlottableRhiLayer::uploadResources(QRhiResourceUpdateBatch* updates,
             dpr,
             entry.offsetX,
             entry.offsetY,
-            {0, 0}
+            entry.halfWidth,
+            float(entry.dash.count),
+            {entry.color[0], entry.color[1], entry.color[2], entry.color[3]},
+            0, 0, {0, 0}, {}
         };
+        if (entry.kind == DrawEntry::DashedTriangles)
+        {
+            // Cumulative ends; the unused tail repeats the period so the
+            // shader's unrolled search never runs past the pattern.
+            float end = 0;
+            for (int k = 0; k < entry.dash.count; ++k)
+            {
+                end += entry.dash.lengths[k];
+                params.dashEnds[k] = end;
+            }
+            for (int k = entry.dash.count; k < kMaxDashes; ++k)
+                params.dashEnds[k] = end;
+            params.dashPeriod = end;
+            params.dashOffset = entry.dash.offset;
+        }
         updates->updateDynamicBuffer(mUniformBuffer, i * stride, sizeof(params), &params);
     }
+    mUploadedBytes += quint64(mDrawEntries.size()) * sizeof(PerDrawUniforms);
 
-    // Upload vertex data only when geometry changed
-    if (!mDirty || mStagingSize == 0)
-        return;
-
-    const int requiredSize = mStagingSize * static_cast<int>(sizeof(float));
-
-    if (!mVertexBuffer || mVertexBufferSize < requiredSize)
+    if (mCornerBuffer && !mCornerUploaded)
     {
-        delete mVertexBuffer;
-        mVertexBuffer = mRhi->newBuffer(QRhiBuffer::Dynamic,
-                                         QRhiBuffer::VertexBuffer,
-                                         requiredSize);
-        if (!mVertexBuffer->create())
-        {
-            qDebug() << "Failed to create plottable vertex buffer";
-            delete mVertexBuffer;
-            mVertexBuffer = nullptr;
-            mVertexBufferSize = 0;
-            return;
-        }
-        mVertexBufferSize = requiredSize;
+        updates->uploadStaticBuffer(mCornerBuffer, kSegmentCorners);
+        mUploadedBytes += sizeof(kSegmentCorners);
+        mCornerUploaded = true;
     }
 
-    updates->updateDynamicBuffer(mVertexBuffer, 0, requiredSize, mStagingData);
-    mDirty = false;
+    // Upload vertex data only when geometry changed, and then only the
+    // ranges that were rewritten since the last upload
+    if (!mDirty)
+        return;
+
+    mUploadedBytes += mVertices.upload(mRhi, updates, mVertexBuffer, mVertexBufferSize);
+    if (mVertexBuffer)
+        mDirty = false;
 }
 
 void QCPPlottableRhiLayer::render(QRhiCommandBuffer* cb,
@@ -253,28 +438,53 @@ void QCPPlottableRhiLayer::render(QRhiCommandBuffer* cb,
     if (!mPipeline || !mVertexBuffer || !mSrb || mDrawEntries.isEmpty())
         return;
 
-    cb->setGraphicsPipeline(mPipeline);
-    cb->setViewport({0, 0, float(outputSize.width()), float(outputSize.height())});
-
-    const QRhiCommandBuffer::VertexInput vbufBinding(mVertexBuffer, 0);
     const int stride = ubufStride();
+    QRhiGraphicsPipeline* bound = nullptr;
     for (int i = 0; i < mDrawEntries.size(); ++i)
     {
         const auto& entry = mDrawEntries[i];
+        QRhiGraphicsPipeline* pipeline = mPipeline;
+        if (entry.kind == DrawEntry::Polyline)
+            pipeline = mCornerBuffer ? mLinePipeline : nullptr;
+        else if (entry.kind == DrawEntry::DashedTriangles)
+            pipeline = mDashPipeline;
+        if (!pipeline)
+            continue;
+        if (pipeline != bound)
+        {
+            cb->setGraphicsPipeline(pipeline);
+            cb->setViewport({0, 0, float(outputSize.width()), float(outputSize.height())});
+            bound = pipeline;
+        }
 
         // Bind per-draw uniform slot via dynamic offset.
         // setShaderResources must precede setVertexInput — on Metal, QRhi offsets
         // vertex buffer indices by the number of SRB buffer bindings.
         const QPair<int, quint32> dynamicOffset(0, quint32(i * stride));
         cb->setShaderResources(mSrb, 1, &dynamicOffset);
-        cb->setVertexInput(0, 1, &vbufBinding);
 
         cb->setScissor({entry.scissorRect.x(), entry.scissorRect.y(),
                         entry.scissorRect.width(), entry.scissorRect.height()});
 
-        if (entry.fillVertexCount > 0)
-            cb->draw(entry.fillVertexCount, 1, entry.fillOffset, 0);
-        if (entry.strokeVertexCount > 0)
-            cb->draw(entry.strokeVertexCount, 1, entry.strokeOffset, 0);
+        const quint32 base = quint32(entry.floatOffset) * sizeof(float);
+        if (entry.kind == DrawEntry::Polyline)
+        {
+            const quint32 point = 2 * sizeof(float);
+            const QRhiCommandBuffer::VertexInput bindings[] = {
+                {mCornerBuffer, 0},
+                {mVertexBuffer, base},
+                {mVertexBuffer, base + point},
+                {mVertexBuffer, base + 2 * point},
+                {mVertexBuffer, base + 3 * point}
+            };
+            cb->setVertexInput(0, 5, bindings);
+            cb->draw(kSegmentVertexCount, entry.vertexCount, 0, 0);
+        }
+        else
+        {
+            const QRhiCommandBuffer::VertexInput vbufBinding(mVertexBuffer, base);
+            cb->setVertexInput(0, 1, &vbufBinding);
+            cb->draw(entry.vertexCount);
+        }
     }
 }
@@ -1,21 +1,38 @@
 #pragma once
 
+#include "rhi-slot-buffer.h"
 #include <QColor>
 #include <QRect>
 #include <QVector>
+#include <array>
 #include <rhi/qrhi.h>
 #include <span>
-#include <cstdlib>
 
 class QCPPlottableRhiLayer
 {
 public:
+    static constexpr int kMaxDashes = 8;
+
+    // Dash pattern in logical pixels: alternating dash and gap lengths
+    // (even count, at most kMaxDashes) and the distance into the pattern at
+    // which each line starts, as QPen::dashPattern/dashOffset times the width.
+    struct DashPattern
+    {
+        std::array<float, kMaxDashes> lengths{};
+        int count = 0;
+        float offset = 0;
+    };
+
     struct DrawEntry
     {
-        int fillOffset = 0;
-        int fillVertexCount = 0;
-        int strokeOffset = 0;
-        int strokeVertexCount = 0;
+        enum Kind { Triangles, Polyline, DashedTriangles };
+
+        Kind kind = Triangles;
+        int floatOffset = 0;          // start of the entry's data in the vertex buffer
+        int vertexCount = 0;          // vertices, or segments for a polyline
+        float halfWidth = 0;          // polyline only, logical pixels
+        DashPattern dash;             // dashed only
+        std::array<float, 4> color{}; // premultiplied RGBA, uploaded per draw
         float offsetX = 0;  // per-draw pixel offset (applied in vertex shader)
         float offsetY = 0;
         QRect scissorRect; // in physical pixels, Y-flipped for Y-up backends
@@ -24,13 +41,47 @@ public:
     explicit QCPPlottableRhiLayer(QRhi* rhi);
     ~QCPPlottableRhiLayer();
 
-    // Geometry accumulation (called during replot)
+    // Geometry accumulation (called during replot). `verts` is a triangle
+    // list of (x, y) positions as produced by QCPLineExtruder, drawn in one
+    // flat color.
+    //
+    // A nonzero `key` identifies the caller's geometry across replots (see
+    // qcp::ExtrusionCache::key). Keyed geometry keeps its range of the vertex buffer
+    // after clear(); unless `geometryChanged`, it is not copied or uploaded
+    // again. Unkeyed geometry is re-uploaded every replot.
     void clear();
-    void addPlottable(std::span<const float> fillVerts,
-                      std::span<const float> strokeVerts,
+    void addPlottable(std::span<const float> verts, const QColor& color,
                       const QRect& clipRect, double dpr,
                       int outputHeight,
-                      float offsetX = 0, float offsetY = 0);
+                      float offsetX = 0, float offsetY = 0,
+                      quint64 key = 0, bool geometryChanged = true);
+
+    // Shader-side extrusion: `points` is the polyline itself, (x, y) per point
+    // with non-finite points as gaps, and the vertex shader builds the same
+    // miter/bevel geometry as QCPLineExtruder from one instance per segment.
+    // Uploads 2 floats per point instead of 12+ per point. Only valid while
+    // supportsShaderExtrusion().
+    void addPolyline(std::span<const float> points, const QColor& color, float penWidth,
+                     const QRect& clipRect, double dpr,
+                     int outputHeight,
+                     float offsetX = 0, float offsetY = 0,
+                     quint64 key = 0, bool geometryChanged = true);
+    // Dashed pens: `verts` from QCPLineExtruder::extrudeDashedPolyline, whose
+    // per-vertex arc length the fragment shader tests against `dash`. Changing
+    // the pattern needs no new vertices.
+    void addDashedPlottable(std::span<const float> verts, const QColor& color,
+                            const DashPattern& dash,
+                            const QRect& clipRect, double dpr,
+                            int outputHeight,
+                            float offsetX = 0, float offsetY = 0,
+                            quint64 key = 0, bool geometryChanged = true);
+    bool supportsDashes() const { return !mDashPipelineFailed; }
+
+    // Needs instanced drawing; callers extrude on the CPU otherwise.
+    bool supportsShaderExtrusion() const
+    {
+        return mRhi && mRhi->isFeatureSupported(QRhi::Instancing) && !mLinePipelineFailed;
+    }
 
     // Offset-only update (no geometry change, no vertex re-upload)
     void setAllOffsets(float offsetX, float offsetY);
@@ -44,25 +95,41 @@ public:
 
     bool isDirty() const { return mDirty; }
     bool hasGeometry() const { return !mDrawEntries.isEmpty(); }
+    // Bytes handed to the update batch by the last uploadResources().
+    quint64 uploadedBytes() const { return mUploadedBytes; }
+    // CPU staging plus the vertex and uniform buffers it is uploaded to.
+    quint64 memoryBytes() const
+    {
+        return mVertices.memoryBytes() + quint64(mVertexBufferSize)
+            + quint64(mUniformBufferSize);
+    }
 
 private:
     // Per-draw uniform data, aligned to GPU requirements.
-    // Matches the ViewportParams UBO in plottable.vert.
+    // Matches the ViewportParams UBO in the plottable shaders; plottable.vert
+    // and polyline.vert declare only the leading members.
     struct alignas(16) PerDrawUniforms
     {
         float width, height, yFlip, dpr;
         float offsetX, offsetY;
-        float _pad[2]; // pad to 32 bytes for std140
+        float halfWidth; // polyline.vert only
+        float dashCount; // the dash members: plottable_dash.frag only
+        float color[4];
+        float dashPeriod, dashOffset;
+        float _pad[2];   // align dashEnds to 16 bytes for std140
+        float dashEnds[kMaxDashes]; // cumulative; vec4[2] in the shader
     };
-    static_assert(sizeof(PerDrawUniforms) == 32);
+    static_assert(sizeof(PerDrawUniforms) == 96);
 
     int ubufStride() const; // aligned slot size for dynamic UBO offsets
+    bool createLinePipeline(QRhiRenderPassDescriptor* rpDesc, int sampleCount,
+                            const QShader& fragShader);
+    bool createDashPipeline(QRhiRenderPassDescriptor* rpDesc, int sampleCount);
+    void appendEntry(DrawEntry entry, const QColor& color, const QRect& clipRect,
+                     double dpr, int outputHeight, float offsetX, float offsetY);
 
-    // Raw staging buffer — avoids QVector::resize zero-initialization overhead
-    void stagingAppend(const float* src, int count);
-    float* mStagingData = nullptr;
-    int mStagingSize = 0;     // floats used
-    int mStagingCapacity = 0; // floats allocated
+    // Staging for mVertexBuffer, one persistent range per keyed caller
+    QCPRhiSlotBuffer mVertices;
 
     QRhi* mRhi; // non-owned; lifetime managed by QRhiWidget
     QVector<DrawEntry> mDrawEntries;
@@ -71,8 +138,15 @@ private:
     QRhiBuffer* mUniformBuffer = nullptr;
     QRhiShaderResourceBindings* mSrb = nullptr;
     QRhiGraphicsPipeline* mPipeline = nullptr;
+    QRhiGraphicsPipeline* mLinePipeline = nullptr; // instanced, polyline.vert
+    QRhiBuffer* mCornerBuffer = nullptr;           // static per-segment vertex table
+    bool mCornerUploaded = false;
+    bool mLinePipelineFailed = false;
+    QRhiGraphicsPipeline* mDashPipeline = nullptr; // plottable_dash.vert/.frag
+    bool mDashPipelineFailed = false;
     int mVertexBufferSize = 0;
     int mUniformBufferSize = 0;
     int mLastSampleCount = 0;
     bool mDirty = false;
+    quint64 mUploadedBytes = 0;
 };
@@ -0,0 +1,212 @@
+#include "rhi-slot-buffer.h"
+#include "Profiling.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+QCPRhiSlotBuffer::~QCPRhiSlotBuffer()
+{
+    std::free(mData);
+}
+
+void QCPRhiSlotBuffer::beginFrame()
+{
+    for (auto it = mSlots.begin(); it != mSlots.end();)
+    {
+        if (!it->live)
+        {
+            release(it->range);
+            it = mSlots.erase(it);
+        }
+        else
+        {
+            it->live = false;
+            ++it;
+        }
+    }
+    for (const Range& range : std::as_const(mTransient))
+        release(range);
+    mTransient.resize(0);
+}
+
+int QCPRhiSlotBuffer::acquire(quint64 key, int count, bool changed, bool& fill)
+{
+    fill = true;
+    auto it = key ? mSlots.find(key) : mSlots.end();
+    // A second draw with the same key in one frame must not overwrite the first
+    if (!key || (it != mSlots.end() && it->live))
+    {
+        const Range range{allocate(count), count};
+        mTransient.append(range);
+        markDirty(range.offset, count);
+        return range.offset;
+    }
+
+    if (it == mSlots.end())
+        it = mSlots.insert(key, Slot{});
+    Slot& slot = *it;
+    slot.live = true;
+    if (slot.range.size > 0 && !changed && slot.count == count)
+    {
+        fill = false;
+        return slot.range.offset;
+    }
+
+    // Reuse the range in place unless it is too small or mostly wasted;
+    // headroom on reallocation absorbs a line that grows a little per frame.
+    if (count > slot.range.size || count < slot.range.size / 4)
+    {
+        if (slot.range.size > 0)
+            release(slot.range);
+        const int size = count + count / 4;
+        slot.range = Range{allocate(size), size};
+    }
+    slot.count = count;
+    markDirty(slot.range.offset, count);
+    return slot.range.offset;
+}
+
+int QCPRhiSlotBuffer::write(quint64 key, std::span<const float> values, bool changed)
+{
+    const int count = static_cast<int>(values.size());
+    bool fill = false;
+    const int offset = acquire(key, count, changed, fill);
+    if (fill)
+        std::memcpy(mData + offset, values.data(), values.size() * sizeof(float));
+    return offset;
+}
+
+bool QCPRhiSlotBuffer::holds(quint64 key, std::span<const float> values) const
+{
+    auto it = key ? mSlots.constFind(key) : mSlots.cend();
+    if (it == mSlots.cend() || it->live || it->count != static_cast<int>(values.size()))
+        return false;
+    return std::memcmp(mData + it->range.offset, values.data(),
+                       values.size() * sizeof(float)) == 0;
+}
+
+int QCPRhiSlotBuffer::allocate(int count)
+{
+    // First fit from the free list
+    for (int i = 0; i < mFree.size(); ++i)
+    {
+        Range& free = mFree[i];
+        if (free.size < count)
+            continue;
+        const int offset = free.offset;
+        free.offset += count;
+        free.size -= count;
+        if (free.size == 0)
+            mFree.remove(i);
+        return offset;
+    }
+
+    const int offset = mEnd;
+    mEnd += count;
+    if (mEnd > mCapacity)
+    {
+        mCapacity = std::max(mCapacity * 2, mEnd);
+        mData = static_cast<float*>(std::realloc(mData, mCapacity * sizeof(float)));
+    }
+    return offset;
+}
+
+void QCPRhiSlotBuffer::release(Range range)
+{
+    if (range.size <= 0)
+        return;
+    auto it = std::lower_bound(mFree.begin(), mFree.end(), range.offset,
+                               [](const Range& r, int offset) { return r.offset < offset; });
+    int i = static_cast<int>(it - mFree.begin());
+    mFree.insert(i, range);
+
+    // Coalesce with the following and preceding neighbours
+    if (i + 1 < mFree.size() && mFree[i].offset + mFree[i].size == mFree[i + 1].offset)
+    {
+        mFree[i].size += mFree[i + 1].size;
+        mFree.remove(i + 1);
+    }
+    if (i > 0 && mFree[i - 1].offset + mFree[i - 1].size == mFree[i].offset)
+    {
+        mFree[i - 1].size += mFree[i].size;
+        mFree.remove(i);
+        --i;
+    }
+
+    // A free tail just lowers the high-water mark
+    if (mFree[i].offset + mFree[i].size == mEnd)
+    {
+        mEnd = mFree[i].offset;
+        mFree.remove(i);
+    }
+}
+
+void QCPRhiSlotBuffer::markDirty(int offset, int count)
+{
+    if (count > 0)
+        mDirty.append(Range{offset, count});
+}
+
+quint64 QCPRhiSlotBuffer::upload(QRhi* rhi, QRhiResourceUpdateBatch* updates,
+                                 QRhiBuffer*& buffer, int& bufferSize)
+{
+    PROFILE_HERE_N("QCPRhiSlotBuffer::upload");
+    if (mEnd == 0)
+    {
+        mDirty.resize(0);
+        return 0;
+    }
+
+    const int requiredSize = mEnd * static_cast<int>(sizeof(float));
+    if (!buffer || bufferSize < requiredSize)
+    {
+        // Size to the staging capacity so the buffer grows as rarely as it does
+        const int size = mCapacity * static_cast<int>(sizeof(float));
+        delete buffer;
+        buffer = rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::VertexBuffer, size);
+        if (!buffer->create())
+        {
+            qDebug() << "Failed to create slot vertex buffer";
+            delete buffer;
+            buffer = nullptr;
+            bufferSize = 0;
+            return 0;
+        }
+        bufferSize = size;
+        updates->updateDynamicBuffer(buffer, 0, requiredSize, mData);
+        mDirty.resize(0);
+        return quint64(requiredSize);
+    }
+
+    if (mDirty.isEmpty())
+        return 0;
+
+    // Merge overlapping and adjacent ranges into as few updates as possible
+    std::sort(mDirty.begin(), mDirty.end(),
+              [](const Range& a, const Range& b) { return a.offset < b.offset; });
+    quint64 bytes = 0;
+    auto flush = [&](int begin, int end) {
+        end = std::min(end, mEnd);
+        if (end <= begin)
+            return;
+        const int byteOffset = begin * static_cast<int>(sizeof(float));
+        const int byteSize = (end - begin) * static_cast<int>(sizeof(float));
+        updates->updateDynamicBuffer(buffer, byteOffset, byteSize, mData + begin);
+        bytes += quint64(byteSize);
+    };
+    int begin = mDirty.first().offset;
+    int end = begin + mDirty.first().size;
+    for (int i = 1; i < mDirty.size(); ++i)
+    {
+        const Range& r = mDirty[i];
+        if (r.offset > end)
+        {
+            flush(begin, end);
+            begin = r.offset;
+        }
+        end = std::max(end, r.offset + r.size);
+    }
+    flush(begin, end);
+    mDirty.resize(0);
+    return bytes;
+}
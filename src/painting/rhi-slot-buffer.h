@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QHash>
+#include <QVector>
+#include <rhi/qrhi.h>
+#include <span>
+
+// CPU staging for a dynamic vertex buffer, sub-allocated into per-owner slots
+// that persist across repaints. An owner (a nonzero key that is stable across
+// replots) gets the same range back every frame; only ranges written since the
+// last upload() are re-uploaded. Ranges of owners that stop drawing return to
+// a free list at the next beginFrame(). Key 0 gets a transient range,
+// released at the next beginFrame().
+class QCPRhiSlotBuffer
+{
+public:
+    QCPRhiSlotBuffer() = default;
+    ~QCPRhiSlotBuffer();
+    QCPRhiSlotBuffer(const QCPRhiSlotBuffer&) = delete;
+    QCPRhiSlotBuffer& operator=(const QCPRhiSlotBuffer&) = delete;
+
+    // Start of a repaint of the owning layer.
+    void beginFrame();
+
+    // Float offset of `key`'s range, `count` floats long. `fill` is set when
+    // the caller must write the range at data() + offset: new or resized
+    // slots, transient ranges, or `changed`. Pointers from data() are only
+    // valid until the next acquire().
+    int acquire(quint64 key, int count, bool changed, bool& fill);
+    // acquire() and copy `values` in if needed.
+    int write(quint64 key, std::span<const float> values, bool changed);
+    // True when `key`'s slot already holds exactly `values`.
+    bool holds(quint64 key, std::span<const float> values) const;
+
+    float* data() { return mData; }
+    bool hasPendingUpload() const { return !mDirty.isEmpty(); }
+
+    // Uploads the written ranges into `buffer`, (re)creating it when it is too
+    // small, which uploads everything. Returns the bytes handed to `updates`.
+    quint64 upload(QRhi* rhi, QRhiResourceUpdateBatch* updates,
+                   QRhiBuffer*& buffer, int& bufferSize);
+
+    int slotCount() const { return mSlots.size(); }
+    int usedFloats() const { return mEnd; }
+    quint64 memoryBytes() const { return quint64(mCapacity) * sizeof(float); }
+
+private:
+    struct Range
+    {
+        int offset = 0;
+        int size = 0;
+    };
+    struct Slot
+    {
+        Range range;   // allocated
+        int count = 0; // floats in use
+        bool live = false; // acquired since the last beginFrame()
+    };
+
+    int allocate(int count);
+    void release(Range range);
+    void markDirty(int offset, int count);
+
+    float* mData = nullptr;
+    int mCapacity = 0; // floats allocated
+    int mEnd = 0;      // high-water mark; everything past it is free
+
+    QHash<quint64, Slot> mSlots;
+    QVector<Range> mTransient;
+    QVector<Range> mFree;  // sorted by offset, coalesced
+    QVector<Range> mDirty; // written since the last upload()
+};
@@ -3,7 +3,6 @@
 #include "Profiling.hpp"
 #include "embedded_shaders.h"
 #include "../scatterstyle.h"
-#include <cstring>
 
 QCPScatterRhiLayer::QCPScatterRhiLayer(QRhi* rhi)
     : mRhi(rhi)
@@ -21,7 +20,6 @@ QCPScatterRhiLayer::~QCPScatterRhiLayer()
     delete mSpriteTexture;
     delete mColormapTexture;
     delete mSampler;
-    std::free(mStagingData);
 }
 
 void QCPScatterRhiLayer::invalidatePipeline()
@@ -50,7 +48,7 @@ void QCPScatterRhiLayer::invalidatePipeline()
 
 void QCPScatterRhiLayer::clear()
 {
-    mStagingSize = 0;
+    mInstances.beginFrame();
     mDrawEntries.resize(0);
     mDirty = true;
 }
@@ -69,24 +67,13 @@ int QCPScatterRhiLayer::ubufStride() const
     return mRhi->ubufAligned(sizeof(PerDrawUniforms));
 }
 
-void QCPScatterRhiLayer::stagingAppend(const float* src, int count)
-{
-    if (mStagingSize + count > mStagingCapacity)
-    {
-        mStagingCapacity = std::max(mStagingCapacity * 2, mStagingSize + count);
-        mStagingData = static_cast<float*>(
-            std::realloc(mStagingData, mStagingCapacity * sizeof(float)));
-    }
-    std::memcpy(mStagingData + mStagingSize, src, count * sizeof(float));
-    mStagingSize += count;
-}
-
 void QCPScatterRhiLayer::addScatter(std::span<const float> points,
                                      const QCPScatterStyle& style,
                                      const QRect& clipRect, double dpr,
                                      int outputHeight,
                                      float offsetX, float offsetY,
-                                     const QImage& colormapImage)
+                                     const QImage& colormapImage,
+                                     quint64 key)
 {
     PROFILE_HERE_N("QCPScatterRhiLayer::addScatter");
 
@@ -124,10 +111,10 @@ void QCPScatterRhiLayer::addScatter(std::span<const float> points,
     entry.scissorRect = qcp::rhi::computeScissor(clipRect, dpr, outputHeight);
     entry.offsetX = offsetX;
     entry.offsetY = offsetY;
-    entry.instanceOffset = mStagingSize / 3;
     entry.instanceCount = static_cast<int>(points.size()) / 3;
-
-    stagingAppend(points.data(), static_cast<int>(points.size()));
+    // Scatter points are rebuilt by their plottable on every replot, so the
+    // comparison is what spares the upload for unchanged ones
+    entry.floatOffset = mInstances.write(key, points, !mInstances.holds(key, points));
     mDrawEntries.append(entry);
     mDirty = true;
 }
@@ -234,6 +221,7 @@ void QCPScatterRhiLayer::uploadResources(QRhiResourceUpdateBatch* updates,
                                            bool isYUpInNDC)
 {
     PROFILE_HERE_N("QCPScatterRhiLayer::uploadResources");
+    mUploadedBytes = 0;
 
     if (mDrawEntries.isEmpty() || !mUniformBuffer)
         return;
@@ -267,6 +255,7 @@ void QCPScatterRhiLayer::uploadResources(QRhiResourceUpdateBatch* updates,
 
         updates->uploadStaticBuffer(mQuadVertexBuffer, quadVerts);
         updates->uploadStaticBuffer(mQuadIndexBuffer, quadIndices);
+        mUploadedBytes += sizeof(quadVerts) + sizeof(quadIndices);
         mQuadUploaded = true;
     }
 
@@ -291,6 +280,7 @@ void QCPScatterRhiLayer::uploadResources(QRhiResourceUpdateBatch* updates,
         QRhiTextureSubresourceUploadDescription subDesc(converted);
         updates->uploadTexture(mSpriteTexture, QRhiTextureUploadDescription(
             QRhiTextureUploadEntry(0, 0, subDesc)));
+        mUploadedBytes += quint64(converted.sizeInBytes());
         mSpriteTextureDirty = false;
     }
 
@@ -314,6 +304,7 @@ void QCPScatterRhiLayer::uploadResources(QRhiResourceUpdateBatch* updates,
         QRhiTextureSubresourceUploadDescription subDesc(converted);
         updates->uploadTexture(mColormapTexture, QRhiTextureUploadDescription(
             QRhiTextureUploadEntry(0, 0, subDesc)));
+        mUploadedBytes += quint64(converted.sizeInBytes());
         mColormapTextureDirty = false;
     }
 
@@ -347,31 +338,16 @@ void QCPScatterRhiLayer::uploadResources(QRhiResourceUpdateBatch* updates,
         };
         updates->updateDynamicBuffer(mUniformBuffer, i * stride, sizeof(params), &params);
     }
+    mUploadedBytes += quint64(mDrawEntries.size()) * sizeof(PerDrawUniforms);
 
-    // Upload instance data only when geometry changed
-    if (!mDirty || mStagingSize == 0)
+    // Upload instance data only when geometry changed, and then only the
+    // ranges that were rewritten since the last upload
+    if (!mDirty)
         return;
 
-    const int requiredSize = mStagingSize * static_cast<int>(sizeof(float));
-
-    if (!mInstanceBuffer || mInstanceBufferSize < requiredSize)
-    {
-        delete mInstanceBuffer;
-        mInstanceBuffer = mRhi->newBuffer(QRhiBuffer::Dynamic,
-                                           QRhiBuffer::VertexBuffer,
-                                           requiredSize);
-        if (!mInstanceBuffer->create())
-        {
-            delete mInstanceBuffer;
-            mInstanceBuffer = nullptr;
-            mInstanceBufferSize = 0;
-            return;
-        }
-        mInstanceBufferSize = requiredSize;
-    }
-
-    updates->updateDynamicBuffer(mInstanceBuffer, 0, requiredSize, mStagingData);
-    mDirty = false;
+    mUploadedBytes += mInstances.upload(mRhi, updates, mInstanceBuffer, mInstanceBufferSize);
+    if (mInstanceBuffer)
+        mDirty = false;
 }
 
 void QCPScatterRhiLayer::render(QRhiCommandBuffer* cb,
@@ -398,7 +374,7 @@ void QCPScatterRhiLayer::render(QRhiCommandBuffer* cb,
 
         const QRhiCommandBuffer::VertexInput vbufBindings[] = {
             {mQuadVertexBuffer, 0},
-            {mInstanceBuffer, quint32(entry.instanceOffset * 3 * sizeof(float))}
+            {mInstanceBuffer, quint32(entry.floatOffset * sizeof(float))}
         };
         cb->setVertexInput(0, 2, vbufBindings, mQuadIndexBuffer, 0,
                            QRhiCommandBuffer::IndexUInt16);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "rhi-slot-buffer.h"
 #include <QBrush>
 #include <QImage>
 #include <QPen>
@@ -7,7 +8,6 @@
 #include <QVector>
 #include <rhi/qrhi.h>
 #include <span>
-#include <cstdlib>
 
 class QCPScatterStyle;
 
@@ -16,7 +16,7 @@ class QCPScatterRhiLayer
 public:
     struct DrawEntry
     {
-        int instanceOffset = 0;
+        int floatOffset = 0; // start of the entry's instances in the instance buffer
         int instanceCount = 0;
         float offsetX = 0;
         float offsetY = 0;
@@ -28,11 +28,15 @@ public:
 
     void clear();
 
+    // `points` holds (x, y, color value) per instance. With a nonzero `key`, the
+    // instances keep their range of the instance buffer across clear() and
+    // are only uploaded again when they differ from the previous replot.
     void addScatter(std::span<const float> points,
                     const QCPScatterStyle& style,
                     const QRect& clipRect, double dpr, int outputHeight,
                     float offsetX = 0, float offsetY = 0,
-                    const QImage& colormapImage = {});
+                    const QImage& colormapImage = {},
+                    quint64 key = 0);
 
     void setAllOffsets(float offsetX, float offsetY);
 
@@ -44,6 +48,15 @@ public:
 
     bool isDirty() const { return mDirty; }
     bool hasGeometry() const { return !mDrawEntries.isEmpty(); }
+    // Bytes handed to the update batch by the last uploadResources().
+    quint64 uploadedBytes() const { return mUploadedBytes; }
+    // CPU staging and sprite images plus the GPU buffers they are uploaded to.
+    quint64 memoryBytes() const
+    {
+        return mInstances.memoryBytes() + quint64(mInstanceBufferSize)
+            + quint64(mUniformBufferSize) + quint64(mSpriteImage.sizeInBytes())
+            + quint64(mColormapImage.sizeInBytes());
+    }
 
 private:
     struct alignas(16) PerDrawUniforms
@@ -57,10 +70,8 @@ private:
 
     int ubufStride() const;
 
-    void stagingAppend(const float* src, int count);
-    float* mStagingData = nullptr;
-    int mStagingSize = 0;
-    int mStagingCapacity = 0;
+    // Staging for mInstanceBuffer, one persistent range per keyed caller
+    QCPRhiSlotBuffer mInstances;
 
     QRhi* mRhi;
     QVector<DrawEntry> mDrawEntries;
@@ -82,6 +93,7 @@ private:
     int mLastSampleCount = 0;
 
     bool mDirty = false;
+    quint64 mUploadedBytes = 0;
     bool mQuadUploaded = false;
     bool mSpriteTextureDirty = false;
     bool mColormapTextureDirty = false;
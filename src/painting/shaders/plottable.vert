@@ -1,7 +1,6 @@
 #version 440
 
 layout(location = 0) in vec2 position;
-layout(location = 1) in vec4 color;
 
 layout(location = 0) out vec4 v_color;
 
@@ -12,6 +11,8 @@ layout(std140, binding = 0) uniform ViewportParams {
     float dpr;
     float offsetX;  // per-draw pixel offset
     float offsetY;
+    float halfWidth; // used by polyline.vert only
+    vec4 color;     // premultiplied, one per draw
 } pc;
 
 void main()
@@ -19,5 +20,5 @@ void main()
     float ndcX = ((position.x + pc.offsetX) * pc.dpr / pc.width) * 2.0 - 1.0;
     float ndcY = pc.yFlip * (((position.y + pc.offsetY) * pc.dpr / pc.height) * 2.0 - 1.0);
     gl_Position = vec4(ndcX, ndcY, 0.0, 1.0);
-    v_color = color;
+    v_color = pc.color;
 }
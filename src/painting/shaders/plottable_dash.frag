@@ -0,0 +1,46 @@
+#version 440
+
+// Dashed pens: even entries of the pattern are dashes, odd entries gaps.
+// Mirrors QPainter's dashing along the stroke centre line; caps and joins
+// take the dash state of the arc length interpolated across them.
+
+layout(location = 0) in vec4 v_color;
+layout(location = 1) in float v_arc;
+
+layout(location = 0) out vec4 fragColor;
+
+layout(std140, binding = 0) uniform ViewportParams {
+    float width;
+    float height;
+    float yFlip;
+    float dpr;
+    float offsetX;
+    float offsetY;
+    float halfWidth;
+    float dashCount;
+    vec4 color;
+    float dashPeriod;
+    float dashOffset;
+    vec4 dashEnds0;
+    vec4 dashEnds1;
+} pc;
+
+void main()
+{
+    float t = mod(v_arc + pc.dashOffset, pc.dashPeriod);
+
+    // Index of the pattern entry containing t; entries past dashCount end at
+    // the period, so t never reaches them.
+    int k = 0;
+    if (t >= pc.dashEnds0.x) k = 1;
+    if (t >= pc.dashEnds0.y) k = 2;
+    if (t >= pc.dashEnds0.z) k = 3;
+    if (t >= pc.dashEnds0.w) k = 4;
+    if (t >= pc.dashEnds1.x) k = 5;
+    if (t >= pc.dashEnds1.y) k = 6;
+    if (t >= pc.dashEnds1.z) k = 7;
+    if (mod(float(k), 2.0) > 0.5)
+        discard;
+
+    fragColor = v_color;
+}
@@ -0,0 +1,34 @@
+#version 440
+
+// plottable.vert plus the arc length along the line, for plottable_dash.frag
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in float arc; // logical pixels from the start of the sub-polyline
+
+layout(location = 0) out vec4 v_color;
+layout(location = 1) out float v_arc;
+
+layout(std140, binding = 0) uniform ViewportParams {
+    float width;
+    float height;
+    float yFlip;
+    float dpr;
+    float offsetX;  // per-draw pixel offset
+    float offsetY;
+    float halfWidth; // used by polyline.vert only
+    float dashCount;
+    vec4 color;     // premultiplied, one per draw
+    float dashPeriod;
+    float dashOffset;
+    vec4 dashEnds0; // cumulative dash/gap ends, unused entries = dashPeriod
+    vec4 dashEnds1;
+} pc;
+
+void main()
+{
+    float ndcX = ((position.x + pc.offsetX) * pc.dpr / pc.width) * 2.0 - 1.0;
+    float ndcY = pc.yFlip * (((position.y + pc.offsetY) * pc.dpr / pc.height) * 2.0 - 1.0);
+    gl_Position = vec4(ndcX, ndcY, 0.0, 1.0);
+    v_color = pc.color;
+    v_arc = arc;
+}
@@ -0,0 +1,123 @@
+#version 440
+
+// Shader-side polyline extrusion: one instance per segment p0 -> p1, with the
+// neighbours prev and next to build the joins. Mirrors QCPLineExtruder's
+// miter-with-bevel-fallback geometry; a non-finite point breaks the line.
+
+// Per-vertex (9 per segment): x = endpoint (0 = p0, 1 = p1), y = side
+// (+1 left, -1 right), z = 0 quad corner, 1 bevel edge (x picks the normal of
+// this or the next segment, y unused), 2 bevel center.
+layout(location = 0) in vec3 corner;
+
+// Per-instance: the same point stream bound at four consecutive offsets
+layout(location = 1) in vec2 prev;
+layout(location = 2) in vec2 p0;
+layout(location = 3) in vec2 p1;
+layout(location = 4) in vec2 next;
+
+layout(location = 0) out vec4 v_color;
+
+layout(std140, binding = 0) uniform ViewportParams {
+    float width;
+    float height;
+    float yFlip;
+    float dpr;
+    float offsetX;  // per-draw pixel offset
+    float offsetY;
+    float halfWidth; // half the pen width in logical pixels
+    vec4 color;     // premultiplied, one per draw
+} pc;
+
+const float MITER_LIMIT = 4.0;
+
+// Clip-space point outside the view volume. Unused triangles are moved here
+// rather than collapsed in place: the clipper rejects them outright, and
+// llvmpipe drops a whole three-triangle draw whose last triangle has zero area.
+const vec4 CULLED = vec4(2.0, 2.0, 2.0, 1.0);
+
+bool isFinitePoint(vec2 p)
+{
+    return !(isnan(p.x) || isnan(p.y) || isinf(p.x) || isinf(p.y));
+}
+
+vec2 segmentNormal(vec2 a, vec2 b)
+{
+    vec2 d = b - a;
+    float len = length(d);
+    vec2 dir = (isinf(len) || isnan(len) || len < 1e-10) ? vec2(0.0, 1.0) : d / len;
+    return vec2(-dir.y, dir.x);
+}
+
+// Miter offset at a joint between normals n0 and n1; false where
+// QCPLineExtruder falls back to a bevel.
+bool miterOffset(vec2 n0, vec2 n1, out vec2 offset)
+{
+    vec2 sum = n0 + n1;
+    float len = length(sum);
+    vec2 tangent = (len < 1e-10) ? vec2(0.0, 1.0) : sum / len;
+    float d = dot(tangent, n0);
+    if (abs(d) < 1e-6)
+        return false;
+    float miterLen = pc.halfWidth / d;
+    if (abs(miterLen) > MITER_LIMIT * pc.halfWidth)
+        return false;
+    offset = tangent * miterLen;
+    return true;
+}
+
+void main()
+{
+    if (!isFinitePoint(p0) || !isFinitePoint(p1))
+    {
+        // Gap: drop the whole instance
+        gl_Position = CULLED;
+        v_color = pc.color;
+        return;
+    }
+
+    vec2 n = segmentNormal(p0, p1);
+    vec2 pos;
+    if (corner.z < 0.5)
+    {
+        vec2 offset = n * pc.halfWidth;
+        if (corner.x < 0.5)
+        {
+            vec2 mo;
+            if (isFinitePoint(prev) && miterOffset(segmentNormal(prev, p0), n, mo))
+                offset = mo;
+            pos = p0 + corner.y * offset;
+        }
+        else
+        {
+            vec2 mo;
+            if (isFinitePoint(next) && miterOffset(n, segmentNormal(p1, next), mo))
+                offset = mo;
+            pos = p1 + corner.y * offset;
+        }
+    }
+    else
+    {
+        // Bevel triangle at p1 on the outer side of the turn; dropped where
+        // the joint is mitered or the line ends.
+        vec2 mo;
+        vec2 nNext = isFinitePoint(next) ? segmentNormal(p1, next) : n;
+        if (!isFinitePoint(next) || miterOffset(n, nNext, mo))
+        {
+            gl_Position = CULLED;
+            v_color = pc.color;
+            return;
+        }
+        pos = p1;
+        if (corner.z < 1.5)
+        {
+            float turn = n.x * nNext.y - n.y * nNext.x;
+            float side = turn > 0.0 ? -1.0 : 1.0;
+            pos = p1 + side * (corner.x < 0.5 ? n : nNext) * pc.halfWidth;
+        }
+    }
+
+    float ndcX = ((pos.x + pc.offsetX) * pc.dpr / pc.width) * 2.0 - 1.0;
+    float ndcY = pc.yFlip * (((pos.y + pc.offsetY) * pc.dpr / pc.height) * 2.0 - 1.0);
+    gl_Position = vec4(ndcX, ndcY, 0.0, 1.0);
+    v_color = pc.color;
+}
@@ -59,6 +59,12 @@ public:
     const double* rawData() const { return mData; }
     double* rawData() { return mData; }
 
+    // Cells plus the alpha map, if any.
+    quint64 memoryBytes() const
+    {
+        return quint64(mKeySize) * quint64(mValueSize) * (sizeof(double) + (mAlpha ? 1 : 0));
+    }
+
     double data(double key, double value);
     double cell(int keyIndex, int valueIndex) const;
     unsigned char alpha(int keyIndex, int valueIndex);
@@ -31,13 +31,14 @@ QCPColorMap2::QCPColorMap2(QCPAxis* keyAxis, QCPAxis* valueAxis)
                 this, [this](QCPAxis::ScaleType) { onViewportChanged(); });
     }
 
-    connect(&mPipeline, &QCPColormapPipeline::finished,
-            this, [this](uint64_t) {
-                ++mContourDataGen;
-                mRenderer.invalidateMapImage();
-                if (parentPlot())
-                    parentPlot()->replot(QCustomPlot::rpQueuedReplot);
-            });
+    auto onNewGrid = [this](uint64_t) {
+        ++mContourDataGen;
+        mRenderer.invalidateMapImage();
+        if (parentPlot())
+            parentPlot()->replot(QCustomPlot::rpQueuedReplot);
+    };
+    connect(&mPipeline, &QCPColormapPipeline::finished, this, onNewGrid);
+    connect(&mPipeline, &QCPColormapPipeline::previewReady, this, onNewGrid);
     connect(&mPipeline, &QCPColormapPipeline::busyChanged,
             this, [this](bool) { updateEffectiveBusy(); });
 }
@@ -47,6 +48,72 @@ QCPColorMap2::~QCPColorMap2()
     mRenderer.releaseRhiLayer();
 }
 
+namespace {
+
+// Output grid of a resample of `src` for `vp`: the viewport clipped to the
+// data extent, at screen resolution or finer (up to 4x) where the source has
+// the columns and rows for it. False when no source column is in view.
+struct ResampleGrid
+{
+    qsizetype xBegin = 0, xEnd = 0;
+    QCPRange xOut, yOut;
+    int pixW = 0, pixH = 0; // screen pixels covered
+    int w = 0, h = 0;       // grid size
+};
+
+bool resampleGrid(const QCPAbstractDataSource2D& src, const ViewportParams& vp, ResampleGrid& grid)
+{
+    if (src.xSize() < 2) return false;
+
+    bool found = false;
+    auto xRange = src.xRange(found);
+    if (!found) return false;
+    auto yRange = src.yRange(found);
+    if (!found) return false;
+
+    grid.xBegin = src.findXBegin(vp.keyRange.lower);
+    grid.xEnd = src.findXEnd(vp.keyRange.upper);
+    if (grid.xEnd <= grid.xBegin) return false;
+
+    // Clamp output grid to intersection of viewport and data extent.
+    // Without this, zooming out creates a grid spanning the full viewport
+    // with bins wider than source spacing, leaving most bins empty (black).
+    grid.xOut = QCPRange(std::max(vp.keyRange.lower, xRange.lower),
+                         std::min(vp.keyRange.upper, xRange.upper));
+    grid.yOut = QCPRange(std::max(vp.valueRange.lower, yRange.lower),
+                         std::min(vp.valueRange.upper, yRange.upper));
+    if (grid.xOut.lower >= grid.xOut.upper || grid.yOut.lower >= grid.yOut.upper)
+        return false;
+
+    auto logFrac = [](const QCPRange& data, const QCPRange& vp) {
+        if (data.lower <= 0 || vp.lower <= 0)
+        {
+            double vpSz = vp.size();
+            return vpSz > 0 ? data.size() / vpSz : 1.0;
+        }
+        double denom = std::log10(vp.upper) - std::log10(vp.lower);
+        return denom > 0 ? (std::log10(data.upper) - std::log10(data.lower)) / denom : 1.0;
+    };
+    double vpKeySz = vp.keyRange.size();
+    double xFrac = vpKeySz > 0 ? grid.xOut.size() / vpKeySz : 1.0;
+    double vpValSz = vp.valueRange.size();
+    double yFrac = vp.valueLogScale ? logFrac(grid.yOut, vp.valueRange)
+                                    : (vpValSz > 0 ? grid.yOut.size() / vpValSz : 1.0);
+    grid.pixW = std::clamp(static_cast<int>(vp.plotWidthPx * xFrac), 1, 32768);
+    grid.pixH = std::clamp(static_cast<int>(vp.plotHeightPx * yFrac), 1, 32768);
+
+    qsizetype visibleSrcCols = grid.xEnd - grid.xBegin;
+    grid.w = static_cast<int>(std::clamp<qsizetype>(visibleSrcCols, grid.pixW, grid.pixW * 4));
+    grid.h = std::clamp(src.ySize(), grid.pixH, grid.pixH * 4);
+    return grid.w > 0 && grid.h > 0;
+}
+
+// The preview pass renders at 1/kPreviewScale of the screen resolution in
+// each direction.
+constexpr int kPreviewScale = 4;
+
+} // namespace
+
 // The transform runs on the scheduler's pool, possibly after this plottable is
 // deleted (queued jobs are not joined with destruction) — it must be
 // self-contained: settings are captured BY VALUE and re-baked when they change.
@@ -56,58 +123,34 @@ void QCPColorMap2::installResampleTransform()
         [gapThreshold = mGapThreshold](
             const QCPAbstractDataSource2D& src,
             const ViewportParams& vp,
-            std::any& cache) -> std::shared_ptr<QCPColorMapData> {
-            if (src.xSize() < 2) return nullptr;
-
-            bool found = false;
-            auto xRange = src.xRange(found);
-            if (!found) return nullptr;
-            auto yRange = src.yRange(found);
-            if (!found) return nullptr;
-
-            int xBegin = src.findXBegin(vp.keyRange.lower);
-            int xEnd = src.findXEnd(vp.keyRange.upper);
-            if (xEnd <= xBegin) return nullptr;
-
-            // Clamp output grid to intersection of viewport and data extent.
-            // Without this, zooming out creates a grid spanning the full viewport
-            // with bins wider than source spacing, leaving most bins empty (black).
-            QCPRange xOut(std::max(vp.keyRange.lower, xRange.lower),
-                          std::min(vp.keyRange.upper, xRange.upper));
-            QCPRange yOut(std::max(vp.valueRange.lower, yRange.lower),
-                          std::min(vp.valueRange.upper, yRange.upper));
-            if (xOut.lower >= xOut.upper || yOut.lower >= yOut.upper)
-                return nullptr;
-
-            auto logFrac = [](const QCPRange& data, const QCPRange& vp) {
-                if (data.lower <= 0 || vp.lower <= 0)
-                {
-                    double vpSz = vp.size();
-                    return vpSz > 0 ? data.size() / vpSz : 1.0;
-                }
-                double denom = std::log10(vp.upper) - std::log10(vp.lower);
-                return denom > 0 ? (std::log10(data.upper) - std::log10(data.lower)) / denom : 1.0;
-            };
-            double vpKeySz = vp.keyRange.size();
-            double xFrac = vpKeySz > 0 ? xOut.size() / vpKeySz : 1.0;
-            double vpValSz = vp.valueRange.size();
-            double yFrac = vp.valueLogScale ? logFrac(yOut, vp.valueRange)
-                                            : (vpValSz > 0 ? yOut.size() / vpValSz : 1.0);
-            int pixW = std::clamp(static_cast<int>(vp.plotWidthPx * xFrac), 1, 32768);
-            int pixH = std::clamp(static_cast<int>(vp.plotHeightPx * yFrac), 1, 32768);
-
-            int visibleSrcCols = xEnd - xBegin;
-            int w = std::clamp(visibleSrcCols, pixW, pixW * 4);
-            int h = std::clamp(src.ySize(), pixH, pixH * 4);
-            if (w <= 0 || h <= 0) return nullptr;
+            std::any& cache,
+            const QCPCancellationToken& cancel) -> std::shared_ptr<QCPColorMapData> {
+            ResampleGrid grid;
+            if (!resampleGrid(src, vp, grid)) return nullptr;
 
             if (!cache.has_value())
                 cache = qcp::algo2d::ResampleCache{};
             auto& rc = std::any_cast<qcp::algo2d::ResampleCache&>(cache);
-            auto* raw = qcp::algo2d::resample(src, xBegin, xEnd,
-                xOut, yOut, w, h, vp.valueLogScale, gapThreshold, &rc);
+            auto* raw = qcp::algo2d::resample(src, grid.xBegin, grid.xEnd,
+                grid.xOut, grid.yOut, grid.w, grid.h, vp.valueLogScale, gapThreshold, &rc, false, cancel);
             return std::shared_ptr<QCPColorMapData>(raw);
         });
+    // Low-resolution first pass after a data change (and for the viewports
+    // requested before the first full result), so a large source shows up
+    // right away and sharpens once the full-resolution job lands.
+    mPipeline.setPreviewTransform(
+        [gapThreshold = mGapThreshold](
+            const QCPAbstractDataSource2D& src,
+            const ViewportParams& vp,
+            const QCPCancellationToken& cancel) -> std::shared_ptr<QCPColorMapData> {
+            ResampleGrid grid;
+            if (!resampleGrid(src, vp, grid)) return nullptr;
+            const int w = std::min(grid.w, std::max(2, grid.pixW / kPreviewScale));
+            const int h = std::min(grid.h, std::max(2, grid.pixH / kPreviewScale));
+            return std::shared_ptr<QCPColorMapData>(qcp::algo2d::resamplePreview(
+                src, grid.xBegin, grid.xEnd, grid.xOut, grid.yOut, w, h,
+                vp.valueLogScale, gapThreshold, cancel));
+        });
 }
 
 void QCPColorMap2::setGapThreshold(double threshold)
@@ -274,7 +317,7 @@ bool QCPColorMap2::canProduceContent() const
 {
     if (!mKeyAxis || !mValueAxis || !mDataSource)
         return false;
-    return mPipeline.result() != nullptr;
+    return mPipeline.result() || mPipeline.preview();
 }
 
 void QCPColorMap2::draw(QCPPainter* painter)
@@ -283,7 +326,9 @@ void QCPColorMap2::draw(QCPPainter* painter)
     if (!mKeyAxis || !mValueAxis)
         return;
 
-    auto* resampledData = mPipeline.result();
+    // A preview is only held while it is newer than the result (the pipeline
+    // drops it when a full result lands).
+    auto* resampledData = mPipeline.preview() ? mPipeline.preview() : mPipeline.result();
     if (!resampledData)
     {
         if (!mDataSource) return;
@@ -570,3 +615,24 @@ void QCPColorMap2::updateContourGpu(const QCPColorMapData* data)
 
     mRenderer.setContourLines(std::move(uvVerts), mContourPen.color());
 }
+
+void QCPColorMap2::accountMemory(QCPMemoryUsage& usage) const
+{
+    // Resampling scratch grids, reused by the next viewport job.
+    mPipeline.inspectCache([&usage](const std::any& cache) {
+        if (auto* rc = std::any_cast<qcp::algo2d::ResampleCache>(&cache))
+            usage.add(QCPMemoryUsage::msColormap, rc->memoryBytes());
+    });
+    if (const QCPColorMapData* data = mPipeline.result())
+        usage.add(QCPMemoryUsage::msResampled, data->memoryBytes());
+    if (const QCPColorMapData* preview = mPipeline.preview())
+        usage.add(QCPMemoryUsage::msResampled, preview->memoryBytes());
+    mRenderer.accountMemory(usage);
+}
+
+// Only scratch state goes; the resampled grid and its image are what is on screen.
+void QCPColorMap2::releaseCaches()
+{
+    mPipeline.releaseCache();
+    mRenderer.releaseCaches();
+}
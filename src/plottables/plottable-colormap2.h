@@ -37,7 +37,7 @@ public:
 
     // Non-owning views
     template <typename X, typename Y, typename Z>
-    void viewData(const X* x, int nx, const Y* y, int ny, const Z* z, int nz)
+    void viewData(const X* x, qsizetype nx, const Y* y, int ny, const Z* z, qsizetype nz)
     {
         setDataSource(std::make_shared<QCPSoADataSource2D<
             std::span<const X>, std::span<const Y>, std::span<const Z>>>(
@@ -93,6 +93,9 @@ public:
     void setAutoContourLevels(int count);
     [[nodiscard]] int autoContourLevelCount() const { return mAutoContourCount; }
 
+    void accountMemory(QCPMemoryUsage& usage) const override;
+    void releaseCaches() override;
+
 public Q_SLOTS:
     void setGradient(const QCPColorGradient& gradient);
     void setDataRange(const QCPRange& range);
@@ -1,10 +1,12 @@
 #include "plottable-draw-utils.h"
 
 #include "../core.h"
+#include "../datasource/pixel-line.h"
 #include "../painting/line-extruder.h"
 #include "../painting/painter.h"
 #include "../painting/plottable-rhi-layer.h"
 
+#include <atomic>
 #include <cmath>
 
 namespace {
@@ -27,10 +29,145 @@ void drawPolylineSplitNaN(QCPPainter* painter, const QVector<QPointF>& pts)
         painter->drawPolyline(pts.constData() + segStart, segLen);
 }
 
+float gpuPenWidth(const QPen& pen, double dpr)
+{
+    return (pen.isCosmetic() || qFuzzyIsNull(pen.widthF()))
+        ? static_cast<float>(1.0 / dpr)
+        : qMax(1.0f, static_cast<float>(pen.widthF()));
+}
+
+// Absolute (x, y) floats of a polyline, for shader-side extrusion.
+template <typename Points>
+void copyPoints(const Points& pts, std::vector<float>& out)
+{
+    out.resize(static_cast<std::size_t>(pts.size()) * 2);
+    for (qsizetype i = 0; i < pts.size(); ++i)
+    {
+        const QPointF p = pts[i];
+        out[2 * i] = static_cast<float>(p.x());
+        out[2 * i + 1] = static_cast<float>(p.y());
+    }
+}
+
+// Pen dash pattern in logical pixels. False when the GPU cannot draw the pen;
+// true with an empty pattern for solid lines.
+bool gpuDashPattern(const QPen& pen, QCPPlottableRhiLayer::DashPattern& dash)
+{
+    dash = {};
+    if (pen.style() == Qt::SolidLine)
+        return true;
+    if (pen.style() == Qt::NoPen)
+        return false;
+
+    const QList<qreal> pattern = pen.dashPattern();
+    if (pattern.isEmpty() || pattern.size() % 2 != 0
+        || pattern.size() > QCPPlottableRhiLayer::kMaxDashes)
+        return false;
+
+    // QPen patterns are in units of the pen width, as QPainter strokes them
+    const double unit = qMax(1.0, pen.widthF());
+    double period = 0;
+    for (int k = 0; k < pattern.size(); ++k)
+    {
+        if (!(pattern[k] >= 0))
+            return false;
+        dash.lengths[k] = static_cast<float>(pattern[k] * unit);
+        period += dash.lengths[k];
+    }
+    if (period <= 0)
+        return false;
+    dash.count = static_cast<int>(pattern.size());
+    dash.offset = static_cast<float>(std::fmod(pen.dashOffset() * unit, period));
+    if (dash.offset < 0)
+        dash.offset += static_cast<float>(period);
+    return true;
+}
+
+bool useShaderExtrusion(QCustomPlot* parentPlot, const QCPPlottableRhiLayer* prl)
+{
+    return parentPlot->plottingHints().testFlag(QCP::phGpuLineExtrusion)
+        && prl->supportsShaderExtrusion();
+}
+
+// GPU half of drawPolylineCached: re-extrudes `pts` into `cache` when stale
+// and queues the cached vertices. False when the GPU path is unavailable.
+template <typename Points>
+bool drawCachedOnGpu(QCPPainter* painter, QCustomPlot* parentPlot, QCPLayer* layer,
+                     const Points& pts, const QPen& pen, const QPointF& gpuOffset,
+                     const QRect& clipRect, bool freshLines, qcp::ExtrusionCache& cache)
+{
+    if (!parentPlot || !parentPlot->rhi()
+        || painter->modes().testFlag(QCPPainter::pmVectorized)
+        || painter->modes().testFlag(QCPPainter::pmNoCaching))
+        return false;
+    QCPPlottableRhiLayer::DashPattern dash;
+    if (!gpuDashPattern(pen, dash))
+        return false;
+    auto* prl = parentPlot->plottableRhiLayer(layer);
+    const bool dashed = dash.count > 0;
+    if (!prl || (dashed && !prl->supportsDashes()))
+        return false;
+
+    const double dpr = parentPlot->bufferDevicePixelRatio();
+    const float penWidth = gpuPenWidth(pen, dpr);
+
+    // Dashed lines carry the arc length, which only the CPU extrusion emits
+    const bool shaderExtrusion = !dashed && useShaderExtrusion(parentPlot, prl);
+
+    // Raw points do not depend on the pen width; extruded vertices do.
+    const bool rebuild = freshLines || cache.isEmpty() || cache.shaderExtruded != shaderExtrusion
+        || cache.dashed != dashed
+        || (!shaderExtrusion && cache.penWidth != penWidth);
+    if (rebuild)
+    {
+        if (shaderExtrusion)
+            copyPoints(pts, cache.vertices);
+        else if (dashed)
+            QCPLineExtruder::extrudeDashedPolyline(pts, penWidth, cache.vertices);
+        else
+            QCPLineExtruder::extrudePolyline(pts, penWidth, cache.vertices);
+        cache.penWidth = penWidth;
+        cache.shaderExtruded = shaderExtrusion;
+        cache.dashed = dashed;
+    }
+
+    if (cache.isEmpty())
+        return true;
+
+    const QSize outputSize = parentPlot->rhiOutputSize();
+    // The cache keys its range of the layer's vertex buffer: an unchanged
+    // line is neither copied nor uploaded again when its layer replots.
+    if (cache.dashed)
+        prl->addDashedPlottable(cache.vertices, pen.color(), dash, clipRect, dpr,
+                                 outputSize.height(),
+                                 static_cast<float>(gpuOffset.x()),
+                                 static_cast<float>(gpuOffset.y()),
+                                 cache.key, rebuild);
+    else if (cache.shaderExtruded)
+        prl->addPolyline(cache.vertices, pen.color(), penWidth, clipRect, dpr,
+                         outputSize.height(),
+                         static_cast<float>(gpuOffset.x()),
+                         static_cast<float>(gpuOffset.y()),
+                         cache.key, rebuild);
+    else
+        prl->addPlottable(cache.vertices, pen.color(), clipRect, dpr,
+                           outputSize.height(),
+                           static_cast<float>(gpuOffset.x()),
+                           static_cast<float>(gpuOffset.y()),
+                           cache.key, rebuild);
+    return true;
+}
+
 } // anonymous namespace
 
 namespace qcp {
 
+quint64 ExtrusionCache::newKey()
+{
+    static std::atomic<quint64> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
 void drawPolylineWithGpuFallback(QCPPainter* painter,
                                   QCustomPlot* parentPlot,
                                   QCPLayer* layer,
@@ -39,22 +176,47 @@ void drawPolylineWithGpuFallback(QCPPainter* painter,
                                   const QPointF& gpuOffset,
                                   const QRect& clipRect)
 {
+    QCPPlottableRhiLayer::DashPattern dash;
     if (auto* rhi = parentPlot ? parentPlot->rhi() : nullptr;
         rhi && !painter->modes().testFlag(QCPPainter::pmVectorized)
             && !painter->modes().testFlag(QCPPainter::pmNoCaching)
-            && pen.style() == Qt::SolidLine)
+            && gpuDashPattern(pen, dash))
     {
-        if (auto* prl = parentPlot->plottableRhiLayer(layer))
+        auto* prl = parentPlot->plottableRhiLayer(layer);
+        if (prl && dash.count > 0 && !prl->supportsDashes())
+            prl = nullptr;
+        if (prl)
         {
             const double dpr = parentPlot->bufferDevicePixelRatio();
-            const float penWidth = (pen.isCosmetic() || qFuzzyIsNull(pen.widthF()))
-                ? static_cast<float>(1.0 / dpr)
-                : qMax(1.0f, static_cast<float>(pen.widthF()));
-            auto strokeVerts = QCPLineExtruder::extrudePolyline(pts, penWidth, pen.color());
-            if (!strokeVerts.isEmpty())
+            const float penWidth = gpuPenWidth(pen, dpr);
+            const QSize outputSize = parentPlot->rhiOutputSize();
+            if (dash.count > 0)
             {
-                const QSize outputSize = parentPlot->rhiOutputSize();
-                prl->addPlottable({}, strokeVerts, clipRect, dpr,
+                std::vector<float> strokeVerts;
+                QCPLineExtruder::extrudeDashedPolyline(pts, penWidth, strokeVerts);
+                if (!strokeVerts.empty())
+                {
+                    prl->addDashedPlottable(strokeVerts, pen.color(), dash, clipRect, dpr,
+                                             outputSize.height(),
+                                             static_cast<float>(gpuOffset.x()),
+                                             static_cast<float>(gpuOffset.y()));
+                    return;
+                }
+            }
+            else if (useShaderExtrusion(parentPlot, prl))
+            {
+                std::vector<float> points;
+                copyPoints(pts, points);
+                prl->addPolyline(points, pen.color(), penWidth, clipRect, dpr,
+                                 outputSize.height(),
+                                 static_cast<float>(gpuOffset.x()),
+                                 static_cast<float>(gpuOffset.y()));
+                return;
+            }
+            else if (auto strokeVerts = QCPLineExtruder::extrudePolyline(pts, penWidth);
+                     !strokeVerts.isEmpty())
+            {
+                prl->addPlottable(strokeVerts, pen.color(), clipRect, dpr,
                                    outputSize.height(),
                                    static_cast<float>(gpuOffset.x()),
                                    static_cast<float>(gpuOffset.y()));
@@ -83,39 +245,28 @@ void drawPolylineCached(QCPPainter* painter,
                          bool freshLines,
                          ExtrusionCache& cache)
 {
-    if (auto* rhi = parentPlot ? parentPlot->rhi() : nullptr;
-        rhi && !painter->modes().testFlag(QCPPainter::pmVectorized)
-            && !painter->modes().testFlag(QCPPainter::pmNoCaching)
-            && pen.style() == Qt::SolidLine)
-    {
-        if (auto* prl = parentPlot->plottableRhiLayer(layer))
-        {
-            const double dpr = parentPlot->bufferDevicePixelRatio();
-            const float penWidth = (pen.isCosmetic() || qFuzzyIsNull(pen.widthF()))
-                ? static_cast<float>(1.0 / dpr)
-                : qMax(1.0f, static_cast<float>(pen.widthF()));
-
-            if (freshLines || cache.isEmpty()
-                || cache.penWidth != penWidth || cache.penColor != pen.color().rgba())
-            {
-                QCPLineExtruder::extrudePolyline(pts, penWidth, pen.color(), cache.vertices);
-                cache.penWidth = penWidth;
-                cache.penColor = pen.color().rgba();
-            }
-
-            if (cache.isEmpty())
-                return;
-
-            const QSize outputSize = parentPlot->rhiOutputSize();
-            prl->addPlottable({}, cache.vertices, clipRect, dpr,
-                               outputSize.height(),
-                               static_cast<float>(gpuOffset.x()),
-                               static_cast<float>(gpuOffset.y()));
-            return;
-        }
-    }
+    if (drawCachedOnGpu(painter, parentPlot, layer, pts, pen, gpuOffset, clipRect,
+                        freshLines, cache))
+        return;
     // Software fallback — no caching benefit, delegate to regular path
     drawPolylineWithGpuFallback(painter, parentPlot, layer, pts, pen, gpuOffset, clipRect);
 }
 
+void drawPolylineCached(QCPPainter* painter,
+                         QCustomPlot* parentPlot,
+                         QCPLayer* layer,
+                         const QCPPixelLine& line,
+                         const QPen& pen,
+                         const QPointF& gpuOffset,
+                         const QRect& clipRect,
+                         bool freshLines,
+                         ExtrusionCache& cache)
+{
+    if (drawCachedOnGpu(painter, parentPlot, layer, line, pen, gpuOffset, clipRect,
+                        freshLines, cache))
+        return;
+    drawPolylineWithGpuFallback(painter, parentPlot, layer, line.toPointF(), pen, gpuOffset,
+                                clipRect);
+}
+
 } // namespace qcp
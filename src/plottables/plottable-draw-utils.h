@@ -9,6 +9,7 @@
 class QCustomPlot;
 class QCPPainter;
 class QCPLayer;
+struct QCPPixelLine;
 
 namespace qcp {
 
@@ -16,17 +17,29 @@ namespace qcp {
 /// Stores the untranslated GPU vertices so they can be reused across frames
 /// with only a cheap translation applied. Uses std::vector to retain capacity
 /// across frames (no COW overhead, no detach on non-const data()).
+/// Vertices are positions only; the pen color is supplied per draw, so a
+/// color change reuses the cache. With QCP::phGpuLineExtrusion the cache holds
+/// the polyline points instead, extruded by the vertex shader. Dashed pens add
+/// the arc length per vertex; the dash pattern itself is applied per draw.
 struct ExtrusionCache {
-    std::vector<float> vertices;   // untranslated extruded verts (6 floats per vertex)
+    std::vector<float> vertices;   // untranslated extruded verts (x, y per vertex)
     float penWidth = 0;
-    QRgb penColor = 0;
+    bool shaderExtruded = false;   // vertices are the raw points (x, y per point)
+    bool dashed = false;           // (x, y, arc length) per vertex
+    // Names the cache's range of the GPU layer's vertex buffer across replots.
+    // Unique per constructed cache, so a cache reallocated at another's
+    // address never picks up stale geometry.
+    quint64 key = newKey();
+
+    static quint64 newKey();
 
     void clear() { vertices.clear(); }
     [[nodiscard]] bool isEmpty() const { return vertices.empty(); }
 };
 
 /// Draw a polyline using the GPU path if available, otherwise QPainter.
-/// The GPU path is disabled during export (pmVectorized, pmNoCaching).
+/// The GPU path is disabled during export (pmVectorized, pmNoCaching) and
+/// for dash patterns it cannot express (see QCPPlottableRhiLayer::DashPattern).
 /// When gpuOffset is non-null, points are pre-translated so other plottables
 /// on the same shared layer are unaffected.
 /// @param clipRect the plottable's clip rect (passed explicitly to avoid protected access)
@@ -51,4 +64,16 @@ void drawPolylineCached(QCPPainter* painter,
                          bool freshLines,
                          ExtrusionCache& cache);
 
+/// Same, from a float32 pixel line. Without the GPU path the line is widened
+/// to QPointF for QPainter.
+void drawPolylineCached(QCPPainter* painter,
+                         QCustomPlot* parentPlot,
+                         QCPLayer* layer,
+                         const QCPPixelLine& line,
+                         const QPen& pen,
+                         const QPointF& gpuOffset,
+                         const QRect& clipRect,
+                         bool freshLines,
+                         ExtrusionCache& cache);
+
 } // namespace qcp
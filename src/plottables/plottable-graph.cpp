@@ -1012,10 +1012,10 @@ void QCPGraph::drawFill(QCPPainter* painter, QVector<QPointF>* lines) const
                 for (QCPDataRange segment : segments)
                 {
                     auto fillVerts = QCPLineExtruder::tessellateFillPolygon(
-                        getFillPolygon(lines, segment), brushColor);
+                        getFillPolygon(lines, segment));
                     if (!fillVerts.isEmpty())
                     {
-                        prl->addPlottable(fillVerts, {}, clipRect(), dpr,
+                        prl->addPlottable(fillVerts, brushColor, clipRect(), dpr,
                                            outHeight);
                     }
                 }
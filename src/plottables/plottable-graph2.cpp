@@ -4,6 +4,7 @@
 #include "plottable-linestyle.h"
 #include "Profiling.hpp"
 #include "../datasource/graph-resampler.h"
+#include "../datasource/l1-cache-registry.h"
 
 #include "../axis/axis.h"
 #include "../core.h"
@@ -16,6 +17,15 @@
 #include <array>
 #include <random>
 
+namespace {
+
+// Double-precision view of either line representation, for the QPointF-only
+// helpers (step styles, impulses, QPainter fallback).
+const QVector<QPointF>& asPointF(const QVector<QPointF>& lines) { return lines; }
+QVector<QPointF> asPointF(const QCPPixelLine& lines) { return lines.toPointF(); }
+
+} // namespace
+
 QCPGraph2::QCPGraph2(QCPAxis* keyAxis, QCPAxis* valueAxis)
     : QCPAbstractPlottable(keyAxis, valueAxis)
     , mPipeline(parentPlot() ? parentPlot()->pipelineScheduler() : nullptr, this)
@@ -27,8 +37,9 @@ QCPGraph2::QCPGraph2(QCPAxis* keyAxis, QCPAxis* valueAxis)
     {
         connect(keyAxis, QOverload<const QCPRange&>::of(&QCPAxis::rangeChanged),
                 this, &QCPGraph2::onViewportChanged);
+        // L2 bins are log-spaced on a log key axis: re-bin on a scale switch
         connect(keyAxis, &QCPAxis::scaleTypeChanged,
-                this, [this] { mLineCacheDirty = true; mCachedLines.clear(); });
+                this, [this] { mLineCacheDirty = true; mCachedLines.clear(); mL2Dirty = true; });
     }
     if (valueAxis)
     {
@@ -38,6 +49,12 @@ QCPGraph2::QCPGraph2(QCPAxis* keyAxis, QCPAxis* valueAxis)
 
     connect(&mPipeline, &QCPGraphPipeline::finished,
             this, [this](uint64_t) { onL1Ready(); });
+    connect(&mPipeline, &QCPGraphPipeline::previewReady,
+            this, [this](uint64_t) {
+                mLineCacheDirty = true;
+                if (parentPlot())
+                    parentPlot()->replot(QCustomPlot::rpQueuedReplot);
+            });
     connect(&mPipeline, &QCPGraphPipeline::busyChanged,
             this, [this](bool) { updateEffectiveBusy(); });
 
@@ -65,25 +82,50 @@ void QCPGraph2::setScatterColorGradient(const QCPColorGradient& gradient)
     mScatterColorMapImage = img;
 }
 
-static void ensureL1Transform(QCPGraphPipeline& pipeline, int sourceSize)
+void QCPGraph2::updateL1Transform(bool chained,
+                                  std::shared_ptr<const qcp::algo::GraphResamplerCache> previous)
 {
-    if (sourceSize >= qcp::algo::kResampleThreshold)
+    if (!mDataSource || mDataSource->size() < qcp::algo::kResampleThreshold)
     {
-        if (!pipeline.hasTransform())
-        {
-            // Pipeline only builds L1 cache — L2 is done synchronously
-            pipeline.setTransform(TransformKind::ViewportIndependent,
-                [](const QCPAbstractDataSource& src,
-                   const ViewportParams& vp,
-                   std::any& cache) -> std::shared_ptr<QCPAbstractDataSource> {
-                    return qcp::algo::buildL1Cache(src, vp, cache);
-                });
-        }
+        if (mPipeline.hasTransform())
+            mPipeline.clearTransform();
+        mL1Chain.reset();
+        return;
     }
-    else if (pipeline.hasTransform())
+    // A chained transform stays installed across appends: the chain hands
+    // each job the newest L1 finished before it.
+    if (chained && mL1Chain)
     {
-        pipeline.clearTransform();
+        mL1Chain->offer(previous);
+        if (previous)
+            mPipeline.setPreviewTransform({});
+        return;
     }
+    if (!chained && !mL1Chain && mPipeline.hasTransform())
+        return;
+    // Pipeline only builds L1 cache — L2 is done synchronously. Full builds go
+    // through the registry, shared with the other graphs of the same source;
+    // an append-only store's L1 is this graph's own, extended by each batch.
+    mL1Chain = chained ? std::make_shared<qcp::algo::L1ExtensionChain>(previous) : nullptr;
+    mPipeline.setTransform(TransformKind::ViewportIndependent,
+        [chain = mL1Chain](const QCPAbstractDataSource& src,
+                           const ViewportParams& vp,
+                           std::any& cache,
+                           const QCPCancellationToken& cancel) -> std::shared_ptr<QCPAbstractDataSource> {
+            if (chain)
+                return qcp::algo::buildChainedL1Cache(src, vp, cache, *chain, cancel.cacheToken());
+            return qcp::algo::buildSharedL1Cache(src, vp, cache, cancel.cacheToken());
+        });
+    // A full build leaves nothing to draw for its duration; an extending one
+    // keeps showing the previous L1.
+    if (previous)
+        mPipeline.setPreviewTransform({});
+    else
+        mPipeline.setPreviewTransform(
+            [](const QCPAbstractDataSource& src, const ViewportParams& vp,
+               const QCPCancellationToken& cancel) {
+                return qcp::algo::buildPreview(src, vp, cancel);
+            });
 }
 
 void QCPGraph2::setDataSource(std::unique_ptr<QCPAbstractDataSource> source)
@@ -94,29 +136,71 @@ void QCPGraph2::setDataSource(std::unique_ptr<QCPAbstractDataSource> source)
 void QCPGraph2::setDataSource(std::shared_ptr<QCPAbstractDataSource> source)
 {
     mDataSource = std::move(source);
+    mAppendable.reset();
     mL1Cache.reset();
     mL2Result.reset();
     mCachedLines.clear();
     mLineCacheDirty = true;
     mL2Dirty = false;
+    mL1Released = false;
     mNeedsResampling = mDataSource && mDataSource->size() >= qcp::algo::kResampleThreshold;
     if (mDataSource)
-        ensureL1Transform(mPipeline, mDataSource->size());
+        updateL1Transform();
     mPipeline.setSource(mDataSource);
 }
 
+void QCPGraph2::applyAppendedSource(std::shared_ptr<QCPAbstractDataSource> snapshot,
+                                    bool extendsPrevious)
+{
+    // The snapshot extends the previous one, so the current L1 stays valid for
+    // its prefix: keep showing it (stale but correct) while the pipeline bins
+    // only the appended tail. A freshly seeded store may have converted the old
+    // data to other types, so that first batch rebuilds from scratch.
+    if (!extendsPrevious)
+    {
+        mL1Cache.reset();
+        mL2Result.reset();
+        mL2Dirty = false;
+    }
+    mDataSource = std::move(snapshot);
+    mLineCacheDirty = true;
+    mL1Released = false;
+    mNeedsResampling = mDataSource->size() >= qcp::algo::kResampleThreshold;
+    if (!extendsPrevious)
+        mL1Chain.reset();
+    updateL1Transform(true, mL1Cache);
+    if (!mPipeline.hasTransform())
+    {
+        mL1Cache.reset();
+        mL2Result.reset();
+    }
+    // Cache work in flight stays valid for an extension — even a full build of
+    // an earlier snapshot: the next job chains from it rather than re-binning
+    // what it covers.
+    if (extendsPrevious && mL1Chain)
+        mPipeline.appendSource(mDataSource);
+    else
+        mPipeline.setSource(mDataSource);
+    if (!mPipeline.hasTransform() && mParentPlot)
+        mParentPlot->replot(QCustomPlot::rpQueuedReplot);
+}
+
 void QCPGraph2::dataChanged()
 {
     mLineCacheDirty = true;
+    if (mDataSource)
+        QCPL1CacheRegistry::instance().invalidate(mDataSource.get());
 
     bool wasResampling = mNeedsResampling;
     mNeedsResampling = mDataSource && mDataSource->size() >= qcp::algo::kResampleThreshold;
 
-    // Update the L1 transform when crossing the resampling threshold in either direction
-    if (mNeedsResampling != wasResampling)
+    // Update the L1 transform when crossing the resampling threshold in either
+    // direction, and drop any previous L1 baked in by addData(): in-place
+    // mutation gives no append-only guarantee.
+    if (mNeedsResampling != wasResampling || mL1Chain)
     {
         if (mDataSource)
-            ensureL1Transform(mPipeline, mDataSource->size());
+            updateL1Transform();
         else if (mPipeline.hasTransform())
             mPipeline.clearTransform();
     }
@@ -125,6 +209,7 @@ void QCPGraph2::dataChanged()
     {
         mL1Cache.reset();
         mL2Dirty = false;
+        mL1Released = false;
         mPipeline.onDataChanged();
     }
     else if (mParentPlot)
@@ -135,28 +220,65 @@ void QCPGraph2::onL1Ready()
 {
     PROFILE_HERE_N("QCPGraph2::onL1Ready");
     qcp::extractL1Cache<qcp::algo::GraphResamplerCache>(mPipeline.cache(), mL1Cache, mL2Dirty);
+    if (mL1Cache)
+        mPipeline.clearPreview();
     mLineCacheDirty = true;
     if (parentPlot())
         parentPlot()->replot(QCustomPlot::rpQueuedReplot);
 }
 
+void QCPGraph2::accountMemory(QCPMemoryUsage& usage) const
+{
+    // An L1 shared through QCPL1CacheRegistry is split between its holders.
+    if (mL1Cache)
+        usage.addShared(QCPMemoryUsage::msL1Cache, mL1Cache->memoryBytes(), mL1Cache.use_count());
+    if (mL2Result)
+        usage.add(QCPMemoryUsage::msResampled, quint64(mL2Result->size()) * mL2Result->sampleBytes());
+    if (auto* preview = mPipeline.preview())
+        usage.add(QCPMemoryUsage::msResampled, quint64(preview->size()) * preview->sampleBytes());
+    usage.add(QCPMemoryUsage::msLineCache, mCachedLines.capacityBytes());
+    usage.add(QCPMemoryUsage::msExtrusion, mExtrusionCache.vertices.capacity() * sizeof(float));
+    usage.add(QCPMemoryUsage::msScatter, mScatterPts.capacity() * sizeof(float)
+                                             + mScatterSubset.capacity() * sizeof(qsizetype));
+}
+
+void QCPGraph2::releaseCaches()
+{
+    if (mL1Cache)
+    {
+        mL1Cache.reset();
+        mL1Released = true;
+    }
+    mL2Result.reset();
+    mL2Dirty = false;
+    mPipeline.clearPreview();
+    mCachedLines = QCPPixelLine();
+    mLineCacheDirty = true;
+    mExtrusionCache = qcp::ExtrusionCache();
+    mScatterPts = std::vector<float>();
+    mScatterSubset = std::vector<qsizetype>();
+}
+
 void QCPGraph2::rebuildL2(const ViewportParams& vp)
 {
     PROFILE_HERE_N("QCPGraph2::rebuildL2");
     if (!mL1Cache) return;
-    if (vp.keyLogScale)
-    {
-        mL2Result.reset(); // L2 not supported for log scale — fall back to raw data
-        return;
-    }
-    mL2Result = qcp::algo::resampleL2(*mL1Cache, vp);
+    mL2Result = qcp::algo::resampleL2(*mL1Cache, vp, mDataSource.get());
 }
 
 // --- QCPPlottableInterface1D ---
 
+// The legacy 1D interface is int-indexed; sources past 2^31 samples are
+// exposed there truncated. Selection (QCPDataRange) and rendering use the
+// source's 64-bit indices directly.
+static int clampToInt(qsizetype i)
+{
+    return static_cast<int>(std::min<qsizetype>(i, std::numeric_limits<int>::max()));
+}
+
 int QCPGraph2::dataCount() const
 {
-    return mDataSource ? mDataSource->size() : 0;
+    return mDataSource ? clampToInt(mDataSource->size()) : 0;
 }
 
 double QCPGraph2::dataMainKey(int index) const
@@ -191,12 +313,12 @@ QPointF QCPGraph2::dataPixelPosition(int index) const
 
 int QCPGraph2::findBegin(double sortKey, bool expandedRange) const
 {
-    return mDataSource ? mDataSource->findBegin(sortKey, expandedRange) : 0;
+    return mDataSource ? clampToInt(mDataSource->findBegin(sortKey, expandedRange)) : 0;
 }
 
 int QCPGraph2::findEnd(double sortKey, bool expandedRange) const
 {
-    return mDataSource ? mDataSource->findEnd(sortKey, expandedRange) : 0;
+    return mDataSource ? clampToInt(mDataSource->findEnd(sortKey, expandedRange)) : 0;
 }
 
 QCPDataSelection QCPGraph2::selectTestRect(const QRectF& rect, bool onlySelectable) const
@@ -215,11 +337,11 @@ QCPDataSelection QCPGraph2::selectTestRect(const QRectF& rect, bool onlySelectab
     QCPRange keyRange(key1, key2);
     QCPRange valueRange(value1, value2);
 
-    int begin = mDataSource->findBegin(keyRange.lower, false);
-    int end = mDataSource->findEnd(keyRange.upper, false);
+    qsizetype begin = mDataSource->findBegin(keyRange.lower, false);
+    qsizetype end = mDataSource->findEnd(keyRange.upper, false);
 
-    int currentSegmentBegin = -1;
-    for (int i = begin; i < end; ++i)
+    qsizetype currentSegmentBegin = -1;
+    for (qsizetype i = begin; i < end; ++i)
     {
         double k = mDataSource->keyAt(i);
         double v = mDataSource->valueAt(i);
@@ -261,19 +383,19 @@ double QCPGraph2::selectTest(const QPointF& pos, bool onlySelectable, QVariant*
     // Keys are sorted — binary search for the nearest key, then check
     // at most 2 neighbors.  O(log N) instead of O(M).
     const QCPAbstractDataSource* ds = mDataSource.get();
-    const int n = ds->size();
+    const qsizetype n = ds->size();
 
     double posKey, dummy;
     pixelsToCoords(pos, posKey, dummy);
 
-    int idx = ds->findEnd(posKey, /*expandedRange=*/false);
-    int lo = qMax(0, idx - 1);
-    int hi = qMin(idx, n - 1);
+    qsizetype idx = ds->findEnd(posKey, /*expandedRange=*/false);
+    qsizetype lo = qMax<qsizetype>(0, idx - 1);
+    qsizetype hi = qMin(idx, n - 1);
 
     double minDistSqr = (std::numeric_limits<double>::max)();
-    int minDistIndex = -1;
+    qsizetype minDistIndex = -1;
 
-    for (int i = lo; i <= hi; ++i)
+    for (qsizetype i = lo; i <= hi; ++i)
     {
         double k = ds->keyAt(i);
         double v = ds->valueAt(i);
@@ -332,7 +454,8 @@ bool QCPGraph2::canProduceContent() const
 {
     if (!mKeyAxis || !mValueAxis || !mDataSource || mDataSource->empty())
         return false;
-    if (mNeedsResampling && !mL1Cache && !mL2Result)
+    // A released L1 is requested again by draw(); nothing of it is on screen.
+    if (mNeedsResampling && !mL1Cache && !mL2Result && !mPipeline.preview() && !mL1Released)
         return false;
     return true;
 }
@@ -364,6 +487,14 @@ void QCPGraph2::draw(QCPPainter* painter)
     if (!mKeyAxis || !mValueAxis || !mDataSource)
         return;
 
+    // Rebuild an L1 dropped by releaseCaches() now that it is needed again.
+    if (mL1Released)
+    {
+        mL1Released = false;
+        if (mNeedsResampling && mPipeline.hasTransform())
+            mPipeline.requestCache();
+    }
+
     // Export path: synchronous fallback when no L1 cache yet
     if (!mL1Cache && mNeedsResampling
         && painter->modes().testFlag(QCPPainter::pmNoCaching))
@@ -391,8 +522,10 @@ void QCPGraph2::draw(QCPPainter* painter)
              || painter->modes().testFlag(QCPPainter::pmNoCaching)
              || mKeyAxis->scaleType() == QCPAxis::stLogarithmic)
         ds = mDataSource.get();
+    else if (mPipeline.preview())
+        ds = mPipeline.preview(); // L1 still building: coarse envelope meanwhile
     else
-        return; // Pipeline active, no L1 yet — wait
+        return; // Pipeline active, no L1 or preview yet — wait
 
     if (!ds || ds->empty())
         return;
@@ -405,7 +538,7 @@ void QCPGraph2::draw(QCPPainter* painter)
         return;
 
     const QCPRange keyRange = mKeyAxis->range();
-    int begin, end;
+    qsizetype begin, end;
     if (scatterOnly)
     {
         begin = 0;
@@ -431,14 +564,16 @@ void QCPGraph2::draw(QCPPainter* painter)
         mHasRenderedRange, mRenderedRange.key, mRenderedRange.value,
         mKeyAxis.data(), mValueAxis.data(), isExportMode);
 
-    QVector<QPointF> lines;
-    int linesBeginIndex = 0;
+    const bool hasColorAxis = !mScatterColorValues.empty();
+    const bool optimizedLines = mAdaptiveSampling && !hasColorAxis && !scatterOnly;
+    const int pixDim = keyIsVertical
+        ? static_cast<int>(mKeyAxis->axisRect()->height())
+        : static_cast<int>(mKeyAxis->axisRect()->width());
+    qsizetype cacheBegin = 0, cacheEnd = 0;
     if (needFreshLines)
     {
-        int cacheBegin, cacheEnd;
         if (scatterOnly)
         {
-            cacheBegin = 0;
             cacheEnd = ds->size();
         }
         else
@@ -449,90 +584,6 @@ void QCPGraph2::draw(QCPPainter* painter)
             cacheBegin = ds->findBegin(keyRange.lower - margin);
             cacheEnd = ds->findEnd(keyRange.upper + margin);
         }
-
-        const bool hasColorAxis = !mScatterColorValues.empty();
-        if (mAdaptiveSampling && !hasColorAxis && !scatterOnly)
-        {
-            const int pixDim = keyIsVertical
-                ? static_cast<int>(mKeyAxis->axisRect()->height())
-                : static_cast<int>(mKeyAxis->axisRect()->width());
-            lines = ds->getOptimizedLineData(
-                cacheBegin, cacheEnd, pixDim, mKeyAxis.data(), mValueAxis.data());
-        }
-        else
-        {
-            lines = ds->getLines(cacheBegin, cacheEnd, mKeyAxis.data(), mValueAxis.data());
-        }
-        linesBeginIndex = cacheBegin;
-
-        if (!isExportMode)
-        {
-            mCachedLines = lines;
-            mCachedLinesBeginIndex = cacheBegin;
-            mRenderedRange = {mKeyAxis->range(), mValueAxis->range()};
-            mHasRenderedRange = true;
-            mLineCacheDirty = false;
-            mCachedPlotSize = currentPlotSize;
-            mExtrusionCache.clear();
-            gpuOffset = {};
-        }
-    }
-    else
-    {
-        lines = mCachedLines;
-        linesBeginIndex = mCachedLinesBeginIndex;
-    }
-
-    if (lines.isEmpty())
-        return;
-
-    const QPen drawPen = selected() && mSelectionDecorator
-        ? mSelectionDecorator->pen() : mPen;
-
-    if (mLineStyle != lsNone && drawPen.style() != Qt::NoPen && drawPen.color().alpha() != 0)
-    {
-        auto drawPoly = [&](const QVector<QPointF>& pts) {
-            applyDefaultAntialiasingHint(painter);
-            if (!isExportMode) {
-                qcp::drawPolylineCached(painter, mParentPlot, mLayer, pts,
-                                         drawPen, gpuOffset, clipRect(),
-                                         needFreshLines, mExtrusionCache);
-            } else {
-                qcp::drawPolylineWithGpuFallback(painter, mParentPlot, mLayer, pts,
-                                                  drawPen, gpuOffset, clipRect());
-            }
-        };
-
-        // Only compute step-transform when the extrusion cache needs rebuilding —
-        // on cache-hit pan frames, drawPolylineCached ignores pts entirely.
-        const bool needStyledLines = needFreshLines || mExtrusionCache.isEmpty();
-        switch (mLineStyle)
-        {
-            case lsNone:
-                break;
-            case lsLine:
-                drawPoly(lines);
-                break;
-            case lsStepLeft:
-                drawPoly(needStyledLines ? qcp::toStepLeftLines(lines, keyIsVertical) : lines);
-                break;
-            case lsStepRight:
-                drawPoly(needStyledLines ? qcp::toStepRightLines(lines, keyIsVertical) : lines);
-                break;
-            case lsStepCenter:
-                drawPoly(needStyledLines ? qcp::toStepCenterLines(lines, keyIsVertical) : lines);
-                break;
-            case lsImpulse:
-            {
-                auto impulse = qcp::toImpulseLines(lines, keyIsVertical, mValueAxis->coordToPixel(0));
-                applyDefaultAntialiasingHint(painter);
-                QPen impulsePen = drawPen;
-                impulsePen.setCapStyle(Qt::FlatCap);
-                painter->setPen(impulsePen);
-                painter->drawLines(impulse);
-                break;
-            }
-        }
     }
 
     static constexpr int kOffsetTableSize = 1024;
@@ -544,99 +595,199 @@ void QCPGraph2::draw(QCPPainter* painter)
         return t;
     }();
 
-    const bool useSubset = scatterOnly && mScatterMaxPoints > 0
-                           && lines.size() > mScatterMaxPoints;
-    if (useSubset)
-    {
-        const int N = lines.size();
-        const int M = mScatterMaxPoints;
-        const int bucketSize = N / M;
-        mScatterSubset.resize(M);
-        for (int i = 0; i < M; ++i)
-            mScatterSubset[i] = i * bucketSize + (kOffsets[i % kOffsetTableSize] % bucketSize);
-    }
+    // `lines` is the float32 line cache on screen, a double-precision QVector
+    // in export mode; both index to absolute pixel positions.
+    auto drawLinesAndScatters = [&](const auto& lines, qsizetype linesBeginIndex) {
+        const QPen drawPen = selected() && mSelectionDecorator
+            ? mSelectionDecorator->pen() : mPen;
 
-    if (!mScatterStyle.isNone())
-    {
-        bool usedGpu = false;
-        if (!isExportMode && mParentPlot)
+        if (mLineStyle != lsNone && drawPen.style() != Qt::NoPen && drawPen.color().alpha() != 0)
         {
-            if (auto* srl = mParentPlot->scatterRhiLayer(mLayer))
-            {
-                const int skip = mScatterSkip + 1;
-                const bool hasColor = !mScatterColorValues.empty();
-                const int colorCount = static_cast<int>(mScatterColorValues.size());
-
-                auto emitPoint = [&](int i) {
-                    const double sx = lines[i].x(), sy = lines[i].y();
-                    if (qIsFinite(sx) && qIsFinite(sy))
-                    {
-                        mScatterPts.push_back(static_cast<float>(sx));
-                        mScatterPts.push_back(static_cast<float>(sy));
-                        if (hasColor)
-                        {
-                            const int dataIdx = linesBeginIndex + i;
-                            mScatterPts.push_back(dataIdx < colorCount ? mScatterColorValues[dataIdx] : 0.0f);
-                        }
-                        else
-                        {
-                            mScatterPts.push_back(0.0f);
-                        }
-                    }
-                };
-
-                mScatterPts.clear();
-                if (useSubset)
-                {
-                    mScatterPts.reserve(mScatterMaxPoints * 3);
-                    for (int i : mScatterSubset)
-                        emitPoint(i);
+            auto drawPoly = [&](const auto& pts) {
+                applyDefaultAntialiasingHint(painter);
+                if (!isExportMode) {
+                    qcp::drawPolylineCached(painter, mParentPlot, mLayer, pts,
+                                             drawPen, gpuOffset, clipRect(),
+                                             needFreshLines, mExtrusionCache);
+                } else {
+                    qcp::drawPolylineWithGpuFallback(painter, mParentPlot, mLayer, asPointF(pts),
+                                                      drawPen, gpuOffset, clipRect());
                 }
+            };
+
+            // Only compute step-transform when the extrusion cache needs rebuilding —
+            // on cache-hit pan frames, drawPolylineCached ignores pts entirely.
+            const bool needStyledLines = needFreshLines || mExtrusionCache.isEmpty();
+            auto drawStyled = [&](auto toStyled) {
+                if (needStyledLines)
+                    drawPoly(toStyled(asPointF(lines), keyIsVertical));
                 else
+                    drawPoly(lines);
+            };
+            switch (mLineStyle)
+            {
+                case lsNone:
+                    break;
+                case lsLine:
+                    drawPoly(lines);
+                    break;
+                case lsStepLeft:
+                    drawStyled([](const QVector<QPointF>& pts, bool vertical) {
+                        return qcp::toStepLeftLines(pts, vertical);
+                    });
+                    break;
+                case lsStepRight:
+                    drawStyled([](const QVector<QPointF>& pts, bool vertical) {
+                        return qcp::toStepRightLines(pts, vertical);
+                    });
+                    break;
+                case lsStepCenter:
+                    drawStyled([](const QVector<QPointF>& pts, bool vertical) {
+                        return qcp::toStepCenterLines(pts, vertical);
+                    });
+                    break;
+                case lsImpulse:
                 {
-                    mScatterPts.reserve((lines.size() / (mScatterSkip + 1)) * 3);
-                    for (int i = 0; i < lines.size(); i += skip)
-                        emitPoint(i);
-                }
-                if (!mScatterPts.empty())
-                {
-                    srl->addScatter(
-                        std::span<const float>(mScatterPts.data(), mScatterPts.size()),
-                        mScatterStyle, clipRect(),
-                        mParentPlot->devicePixelRatioF(),
-                        mParentPlot->rhiOutputSize().height(),
-                        static_cast<float>(gpuOffset.x()),
-                        static_cast<float>(gpuOffset.y()),
-                        hasColor ? mScatterColorMapImage : QImage{});
+                    auto impulse = qcp::toImpulseLines(asPointF(lines), keyIsVertical,
+                                                       mValueAxis->coordToPixel(0));
+                    applyDefaultAntialiasingHint(painter);
+                    QPen impulsePen = drawPen;
+                    impulsePen.setCapStyle(Qt::FlatCap);
+                    painter->setPen(impulsePen);
+                    painter->drawLines(impulse);
+                    break;
                 }
-                usedGpu = true;
             }
         }
-        if (!usedGpu)
+
+        const bool useSubset = scatterOnly && mScatterMaxPoints > 0
+                               && lines.size() > mScatterMaxPoints;
+        if (useSubset)
         {
-            applyScattersAntialiasingHint(painter);
-            mScatterStyle.applyTo(painter, drawPen);
-            if (useSubset)
+            const qsizetype N = lines.size();
+            const int M = mScatterMaxPoints;
+            const qsizetype bucketSize = N / M;
+            mScatterSubset.resize(M);
+            for (int i = 0; i < M; ++i)
+                mScatterSubset[i] = i * bucketSize + (kOffsets[i % kOffsetTableSize] % bucketSize);
+        }
+
+        if (!mScatterStyle.isNone())
+        {
+            bool usedGpu = false;
+            if (!isExportMode && mParentPlot)
             {
-                for (int i : mScatterSubset)
+                if (auto* srl = mParentPlot->scatterRhiLayer(mLayer))
                 {
-                    const double sx = lines[i].x(), sy = lines[i].y();
-                    if (qIsFinite(sx) && qIsFinite(sy))
-                        mScatterStyle.drawShape(painter, sx, sy);
+                    const int skip = mScatterSkip + 1;
+                    const bool hasColor = !mScatterColorValues.empty();
+                    const qsizetype colorCount = static_cast<qsizetype>(mScatterColorValues.size());
+
+                    auto emitPoint = [&](qsizetype i) {
+                        const double sx = lines[i].x(), sy = lines[i].y();
+                        if (qIsFinite(sx) && qIsFinite(sy))
+                        {
+                            mScatterPts.push_back(static_cast<float>(sx));
+                            mScatterPts.push_back(static_cast<float>(sy));
+                            if (hasColor)
+                            {
+                                const qsizetype dataIdx = linesBeginIndex + i;
+                                mScatterPts.push_back(dataIdx < colorCount ? mScatterColorValues[dataIdx] : 0.0f);
+                            }
+                            else
+                            {
+                                mScatterPts.push_back(0.0f);
+                            }
+                        }
+                    };
+
+                    mScatterPts.clear();
+                    if (useSubset)
+                    {
+                        mScatterPts.reserve(mScatterMaxPoints * 3);
+                        for (qsizetype i : mScatterSubset)
+                            emitPoint(i);
+                    }
+                    else
+                    {
+                        mScatterPts.reserve((lines.size() / (mScatterSkip + 1)) * 3);
+                        for (qsizetype i = 0; i < lines.size(); i += skip)
+                            emitPoint(i);
+                    }
+                    if (!mScatterPts.empty())
+                    {
+                        srl->addScatter(
+                            std::span<const float>(mScatterPts.data(), mScatterPts.size()),
+                            mScatterStyle, clipRect(),
+                            mParentPlot->devicePixelRatioF(),
+                            mParentPlot->rhiOutputSize().height(),
+                            static_cast<float>(gpuOffset.x()),
+                            static_cast<float>(gpuOffset.y()),
+                            hasColor ? mScatterColorMapImage : QImage{},
+                            reinterpret_cast<quintptr>(this));
+                    }
+                    usedGpu = true;
                 }
             }
-            else
+            if (!usedGpu)
             {
-                const int skip = mScatterSkip + 1;
-                for (int i = 0; i < lines.size(); i += skip)
+                applyScattersAntialiasingHint(painter);
+                mScatterStyle.applyTo(painter, drawPen);
+                if (useSubset)
+                {
+                    for (qsizetype i : mScatterSubset)
+                    {
+                        const double sx = lines[i].x(), sy = lines[i].y();
+                        if (qIsFinite(sx) && qIsFinite(sy))
+                            mScatterStyle.drawShape(painter, sx, sy);
+                    }
+                }
+                else
                 {
-                    const double sx = lines[i].x(), sy = lines[i].y();
-                    if (qIsFinite(sx) && qIsFinite(sy))
-                        mScatterStyle.drawShape(painter, sx, sy);
+                    const int skip = mScatterSkip + 1;
+                    for (qsizetype i = 0; i < lines.size(); i += skip)
+                    {
+                        const double sx = lines[i].x(), sy = lines[i].y();
+                        if (qIsFinite(sx) && qIsFinite(sy))
+                            mScatterStyle.drawShape(painter, sx, sy);
+                    }
                 }
             }
         }
+    };
+
+    if (isExportMode)
+    {
+        // Vector and no-cache exports keep full precision and leave the
+        // on-screen cache untouched (evaluateLineCache always asks for fresh lines).
+        const QVector<QPointF> lines = optimizedLines
+            ? ds->getOptimizedLineData(cacheBegin, cacheEnd, pixDim, mKeyAxis.data(), mValueAxis.data())
+            : ds->getLines(cacheBegin, cacheEnd, mKeyAxis.data(), mValueAxis.data());
+        if (!lines.isEmpty())
+            drawLinesAndScatters(lines, cacheBegin);
+        return;
     }
+
+    if (needFreshLines)
+    {
+        // Rebuilt in place: the buffer keeps its capacity across rebuilds.
+        mCachedLines.origin = QPointF(mKeyAxis->axisRect()->topLeft());
+        if (optimizedLines)
+            ds->getOptimizedPixelLine(cacheBegin, cacheEnd, pixDim,
+                                      mKeyAxis.data(), mValueAxis.data(), mCachedLines);
+        else
+            ds->getPixelLine(cacheBegin, cacheEnd, mKeyAxis.data(), mValueAxis.data(), mCachedLines);
+        mCachedLinesBeginIndex = cacheBegin;
+        mRenderedRange = {mKeyAxis->range(), mValueAxis->range()};
+        mHasRenderedRange = true;
+        mLineCacheDirty = false;
+        mCachedPlotSize = currentPlotSize;
+        mExtrusionCache.clear();
+        gpuOffset = {};
+    }
+
+    if (!mCachedLines.isEmpty())
+        drawLinesAndScatters(mCachedLines, mCachedLinesBeginIndex);
 }
 
 void QCPGraph2::drawLegendIcon(QCPPainter* painter, const QRectF& rect) const
@@ -676,4 +827,8 @@ void QCPGraph2::onViewportChanged()
                 mViewportDebounce.start();
         }
     }
+    // Paged sources (memory-mapped files) start reading what the next draw
+    // of raw samples will touch.
+    if (mDataSource && mKeyAxis)
+        qcp::algo::adviseViewport(*mDataSource, mKeyAxis->range());
 }
@@ -2,6 +2,7 @@
 #include "plottable.h"
 #include "plottable1d.h"
 #include "datasource/abstract-datasource.h"
+#include "datasource/appendable-datasource.h"
 #include "datasource/soa-datasource.h"
 #include "datasource/async-pipeline.h"
 #include "datasource/graph-resampler.h"
@@ -44,7 +45,7 @@ public:
 
     // Convenience: non-owning view from raw pointers
     template <typename K, typename V>
-    void viewData(const K* keys, const V* values, int count)
+    void viewData(const K* keys, const V* values, qsizetype count)
     {
         setDataSource(std::make_shared<QCPSoADataSource<std::span<const K>, std::span<const V>>>(
             std::span<const K>(keys, count), std::span<const V>(values, count)));
@@ -58,6 +59,48 @@ public:
             keys, values));
     }
 
+    // Streaming: append a sorted batch after the current data. The graph
+    // switches to an append-only store on the first call and the L1 cache is
+    // then extended incrementally — only the new tail is binned — instead of
+    // being rebuilt over the whole series.
+    // The store takes the element types of that first batch. Any data set
+    // before is converted into it once, an O(n) copy through the source's
+    // keyAt()/valueAt(), and the L1 is rebuilt. If that conversion would
+    // change a sample (e.g. double data followed by a float batch), the batch
+    // is dropped with a warning and the data is left as it was. Later batches
+    // must use the store's element types; others are dropped likewise.
+    template <IndexableNumericRange KC, IndexableNumericRange VC>
+    void addData(const KC& keys, const VC& values)
+    {
+        using K = std::ranges::range_value_t<KC>;
+        using V = std::ranges::range_value_t<VC>;
+        using Store = QCPAppendableDataSource<K, V>;
+        if (mAppendable)
+        {
+            auto* store = dynamic_cast<Store*>(mAppendable.get());
+            if (!store)
+            {
+                qWarning("QCPGraph2::addData: element types differ from the earlier batches — "
+                         "dropping batch");
+                return;
+            }
+            if (store->append(keys, values))
+                applyAppendedSource(store->snapshot(), true);
+            return;
+        }
+        auto created = mDataSource ? Store::fromExact(*mDataSource) : std::make_shared<Store>();
+        if (!created)
+        {
+            qWarning("QCPGraph2::addData: the current data does not convert exactly to the "
+                     "batch's element types — dropping batch");
+            return;
+        }
+        if (!created->append(keys, values))
+            return;
+        mAppendable = created;
+        applyAppendedSource(created->snapshot(), false);
+    }
+
     void dataChanged();
 
     // Pipeline
@@ -118,6 +161,8 @@ public:
     QCPRange getValueRange(bool& foundRange,
                            QCP::SignDomain inSignDomain = QCP::sdBoth,
                            const QCPRange& inKeyRange = QCPRange()) const override;
+    void accountMemory(QCPMemoryUsage& usage) const override;
+    void releaseCaches() override;
 
 protected:
     void draw(QCPPainter* painter) override;
@@ -131,18 +176,20 @@ private:
     QCPGraphPipeline mPipeline;
 
     // Two-phase resampling: L1 built async, L2 computed lazily at draw time
-    std::shared_ptr<qcp::algo::GraphResamplerCache> mL1Cache;
+    std::shared_ptr<const qcp::algo::GraphResamplerCache> mL1Cache;
     std::shared_ptr<QCPAbstractDataSource> mL2Result;
     bool mNeedsResampling = false;
     bool mL2Dirty = false;
+    // Set by releaseCaches(): the next draw asks the pipeline for the L1 again.
+    bool mL1Released = false;
 
     // GPU translation fast path: axis ranges when data was last drawn fresh
     struct { QCPRange key, value; } mRenderedRange {};
     bool mHasRenderedRange = false;
 
     // Line cache: reuse across replots when viewport shift is small
-    QVector<QPointF> mCachedLines;
-    int mCachedLinesBeginIndex = 0;
+    QCPPixelLine mCachedLines; // float32, relative to the axis rect origin
+    qsizetype mCachedLinesBeginIndex = 0;
     bool mLineCacheDirty = true;
     QSize mCachedPlotSize;
     // Cached extruded GPU vertices — avoids re-extrusion on pan
@@ -150,6 +197,15 @@ private:
     // Debounce timer: defers expensive L2 rebuild until panning stops
     QTimer mViewportDebounce;
 
+    // Append-only store behind addData(); reset by setDataSource().
+    std::shared_ptr<QCPAbstractAppendableDataSource> mAppendable;
+    // Set while the L1 transform extends the previous L1 of an append-only
+    // store instead of building a fresh one; see qcp::algo::L1ExtensionChain.
+    std::shared_ptr<qcp::algo::L1ExtensionChain> mL1Chain;
+
+    void applyAppendedSource(std::shared_ptr<QCPAbstractDataSource> snapshot, bool extendsPrevious);
+    void updateL1Transform(bool chained = false,
+                           std::shared_ptr<const qcp::algo::GraphResamplerCache> previous = {});
     void onL1Ready();
     void rebuildL2(const ViewportParams& vp);
 
@@ -166,6 +222,6 @@ private:
     QImage mScatterColorMapImage;
 
     // Reused across draw() calls to avoid per-frame heap allocations
-    std::vector<int> mScatterSubset;
+    std::vector<qsizetype> mScatterSubset;
     std::vector<float> mScatterPts;
 };
@@ -31,12 +31,31 @@ QCPHistogram2D::QCPHistogram2D(QCPAxis* keyAxis, QCPAxis* valueAxis)
         connect(keyAxis, &QCPAxis::scaleTypeChanged, this, &QCPHistogram2D::refreshBinning);
     if (valueAxis)
         connect(valueAxis, &QCPAxis::scaleTypeChanged, this, &QCPHistogram2D::refreshBinning);
+
+    // Viewport binning re-bins on pan/zoom (a no-op for the fixed-mode transform).
+    if (keyAxis)
+        connect(keyAxis, QOverload<const QCPRange&>::of(&QCPAxis::rangeChanged),
+                this, &QCPHistogram2D::onViewportChanged);
+    if (valueAxis)
+        connect(valueAxis, QOverload<const QCPRange&>::of(&QCPAxis::rangeChanged),
+                this, &QCPHistogram2D::onViewportChanged);
 }
 
 void QCPHistogram2D::refreshBinning()
 {
     installTransform();
-    mPipeline.onDataChanged();
+    // The viewport-mode key index doesn't depend on the scale: keep it. The
+    // whole-data grid standing in for it (source too large to index) does,
+    // and so may the cache of a job still running.
+    bool scaleFree = false;
+    if (mBinningMode == bmViewport)
+        mPipeline.inspectCache([&scaleFree](const std::any& cache) {
+            scaleFree = !std::any_cast<std::shared_ptr<QCPColorMapData>>(&cache);
+        });
+    if (scaleFree)
+        onViewportChanged();
+    else
+        mPipeline.onDataChanged();
 }
 
 QCPHistogram2D::~QCPHistogram2D()
@@ -51,13 +70,58 @@ void QCPHistogram2D::installTransform()
     const bool keyLog = mKeyAxis && mKeyAxis->scaleType() == QCPAxis::stLogarithmic;
     const bool valueLog = mValueAxis && mValueAxis->scaleType() == QCPAxis::stLogarithmic;
 
+    if (mBinningMode == bmViewport)
+    {
+        // The key index only depends on the data: it lives in the pipeline
+        // cache, which onDataChanged() clears, and is reused by every
+        // viewport job in between. A scattered source too large to index is
+        // binned whole instead, as in bmFixed, and that grid is cached.
+        using IndexPtr = std::shared_ptr<const qcp::algo::Histogram2DIndex>;
+        using GridPtr = std::shared_ptr<QCPColorMapData>;
+        mPipeline.setTransform(TransformKind::ViewportDependent,
+            [binSize = mViewportBinSize, capturedKeyBins, capturedValueBins, keyLog, valueLog](
+                const QCPAbstractDataSource& src,
+                const ViewportParams& vp,
+                std::any& cache,
+                const QCPCancellationToken& cancel) -> std::shared_ptr<QCPColorMapData> {
+                if (vp.plotWidthPx <= 0 || vp.plotHeightPx <= 0)
+                    return nullptr; // no viewport recorded yet
+                if (auto* grid = std::any_cast<GridPtr>(&cache))
+                    return *grid;
+                if (!std::any_cast<IndexPtr>(&cache))
+                {
+                    // Zooming doesn't interrupt the index build, only new data.
+                    auto built = qcp::algo::buildHistogram2DIndex(src, cancel.cacheToken());
+                    if (!built)
+                        return nullptr;
+                    if (built->storage == qcp::algo::Histogram2DIndex::Storage::None)
+                    {
+                        GridPtr grid(qcp::algo::bin2d(src, capturedKeyBins, capturedValueBins,
+                                                      keyLog, valueLog, cancel.cacheToken()));
+                        if (grid)
+                            cache = grid;
+                        return grid;
+                    }
+                    cache = IndexPtr(std::move(built));
+                }
+                const IndexPtr& index = std::any_cast<const IndexPtr&>(cache);
+                const int keyBins = std::clamp(vp.plotWidthPx / binSize, 1, 32768);
+                const int valueBins = std::clamp(vp.plotHeightPx / binSize, 1, 32768);
+                auto* raw = qcp::algo::bin2dViewport(src, *index, vp.keyRange, vp.valueRange,
+                                                     keyBins, valueBins, keyLog, valueLog, cancel);
+                return std::shared_ptr<QCPColorMapData>(raw);
+            });
+        return;
+    }
+
     mPipeline.setTransform(TransformKind::ViewportIndependent,
         [capturedKeyBins, capturedValueBins, keyLog, valueLog](
             const QCPAbstractDataSource& src,
             const ViewportParams& /*vp*/,
-            std::any& /*cache*/) -> std::shared_ptr<QCPColorMapData> {
+            std::any& /*cache*/,
+            const QCPCancellationToken& cancel) -> std::shared_ptr<QCPColorMapData> {
             auto* raw = qcp::algo::bin2d(src, capturedKeyBins, capturedValueBins,
-                                         keyLog, valueLog);
+                                         keyLog, valueLog, cancel);
             return std::shared_ptr<QCPColorMapData>(raw);
         });
 }
@@ -115,6 +179,38 @@ void QCPHistogram2D::setBins(int keyBins, int valueBins)
     mPipeline.onDataChanged();
 }
 
+void QCPHistogram2D::setBinningMode(BinningMode mode)
+{
+    if (mBinningMode == mode)
+        return;
+    mBinningMode = mode;
+    installTransform();
+    if (mBinningMode == bmViewport)
+        onViewportChanged();
+    else if (mDataSource)
+        mPipeline.onDataChanged();
+}
+
+void QCPHistogram2D::setViewportBinSize(int pixels)
+{
+    if (pixels <= 0 || pixels == mViewportBinSize)
+        return;
+    mViewportBinSize = pixels;
+    if (mBinningMode != bmViewport)
+        return;
+    installTransform();
+    onViewportChanged();
+}
+
+// Also called without a source: the pipeline records the viewport for the
+// job setDataSource() starts.
+void QCPHistogram2D::onViewportChanged()
+{
+    if (!mKeyAxis || !mValueAxis)
+        return;
+    mPipeline.onViewportChanged(ViewportParams::fromAxes(mKeyAxis.data(), mValueAxis.data()));
+}
+
 void QCPHistogram2D::setKeyBinScale(QCPAxis::ScaleType type)
 {
     if (mKeyAxis)
@@ -293,7 +389,11 @@ void QCPHistogram2D::draw(QCPPainter* painter)
         }
         else
         {
-            if (!mPipeline.isBusy())
+            if (mPipeline.isBusy())
+                return;
+            if (mBinningMode == bmViewport)
+                onViewportChanged();
+            else
                 mPipeline.onDataChanged();
             return;
         }
@@ -375,8 +475,8 @@ QCPRange QCPHistogram2D::getValueRange(bool& foundRange, QCP::SignDomain inSignD
     foundRange = false;
     double lo = std::numeric_limits<double>::max();
     double hi = std::numeric_limits<double>::lowest();
-    const int n = mDataSource->size();
-    for (int i = 0; i < n; ++i)
+    const qsizetype n = mDataSource->size();
+    for (qsizetype i = 0; i < n; ++i)
     {
         const double k = mDataSource->keyAt(i);
         if (k < inKeyRange.lower || k > inKeyRange.upper)
@@ -407,3 +507,23 @@ double QCPHistogram2D::selectTest(const QPointF& pos, bool onlySelectable, QVari
         return 0;
     return -1;
 }
+
+void QCPHistogram2D::accountMemory(QCPMemoryUsage& usage) const
+{
+    // The viewport-binning index; a running job may hold a second reference.
+    mPipeline.inspectCache([&usage](const std::any& cache) {
+        using IndexPtr = std::shared_ptr<const qcp::algo::Histogram2DIndex>;
+        if (auto* index = std::any_cast<IndexPtr>(&cache); index && *index)
+            usage.addShared(QCPMemoryUsage::msL1Cache, (*index)->memoryBytes(), index->use_count());
+    });
+    if (const QCPColorMapData* data = mPipeline.result())
+        usage.add(QCPMemoryUsage::msResampled, data->memoryBytes());
+    mRenderer.accountMemory(usage);
+}
+
+// The next viewport job rebuilds the index; the binned grid on screen stays.
+void QCPHistogram2D::releaseCaches()
+{
+    mPipeline.releaseCache();
+    mRenderer.releaseCaches();
+}
@@ -15,6 +15,7 @@ class QCP_LIB_DECL QCPHistogram2D : public QCPAbstractPlottable
     Q_OBJECT
 public:
     enum Normalization { nNone, nColumn };
+    enum BinningMode { bmFixed, bmViewport };
 
     explicit QCPHistogram2D(QCPAxis* keyAxis, QCPAxis* valueAxis);
     ~QCPHistogram2D() override;
@@ -29,7 +30,7 @@ public:
     }
 
     template <typename K, typename V>
-    void viewData(const K* keys, const V* values, int count)
+    void viewData(const K* keys, const V* values, qsizetype count)
     {
         setDataSource(std::make_shared<QCPSoADataSource<std::span<const K>, std::span<const V>>>(
             std::span<const K>(keys, count), std::span<const V>(values, count)));
@@ -52,6 +53,19 @@ public:
     int keyBins() const { return mKeyBins; }
     int valueBins() const { return mValueBins; }
 
+    // bmFixed bins the whole data set once into keyBins() x valueBins().
+    // bmViewport re-bins only the visible region on every pan/zoom, at one
+    // bin per viewportBinSize() screen pixels, from an index of equal-width
+    // key buckets built once per data change — the cost of a zoom follows the
+    // visible samples, and counts (hence the colour scale) follow the zoom
+    // level. The buckets are row ranges of a key-sorted source, else a copy
+    // of the samples (16 bytes each); a scattered source too large to copy
+    // (see kHistogramIndexMaxCopiedSamples) is binned as in bmFixed instead.
+    void setBinningMode(BinningMode mode);
+    BinningMode binningMode() const { return mBinningMode; }
+    void setViewportBinSize(int pixels);
+    int viewportBinSize() const { return mViewportBinSize; }
+
     // Normalization
     void setNormalization(Normalization norm);
     Normalization normalization() const { return mNormalization; }
@@ -81,6 +95,10 @@ public:
     // Pipeline access
     QCPHistogramPipeline& pipeline() { return mPipeline; }
     const QCPHistogramPipeline& pipeline() const { return mPipeline; }
+
+    void accountMemory(QCPMemoryUsage& usage) const override;
+    void releaseCaches() override;
+
 public Q_SLOTS:
     void setGradient(const QCPColorGradient& gradient);
     void setDataRange(const QCPRange& range);
@@ -109,6 +127,8 @@ private:
     int mKeyBins = 100;
     int mValueBins = 100;
     Normalization mNormalization = nNone;
+    BinningMode mBinningMode = bmFixed;
+    int mViewportBinSize = 1;
     QCPHistogramPipeline mPipeline;
     QCPColormapRenderer mRenderer;
 
@@ -129,4 +149,5 @@ private:
                             bool keyPositiveOnly, bool valuePositiveOnly) const;
 
     void installTransform();
+    void onViewportChanged();
 };
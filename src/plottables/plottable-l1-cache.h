@@ -7,15 +7,27 @@ namespace qcp {
 
 /// Extract an L1 resampler cache from a pipeline's std::any cache slot.
 /// Moves the cache into \a dest, clears the pipeline slot, and sets \a l2Dirty.
+/// The slot holds either the cache itself or a std::shared_ptr<const CacheType>
+/// shared with other plottables (see QCPL1CacheRegistry).
 template<typename CacheType>
 void extractL1Cache(std::any& pipelineCache,
-                    std::shared_ptr<CacheType>& dest,
+                    std::shared_ptr<const CacheType>& dest,
                     bool& l2Dirty)
 {
+    if (auto* shared = std::any_cast<std::shared_ptr<const CacheType>>(&pipelineCache))
+    {
+        if (*shared && (*shared)->sourceSize > 0)
+        {
+            dest = std::move(*shared);
+            pipelineCache = std::any{};
+            l2Dirty = true;
+        }
+        return;
+    }
     auto* c = std::any_cast<CacheType>(&pipelineCache);
     if (c && c->sourceSize > 0)
     {
-        dest = std::make_shared<CacheType>(std::move(*c));
+        dest = std::make_shared<const CacheType>(std::move(*c));
         pipelineCache = std::any{};
         l2Dirty = true;
     }
@@ -45,8 +45,9 @@ QCPMultiGraph::QCPMultiGraph(QCPAxis* keyAxis, QCPAxis* valueAxis)
     {
         connect(keyAxis, QOverload<const QCPRange&>::of(&QCPAxis::rangeChanged),
                 this, &QCPMultiGraph::onViewportChanged);
+        // L2 bins are log-spaced on a log key axis: re-bin on a scale switch
         connect(keyAxis, &QCPAxis::scaleTypeChanged,
-                this, [this] { mLineCacheDirty = true; mCachedLines.clear(); });
+                this, [this] { mLineCacheDirty = true; mCachedLines.clear(); mL2Dirty = true; });
     }
     if (valueAxis)
     {
@@ -75,7 +76,7 @@ void QCPMultiGraph::setDataSource(std::unique_ptr<QCPAbstractMultiDataSource> so
     setDataSource(std::shared_ptr<QCPAbstractMultiDataSource>(std::move(source)));
 }
 
-static void ensureL1TransformMulti(QCPMultiGraphPipeline& pipeline, int sourceSize, int colCount)
+static void ensureL1TransformMulti(QCPMultiGraphPipeline& pipeline, qsizetype sourceSize, int colCount)
 {
     const bool needsResampling = colCount > 0
         && static_cast<int64_t>(sourceSize) * colCount >= qcp::algo::kResampleThreshold;
@@ -105,6 +106,7 @@ void QCPMultiGraph::setDataSource(std::shared_ptr<QCPAbstractMultiDataSource> so
     mL2Result.reset();
     mCachedLines.clear();
     mL2Dirty = false;
+    mL1Released = false;
     mLineCacheDirty = true;
 
     if (mDataSource)
@@ -134,6 +136,7 @@ void QCPMultiGraph::dataChanged()
 
     mL1Cache.reset();
     mL2Dirty = false;
+    mL1Released = false;
 
     if (mPipeline.hasTransform())
         mPipeline.onDataChanged();
@@ -149,6 +152,34 @@ void QCPMultiGraph::onL1Ready()
         parentPlot()->replot(QCustomPlot::rpQueuedReplot);
 }
 
+void QCPMultiGraph::accountMemory(QCPMemoryUsage& usage) const
+{
+    if (mL1Cache)
+        usage.addShared(QCPMemoryUsage::msL1Cache, mL1Cache->memoryBytes(), mL1Cache.use_count());
+    if (mL2Result)
+        usage.add(QCPMemoryUsage::msResampled, quint64(mL2Result->size())
+                                                   * (mL2Result->columnCount() + 1) * sizeof(double));
+    for (const QVector<QPointF>& lines : mCachedLines)
+        usage.add(QCPMemoryUsage::msLineCache, quint64(lines.capacity()) * sizeof(QPointF));
+    for (const qcp::ExtrusionCache& extrusion : mExtrusionCaches)
+        usage.add(QCPMemoryUsage::msExtrusion, extrusion.vertices.capacity() * sizeof(float));
+}
+
+void QCPMultiGraph::releaseCaches()
+{
+    if (mL1Cache)
+    {
+        mL1Cache.reset();
+        mL1Released = true;
+    }
+    mL2Result.reset();
+    mL2Dirty = false;
+    mCachedLines = QVector<QVector<QPointF>>();
+    mLineCacheDirty = true;
+    for (qcp::ExtrusionCache& extrusion : mExtrusionCaches)
+        extrusion = qcp::ExtrusionCache();
+}
+
 void QCPMultiGraph::rebuildL2(const ViewportParams& vp)
 {
     if (!mL1Cache) return;
@@ -167,6 +198,10 @@ void QCPMultiGraph::onViewportChanged()
                 mViewportDebounce.start();
         }
     }
+    // Paged sources (memory-mapped files) start reading what the next draw
+    // of raw samples will touch.
+    if (mDataSource && mKeyAxis)
+        qcp::algo::adviseViewport(*mDataSource, mKeyAxis->range());
 }
 
 void QCPMultiGraph::syncComponentCount()
@@ -230,7 +265,7 @@ void QCPMultiGraph::setComponentPens(const QList<QPen>& pens)
     }
 }
 
-double QCPMultiGraph::componentValueAt(int column, int index) const
+double QCPMultiGraph::componentValueAt(int column, qsizetype index) const
 {
     return mDataSource ? mDataSource->valueAt(column, index) : 0.0;
 }
@@ -250,9 +285,17 @@ void QCPMultiGraph::setComponentSelection(int index, const QCPDataSelection& sel
 
 // --- QCPPlottableInterface1D ---
 
+// The legacy 1D interface is int-indexed; sources past 2^31 samples are
+// exposed there truncated. Selection (QCPDataRange) and rendering use the
+// source's 64-bit indices directly.
+static int clampToInt(qsizetype i)
+{
+    return static_cast<int>(std::min<qsizetype>(i, std::numeric_limits<int>::max()));
+}
+
 int QCPMultiGraph::dataCount() const
 {
-    return mDataSource ? mDataSource->size() : 0;
+    return mDataSource ? clampToInt(mDataSource->size()) : 0;
 }
 
 double QCPMultiGraph::dataMainKey(int index) const
@@ -295,12 +338,12 @@ QPointF QCPMultiGraph::dataPixelPosition(int index) const
 
 int QCPMultiGraph::findBegin(double sortKey, bool expandedRange) const
 {
-    return mDataSource ? mDataSource->findBegin(sortKey, expandedRange) : 0;
+    return mDataSource ? clampToInt(mDataSource->findBegin(sortKey, expandedRange)) : 0;
 }
 
 int QCPMultiGraph::findEnd(double sortKey, bool expandedRange) const
 {
-    return mDataSource ? mDataSource->findEnd(sortKey, expandedRange) : 0;
+    return mDataSource ? clampToInt(mDataSource->findEnd(sortKey, expandedRange)) : 0;
 }
 
 // --- Range queries ---
@@ -356,24 +399,24 @@ double QCPMultiGraph::selectTest(const QPointF& pos, bool onlySelectable, QVaria
     // Keys are sorted — binary search for the nearest key, then check
     // each component at that index.  O(log N + C) instead of O(C × M).
     const QCPAbstractMultiDataSource* ds = mDataSource.get();
-    const int n = ds->size();
+    const qsizetype n = ds->size();
 
     double posKey, dummy;
     pixelsToCoords(pos, posKey, dummy);
 
     // findEnd gives the first index > posKey; the nearest key is either
     // that index or the one before it.
-    int idx = ds->findEnd(posKey, /*expandedRange=*/false);
-    int lo = qMax(0, idx - 1);
-    int hi = qMin(idx, n - 1);
+    qsizetype idx = ds->findEnd(posKey, /*expandedRange=*/false);
+    qsizetype lo = qMax<qsizetype>(0, idx - 1);
+    qsizetype hi = qMin(idx, n - 1);
 
     double minDistSqr = (std::numeric_limits<double>::max)();
-    int minDistIndex = -1;
+    qsizetype minDistIndex = -1;
     int minDistComponent = -1;
     double minKey = 0, minValue = 0;
 
     const int nComponents = qMin(mComponents.size(), ds->columnCount());
-    for (int i = lo; i <= hi; ++i) {
+    for (qsizetype i = lo; i <= hi; ++i) {
         double k = ds->keyAt(i);
         for (int c = 0; c < nComponents; ++c) {
             if (!mComponents[c].visible) continue;
@@ -409,7 +452,7 @@ double QCPMultiGraph::selectTest(const QPointF& pos, bool onlySelectable, QVaria
     if (minDistIndex >= 0) {
         QVariantMap map;
         map["componentIndex"] = minDistComponent;
-        map["dataIndex"] = minDistIndex;
+        map["dataIndex"] = static_cast<qlonglong>(minDistIndex);
         map["key"] = minKey;
         map["value"] = minValue;
         details->setValue(map);
@@ -434,15 +477,15 @@ QCPDataSelection QCPMultiGraph::selectTestRect(const QRectF& rect, bool onlySele
     QCPRange keyRange(key1, key2);
     QCPRange valueRange(value1, value2);
 
-    int begin = mDataSource->findBegin(keyRange.lower, false);
-    int end = mDataSource->findEnd(keyRange.upper, false);
+    qsizetype begin = mDataSource->findBegin(keyRange.lower, false);
+    qsizetype end = mDataSource->findEnd(keyRange.upper, false);
 
     mLastRectSelections.resize(mComponents.size());
     for (int c = 0; c < mComponents.size(); ++c) {
         if (!mComponents[c].visible) continue;
         QCPDataSelection colSel;
-        int segBegin = -1;
-        for (int i = begin; i < end; ++i) {
+        qsizetype segBegin = -1;
+        for (qsizetype i = begin; i < end; ++i) {
             double k = mDataSource->keyAt(i);
             double v = mDataSource->valueAt(c, i);
             if (segBegin == -1) {
@@ -485,7 +528,7 @@ void QCPMultiGraph::selectEvent([[maybe_unused]] QMouseEvent* event, bool additi
         // Point selection: details is a QVariantMap with componentIndex/dataIndex
         auto map = details.toMap();
         int compIdx = map.value("componentIndex", -1).toInt();
-        int dataIdx = map.value("dataIndex", -1).toInt();
+        qsizetype dataIdx = map.value("dataIndex", -1).toLongLong();
         if (compIdx < 0 || compIdx >= mComponents.size() || dataIdx < 0)
             return;
         mComponents[compIdx].selection.addDataRange(QCPDataRange(dataIdx, dataIdx + 1), false);
@@ -519,8 +562,9 @@ bool QCPMultiGraph::canProduceContent() const
 {
     if (!mKeyAxis || !mValueAxis || !mDataSource || mDataSource->empty())
         return false;
-    // Pipeline active but L1 not ready — draw() will bail out
-    if (mNeedsResampling && !mL1Cache && !mL2Result)
+    // Pipeline active but L1 not ready — draw() will bail out, unless it has
+    // to request a released one again
+    if (mNeedsResampling && !mL1Cache && !mL2Result && !mL1Released)
         return false;
     return true;
 }
@@ -553,6 +597,14 @@ void QCPMultiGraph::draw(QCPPainter* painter)
     if (mKeyAxis->range().size() <= 0)
         return;
 
+    // Rebuild an L1 dropped by releaseCaches() now that it is needed again.
+    if (mL1Released)
+    {
+        mL1Released = false;
+        if (mNeedsResampling && mPipeline.hasTransform())
+            mPipeline.requestCache();
+    }
+
     // Export path: synchronous fallback when no L1 cache yet
     if (!mL1Cache && mNeedsResampling
         && painter->modes().testFlag(QCPPainter::pmNoCaching))
@@ -579,8 +631,8 @@ void QCPMultiGraph::draw(QCPPainter* painter)
         return;
 
     const QCPRange keyRange = mKeyAxis->range();
-    int begin = ds->findBegin(keyRange.lower);
-    int end = ds->findEnd(keyRange.upper);
+    qsizetype begin = ds->findBegin(keyRange.lower);
+    qsizetype end = ds->findEnd(keyRange.upper);
     if (begin >= end)
         return;
 
@@ -620,8 +672,8 @@ void QCPMultiGraph::draw(QCPPainter* painter)
         // Expand data range by 100% on each side so GPU-translated pans
         // don't expose uncovered edges before the rebuild threshold triggers.
         const double margin = keyRange.size() * 1.0;
-        int cacheBegin = ds->findBegin(keyRange.lower - margin);
-        int cacheEnd = ds->findEnd(keyRange.upper + margin);
+        qsizetype cacheBegin = ds->findBegin(keyRange.lower - margin);
+        qsizetype cacheEnd = ds->findEnd(keyRange.upper + margin);
 
         const int nc = static_cast<int>(mComponents.size());
         linesTarget.resize(nc);
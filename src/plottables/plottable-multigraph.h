@@ -67,7 +67,7 @@ public:
                            int columns, int stride)
     {
         setDataSource(std::make_shared<QCPRowMajorMultiDataSource<K, V>>(
-            keys, values, static_cast<int>(keys.size()), columns, stride));
+            keys, values, static_cast<qsizetype>(keys.size()), columns, stride));
     }
 
     // Components
@@ -79,7 +79,7 @@ public:
     void setComponentPens(const QList<QPen>& pens);
 
     // Per-component value access (for tracers/tooltips)
-    [[nodiscard]] double componentValueAt(int column, int index) const;
+    [[nodiscard]] double componentValueAt(int column, qsizetype index) const;
 
     // Shared style
     [[nodiscard]] LineStyle lineStyle() const { return mLineStyle; }
@@ -114,6 +114,8 @@ public:
     QCPRange getValueRange(bool& foundRange,
                            QCP::SignDomain inSignDomain = QCP::sdBoth,
                            const QCPRange& inKeyRange = QCPRange()) const override;
+    void accountMemory(QCPMemoryUsage& usage) const override;
+    void releaseCaches() override;
 
     // Legend
     using QCPAbstractPlottable::addToLegend;
@@ -140,10 +142,12 @@ protected:
     bool mAdaptiveSampling = true;
     int mScatterSkip = 0;
     QCPMultiGraphPipeline mPipeline;
-    std::shared_ptr<qcp::algo::MultiGraphResamplerCache> mL1Cache;
+    std::shared_ptr<const qcp::algo::MultiGraphResamplerCache> mL1Cache;
     std::shared_ptr<QCPAbstractMultiDataSource> mL2Result;
     bool mL2Dirty = false;
     bool mNeedsResampling = false;
+    // Set by releaseCaches(): the next draw asks the pipeline for the L1 again.
+    bool mL1Released = false;
     struct { QCPRange key, value; } mRenderedRange {};
     bool mHasRenderedRange = false;
     // Line cache: per-component cached lines, reused with GPU offset
@@ -14,15 +14,15 @@ QCPWaterfallDataAdapter::QCPWaterfallDataAdapter(
 }
 
 int QCPWaterfallDataAdapter::columnCount() const { return mSource ? mSource->columnCount() : 0; }
-int QCPWaterfallDataAdapter::size() const { return mSource ? mSource->size() : 0; }
-double QCPWaterfallDataAdapter::keyAt(int i) const { return mSource ? mSource->keyAt(i) : 0.0; }
+qsizetype QCPWaterfallDataAdapter::size() const { return mSource ? mSource->size() : 0; }
+double QCPWaterfallDataAdapter::keyAt(qsizetype i) const { return mSource ? mSource->keyAt(i) : 0.0; }
 QCPRange QCPWaterfallDataAdapter::keyRange(bool& found, QCP::SignDomain sd) const
 {
     if (!mSource) { found = false; return QCPRange(); }
     return mSource->keyRange(found, sd);
 }
-int QCPWaterfallDataAdapter::findBegin(double sortKey, bool expandedRange) const { return mSource ? mSource->findBegin(sortKey, expandedRange) : 0; }
-int QCPWaterfallDataAdapter::findEnd(double sortKey, bool expandedRange) const { return mSource ? mSource->findEnd(sortKey, expandedRange) : 0; }
+qsizetype QCPWaterfallDataAdapter::findBegin(double sortKey, bool expandedRange) const { return mSource ? mSource->findBegin(sortKey, expandedRange) : 0; }
+qsizetype QCPWaterfallDataAdapter::findEnd(double sortKey, bool expandedRange) const { return mSource ? mSource->findEnd(sortKey, expandedRange) : 0; }
 
 double QCPWaterfallDataAdapter::transform(int column, double rawValue) const
 {
@@ -31,7 +31,7 @@ double QCPWaterfallDataAdapter::transform(int column, double rawValue) const
     return offset + rawValue * norm * mGain;
 }
 
-double QCPWaterfallDataAdapter::valueAt(int column, int i) const
+double QCPWaterfallDataAdapter::valueAt(int column, qsizetype i) const
 {
     if (!mSource) return 0.0;
     return transform(column, mSource->valueAt(column, i));
@@ -52,20 +52,20 @@ QCPRange QCPWaterfallDataAdapter::valueRange(int column, bool& found, QCP::SignD
     return result;
 }
 
-QVector<QPointF> QCPWaterfallDataAdapter::getLines(int column, int begin, int end,
+QVector<QPointF> QCPWaterfallDataAdapter::getLines(int column, qsizetype begin, qsizetype end,
                                                      QCPAxis* keyAxis, QCPAxis* valueAxis) const
 {
     if (!mSource || begin >= end) return {};
     std::vector<double> keys(end - begin);
     std::vector<double> vals(end - begin);
-    for (int i = begin; i < end; ++i) {
+    for (qsizetype i = begin; i < end; ++i) {
         keys[i - begin] = mSource->keyAt(i);
         vals[i - begin] = transform(column, mSource->valueAt(column, i));
     }
     return qcp::algo::linesToPixels(keys, vals, 0, end - begin, keyAxis, valueAxis);
 }
 
-QVector<QPointF> QCPWaterfallDataAdapter::getOptimizedLineData(int column, int begin, int end,
+QVector<QPointF> QCPWaterfallDataAdapter::getOptimizedLineData(int column, qsizetype begin, qsizetype end,
                                                                  int pixelWidth,
                                                                  QCPAxis* keyAxis,
                                                                  QCPAxis* valueAxis) const
@@ -73,7 +73,7 @@ QVector<QPointF> QCPWaterfallDataAdapter::getOptimizedLineData(int column, int b
     if (!mSource || begin >= end) return {};
     std::vector<double> keys(end - begin);
     std::vector<double> vals(end - begin);
-    for (int i = begin; i < end; ++i) {
+    for (qsizetype i = begin; i < end; ++i) {
         keys[i - begin] = mSource->keyAt(i);
         vals[i - begin] = transform(column, mSource->valueAt(column, i));
     }
@@ -116,7 +116,7 @@ void QCPWaterfallGraph::recomputeNormFactors()
         return;
     }
     int cols = mOriginalSource->columnCount();
-    int n = mOriginalSource->size();
+    qsizetype n = mOriginalSource->size();
     mCachedNormFactors.resize(cols);
     for (int c = 0; c < cols; ++c) {
         if (!mNormalize) {
@@ -124,7 +124,7 @@ void QCPWaterfallGraph::recomputeNormFactors()
             continue;
         }
         double maxAbs = 0.0;
-        for (int i = 0; i < n; ++i)
+        for (qsizetype i = 0; i < n; ++i)
             maxAbs = qMax(maxAbs, qAbs(mOriginalSource->valueAt(c, i)));
         mCachedNormFactors[c] = (maxAbs > 0.0) ? (1.0 / maxAbs) : 1.0;
     }
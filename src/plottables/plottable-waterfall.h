@@ -15,18 +15,18 @@ public:
     QCPAbstractMultiDataSource* source() const { return mSource.get(); }
 
     int columnCount() const override;
-    int size() const override;
-    double keyAt(int i) const override;
+    qsizetype size() const override;
+    double keyAt(qsizetype i) const override;
     QCPRange keyRange(bool& found, QCP::SignDomain sd = QCP::sdBoth) const override;
-    int findBegin(double sortKey, bool expandedRange = true) const override;
-    int findEnd(double sortKey, bool expandedRange = true) const override;
+    qsizetype findBegin(double sortKey, bool expandedRange = true) const override;
+    qsizetype findEnd(double sortKey, bool expandedRange = true) const override;
 
-    double valueAt(int column, int i) const override;
+    double valueAt(int column, qsizetype i) const override;
     QCPRange valueRange(int column, bool& found, QCP::SignDomain sd = QCP::sdBoth,
                         const QCPRange& inKeyRange = QCPRange()) const override;
-    QVector<QPointF> getLines(int column, int begin, int end,
+    QVector<QPointF> getLines(int column, qsizetype begin, qsizetype end,
                                QCPAxis* keyAxis, QCPAxis* valueAxis) const override;
-    QVector<QPointF> getOptimizedLineData(int column, int begin, int end, int pixelWidth,
+    QVector<QPointF> getOptimizedLineData(int column, qsizetype begin, qsizetype end, int pixelWidth,
                                            QCPAxis* keyAxis, QCPAxis* valueAxis) const override;
 
 private:
@@ -41,6 +41,7 @@ class QCPPainter;
 class QCPAbstractPlottable;
 class QCPPlottableInterface1D;
 class QCPLegend;
+struct QCPMemoryUsage;
 
 class QCP_LIB_DECL QCPSelectionDecorator
 {
@@ -165,6 +166,12 @@ public:
     virtual QPointF stallPixelOffset() const { return {}; }
     virtual void releaseGpuResources() {}
 
+    // Caches: adds the bytes this plottable's caches hold to `usage`, and drops
+    // them, to be rebuilt on demand when the plottable is drawn again (see
+    // QCPMemoryBudget). Plottables without caches keep the defaults.
+    virtual void accountMemory(QCPMemoryUsage& /*usage*/) const {}
+    virtual void releaseCaches() {}
+
     // Returns false when draw() would bail out early (e.g. async pipeline
     // hasn't delivered data yet).  Used by setupPaintBuffers to preserve
     // stale buffer content instead of clearing to transparent.
@@ -256,6 +263,8 @@ private:
     bool mVisuallyBusy = false;
     bool mEffectiveBusy = false;
     QTimer mBusyDebounceTimer;
+    // QCustomPlot::mReplotTick of the last replot that drew this plottable.
+    quint64 mLastDrawTick = 0;
 
     std::optional<QString> mBusyIndicatorSymbol;
     std::optional<qreal> mBusyFadeAlpha;
@@ -267,6 +276,8 @@ private:
     friend class QCustomPlot;
     friend class QCPAxis;
     friend class QCPPlottableLegendItem;
+    friend class QCPLayer;
+    friend class QCPMemoryBudget;
 };
 
 
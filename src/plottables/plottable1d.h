@@ -576,12 +576,12 @@ void QCPAbstractPlottable1D<DataType>::drawPolyline(QCPPainter* painter,
         {
             QColor penColor = painter->pen().color();
             float penWidth = qMax(1.0f, static_cast<float>(painter->pen().widthF()));
-            auto strokeVerts = QCPLineExtruder::extrudePolyline(lineData, penWidth, penColor);
+            auto strokeVerts = QCPLineExtruder::extrudePolyline(lineData, penWidth);
             if (!strokeVerts.isEmpty())
             {
                 const double dpr = mParentPlot->bufferDevicePixelRatio();
                 const QSize outputSize = mParentPlot->rhiOutputSize();
-                prl->addPlottable({}, strokeVerts, clipRect(), dpr,
+                prl->addPlottable(strokeVerts, penColor, clipRect(), dpr,
                                    outputSize.height());
             }
             return;
@@ -56,6 +56,8 @@
 #include "items/item-vspan.h"
 #include "layer.h"
 #include "overlay.h"
+#include "frame-profile.h"
+#include "memory-usage.h"
 #include "layout.h"
 #include "layoutelements/layoutelement-axisrect.h"
 #include "layoutelements/layoutelement-colorscale.h"
@@ -84,6 +86,8 @@
 #include "datasource/soa-multi-datasource.h"
 #include "datasource/algorithms-2d.h"
 #include "datasource/resample.h"
+#include "datasource/mmap-datasource.h"
+#include "datasource/chunked-datasource.h"
 #include "plottables/plottable-colormap2.h"
 #include "plottables/plottable-histogram2d.h"
 #include "polar/layoutelement-angularaxis.h"
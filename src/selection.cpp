@@ -36,6 +36,9 @@
   of a contiguous set of data points. The \a end index corresponds to the data point just after the
   last data point of the data range, like in standard iterators.
 
+  The indices are \c qsizetype (64-bit on 64-bit platforms), so selections on zero-copy data
+  sources with more than 2^31 samples (e.g. \ref QCPGraph2) are represented exactly.
+
   Data Ranges are not bound to a certain plottable, thus they can be freely exchanged, created and
   modified. If a non-contiguous data set shall be described, the class \ref QCPDataSelection is
   used, which holds and manages multiple instances of \ref QCPDataRange. In most situations, \ref
@@ -56,7 +59,7 @@
 
 /* start documentation of inline functions */
 
-/*! \fn int QCPDataRange::size() const
+/*! \fn qsizetype QCPDataRange::size() const
 
   Returns the number of data points described by this data range. This is equal to the end index
   minus the begin index.
@@ -64,12 +67,12 @@
   \see length
 */
 
-/*! \fn int QCPDataRange::length() const
+/*! \fn qsizetype QCPDataRange::length() const
 
   Returns the number of data points described by this data range. Equivalent to \ref size.
 */
 
-/*! \fn void QCPDataRange::setBegin(int begin)
+/*! \fn void QCPDataRange::setBegin(qsizetype begin)
 
   Sets the begin of this data range. The \a begin index points to the first data point that is part
   of the data range.
@@ -79,7 +82,7 @@
   \see setEnd
 */
 
-/*! \fn void QCPDataRange::setEnd(int end)
+/*! \fn void QCPDataRange::setEnd(qsizetype end)
 
   Sets the end of this data range. The \a end index points to the data point just after the last
   data point that is part of the data range.
@@ -108,7 +111,7 @@
   \see size, length
 */
 
-/*! \fn QCPDataRange QCPDataRange::adjusted(int changeBegin, int changeEnd) const
+/*! \fn QCPDataRange QCPDataRange::adjusted(qsizetype changeBegin, qsizetype changeEnd) const
 
   Returns a data range where \a changeBegin and \a changeEnd were added to the begin and end
   indices, respectively.
@@ -126,7 +129,7 @@ QCPDataRange::QCPDataRange() : mBegin(0), mEnd(0) { }
 
   No checks or corrections are made to ensure the resulting range is valid (\ref isValid).
 */
-QCPDataRange::QCPDataRange(int begin, int end) : mBegin(begin), mEnd(end) { }
+QCPDataRange::QCPDataRange(qsizetype begin, qsizetype end) : mBegin(begin), mEnd(end) { }
 
 /*!
   Returns a data range that matches this data range, except that parts exceeding \a other are
@@ -341,8 +344,8 @@ QCPDataSelection& QCPDataSelection::operator-=(const QCPDataRange& other)
     int i = 0;
     while (i < mDataRanges.size())
     {
-        const int thisBegin = mDataRanges.at(i).begin();
-        const int thisEnd = mDataRanges.at(i).end();
+        const qsizetype thisBegin = mDataRanges.at(i).begin();
+        const qsizetype thisEnd = mDataRanges.at(i).end();
         if (thisBegin >= other.end())
             break; // since data ranges are sorted after the simplify() call, no ranges which
                    // contain other will come after this
@@ -386,9 +389,9 @@ QCPDataSelection& QCPDataSelection::operator-=(const QCPDataRange& other)
   Returns the total number of data points contained in all data ranges that make up this data
   selection.
 */
-int QCPDataSelection::dataPointCount() const
+qsizetype QCPDataSelection::dataPointCount() const
 {
-    int result = 0;
+    qsizetype result = 0;
     for (QCPDataRange dataRange : mDataRanges)
         result += dataRange.length();
     return result;
@@ -32,7 +32,7 @@ class QCP_LIB_DECL QCPDataRange
 {
 public:
     QCPDataRange();
-    QCPDataRange(int begin, int end);
+    QCPDataRange(qsizetype begin, qsizetype end);
 
     [[nodiscard]] bool operator==(const QCPDataRange& other) const
     {
@@ -42,18 +42,18 @@ public:
     [[nodiscard]] bool operator!=(const QCPDataRange& other) const { return !(*this == other); }
 
     // getters:
-    [[nodiscard]] int begin() const { return mBegin; }
+    [[nodiscard]] qsizetype begin() const { return mBegin; }
 
-    [[nodiscard]] int end() const { return mEnd; }
+    [[nodiscard]] qsizetype end() const { return mEnd; }
 
-    [[nodiscard]] int size() const { return mEnd - mBegin; }
+    [[nodiscard]] qsizetype size() const { return mEnd - mBegin; }
 
-    [[nodiscard]] int length() const { return size(); }
+    [[nodiscard]] qsizetype length() const { return size(); }
 
     // setters:
-    void setBegin(int begin) { mBegin = begin; }
+    void setBegin(qsizetype begin) { mBegin = begin; }
 
-    void setEnd(int end) { mEnd = end; }
+    void setEnd(qsizetype end) { mEnd = end; }
 
     // non-property methods:
     [[nodiscard]] bool isValid() const { return (mEnd >= mBegin) && (mBegin >= 0); }
@@ -64,7 +64,7 @@ public:
     [[nodiscard]] QCPDataRange expanded(const QCPDataRange& other) const;
     [[nodiscard]] QCPDataRange intersection(const QCPDataRange& other) const;
 
-    [[nodiscard]] QCPDataRange adjusted(int changeBegin, int changeEnd) const
+    [[nodiscard]] QCPDataRange adjusted(qsizetype changeBegin, qsizetype changeEnd) const
     {
         return QCPDataRange(mBegin + changeBegin, mEnd + changeEnd);
     }
@@ -74,7 +74,7 @@ public:
 
 private:
     // property members:
-    int mBegin, mEnd;
+    qsizetype mBegin, mEnd;
 };
 
 Q_DECLARE_TYPEINFO(QCPDataRange, Q_MOVABLE_TYPE);
@@ -111,7 +111,7 @@ public:
     // getters:
     [[nodiscard]] int dataRangeCount() const { return mDataRanges.size(); }
 
-    [[nodiscard]] int dataPointCount() const;
+    [[nodiscard]] qsizetype dataPointCount() const;
     [[nodiscard]] QCPDataRange dataRange(int index = 0) const;
 
     [[nodiscard]] QList<QCPDataRange> dataRanges() const { return mDataRanges; }
@@ -27,12 +27,14 @@
 #include "test-creation-mode/test-creation-mode.h"
 #include "test-grid-rhi/test-grid-rhi.h"
 #include "test-scatter-rhi/test-scatter-rhi.h"
+#include "test-rhi-slot-buffer/test-rhi-slot-buffer.h"
 
-#define QCPTEST(t) t t##instance; QTest::qExec(&t##instance)
+#define QCPTEST(t) t t##instance; status |= QTest::qExec(&t##instance)
 
 int main(int argc, char **argv)
 {
   QApplication app(argc, argv);
+  int status = 0;
   
   QCPTEST(TestQCustomPlot);
   QCPTEST(TestQCPGraph);
@@ -63,6 +65,7 @@ int main(int argc, char **argv)
   QCPTEST(TestCreationMode);
   QCPTEST(TestGridRhi);
   QCPTEST(TestScatterRhi);
+  QCPTEST(TestRhiSlotBuffer);
 
-  return 0;
+  return status;
 }
@@ -2,6 +2,16 @@
 #include "qcustomplot.h"
 #include "datasource/algorithms.h"
 #include "datasource/soa-datasource.h"
+#include "datasource/appendable-datasource.h"
+#include "datasource/mmap-datasource.h"
+#include "datasource/chunked-datasource.h"
+#include "datasource/graph-resampler.h"
+#include "datasource/pipeline-scheduler.h"
+#include <QFile>
+#include <QTemporaryDir>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
 #include <vector>
 
 void TestDataSource::init() {}
@@ -266,6 +276,96 @@ void TestDataSource::soaMismatchedLengthsDegradeToEmpty()
     QVERIFY(!found);
 }
 
+void TestDataSource::appendableSnapshotIsStable()
+{
+    // A snapshot is a frozen view: later appends (including ones that
+    // reallocate the backing block) must not change what it reads.
+    QCPAppendableDataSource<double, float> store;
+    QVERIFY(store.append(std::vector<double>{1.0, 2.0, 3.0}, std::vector<float>{10.f, 20.f, 30.f}));
+    auto first = store.snapshot();
+    QCOMPARE(first->size(), 3);
+
+    std::vector<double> keys(5000);
+    std::vector<float> values(5000);
+    for (int i = 0; i < 5000; ++i)
+    {
+        keys[i] = 4.0 + i;
+        values[i] = static_cast<float>(i);
+    }
+    QVERIFY(store.append(keys, values));
+    QCOMPARE(store.size(), 5003);
+
+    QCOMPARE(first->size(), 3);
+    QCOMPARE(first->keyAt(2), 3.0);
+    QCOMPARE(first->valueAt(2), 30.0);
+
+    auto second = store.snapshot();
+    QCOMPARE(second->size(), 5003);
+    QCOMPARE(second->keyAt(0), 1.0);
+    QCOMPARE(second->keyAt(5002), 5003.0);
+    QCOMPARE(second->valueAt(5002), 4999.0);
+}
+
+void TestDataSource::appendableRejectsUnsortedBatch()
+{
+    QCPAppendableDataSource<double, double> store;
+    QVERIFY(store.append(std::vector<double>{5.0, 6.0}, std::vector<double>{1.0, 2.0}));
+
+    // Starts before the stored tail
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("not sorted"));
+    QVERIFY(!store.append(std::vector<double>{4.0}, std::vector<double>{3.0}));
+    // Unsorted within the batch
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("not sorted"));
+    QVERIFY(!store.append(std::vector<double>{8.0, 7.0}, std::vector<double>{3.0, 4.0}));
+    // Length mismatch
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("length mismatch"));
+    QVERIFY(!store.append(std::vector<double>{9.0}, std::vector<double>{}));
+
+    QCOMPARE(store.size(), 2);
+}
+
+void TestDataSource::graph2AddData()
+{
+    mPlot = new QCustomPlot();
+    auto* graph = new QCPGraph2(mPlot->xAxis, mPlot->yAxis);
+    graph->setData(std::vector<double>{1.0, 2.0}, std::vector<double>{10.0, 20.0});
+
+    // First addData seeds the append store from the existing data
+    graph->addData(std::vector<double>{3.0, 4.0}, std::vector<double>{30.0, 40.0});
+    QCOMPARE(graph->dataCount(), 4);
+    QCOMPARE(graph->dataMainKey(0), 1.0);
+    QCOMPARE(graph->dataMainValue(3), 40.0);
+
+    graph->addData(std::vector<double>{5.0}, std::vector<double>{50.0});
+    QCOMPARE(graph->dataCount(), 5);
+    QCOMPARE(graph->dataMainValue(4), 50.0);
+
+    // Other element types would re-seed the store: dropped instead
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("element types differ"));
+    graph->addData(std::vector<double>{6.0}, std::vector<float>{60.0f});
+    QCOMPARE(graph->dataCount(), 5);
+
+    // setData replaces the store: the next addData appends to the new data
+    graph->setData(std::vector<double>{100.0}, std::vector<double>{1.0});
+    graph->addData(std::vector<double>{101.0}, std::vector<double>{2.0});
+    QCOMPARE(graph->dataCount(), 2);
+    QCOMPARE(graph->dataMainKey(0), 100.0);
+
+    // A first batch whose types would round the existing data is dropped
+    graph->setData(std::vector<double>{1.0, 2.0}, std::vector<double>{0.1, 0.2});
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("does not convert exactly"));
+    graph->addData(std::vector<double>{3.0}, std::vector<float>{0.3f});
+    QCOMPARE(graph->dataCount(), 2);
+    QCOMPARE(graph->dataMainValue(1), 0.2);
+
+    // ...but data that converts exactly is taken over, e.g. integral doubles
+    graph->setData(std::vector<double>{1.0, 2.0}, std::vector<double>{10.0, -20.0});
+    graph->addData(std::vector<qint64>{3}, std::vector<int>{30});
+    QCOMPARE(graph->dataCount(), 3);
+    QCOMPARE(graph->dataMainValue(1), -20.0);
+    QCOMPARE(graph->dataMainKey(2), 3.0);
+}
+
 // QCPGraph2 integration tests
 void TestDataSource::graph2Creation()
 {
@@ -461,3 +561,289 @@ void TestDataSource::graph2LineStyleNoneWithScatter()
     graph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssPlus, 8));
     mPlot->replot(QCustomPlot::rpImmediateRefresh);
 }
+
+namespace {
+// Writes a version 1.0 .npy file (header padded to 64 bytes, as numpy does).
+template <typename T>
+bool writeNpy(const QString& path, const char* descr, const std::vector<T>& data,
+              const QByteArray& shape, bool fortran = false)
+{
+    QByteArray header = QByteArray("{'descr': '") + descr + "', 'fortran_order': "
+        + (fortran ? "True" : "False") + ", 'shape': " + shape + ", }";
+    while ((10 + header.size() + 1) % 64 != 0)
+        header += ' ';
+    header += '\n';
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly))
+        return false;
+    f.write("\x93NUMPY\x01\x00", 8);
+    const quint16 len = static_cast<quint16>(header.size());
+    f.write(reinterpret_cast<const char*>(&len), 2);
+    f.write(header);
+    f.write(reinterpret_cast<const char*>(data.data()), qint64(data.size() * sizeof(T)));
+    return true;
+}
+} // namespace
+
+void TestDataSource::mmapNpyColumns()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const int n = 1000;
+    std::vector<double> keys(n);
+    std::vector<std::int16_t> values(n);
+    std::vector<float> grid(n * 3); // rows x 3, C order
+    for (int i = 0; i < n; ++i)
+    {
+        keys[i] = i * 0.5;
+        values[i] = static_cast<std::int16_t>(i % 200 - 100);
+        for (int c = 0; c < 3; ++c)
+            grid[i * 3 + c] = float(i * 10 + c);
+    }
+    QVERIFY(writeNpy(dir.filePath("k.npy"), "<f8", keys, "(1000,)"));
+    QVERIFY(writeNpy(dir.filePath("v.npy"), "<i2", values, "(1000,)"));
+    QVERIFY(writeNpy(dir.filePath("g.npy"), "<f4", grid, "(1000, 3)"));
+
+    auto src = QCPMmapDataSource::openNpy(dir.filePath("k.npy"), dir.filePath("v.npy"));
+    QVERIFY(src);
+    QCOMPARE(src->size(), qsizetype(n));
+    QCOMPARE(src->keyAt(10), 5.0);
+    QCOMPARE(src->valueAt(150), 50.0);
+    QCOMPARE(src->findBegin(100.0, false), qsizetype(200));
+    bool found = false;
+    const QCPRange vr = src->valueRange(found);
+    QVERIFY(found);
+    QCOMPARE(vr.lower, -100.0);
+    QCOMPARE(vr.upper, 99.0);
+    src->adviseAccess(0, n, QCPAccessHint::WillNeed); // hint only: must not disturb reads
+    QCOMPARE(src->valueAt(n - 1), 99.0);
+
+    // 2-D values need the multi-column source.
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("value columns"));
+    QVERIFY(!QCPMmapDataSource::openNpy(dir.filePath("k.npy"), dir.filePath("g.npy")));
+    auto multi = QCPMmapMultiDataSource::openNpy(dir.filePath("k.npy"), dir.filePath("g.npy"));
+    QVERIFY(multi);
+    QCOMPARE(multi->columnCount(), 3);
+    QCOMPARE(multi->valueAt(2, 7), 72.0);
+}
+
+void TestDataSource::mmapRawLayouts()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    // [16-byte preamble][keys int64 x n][values float64, column-major n x 2]
+    const int n = 64;
+    QByteArray bytes(16, '\0');
+    for (int i = 0; i < n; ++i)
+    {
+        const std::int64_t k = 1000 + i;
+        bytes.append(reinterpret_cast<const char*>(&k), sizeof k);
+    }
+    for (int c = 0; c < 2; ++c)
+        for (int i = 0; i < n; ++i)
+        {
+            const double v = c * 100.0 + i;
+            bytes.append(reinterpret_cast<const char*>(&v), sizeof v);
+        }
+    const QString path = dir.filePath("raw.bin");
+    {
+        QFile f(path);
+        QVERIFY(f.open(QIODevice::WriteOnly));
+        f.write(bytes);
+    }
+
+    QCPMmapLayout layout;
+    layout.rows = n;
+    layout.columns = 2;
+    layout.keyType = QCPDType::Int64;
+    layout.keyOffset = 16;
+    layout.valueType = QCPDType::Float64;
+    layout.valueOffset = 16 + n * 8;
+    auto multi = QCPMmapMultiDataSource::openRaw(path, layout);
+    QVERIFY(multi);
+    QCOMPARE(multi->keyAt(3), 1003.0);
+    QCOMPARE(multi->valueAt(1, 5), 105.0);
+    QVERIFY(multi->rawColumnData(0)); // contiguous doubles keep the fast path
+
+    layout.columns = 1;
+    auto single = QCPMmapDataSource::openRaw(path, layout);
+    QVERIFY(single);
+    QCOMPARE(single->valueAt(63), 63.0);
+
+    // Shape lies degrade to nullptr with a warning, never to reads past the file.
+    layout.rows = n + 1;
+    layout.columns = 2;
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("don't fit"));
+    QVERIFY(!QCPMmapMultiDataSource::openRaw(path, layout));
+    layout.rows = n;
+    layout.valueOffset = 17;
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("not aligned"));
+    QVERIFY(!QCPMmapMultiDataSource::openRaw(path, layout));
+}
+
+namespace {
+
+// 10 chunks of 1000 samples, keys 0..9999 with a few NaN values.
+struct ChunkedFixture {
+    std::vector<double> keys, values;
+    std::vector<QCPChunkSummary> summaries;
+    std::shared_ptr<std::atomic<int>> loads = std::make_shared<std::atomic<int>>(0);
+    static constexpr int kChunk = 1000;
+
+    ChunkedFixture()
+    {
+        for (int i = 0; i < 10 * kChunk; ++i)
+        {
+            keys.push_back(i);
+            values.push_back(i % 97 == 0 ? qQNaN() : std::sin(i * 0.01) * 100);
+        }
+        for (int c = 0; c < 10; ++c)
+            summaries.push_back(QCPChunkSummary::of(keys.data() + c * kChunk, values.data() + c * kChunk, kChunk));
+    }
+
+    QCPChunkLoader loader() const
+    {
+        return [keys = keys, values = values, loads = loads](int c) {
+            ++*loads;
+            auto p = std::make_shared<QCPChunkPayload>();
+            p->keys.assign(keys.begin() + c * kChunk, keys.begin() + (c + 1) * kChunk);
+            p->values.assign(values.begin() + c * kChunk, values.begin() + (c + 1) * kChunk);
+            return std::shared_ptr<const QCPChunkPayload>(p);
+        };
+    }
+};
+
+} // namespace
+
+void TestDataSource::chunkedMatchesContiguous()
+{
+    ChunkedFixture fx;
+    QCPChunkedDataSource chunked(fx.summaries, fx.loader());
+    QCPSoADataSource<std::vector<double>, std::vector<double>> ref(fx.keys, fx.values);
+    QCOMPARE(chunked.size(), ref.size());
+
+    // Searches landing on a chunk boundary don't load anything.
+    QCOMPARE(chunked.findBegin(3000, false), qsizetype(3000));
+    QCOMPARE(chunked.findEnd(2999.5, false), qsizetype(3000));
+    QCOMPARE(fx.loads->load(), 0);
+
+    for (double k : {-5.0, 0.0, 0.5, 999.0, 1000.0, 4321.5, 9999.0, 20000.0})
+    {
+        QCOMPARE(chunked.findBegin(k), ref.findBegin(k));
+        QCOMPARE(chunked.findEnd(k), ref.findEnd(k));
+    }
+    QCOMPARE(chunked.keyAt(4567), 4567.0);
+    QCOMPARE(chunked.valueAt(4567), fx.values[4567]);
+
+    bool found = false, refFound = false;
+    QVERIFY(chunked.valueRange(found) == ref.valueRange(refFound));
+    QCOMPARE(found, refFound);
+    const QCPRange window(1234.5, 5678.5);
+    QVERIFY(chunked.valueRange(found, QCP::sdPositive, window)
+            == ref.valueRange(refFound, QCP::sdPositive, window));
+    QVERIFY(chunked.keyRange(found, QCP::sdPositive) == ref.keyRange(refFound, QCP::sdPositive));
+
+    // L1-style binning: bins spanning whole chunks fold their summaries
+    // without loading; finer bins load and still match exactly.
+    for (double binWidth : {2000.0, 37.0})
+    {
+        const int bins = int(10000 / binWidth) + 1;
+        std::vector<double> got(2 * bins, qQNaN()), want(2 * bins, qQNaN());
+        const int before = fx.loads->load();
+        QCPChunkedDataSource cold(fx.summaries, fx.loader());
+        cold.accumulateMinMax(0, cold.size(), 0, binWidth, got.data(), 0, bins);
+        ref.accumulateMinMax(0, ref.size(), 0, binWidth, want.data(), 0, bins);
+        for (int i = 0; i < 2 * bins; ++i)
+            QVERIFY(got[i] == want[i] || (std::isnan(got[i]) && std::isnan(want[i])));
+        if (binWidth > 1000)
+            QCOMPARE(fx.loads->load(), before);
+    }
+}
+
+void TestDataSource::chunkedGraphFullViewLoadsNothing()
+{
+    // A long archive in many evenly spaced chunks, generated on load.
+    const int chunks = 8000, chunk = 1000;
+    auto sample = [](qsizetype i) { return std::sin(i * 0.001); };
+    std::vector<QCPChunkSummary> summaries;
+    std::vector<double> keys(chunk), values(chunk);
+    for (int c = 0; c < chunks; ++c)
+    {
+        for (int i = 0; i < chunk; ++i)
+        {
+            keys[i] = qsizetype(c) * chunk + i;
+            values[i] = sample(qsizetype(c) * chunk + i);
+        }
+        summaries.push_back(QCPChunkSummary::of(keys.data(), values.data(), chunk));
+    }
+    auto loads = std::make_shared<std::atomic<int>>(0);
+    auto source = std::make_shared<QCPChunkedDataSource>(summaries, [=](int c) {
+        ++*loads;
+        auto p = std::make_shared<QCPChunkPayload>();
+        for (int i = 0; i < chunk; ++i)
+        {
+            p->keys.push_back(qsizetype(c) * chunk + i);
+            p->values.push_back(sample(qsizetype(c) * chunk + i));
+        }
+        return std::shared_ptr<const QCPChunkPayload>(p);
+    });
+    QCOMPARE(source->l1BinWidthHint(), double(chunk));
+
+    // The L1 grid follows the chunks: one bin each, folded from the summaries.
+    std::any cache;
+    qcp::algo::buildL1Cache(*source, ViewportParams{}, cache);
+    auto* l1 = std::any_cast<qcp::algo::GraphResamplerCache>(&cache);
+    QVERIFY(l1);
+    QCOMPARE(l1->l1BinWidth, double(chunk));
+    QCOMPARE(l1->level1.bins(), chunks);
+    QCOMPARE(loads->load(), 0);
+
+    // Same through QCPGraph2: building its L1 and drawing the full view.
+    mPlot = new QCustomPlot();
+    mPlot->resize(400, 300);
+    auto* graph = new QCPGraph2(mPlot->xAxis, mPlot->yAxis);
+    graph->setDataSource(std::shared_ptr<QCPAbstractDataSource>(source));
+    mPlot->xAxis->setRange(0, double(chunks) * chunk);
+    mPlot->yAxis->setRange(-1.5, 1.5);
+    QTRY_VERIFY_WITH_TIMEOUT(!graph->pipeline().isBusy(), 30000);
+    mPlot->replot(QCustomPlot::rpImmediateRefresh);
+    mPlot->replot(QCustomPlot::rpImmediateRefresh);
+    QCOMPARE(loads->load(), 0);
+}
+
+void TestDataSource::chunkedLruBudget()
+{
+    ChunkedFixture fx;
+    const qint64 chunkBytes = ChunkedFixture::kChunk * 16;
+    QCPChunkedDataSource chunked(fx.summaries, fx.loader(), 3 * chunkBytes);
+    std::vector<double> keys(chunked.size()), values(chunked.size());
+    chunked.readSamples(0, chunked.size(), keys.data(), values.data());
+    QCOMPARE(keys, fx.keys);
+    QCOMPARE(fx.loads->load(), 10);
+    QCOMPARE(chunked.residentBytes(), 3 * chunkBytes);
+    QVERIFY(chunked.isResident(9) && chunked.isResident(7) && !chunked.isResident(6));
+
+    chunked.keyAt(8500); // hit: no reload, 8 becomes most recent
+    QCOMPARE(fx.loads->load(), 10);
+    chunked.keyAt(500);  // miss: evicts 7, the least recently used
+    QVERIFY(!chunked.isResident(7) && chunked.isResident(8) && chunked.isResident(0));
+
+    chunked.setMemoryBudget(chunkBytes);
+    QCOMPARE(chunked.residentBytes(), chunkBytes);
+
+    // WillNeed prefetches through the scheduler and reports each landed chunk.
+    QCPPipelineScheduler scheduler(2);
+    std::atomic<int> landed{0};
+    chunked.setMemoryBudget(10 * chunkBytes);
+    chunked.setScheduler(&scheduler);
+    chunked.setChunkLoadedCallback([&landed](int) { ++landed; });
+    chunked.adviseAccess(2000, 4000, QCPAccessHint::WillNeed);
+    QTRY_COMPARE(landed.load(), 2);
+    QVERIFY(chunked.isResident(2) && chunked.isResident(3));
+
+    // A failed load reads as NaN values (a gap) and isn't cached.
+    QCPChunkedDataSource broken(fx.summaries, [](int) { return std::shared_ptr<const QCPChunkPayload>(); });
+    QVERIFY(std::isnan(broken.valueAt(10)));
+    QCOMPARE(broken.keyAt(999), 999.0);
+    QCOMPARE(broken.residentBytes(), qint64(0));
+}
@@ -27,6 +27,18 @@ private slots:
     void soaIntValues();
     void soaMismatchedLengthsDegradeToEmpty();
 
+    // Appendable data source tests
+    void appendableSnapshotIsStable();
+    void appendableRejectsUnsortedBatch();
+    void graph2AddData();
+
+    // Memory-mapped data source tests
+    void mmapNpyColumns();
+    void mmapRawLayouts();
+    void chunkedMatchesContiguous();
+    void chunkedGraphFullViewLoadsNothing();
+    void chunkedLruBudget();
+
     // QCPGraph2 integration tests
     void graph2Creation();
     void graph2SetDataOwning();
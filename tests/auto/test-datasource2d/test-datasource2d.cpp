@@ -3,9 +3,11 @@
 #include <datasource/algorithms-2d.h>
 #include <datasource/soa-datasource-2d.h>
 #include <datasource/resample.h>
+#include <datasource/pipeline-stats.h>
 #include <QtTest/QtTest>
 #include <QTemporaryFile>
 #include <cmath>
+#include <numeric>
 #include <span>
 
 void TestDataSource2D::init()
@@ -801,6 +803,105 @@ void TestDataSource2D::resampleVariableYPerColumn()
     delete r;
 }
 
+void TestDataSource2D::resampleNativeTypesMatchDouble()
+{
+    // float32 / 16-bit spectrograms take the typed raw path; every value is
+    // exactly representable in double, so the output must equal that of a
+    // double copy of the same data.
+    const int nx = 300, ys = 40;
+    std::vector<double> x(nx), yD(ys), zD(static_cast<std::size_t>(nx) * ys);
+    std::vector<float> yF(ys), zF(zD.size());
+    std::vector<quint16> zU(zD.size());
+    std::vector<qint32> zI(zD.size());
+    for (int i = 0; i < nx; ++i)
+        x[i] = i * 2.0;
+    for (int j = 0; j < ys; ++j)
+        yF[j] = static_cast<float>(yD[j] = 10.0 + j * 0.5);
+    for (std::size_t i = 0; i < zD.size(); ++i)
+    {
+        zU[i] = static_cast<quint16>((i * 2654435761u) >> 16);
+        zI[i] = zU[i];
+        zF[i] = static_cast<float>(zD[i] = zU[i]);
+    }
+
+    QCPSoADataSource2D<std::span<const double>, std::span<const float>, std::span<const float>>
+        floatSrc(x, yF, zF);
+    QCPSoADataSource2D<std::span<const double>, std::span<const double>, std::span<const quint16>>
+        adcSrc(x, yD, zU);
+    QCPSoADataSource2D<std::span<const double>, std::span<const double>, std::span<const qint32>>
+        intSrc(x, yD, zI);
+    QCPSoADataSource2D<std::span<const double>, std::span<const double>, std::span<const double>>
+        doubleSrc(x, yD, zD);
+    QCOMPARE(floatSrc.rawZ().type, QCPRawArray::Type::Float32);
+    QCOMPARE(adcSrc.rawZ().type, QCPRawArray::Type::UInt16);
+
+    auto resampleOf = [&](const QCPAbstractDataSource2D& src) {
+        return std::unique_ptr<QCPColorMapData>(qcp::algo2d::resample(
+            src, 0, nx, QCPRange(0, 2.0 * (nx - 1)), QCPRange(10, 10 + 0.5 * (ys - 1)),
+            97, 23, false, 1.5));
+    };
+    auto reference = resampleOf(doubleSrc);
+    QVERIFY(reference);
+    for (const QCPAbstractDataSource2D* src : {static_cast<const QCPAbstractDataSource2D*>(&floatSrc),
+                                               static_cast<const QCPAbstractDataSource2D*>(&adcSrc),
+                                               static_cast<const QCPAbstractDataSource2D*>(&intSrc)})
+    {
+        auto out = resampleOf(*src);
+        QVERIFY(out);
+        for (int i = 0; i < reference->keySize(); ++i)
+        {
+            for (int j = 0; j < reference->valueSize(); ++j)
+            {
+                const double r = reference->cell(i, j);
+                if (std::isnan(r))
+                    QVERIFY(std::isnan(out->cell(i, j)));
+                else
+                    QCOMPARE(out->cell(i, j), r);
+            }
+        }
+    }
+}
+
+void TestDataSource2D::resamplePreviewReadsStridedColumns()
+{
+    // z equals the column index, so any column subset still rises along x.
+    const int nx = 20000, ys = 8;
+    std::vector<double> x(nx), y(ys), z(static_cast<std::size_t>(nx) * ys);
+    for (int i = 0; i < nx; ++i)
+    {
+        x[i] = i;
+        for (int j = 0; j < ys; ++j)
+            z[static_cast<std::size_t>(i) * ys + j] = i;
+    }
+    std::iota(y.begin(), y.end(), 0.0);
+    QCPSoADataSource2D src(std::move(x), std::move(y), std::move(z));
+
+    std::atomic<quint64> bytes{0};
+    std::unique_ptr<QCPColorMapData> preview;
+    {
+        qcp::ScanCounterScope scope(&bytes);
+        preview.reset(qcp::algo2d::resamplePreview(src, 0, nx, QCPRange(0, nx - 1),
+                                                   QCPRange(0, ys - 1), 50, ys, false, 1.5));
+    }
+    QVERIFY(preview);
+    QCOMPARE(preview->keySize(), 50);
+    QCOMPARE(preview->valueSize(), ys);
+
+    // About kPreviewColumnsPerBin columns per target column were read, not all 20000.
+    const quint64 columnBytes = sizeof(double) + ys * sizeof(double);
+    QVERIFY(bytes.load() <= quint64(50 * qcp::algo2d::kPreviewColumnsPerBin + 2) * columnBytes + ys * sizeof(double));
+
+    double previous = -1;
+    for (int i = 0; i < preview->keySize(); ++i)
+    {
+        const double v = preview->cell(i, ys / 2);
+        QVERIFY2(!std::isnan(v), qPrintable(QString("empty preview column %1").arg(i)));
+        QVERIFY(v >= previous);
+        previous = v;
+    }
+    QVERIFY(previous > nx * 0.9);
+}
+
 void TestDataSource2D::colormap2NanHandling()
 {
     // Bug #2: Default NaN handling was nhNone, causing UB when colorizing
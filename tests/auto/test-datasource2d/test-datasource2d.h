@@ -45,6 +45,8 @@ private slots:
     void resampleZoomedOutNotBlack();
     void resampleLogYResolutionNotCoarse();
     void resampleVariableYPerColumn();
+    void resampleNativeTypesMatchDouble();
+    void resamplePreviewReadsStridedColumns();
     void colormap2NanHandling();
     void colormap2DataScaleTypeSync();
 
@@ -1,46 +1,43 @@
 #include "test-line-extruder.h"
 #include "painting/line-extruder.h"
+#include "datasource/pixel-line.h"
+#include "../../../src/qcp.h"
+#include "../../../src/painting/plottable-rhi-layer.h"
+#include <QtWidgets/qtestsupport_widgets.h>
 #include <QPolygonF>
 
 void TestLineExtruder::horizontalSegment()
 {
     QVector<QPointF> points = {{0.0, 5.0}, {10.0, 5.0}};
-    QColor color(255, 0, 0, 255);
     float penWidth = 2.0f;
 
-    auto verts = QCPLineExtruder::extrudePolyline(points, penWidth, color);
+    auto verts = QCPLineExtruder::extrudePolyline(points, penWidth);
 
     // 2 points → 1 segment → 1 quad → 6 vertices (triangle list)
-    // each vertex: x, y, r, g, b, a = 6 floats
-    QCOMPARE(verts.size(), 6 * 6);
+    // each vertex: x, y = 2 floats; the color is per draw, not per vertex
+    QCOMPARE(verts.size(), 6 * 2);
 
     // Verify the quad spans y = 4.0 to y = 6.0 (penWidth/2 = 1.0 offset)
     // and x = 0.0 to x = 10.0
     for (int i = 0; i < 6; ++i) {
-        float y = verts[i * 6 + 1];
+        float y = verts[i * 2 + 1];
         QVERIFY(qFuzzyCompare(y, 4.0f) || qFuzzyCompare(y, 6.0f));
-        float x = verts[i * 6 + 0];
+        float x = verts[i * 2 + 0];
         QVERIFY(x >= -0.01f && x <= 10.01f);
-        // Check color (premultiplied: alpha=1.0 so RGB unchanged)
-        QCOMPARE(verts[i * 6 + 2], 1.0f); // r
-        QCOMPARE(verts[i * 6 + 3], 0.0f); // g
-        QCOMPARE(verts[i * 6 + 4], 0.0f); // b
-        QCOMPARE(verts[i * 6 + 5], 1.0f); // a
     }
 }
 
 void TestLineExtruder::verticalSegment()
 {
     QVector<QPointF> points = {{5.0, 0.0}, {5.0, 10.0}};
-    QColor color(0, 255, 0, 255);
     float penWidth = 4.0f;
 
-    auto verts = QCPLineExtruder::extrudePolyline(points, penWidth, color);
+    auto verts = QCPLineExtruder::extrudePolyline(points, penWidth);
 
-    QCOMPARE(verts.size(), 6 * 6);
+    QCOMPARE(verts.size(), 6 * 2);
 
     for (int i = 0; i < 6; ++i) {
-        float x = verts[i * 6 + 0];
+        float x = verts[i * 2 + 0];
         QVERIFY(qFuzzyCompare(x, 3.0f) || qFuzzyCompare(x, 7.0f));
     }
 }
@@ -48,26 +45,24 @@ void TestLineExtruder::verticalSegment()
 void TestLineExtruder::miterJoin()
 {
     QVector<QPointF> points = {{0.0, 0.0}, {10.0, 0.0}, {10.0, 10.0}};
-    QColor color(0, 0, 255, 255);
     float penWidth = 2.0f;
 
-    auto verts = QCPLineExtruder::extrudePolyline(points, penWidth, color);
+    auto verts = QCPLineExtruder::extrudePolyline(points, penWidth);
 
     // 3 points → 2 segments → 2 quads → 12 vertices
-    QCOMPARE(verts.size(), 12 * 6);
+    QCOMPARE(verts.size(), 12 * 2);
 }
 
 void TestLineExtruder::bevelFallback()
 {
     QVector<QPointF> points = {{0.0, 0.0}, {10.0, 0.0}, {0.5, 0.5}};
-    QColor color(255, 255, 255, 255);
     float penWidth = 4.0f;
 
-    auto verts = QCPLineExtruder::extrudePolyline(points, penWidth, color);
+    auto verts = QCPLineExtruder::extrudePolyline(points, penWidth);
 
     // Bevel adds 1 extra triangle (3 verts) at the join
     // 2 quads (12) + 1 bevel triangle (3) = 15 vertices
-    QCOMPARE(verts.size(), 15 * 6);
+    QCOMPARE(verts.size(), 15 * 2);
 }
 
 void TestLineExtruder::nanGap()
@@ -77,34 +72,33 @@ void TestLineExtruder::nanGap()
         {qQNaN(), qQNaN()},
         {20.0, 0.0}, {30.0, 0.0}
     };
-    QColor color(255, 0, 0, 255);
     float penWidth = 2.0f;
 
-    auto verts = QCPLineExtruder::extrudePolyline(points, penWidth, color);
+    auto verts = QCPLineExtruder::extrudePolyline(points, penWidth);
 
     // Two separate segments, each 1 quad = 6 verts → 12 total
-    QCOMPARE(verts.size(), 12 * 6);
+    QCOMPARE(verts.size(), 12 * 2);
 }
 
 void TestLineExtruder::singlePoint()
 {
     QVector<QPointF> points = {{5.0, 5.0}};
-    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f, Qt::red);
+    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f);
     QVERIFY(verts.isEmpty());
 }
 
 void TestLineExtruder::emptyInput()
 {
     QVector<QPointF> points;
-    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f, Qt::red);
+    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f);
     QVERIFY(verts.isEmpty());
 }
 
 void TestLineExtruder::twoPoints()
 {
     QVector<QPointF> points = {{0.0, 0.0}, {10.0, 0.0}};
-    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f, Qt::red);
-    QCOMPARE(verts.size(), 6 * 6);
+    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f);
+    QCOMPARE(verts.size(), 6 * 2);
 }
 
 void TestLineExtruder::consecutiveNaNs()
@@ -114,35 +108,35 @@ void TestLineExtruder::consecutiveNaNs()
         {qQNaN(), qQNaN()}, {qQNaN(), qQNaN()},
         {20.0, 0.0}, {30.0, 0.0}
     };
-    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f, Qt::red);
-    QCOMPARE(verts.size(), 12 * 6);
+    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f);
+    QCOMPARE(verts.size(), 12 * 2);
 }
 
 void TestLineExtruder::nanAtStart()
 {
     QVector<QPointF> points = {{qQNaN(), qQNaN()}, {0.0, 0.0}, {10.0, 0.0}};
-    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f, Qt::red);
-    QCOMPARE(verts.size(), 6 * 6);
+    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f);
+    QCOMPARE(verts.size(), 6 * 2);
 }
 
 void TestLineExtruder::nanAtEnd()
 {
     QVector<QPointF> points = {{0.0, 0.0}, {10.0, 0.0}, {qQNaN(), qQNaN()}};
-    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f, Qt::red);
-    QCOMPARE(verts.size(), 6 * 6);
+    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f);
+    QCOMPARE(verts.size(), 6 * 2);
 }
 
 void TestLineExtruder::duplicatePoints()
 {
     QVector<QPointF> points = {{5.0, 5.0}, {5.0, 5.0}, {15.0, 5.0}};
-    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f, Qt::red);
+    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f);
     QVERIFY(!verts.isEmpty());
 }
 
 void TestLineExtruder::zeroWidthPen()
 {
     QVector<QPointF> points = {{0.0, 0.0}, {10.0, 0.0}};
-    auto verts = QCPLineExtruder::extrudePolyline(points, 0.0f, Qt::red);
+    auto verts = QCPLineExtruder::extrudePolyline(points, 0.0f);
     QVERIFY(verts.isEmpty());
 }
 
@@ -154,24 +148,24 @@ void TestLineExtruder::infGap()
         {inf, inf},
         {20.0, 0.0}, {30.0, 0.0}
     };
-    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f, Qt::red);
-    QCOMPARE(verts.size(), 12 * 6);
+    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f);
+    QCOMPARE(verts.size(), 12 * 2);
 }
 
 void TestLineExtruder::infAtStart()
 {
     constexpr double inf = std::numeric_limits<double>::infinity();
     QVector<QPointF> points = {{inf, inf}, {0.0, 0.0}, {10.0, 0.0}};
-    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f, Qt::red);
-    QCOMPARE(verts.size(), 6 * 6);
+    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f);
+    QCOMPARE(verts.size(), 6 * 2);
 }
 
 void TestLineExtruder::infAtEnd()
 {
     constexpr double inf = std::numeric_limits<double>::infinity();
     QVector<QPointF> points = {{0.0, 0.0}, {10.0, 0.0}, {inf, inf}};
-    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f, Qt::red);
-    QCOMPARE(verts.size(), 6 * 6);
+    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f);
+    QCOMPARE(verts.size(), 6 * 2);
 }
 
 void TestLineExtruder::mixedNanInf()
@@ -184,15 +178,15 @@ void TestLineExtruder::mixedNanInf()
         {inf, qQNaN()},
         {40.0, 0.0}, {50.0, 0.0}
     };
-    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f, Qt::red);
-    QCOMPARE(verts.size(), 18 * 6);
+    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f);
+    QCOMPARE(verts.size(), 18 * 2);
 }
 
 void TestLineExtruder::bothPointsInf()
 {
     constexpr double inf = std::numeric_limits<double>::infinity();
     QVector<QPointF> points = {{inf, 0.0}, {inf, 10.0}};
-    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f, Qt::red);
+    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f);
     QVERIFY(verts.isEmpty());
 }
 
@@ -204,8 +198,8 @@ void TestLineExtruder::negativeInf()
         {-inf, -inf},
         {20.0, 0.0}, {30.0, 0.0}
     };
-    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f, Qt::red);
-    QCOMPARE(verts.size(), 12 * 6);
+    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f);
+    QCOMPARE(verts.size(), 12 * 2);
 }
 
 void TestLineExtruder::singleInfCoord()
@@ -216,8 +210,8 @@ void TestLineExtruder::singleInfCoord()
         {inf, 5.0},
         {20.0, 0.0}, {30.0, 0.0}
     };
-    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f, Qt::red);
-    QCOMPARE(verts.size(), 12 * 6);
+    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f);
+    QCOMPARE(verts.size(), 12 * 2);
 }
 
 void TestLineExtruder::overflowToInf()
@@ -228,23 +222,90 @@ void TestLineExtruder::overflowToInf()
         {big, big},
         {20.0, 0.0}, {30.0, 0.0}
     };
-    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f, Qt::red);
+    auto verts = QCPLineExtruder::extrudePolyline(points, 2.0f);
     // big*big overflows to Inf in normalized() — must not crash
     QVERIFY(!verts.isEmpty());
 }
 
+void TestLineExtruder::pixelLineMatchesPoints()
+{
+    QVector<QPointF> points = {
+        {100.0, 50.0}, {110.0, 58.0}, {120.0, 41.0},
+        {qQNaN(), qQNaN()},
+        {130.0, 45.0}, {140.0, 60.0}
+    };
+    QCPPixelLine line;
+    line.origin = QPointF(80, 30);
+    for (const QPointF& p : points)
+        line.append(p);
+
+    std::vector<float> fromPoints, fromLine;
+    QCPLineExtruder::extrudePolyline(points, 3.0f, fromPoints);
+    QCPLineExtruder::extrudePolyline(line, 3.0f, fromLine);
+
+    QCOMPARE(fromLine.size(), fromPoints.size());
+    QCOMPARE(fromPoints.size() % QCPLineExtruder::kFloatsPerVertex, std::size_t(0));
+    for (std::size_t i = 0; i < fromPoints.size(); ++i)
+        QVERIFY(qAbs(fromLine[i] - fromPoints[i]) < 1e-3f);
+}
+
+void TestLineExtruder::dashedArcLength()
+{
+    // 3-4-5 right angle: miter join, arc 0 -> 3 -> 7
+    QVector<QPointF> points = {{0, 0}, {3, 0}, {3, 4}};
+    std::vector<float> solid, dashed;
+    QCPLineExtruder::extrudePolyline(points, 2.0f, solid);
+    QCPLineExtruder::extrudeDashedPolyline(points, 2.0f, dashed);
+
+    constexpr int stride = QCPLineExtruder::kDashedFloatsPerVertex;
+    QCOMPARE(dashed.size() / stride, solid.size() / QCPLineExtruder::kFloatsPerVertex);
+    QCOMPARE(dashed.size() % stride, std::size_t(0));
+    float maxArc = 0;
+    for (std::size_t v = 0; v < dashed.size() / stride; ++v)
+    {
+        // Same positions as the solid extrusion
+        QCOMPARE(dashed[v * stride], solid[v * 2]);
+        QCOMPARE(dashed[v * stride + 1], solid[v * 2 + 1]);
+        const float arc = dashed[v * stride + 2];
+        QVERIFY(qFuzzyIsNull(arc) || qFuzzyCompare(arc, 3.0f) || qFuzzyCompare(arc, 7.0f));
+        maxArc = qMax(maxArc, arc);
+    }
+    QCOMPARE(maxArc, 7.0f);
+}
+
+void TestLineExtruder::dashedArcRestartsAfterGap()
+{
+    QVector<QPointF> points = {
+        {0, 0}, {10, 0},
+        {qQNaN(), qQNaN()},
+        {20, 0}, {25, 0}
+    };
+    std::vector<float> verts;
+    QCPLineExtruder::extrudeDashedPolyline(points, 2.0f, verts);
+
+    constexpr int stride = QCPLineExtruder::kDashedFloatsPerVertex;
+    QCOMPARE(verts.size(), std::size_t(12 * stride));
+    // First quad spans 0..10, the second restarts: 0..5
+    for (int v = 0; v < 12; ++v)
+    {
+        const float x = verts[v * stride];
+        const float arc = verts[v * stride + 2];
+        const float segmentStart = v < 6 ? 0.0f : 20.0f;
+        QVERIFY(qAbs(arc - (x - segmentStart)) < 1e-4f);
+    }
+}
+
 void TestLineExtruder::fillHorizontalBaseline()
 {
     // Polygon: base0(0,10), curve(0,0), curve(5,0), curve(10,0), base1(10,10)
     // Horizontal baseline at y=10, curve at y=0
     QPolygonF poly;
     poly << QPointF(0, 10) << QPointF(0, 0) << QPointF(5, 0) << QPointF(10, 0) << QPointF(10, 10);
-    QColor color(0, 0, 255, 255);
 
-    auto verts = QCPLineExtruder::tessellateFillPolygon(poly, color);
+    auto verts = QCPLineExtruder::tessellateFillPolygon(poly);
 
     // 3 curve points → first cap (3 verts) + 2 trapezoid quads (12 verts) + last cap (3 verts) = 18
-    QCOMPARE(verts.size(), 18 * 6);
+    QCOMPARE(verts.size(), 18 * 2);
 }
 
 void TestLineExtruder::fillVerticalBaseline()
@@ -252,18 +313,17 @@ void TestLineExtruder::fillVerticalBaseline()
     // Vertical baseline at x=10
     QPolygonF poly;
     poly << QPointF(10, 0) << QPointF(0, 0) << QPointF(0, 5) << QPointF(0, 10) << QPointF(10, 10);
-    QColor color(255, 0, 0, 255);
 
-    auto verts = QCPLineExtruder::tessellateFillPolygon(poly, color);
+    auto verts = QCPLineExtruder::tessellateFillPolygon(poly);
 
-    QCOMPARE(verts.size(), 18 * 6);
+    QCOMPARE(verts.size(), 18 * 2);
 }
 
 void TestLineExtruder::fillTooFewPoints()
 {
     QPolygonF poly;
     poly << QPointF(0, 0) << QPointF(5, 5) << QPointF(10, 0);
-    auto verts = QCPLineExtruder::tessellateFillPolygon(poly, Qt::red);
+    auto verts = QCPLineExtruder::tessellateFillPolygon(poly);
     QVERIFY(verts.isEmpty()); // < 4 points
 }
 
@@ -272,8 +332,86 @@ void TestLineExtruder::fillMinimalTrapezoid()
     // 4 points: base0, c0, c1, base1 → 2 curve points
     QPolygonF poly;
     poly << QPointF(0, 10) << QPointF(0, 0) << QPointF(10, 0) << QPointF(10, 10);
-    auto verts = QCPLineExtruder::tessellateFillPolygon(poly, Qt::red);
+    auto verts = QCPLineExtruder::tessellateFillPolygon(poly);
 
     // 2 curve points → first cap (3) + 1 quad (6) + last cap (3) = 12
-    QCOMPARE(verts.size(), 12 * 6);
+    QCOMPARE(verts.size(), 12 * 2);
+}
+
+// CI sets QCP_REQUIRE_RHI (Linux runs under Xvfb with Mesa llvmpipe), where a
+// missing QRhi must fail the GPU comparison instead of skipping it unnoticed.
+#define SKIP_WITHOUT_RHI(message) \
+    do { \
+        if (qEnvironmentVariableIsSet("QCP_REQUIRE_RHI")) \
+            QFAIL(message); \
+        QSKIP(message); \
+    } while (false)
+
+void TestLineExtruder::shaderExtrusionMatchesCpu()
+{
+    // Renders the same graph with CPU extrusion and with QCP::phGpuLineExtrusion
+    // and compares the frames. Runs wherever a QRhi with instancing exists,
+    // including a software rasterizer (llvmpipe).
+    QCustomPlot plot;
+    plot.resize(400, 300);
+    plot.show();
+    if (!QTest::qWaitForWindowExposed(&plot))
+        SKIP_WITHOUT_RHI("window not exposed in this environment");
+    QCoreApplication::processEvents();
+    if (!plot.rhi())
+        SKIP_WITHOUT_RHI("no QRhi available in this environment");
+
+    // Sharp zig-zags (bevel joins), gentle turns (miters), a gap and a lone point
+    const int n = 200;
+    std::vector<double> keys(n), values(n);
+    for (int i = 0; i < n; ++i)
+    {
+        keys[i] = i;
+        values[i] = (i < 80) ? ((i % 2) ? 1.0 : -1.0) : std::sin(i * 0.1);
+    }
+    values[120] = qQNaN();
+    values[122] = qQNaN();
+    auto* graph = new QCPGraph2(plot.xAxis, plot.yAxis);
+    graph->setData(std::move(keys), std::move(values));
+    graph->setPen(QPen(Qt::black, 3));
+    // A single segment is a draw of its own: three triangles, the bevel unused
+    auto* segment = new QCPGraph2(plot.xAxis, plot.yAxis);
+    segment->setData(std::vector<double>{0.0, double(n)}, std::vector<double>{-1.4, 1.4});
+    segment->setPen(QPen(Qt::black, 3));
+    plot.xAxis->setRange(0, n);
+    plot.yAxis->setRange(-1.5, 1.5);
+    plot.replot(QCustomPlot::rpImmediateRefresh);
+
+    auto* prl = plot.plottableRhiLayer(graph->layer());
+    if (!prl || !prl->supportsShaderExtrusion())
+        SKIP_WITHOUT_RHI("no instanced drawing on this QRhi backend");
+    const QImage cpu = plot.grabFramebuffer();
+
+    plot.setPlottingHint(QCP::phGpuLineExtrusion);
+    plot.replot(QCustomPlot::rpImmediateRefresh);
+    QVERIFY(prl->supportsShaderExtrusion());
+    const QImage gpu = plot.grabFramebuffer();
+
+    QCOMPARE(gpu.size(), cpu.size());
+    // Inside the axis rect only: axes and labels are drawn by QPainter either way
+    const qreal dpr = cpu.devicePixelRatio();
+    const QRect inner = QRect(plot.axisRect()->rect().topLeft() * dpr,
+                              plot.axisRect()->rect().size() * dpr)
+                            .adjusted(2, 2, -2, -2) & cpu.rect();
+    int linePixels = 0, mismatches = 0;
+    for (int y = inner.top(); y <= inner.bottom(); ++y)
+    {
+        for (int x = inner.left(); x <= inner.right(); ++x)
+        {
+            const QRgb a = cpu.pixel(x, y), b = gpu.pixel(x, y);
+            if (qGray(a) < 128)
+                ++linePixels;
+            if (qAbs(qGray(a) - qGray(b)) > 64)
+                ++mismatches;
+        }
+    }
+    QVERIFY(linePixels > 0);
+    // Same triangles up to float rounding: only edge pixels may flip
+    QVERIFY2(mismatches <= linePixels / 100,
+             qPrintable(QStringLiteral("%1 of %2 line pixels differ").arg(mismatches).arg(linePixels)));
 }
@@ -27,8 +27,14 @@ private slots:
     void negativeInf();
     void singleInfCoord();
     void overflowToInf();
+    void pixelLineMatchesPoints();
+    void dashedArcLength();
+    void dashedArcRestartsAfterGap();
     void fillHorizontalBaseline();
     void fillVerticalBaseline();
     void fillTooFewPoints();
     void fillMinimalTrapezoid();
+
+    // Shader-side extrusion against the CPU extruder (needs a live QRhi)
+    void shaderExtrusionMatchesCpu();
 };
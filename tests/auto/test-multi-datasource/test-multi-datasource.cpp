@@ -3,6 +3,7 @@
 #include "datasource/soa-multi-datasource.h"
 #include "datasource/row-major-multi-datasource.h"
 #include "datasource/resampled-multi-datasource.h"
+#include <numeric>
 #include <vector>
 #include <span>
 
@@ -676,3 +677,28 @@ void TestMultiDataSource::l2MultiEmptyInput()
     auto result = qcp::algo::resampleL2Multi(cache, vp);
     QVERIFY(result == nullptr);
 }
+
+void TestMultiDataSource::l1MultiCountsStorageBytes()
+{
+    // Scan accounting follows the storage types: 8-byte keys and two 4-byte
+    // columns are 16 bytes per row, whether stored by column or by row.
+    const int n = 2000;
+    std::vector<double> keys(n);
+    std::vector<float> col(n, 1.0f), rows(2 * n, 1.0f);
+    std::iota(keys.begin(), keys.end(), 0.0);
+
+    QCPSoAMultiDataSource<std::vector<double>, std::vector<float>> soa(keys, {col, col});
+    QCPRowMajorMultiDataSource<double, float> rowMajor(keys, rows.data(), n, 2, 2);
+    for (const QCPAbstractMultiDataSource* src : {static_cast<const QCPAbstractMultiDataSource*>(&soa),
+                                                  static_cast<const QCPAbstractMultiDataSource*>(&rowMajor)})
+    {
+        QCOMPARE(src->sampleBytes(), qsizetype(16));
+        std::atomic<quint64> scanned{0};
+        {
+            qcp::ScanCounterScope scope(&scanned);
+            std::any cache;
+            qcp::algo::buildL1CacheMulti(*src, ViewportParams{}, cache);
+        }
+        QCOMPARE(scanned.load(), quint64(n) * 16);
+    }
+}
@@ -49,6 +49,7 @@ private slots:
     void l2MultiMultiColumnConsistency();
     void l2MultiSparseReturnNull();
     void l2MultiEmptyInput();
+    void l1MultiCountsStorageBytes();
 
 private:
     QCustomPlot* mPlot = nullptr;
@@ -1,7 +1,9 @@
 #include "test-pipeline.h"
 #include <qcustomplot.h>
 #include <datasource/pipeline-scheduler.h>
+#include <datasource/work-executor.h>
 #include <datasource/async-pipeline.h>
+#include <datasource/pipeline-stats.h>
 #include <datasource/soa-datasource.h>
 #include <datasource/soa-datasource-2d.h>
 #include <datasource/soa-multi-datasource.h>
@@ -9,17 +11,21 @@
 #include <plottables/plottable-colormap2.h>
 #include <plottables/plottable-colormap.h>
 #include <datasource/graph-resampler.h>
+#include <datasource/minmax-kernels.h>
 #include <datasource/resampled-multi-datasource.h>
 #include <datasource/histogram-binner.h>
+#include <datasource/l1-cache-registry.h>
 #include <plottables/plottable-histogram2d.h>
 #include <plottables/plottable-multigraph.h>
 #include <plottables/plottable-waterfall.h>
 #include <QSignalSpy>
+#include <QElapsedTimer>
 #include <QThread>
 #include <thread>
 #include <QtWidgets/qtestsupport_widgets.h> // QTest::qWaitForWindowExposed
 #include <cmath>
 #include <limits>
+#include <numeric>
 
 namespace {
 // Combined L1+L2 helper — used only by tests below.
@@ -128,6 +134,192 @@ void TestPipeline::schedulerFastPriority()
     QCOMPARE(order[1], 1);
 }
 
+void TestPipeline::executorNestedTaskGroups()
+{
+    // Groups nest (a subtask forks its own group) and may be opened from a
+    // non-worker thread; waiting helps instead of blocking, so this finishes
+    // even with more nesting than workers.
+    QCPWorkExecutor executor(2);
+    std::atomic<int> leaves{0};
+    std::atomic<bool> done{false};
+    executor.registerOwner(this, 1);
+    executor.submit(this, QCPWorkExecutor::Heavy, [&] {
+        QCPTaskGroup outer;
+        for (int i = 0; i < 8; ++i)
+            outer.run([&] {
+                QCPTaskGroup inner;
+                for (int j = 0; j < 8; ++j)
+                    inner.run([&] { leaves.fetch_add(1); });
+            });
+        outer.wait();
+        done.store(true);
+    });
+    while (!done.load()) QThread::msleep(1);
+    executor.unregisterOwner(this);
+    QCOMPARE(leaves.load(), 64);
+
+    // From the test thread, on the shared executor.
+    std::vector<int> partial(16, 0);
+    {
+        QCPTaskGroup group;
+        for (int i = 0; i < 16; ++i)
+            group.run([&partial, i] {
+                QCPTaskGroup inner;
+                for (int j = 0; j < 4; ++j)
+                    inner.run([] { });
+                inner.wait();
+                partial[i] = i;
+            });
+    }
+    QCOMPARE(std::accumulate(partial.begin(), partial.end(), 0), 120);
+}
+
+void TestPipeline::executorRoundRobinAcrossOwners()
+{
+    // A plot with a backlog of heavy jobs must not starve another plot: owners
+    // are served round-robin, and the Fast lane goes before both.
+    QCPWorkExecutor executor(1);
+    int ownerX = 0, ownerY = 0;
+    executor.registerOwner(&ownerX, 1);
+    executor.registerOwner(&ownerY, 1);
+    std::atomic<bool> gate{false};
+    std::atomic<bool> blockerStarted{false};
+    QStringList order;
+    QMutex orderMutex;
+    auto record = [&](const QString& name) {
+        return [&, name] {
+            QMutexLocker lock(&orderMutex);
+            order.push_back(name);
+        };
+    };
+
+    executor.submit(&ownerX, QCPWorkExecutor::Heavy, [&] {
+        blockerStarted.store(true);
+        while (!gate.load()) QThread::msleep(2);
+    });
+    while (!blockerStarted.load()) QThread::msleep(1);
+    executor.submit(&ownerX, QCPWorkExecutor::Heavy, record("x1"));
+    executor.submit(&ownerX, QCPWorkExecutor::Heavy, record("x2"));
+    executor.submit(&ownerY, QCPWorkExecutor::Heavy, record("y1"));
+    executor.submit(&ownerY, QCPWorkExecutor::Fast, record("yFast"));
+    gate.store(true);
+
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < 5000)
+    {
+        {
+            QMutexLocker lock(&orderMutex);
+            if (order.size() == 4)
+                break;
+        }
+        QThread::msleep(2);
+    }
+    executor.unregisterOwner(&ownerX);
+    executor.unregisterOwner(&ownerY);
+
+    QCOMPARE(order, (QStringList{"yFast", "y1", "x1", "x2"}));
+}
+
+void TestPipeline::executorRanksAndSharedGroups()
+{
+    // The higher-ranked owner (the plot under the mouse) is served first,
+    // whatever the submission order.
+    {
+        QCPWorkExecutor executor(1);
+        int hidden = 0, focused = 0;
+        executor.registerOwner(&hidden, 1);
+        executor.registerOwner(&focused, 1);
+        executor.setOwnerRank(&focused, QCPPipelineScheduler::Focused);
+        std::atomic<bool> gate{false};
+        std::atomic<bool> blockerStarted{false};
+        QStringList order;
+        QMutex orderMutex;
+        executor.submit(&hidden, QCPWorkExecutor::Heavy, [&] {
+            blockerStarted.store(true);
+            while (!gate.load()) QThread::msleep(2);
+        });
+        while (!blockerStarted.load()) QThread::msleep(1);
+        for (const QString& name : {QString("h1"), QString("h2")})
+            executor.submit(&hidden, QCPWorkExecutor::Heavy, [&, name] {
+                QMutexLocker lock(&orderMutex);
+                order.push_back(name);
+            });
+        executor.submit(&focused, QCPWorkExecutor::Heavy, [&] {
+            QMutexLocker lock(&orderMutex);
+            order.push_back("f1");
+        });
+        gate.store(true);
+        auto ranAll = [&] {
+            QMutexLocker lock(&orderMutex);
+            return order.size() == 3;
+        };
+        QTRY_VERIFY_WITH_TIMEOUT(ranAll(), 5000);
+        executor.unregisterOwner(&hidden);
+        executor.unregisterOwner(&focused);
+        QCOMPARE(order, (QStringList{"f1", "h1", "h2"}));
+    }
+
+    // Owners of one group share its cap even with idle workers around.
+    {
+        QCPWorkExecutor executor(4);
+        int a = 0, b = 0, group = 0;
+        executor.registerOwner(&a, 4);
+        executor.registerOwner(&b, 4);
+        executor.setGroupLimit(&group, 1);
+        executor.setOwnerGroup(&a, &group);
+        executor.setOwnerGroup(&b, &group);
+        std::atomic<bool> gate{false};
+        std::atomic<bool> blockerStarted{false};
+        std::atomic<bool> otherRan{false};
+        executor.submit(&a, QCPWorkExecutor::Heavy, [&] {
+            blockerStarted.store(true);
+            while (!gate.load()) QThread::msleep(2);
+        });
+        while (!blockerStarted.load()) QThread::msleep(1);
+        executor.submit(&b, QCPWorkExecutor::Heavy, [&] { otherRan.store(true); });
+        QThread::msleep(50);
+        QVERIFY(!otherRan.load());
+        // Leaving the group lifts the shared cap.
+        executor.setOwnerGroup(&b, nullptr);
+        QTRY_VERIFY_WITH_TIMEOUT(otherRan.load(), 5000);
+        gate.store(true);
+        executor.unregisterOwner(&a);
+        executor.unregisterOwner(&b);
+    }
+
+    // Limits above the worker count are clamped, not met with new threads.
+    {
+        QCPWorkExecutor executor(2);
+        int owner = 0, group = 0;
+        executor.registerOwner(&owner, 16);
+        executor.setGroupLimit(&group, 16);
+        QCOMPARE(executor.workerCount(), 2);
+        QCOMPARE(executor.groupLimit(&group), 2);
+        executor.unregisterOwner(&owner);
+    }
+}
+
+void TestPipeline::plotVisibilityRanksScheduler()
+{
+    auto* scheduler = mPlot->pipelineScheduler();
+    mPlot->replot();
+    QCOMPARE(scheduler->visibility(), QCPPipelineScheduler::Hidden);
+
+    mPlot->show();
+    if (!QTest::qWaitForWindowExposed(mPlot))
+        QSKIP("window not exposed on this platform");
+    QVERIFY(scheduler->visibility() != QCPPipelineScheduler::Hidden);
+
+    mPlot->hide();
+    QCOMPARE(scheduler->visibility(), QCPPipelineScheduler::Hidden);
+
+    QVERIFY(!mPlot->sharedPipelineScheduling());
+    mPlot->setSharedPipelineScheduling(true);
+    QVERIFY(mPlot->sharedPipelineScheduling());
+    QVERIFY(QCPPipelineScheduler::sharedMaxThreads() >= 1);
+}
+
 void TestPipeline::pipelinePassthrough()
 {
     QCPPipelineScheduler scheduler;
@@ -631,6 +823,206 @@ void TestPipeline::pipelineNullSourceWhileJobRunningResyncsGeneration()
     QTRY_VERIFY_WITH_TIMEOUT(!pipeline.isBusy(), 2000);
 }
 
+void TestPipeline::pipelineCancelsSupersededJob()
+{
+    QCPPipelineScheduler scheduler(1);
+    std::atomic<bool> started{false};
+    std::atomic<int> bailedOut{0};
+
+    QCPGraphPipeline pipeline(&scheduler);
+    QSignalSpy spy(&pipeline, &QCPGraphPipeline::finished);
+
+    // Spins until cancelled: without cancellation the first job never ends.
+    pipeline.setTransform(TransformKind::ViewportIndependent,
+        [&](const QCPAbstractDataSource& src, const ViewportParams&, std::any&,
+            const QCPCancellationToken& cancel) -> std::shared_ptr<QCPAbstractDataSource> {
+            if (src.size() == 1)
+            {
+                started.store(true);
+                while (!cancel.isCancelled()) QThread::msleep(2);
+                bailedOut.fetch_add(1);
+                return nullptr;
+            }
+            return std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<double>>>(
+                std::vector<double>{1, 2}, std::vector<double>{7, 8});
+        });
+
+    pipeline.setSource(std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<double>>>(
+        std::vector<double>{1}, std::vector<double>{1}));
+    while (!started.load()) QThread::msleep(1);
+    pipeline.setSource(std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<double>>>(
+        std::vector<double>{1, 2}, std::vector<double>{3, 4}));
+
+    QTRY_VERIFY_WITH_TIMEOUT(!pipeline.isBusy(), 2000);
+    QCOMPARE(bailedOut.load(), 1);
+    QVERIFY(pipeline.result() != nullptr);
+    QCOMPARE(pipeline.result()->valueAt(1), 8.0);
+    QCOMPARE(pipeline.cancellationStats().cancelledJobs, quint64(1));
+    QCOMPARE(pipeline.cancellationStats().completedJobs, quint64(1));
+    QVERIFY(pipeline.cancellationStats().cancelledNs > 0);
+}
+
+void TestPipeline::pipelineStatsCountJobsAndBytes()
+{
+    QCPPipelineScheduler scheduler(1);
+    std::atomic<bool> started{false};
+    std::atomic<bool> gate{false};
+
+    QCPGraphPipeline pipeline(&scheduler);
+    pipeline.setTransform(TransformKind::ViewportIndependent,
+        [&](const QCPAbstractDataSource& src, const ViewportParams&,
+            std::any&) -> std::shared_ptr<QCPAbstractDataSource> {
+            started.store(true);
+            while (!gate.load()) QThread::msleep(1);
+            auto bins = qcp::algo::binMinMax(src, 0, src.size(), QCPRange(0, 1000), 10);
+            return std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<double>>>(
+                std::move(bins.keys), std::move(bins.values));
+        });
+
+    // 8-byte keys and 4-byte values: 12 bytes per sample scanned.
+    auto makeSource = [] {
+        std::vector<double> keys(1000);
+        std::vector<float> values(1000, 1.0f);
+        std::iota(keys.begin(), keys.end(), 0.0);
+        return std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<float>>>(
+            std::move(keys), std::move(values));
+    };
+
+    pipeline.setSource(makeSource());
+    while (!started.load()) QThread::msleep(1);
+    pipeline.setSource(makeSource()); // queued behind the running job
+    pipeline.setSource(makeSource()); // folded into the queued one
+    gate.store(true);
+    QTRY_VERIFY_WITH_TIMEOUT(!pipeline.isBusy(), 2000);
+
+    // Queue wait and bytes are recorded once the job returns on its worker,
+    // which may be just after its result reached the GUI thread.
+    QTRY_COMPARE_WITH_TIMEOUT(pipeline.stats().queueWait.count, quint64(2), 2000);
+    const QCPPipelineStats stats = pipeline.stats();
+    QCOMPARE(stats.submitted, quint64(2));
+    QCOMPARE(stats.coalesced, quint64(1));
+    QCOMPARE(stats.cancelled, quint64(1));
+    QCOMPARE(stats.completed, quint64(1));
+    QCOMPARE(stats.dropped, quint64(0));
+    QCOMPARE(stats.execution.count, quint64(2));
+    QCOMPARE(stats.delivery.count, quint64(2));
+    QCOMPARE(stats.bytesScanned, quint64(2 * 1000 * 12));
+    // The second job was requested while the first one waited on the gate.
+    QVERIFY(stats.queueWait.maxNs > 0);
+
+    QTRY_COMPARE_WITH_TIMEOUT(scheduler.stats().completed, quint64(2), 2000);
+    const QCPPipelineStats schedulerStats = scheduler.stats();
+    QCOMPARE(schedulerStats.submitted, quint64(2));
+    QCOMPARE(schedulerStats.dropped, quint64(0));
+    QCOMPARE(schedulerStats.queuedFast + schedulerStats.queuedHeavy, 0);
+    QCOMPARE(schedulerStats.bytesScanned, quint64(2 * 1000 * 12));
+
+    pipeline.resetStats();
+    scheduler.resetStats();
+    QCOMPARE(pipeline.stats().submitted, quint64(0));
+    QCOMPARE(scheduler.stats().bytesScanned, quint64(0));
+}
+
+void TestPipeline::latencyHistogramQuantiles()
+{
+    QCPLatencyHistogram h;
+    QCOMPARE(h.quantileNs(0.5), qint64(0));
+
+    // 90 samples of 1 us, 10 of 1 ms.
+    for (int i = 0; i < 90; ++i)
+        h.add(1'000);
+    for (int i = 0; i < 10; ++i)
+        h.add(1'000'000);
+    QCOMPARE(h.count, quint64(100));
+    QCOMPARE(h.maxNs, qint64(1'000'000));
+    QCOMPARE(h.meanNs(), qint64(100'900));
+    QCOMPARE(h.quantileNs(0.5), qint64(2'000));
+    QCOMPARE(h.quantileNs(0.99), qint64(1'000'000)); // capped at the max sample
+    QCOMPARE(QCPLatencyHistogram::bucketOf(-5), 0);
+    QCOMPARE(QCPLatencyHistogram::bucketOf(qint64(1) << 62), QCPLatencyHistogram::kBuckets - 1);
+
+    QCPLatencyHistogram other;
+    other.add(5'000'000);
+    h.merge(other);
+    QCOMPARE(h.count, quint64(101));
+    QCOMPARE(h.maxNs, qint64(5'000'000));
+}
+
+void TestPipeline::pipelineViewportCancelKeepsCacheWork()
+{
+    // A zoom during the cache-filling stage cancels the result only: the
+    // cache build completes and the next viewport job reuses it.
+    QCPPipelineScheduler scheduler(1);
+    std::atomic<bool> gate{false};
+    std::atomic<bool> building{false};
+    std::atomic<int> builds{0};
+
+    QCPGraphPipeline pipeline(&scheduler);
+    pipeline.setTransform(TransformKind::ViewportDependent,
+        [&](const QCPAbstractDataSource&, const ViewportParams& vp, std::any& cache,
+            const QCPCancellationToken& cancel) -> std::shared_ptr<QCPAbstractDataSource> {
+            if (!cache.has_value())
+            {
+                building.store(true);
+                while (!gate.load() && !cancel.cacheToken().isCancelled()) QThread::msleep(2);
+                if (cancel.cacheToken().isCancelled())
+                    return nullptr;
+                builds.fetch_add(1);
+                cache = 1;
+            }
+            if (cancel.isCancelled())
+                return nullptr;
+            return std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<double>>>(
+                std::vector<double>{1}, std::vector<double>{double(vp.plotWidthPx)});
+        });
+
+    pipeline.setSource(std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<double>>>(
+        std::vector<double>{1}, std::vector<double>{1}));
+    while (!building.load()) QThread::msleep(1);
+    ViewportParams vp;
+    vp.plotWidthPx = 123;
+    pipeline.onViewportChanged(vp);
+    gate.store(true);
+
+    QTRY_VERIFY_WITH_TIMEOUT(!pipeline.isBusy(), 2000);
+    QCOMPARE(builds.load(), 1);
+    QVERIFY(pipeline.result() != nullptr);
+    QCOMPARE(pipeline.result()->valueAt(0), 123.0);
+    QCOMPARE(pipeline.cancellationStats().cancelledJobs, quint64(1));
+}
+
+void TestPipeline::cancelledBinningBailsOut()
+{
+    const int n = 3'000'000;
+    std::vector<double> keys(n), values(n);
+    for (int i = 0; i < n; ++i)
+    {
+        keys[i] = i;
+        values[i] = std::sin(i * 1e-3);
+    }
+    QCPSoADataSource<std::vector<double>, std::vector<double>> src(keys, values);
+
+    auto cancel = QCPCancellationToken::create();
+    QVERIFY(!cancel.isCancelled() && !cancel.cacheToken().isCancelled());
+    cancel.cancelResult();
+    QVERIFY(cancel.isCancelled() && !cancel.cacheToken().isCancelled());
+
+    // The result-level flag doesn't stop cache work, a full cancel does.
+    auto full = qcp::algo::binMinMaxParallel(src, 0, n, QCPRange(0, n), 1000, cancel.cacheToken());
+    QVERIFY(!std::isnan(full.values[0]));
+    cancel.cancel();
+    auto stopped = qcp::algo::binMinMaxParallel(src, 0, n, QCPRange(0, n), 1000, cancel.cacheToken());
+    QVERIFY(std::all_of(stopped.values.begin(), stopped.values.end(),
+                        [](double v) { return std::isnan(v); }));
+
+    std::any cache;
+    qcp::algo::buildL1Cache(src, ViewportParams{}, cache, nullptr, cancel);
+    QVERIFY(!cache.has_value());
+    QVERIFY(!qcp::algo::bin2d(src, 64, 64, false, false, cancel));
+    QVERIFY(!qcp::algo::buildHistogram2DIndex(src, cancel));
+    QVERIFY(!QCPCancellationToken().isCancelled());
+}
+
 void TestPipeline::schedulerDtorDropsQueuedJobs()
 {
     // Jobs still queued when the scheduler dies belong to plottables that may
@@ -794,18 +1186,17 @@ void TestPipeline::graphResamplerCacheReuse()
 
     // Exercise binMinMax and GraphResamplerCache directly
     qcp::algo::GraphResamplerCache c;
-    c.level1 = qcp::algo::binMinMax(keys, vals, 0, N, QCPRange(0, N - 1), 500);
+    c.level1 = qcp::algo::PyramidLevel::fromBins(
+        qcp::algo::binMinMax(keys, vals, 0, N, QCPRange(0, N - 1), 500));
     c.cachedKeyRange = QCPRange(0, N - 1);
     c.sourceSize = N;
 
     // Level 2 from cache
-    auto l2 = qcp::algo::binMinMax(c.level1.keys, c.level1.values,
-        0, static_cast<int>(c.level1.keys.size()), QCPRange(10000, 50000), 800);
+    auto l2 = qcp::algo::binMinMax(c.level1, 0, c.level1.size(), QCPRange(10000, 50000), 800);
     QVERIFY(l2.keys.size() > 0u);
 
     // Pan: different viewport, same cache
-    auto l2b = qcp::algo::binMinMax(c.level1.keys, c.level1.values,
-        0, static_cast<int>(c.level1.keys.size()), QCPRange(20000, 25000), 800);
+    auto l2b = qcp::algo::binMinMax(c.level1, 0, c.level1.size(), QCPRange(20000, 25000), 800);
     QVERIFY(l2b.keys.size() > 0u);
 }
 
@@ -845,11 +1236,11 @@ void TestPipeline::graphResamplerEmptyBinsProduceNaN()
 class SyntheticLargeSource : public QCPAbstractDataSource
 {
 public:
-    explicit SyntheticLargeSource(int n) : mN(n) {}
-    int size() const override { return mN; }
+    explicit SyntheticLargeSource(qsizetype n) : mN(n) {}
+    qsizetype size() const override { return mN; }
     bool empty() const override { return mN == 0; }
-    double keyAt(int i) const override { return static_cast<double>(i); }
-    double valueAt(int i) const override { return std::sin(i * 0.0001); }
+    double keyAt(qsizetype i) const override { return static_cast<double>(i); }
+    double valueAt(qsizetype i) const override { return std::sin(i * 0.0001); }
     QCPRange keyRange(bool& found, QCP::SignDomain sd) const override
     {
         Q_UNUSED(sd);
@@ -862,28 +1253,28 @@ public:
         found = mN > 0;
         return QCPRange(-1, 1);
     }
-    int findBegin(double sortKey, bool) const override
+    qsizetype findBegin(double sortKey, bool) const override
     {
-        return std::clamp(static_cast<int>(sortKey), 0, mN);
+        return std::clamp<qsizetype>(static_cast<qsizetype>(sortKey), 0, mN);
     }
-    int findEnd(double sortKey, bool) const override
+    qsizetype findEnd(double sortKey, bool) const override
     {
-        return std::clamp(static_cast<int>(std::ceil(sortKey)) + 1, 0, mN);
+        return std::clamp<qsizetype>(static_cast<qsizetype>(std::ceil(sortKey)) + 1, 0, mN);
     }
-    QVector<QPointF> getOptimizedLineData(int begin, int end, int, QCPAxis*, QCPAxis*) const override
+    QVector<QPointF> getOptimizedLineData(qsizetype begin, qsizetype end, int, QCPAxis*, QCPAxis*) const override
     {
         return getLines(begin, end, nullptr, nullptr);
     }
-    QVector<QPointF> getLines(int begin, int end, QCPAxis*, QCPAxis*) const override
+    QVector<QPointF> getLines(qsizetype begin, qsizetype end, QCPAxis*, QCPAxis*) const override
     {
         QVector<QPointF> result;
         result.reserve(end - begin);
-        for (int i = begin; i < end; ++i)
+        for (qsizetype i = begin; i < end; ++i)
             result.append(QPointF(keyAt(i), valueAt(i)));
         return result;
     }
 private:
-    int mN;
+    qsizetype mN;
 };
 
 void TestPipeline::graph2HierarchicalResamplingActivates()
@@ -1029,26 +1420,940 @@ void TestPipeline::graphResamplerParallelMatchesSingleThreaded()
     auto src = std::make_shared<QCPSoADataSource<
         std::vector<double>, std::vector<double>>>(std::move(keys), std::move(vals));
 
-    QCPRange fullRange(0, N - 1);
     int numBins = 1000;
+    // The second range puts sample keys exactly on the chunk boundaries.
+    for (const QCPRange& fullRange : {QCPRange(0, N - 1), QCPRange(0, N)})
+    {
+        auto sequential = qcp::algo::binMinMax(*src, 0, N, fullRange, numBins);
+        auto parallel = qcp::algo::binMinMaxParallel(*src, 0, N, fullRange, numBins);
+
+        QCOMPARE(parallel.keys.size(), sequential.keys.size());
+        QCOMPARE(parallel.values.size(), sequential.values.size());
+
+        for (size_t i = 0; i < sequential.keys.size(); ++i)
+            QCOMPARE(parallel.keys[i], sequential.keys[i]);
+
+        for (size_t i = 0; i < sequential.values.size(); ++i)
+        {
+            if (std::isnan(sequential.values[i]))
+                QVERIFY(std::isnan(parallel.values[i]));
+            else
+                QCOMPARE(parallel.values[i], sequential.values[i]);
+        }
+    }
+}
+
+void TestPipeline::graphResamplerNativeTypeBinning()
+{
+    // Typed sources bin in their own types; the result must match the generic
+    // keyAt()/valueAt() path of the base class exactly.
+    auto check = [](const QCPAbstractDataSource& src, const QCPRange& range, int numBins) {
+        const double binWidth = range.size() / numBins;
+        std::vector<double> typed(numBins * 2, qQNaN()), generic(numBins * 2, qQNaN());
+        src.accumulateMinMax(0, src.size(), range.lower, binWidth, typed.data(), 0, numBins);
+        src.QCPAbstractDataSource::accumulateMinMax(0, src.size(), range.lower, binWidth,
+                                                    generic.data(), 0, numBins);
+        for (int i = 0; i < numBins * 2; ++i)
+        {
+            if (std::isnan(generic[i]))
+                QVERIFY(std::isnan(typed[i]));
+            else
+                QCOMPARE(typed[i], generic[i]);
+        }
+    };
+
+    const int N = 100'000;
+    std::vector<float> fKeys(N), fValues(N);
+    std::vector<qint64> iKeys(N);
+    std::vector<qint16> adc(N);
+    for (int i = 0; i < N; ++i)
+    {
+        fKeys[i] = i * 0.5f;
+        fValues[i] = (i % 101 == 0) ? std::numeric_limits<float>::quiet_NaN()
+                                    : std::sin(i * 0.001f) * 50.0f;
+        iKeys[i] = 1'000'000'000LL + i * 3;
+        adc[i] = static_cast<qint16>((i * 7919) % 65536 - 32768);
+    }
+    fKeys[500] = std::numeric_limits<float>::infinity();
 
-    auto sequential = qcp::algo::binMinMax(*src, 0, N, fullRange, numBins);
-    auto parallel = qcp::algo::binMinMaxParallel(*src, 0, N, fullRange, numBins);
+    QCPSoADataSource<std::vector<float>, std::vector<float>> floatSrc(fKeys, fValues);
+    check(floatSrc, QCPRange(0, N * 0.5), 777);
+    // Partial grid: samples outside the range clamp into the edge bins
+    check(floatSrc, QCPRange(1000, 2000), 64);
 
-    QCOMPARE(parallel.keys.size(), sequential.keys.size());
-    QCOMPARE(parallel.values.size(), sequential.values.size());
+    QCPSoADataSource<std::span<const qint64>, std::span<const qint16>> adcSrc(iKeys, adc);
+    check(adcSrc, QCPRange(1'000'000'000.0, 1'000'000'000.0 + 3.0 * N), 1000);
 
-    for (size_t i = 0; i < sequential.keys.size(); ++i)
-        QCOMPARE(parallel.keys[i], sequential.keys[i]);
+    auto l1 = qcp::algo::binMinMax(adcSrc, 0, N,
+                                   QCPRange(1'000'000'000.0, 1'000'000'000.0 + 3.0 * N), 10);
+    QCOMPARE(l1.values.size(), size_t(20));
+    QVERIFY(l1.values[0] >= -32768 && l1.values[1] <= 32767);
+}
 
-    for (size_t i = 0; i < sequential.values.size(); ++i)
+namespace {
+// Reference fold for the incremental L1 tests: same grid arithmetic as the
+// resampler, bins clamped to [0, numBins).
+void foldMinMax(const std::vector<double>& keys, const std::vector<double>& vals,
+                int begin, int end, double keyLo, double binWidth, int numBins,
+                std::vector<double>& out)
+{
+    for (int i = begin; i < end; ++i)
     {
-        if (std::isnan(sequential.values[i]))
-            QVERIFY(std::isnan(parallel.values[i]));
+        int b = std::clamp(static_cast<int>((keys[i] - keyLo) / binWidth), 0, numBins - 1);
+        double& mn = out[b * 2 + 0];
+        double& mx = out[b * 2 + 1];
+        if (std::isnan(mn) || vals[i] < mn) mn = vals[i];
+        if (std::isnan(mx) || vals[i] > mx) mx = vals[i];
+    }
+}
+
+void compareBins(const std::vector<double>& actual, const std::vector<double>& expected)
+{
+    QCOMPARE(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        if (std::isnan(expected[i]))
+            QVERIFY2(std::isnan(actual[i]), qPrintable(QString("bin value %1 should be empty").arg(i)));
         else
-            QCOMPARE(parallel.values[i], sequential.values[i]);
+            QCOMPARE(actual[i], expected[i]);
+    }
+}
+
+// Every coarse level must match a from-scratch derivation from level1.
+void checkPyramid(const qcp::algo::GraphResamplerCache& c)
+{
+    auto fresh = c;
+    fresh.coarseLevels.clear();
+    qcp::algo::updatePyramid(fresh);
+    QCOMPARE(c.coarseLevels.size(), fresh.coarseLevels.size());
+    for (size_t l = 0; l < fresh.coarseLevels.size(); ++l)
+    {
+        const auto actual = c.coarseLevels[l].toBins();
+        const auto expected = fresh.coarseLevels[l].toBins();
+        QCOMPARE(actual.keys, expected.keys);
+        compareBins(actual.values, expected.values);
     }
 }
+} // namespace
+
+void TestPipeline::graphResamplerIncrementalL1BinsOnlyTail()
+{
+    const int N1 = 600'000, N2 = 660'000;
+    std::vector<double> keys(N2), vals(N2);
+    for (int i = 0; i < N2; ++i)
+    {
+        keys[i] = i;
+        vals[i] = std::sin(i * 0.001) * 50.0;
+    }
+    using Src = QCPSoADataSource<std::span<const double>, std::span<const double>>;
+    Src prefix(std::span<const double>(keys.data(), N1), std::span<const double>(vals.data(), N1));
+    Src full(std::span<const double>(keys), std::span<const double>(vals));
+
+    std::any cache;
+    qcp::algo::buildL1Cache(prefix, ViewportParams{}, cache);
+    auto prev = std::any_cast<qcp::algo::GraphResamplerCache>(cache);
+    const int prevBins = prev.level1.bins();
+
+    std::any extended;
+    qcp::algo::buildL1Cache(full, ViewportParams{}, extended, &prev);
+    auto* c = std::any_cast<qcp::algo::GraphResamplerCache>(&extended);
+    QVERIFY(c);
+    QCOMPARE(c->sourceSize, N2);
+    // Same origin and bin width: the grid only grew by whole bins
+    QCOMPARE(c->l1BinWidth, prev.l1BinWidth);
+    const int bins = c->level1.bins();
+    QVERIFY(bins > prevBins);
+    QVERIFY(c->level1.key(bins * 2 - 2) + c->l1BinWidth >= N2 - 1);
+
+    // Prefix bins are kept as-is, the tail is folded in on the extended grid
+    std::vector<double> expected(bins * 2, std::numeric_limits<double>::quiet_NaN());
+    const auto prevBinsFlat = prev.level1.toBins();
+    std::copy(prevBinsFlat.values.begin(), prevBinsFlat.values.end(), expected.begin());
+    foldMinMax(keys, vals, N1, N2, 0.0, c->l1BinWidth, bins, expected);
+    compareBins(c->level1.toBins().values, expected);
+
+    // Blocks before the first appended key are shared with prev, not copied.
+    const int firstBlock = (prevBins - 1) / qcp::algo::PyramidLevel::kBlockBins;
+    QVERIFY(firstBlock >= 2);
+    for (int b = 0; b < firstBlock; ++b)
+        QCOMPARE(&c->level1.block(b), &prev.level1.block(b));
+    QVERIFY(&c->level1.block(firstBlock) != &prev.level1.block(firstBlock));
+    QVERIFY(!c->coarseLevels.empty());
+    checkPyramid(*c);
+}
+
+void TestPipeline::graphResamplerIncrementalL1RegridsOnDoubling()
+{
+    // 200k points -> 12.5k L1 bins of 16 keys; a sparse tail stretching the
+    // key range past kLevel1MaxBins bins worth must merge bin pairs (width
+    // doubles).
+    const int N1 = 200'000, N2 = 300'000;
+    const double tailStride = 1.2 * qcp::algo::kLevel1MaxBins * qcp::algo::kLevel1SamplesPerBin
+                              / (N2 - N1);
+    std::vector<double> keys(N2), vals(N2);
+    for (int i = 0; i < N2; ++i)
+    {
+        keys[i] = i < N1 ? i : N1 + (i - N1 + 1) * tailStride;
+        vals[i] = std::cos(i * 0.0003) * 10.0 + (i % 7);
+    }
+    using Src = QCPSoADataSource<std::span<const double>, std::span<const double>>;
+    Src prefix(std::span<const double>(keys.data(), N1), std::span<const double>(vals.data(), N1));
+    Src full(std::span<const double>(keys), std::span<const double>(vals));
+
+    std::any cache;
+    qcp::algo::buildL1Cache(prefix, ViewportParams{}, cache);
+    auto prev = std::any_cast<qcp::algo::GraphResamplerCache>(cache);
+    const int prevBins = prev.level1.bins();
+    const auto prevBinsFlat = prev.level1.toBins();
+
+    std::any extended;
+    qcp::algo::buildL1Cache(full, ViewportParams{}, extended, &prev);
+    auto* c = std::any_cast<qcp::algo::GraphResamplerCache>(&extended);
+    QVERIFY(c);
+    QCOMPARE(c->l1BinWidth, prev.l1BinWidth * 2);
+    const int bins = c->level1.bins();
+    QVERIFY(bins <= qcp::algo::kLevel1MaxBins);
+
+    std::vector<double> expected(bins * 2, std::numeric_limits<double>::quiet_NaN());
+    for (int b = 0; b < (prevBins + 1) / 2; ++b)
+    {
+        const int lo = 2 * b, hi = std::min(2 * b + 1, prevBins - 1);
+        expected[b * 2 + 0] = std::fmin(prevBinsFlat.values[lo * 2], prevBinsFlat.values[hi * 2]);
+        expected[b * 2 + 1] = std::fmax(prevBinsFlat.values[lo * 2 + 1], prevBinsFlat.values[hi * 2 + 1]);
+    }
+    foldMinMax(keys, vals, N1, N2, 0.0, c->l1BinWidth, bins, expected);
+    compareBins(c->level1.toBins().values, expected);
+    checkPyramid(*c);
+}
+
+void TestPipeline::graphResamplerIncrementalL1RejectsMovedStart()
+{
+    // A source whose first key moved is not an append of the cached prefix:
+    // the L1 must be rebuilt over the full range.
+    const int N = 200'000;
+    std::vector<double> keys(N), vals(N, 1.0);
+    for (int i = 0; i < N; ++i)
+        keys[i] = i;
+    auto src = std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<double>>>(keys, vals);
+
+    std::any cache;
+    qcp::algo::buildL1Cache(*src, ViewportParams{}, cache);
+    auto prev = std::any_cast<qcp::algo::GraphResamplerCache>(cache);
+
+    for (auto& k : keys)
+        k += 1000.0;
+    auto moved = std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<double>>>(keys, vals);
+    std::any rebuilt;
+    qcp::algo::buildL1Cache(*moved, ViewportParams{}, rebuilt, &prev);
+    auto* c = std::any_cast<qcp::algo::GraphResamplerCache>(&rebuilt);
+    QVERIFY(c);
+    QCOMPARE(c->cachedKeyRange.lower, 1000.0);
+    QCOMPARE(c->level1.bins(), prev.level1.bins());
+
+    // A tail key so far out that the grid would need more than twice
+    // kLevel1MaxBins bins is not merged down to: the L1 is rebuilt over the
+    // new range instead.
+    keys = std::vector<double>(N);
+    for (int i = 0; i < N; ++i)
+        keys[i] = i;
+    keys.push_back(1e300);
+    vals.push_back(2.0);
+    auto jumped = std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<double>>>(keys, vals);
+    std::any far;
+    qcp::algo::buildL1Cache(*jumped, ViewportParams{}, far, &prev);
+    c = std::any_cast<qcp::algo::GraphResamplerCache>(&far);
+    QVERIFY(c);
+    QCOMPARE(c->sourceSize, qsizetype(N + 1));
+    QCOMPARE(c->l1BinWidth, 1e300 / ((N + 1) / qcp::algo::kLevel1SamplesPerBin));
+}
+
+void TestPipeline::graph2AddDataExtendsL1()
+{
+    auto* g = new QCPGraph2(mPlot->xAxis, mPlot->yAxis);
+    QSignalSpy spy(&g->pipeline(), &QCPGraphPipeline::finished);
+
+    auto batch = [](int from, int count) {
+        std::vector<double> k(count), v(count);
+        for (int i = 0; i < count; ++i)
+        {
+            k[i] = from + i;
+            v[i] = std::sin((from + i) * 0.01);
+        }
+        return std::pair{k, v};
+    };
+
+    auto [k1, v1] = batch(0, 200'000);
+    g->addData(k1, v1);
+    QVERIFY(g->pipeline().hasTransform());
+    QTRY_VERIFY_WITH_TIMEOUT(spy.count() >= 1 && g->mL1Cache, 30000);
+    const double firstWidth = g->mL1Cache->l1BinWidth;
+    QCOMPARE(g->mL1Cache->sourceSize, 200'000);
+
+    auto [k2, v2] = batch(200'000, 50'000);
+    g->addData(k2, v2);
+    // The stale L1 stays displayed while the tail is binned
+    QVERIFY(g->mL1Cache);
+    QCOMPARE(g->dataCount(), 250'000);
+
+    QTRY_VERIFY_WITH_TIMEOUT(g->mL1Cache->sourceSize == 250'000, 30000);
+    // Extended in place: a full rebuild would have re-derived the bin width
+    // from the new key range
+    QCOMPARE(g->mL1Cache->l1BinWidth, firstWidth);
+}
+
+void TestPipeline::graph2AddDataWhileExtending()
+{
+    auto* g = new QCPGraph2(mPlot->xAxis, mPlot->yAxis);
+    auto batch = [](int from, int count) {
+        std::vector<double> k(count), v(count);
+        for (int i = 0; i < count; ++i)
+        {
+            k[i] = from + i;
+            v[i] = std::sin((from + i) * 0.01);
+        }
+        return std::pair{k, v};
+    };
+    auto [k0, v0] = batch(0, 200'000);
+    g->addData(k0, v0);
+    QTRY_VERIFY_WITH_TIMEOUT(g->mL1Cache && g->mL1Cache->sourceSize == 200'000, 30000);
+
+    std::vector<qsizetype> shown;
+    connect(&g->pipeline(), &QCPGraphPipeline::finished, this, [&](uint64_t) {
+        shown.push_back(g->mL1Cache ? g->mL1Cache->sourceSize : -1);
+    });
+    g->pipeline().resetStats();
+
+    // Back to back, without an event loop in between: the first extension is
+    // still running (or queued) when the others arrive.
+    const int batches = 10, batchSize = 50'000;
+    for (int b = 0; b < batches; ++b)
+    {
+        auto [k, v] = batch(200'000 + b * batchSize, batchSize);
+        g->addData(k, v);
+    }
+    const qsizetype total = 200'000 + batches * batchSize;
+    QTRY_VERIFY_WITH_TIMEOUT(g->mL1Cache->sourceSize == total, 30000);
+
+    // The first extension was kept and shown, and the next job chained from
+    // it: every appended sample was binned exactly once.
+    QVERIFY(!shown.empty());
+    QCOMPARE(shown.front(), qsizetype(200'000 + batchSize));
+    QCOMPARE(g->pipeline().stats().bytesScanned,
+             quint64(batches) * batchSize * quint64(g->mDataSource->sampleBytes()));
+}
+
+void TestPipeline::sharedL1CacheBuiltOnce()
+{
+    using Shared = std::shared_ptr<const qcp::algo::GraphResamplerCache>;
+    const int N = 300'000;
+    std::vector<double> keys(N), vals(N);
+    for (int i = 0; i < N; ++i)
+    {
+        keys[i] = i;
+        vals[i] = std::sin(i * 0.001);
+    }
+    QCPSoADataSource<std::vector<double>, std::vector<double>> src(std::move(keys), std::move(vals));
+    auto& registry = QCPL1CacheRegistry::instance();
+    const quint64 builds = registry.buildCount();
+
+    // Concurrent pipelines of one source: one bins it, the other waits and
+    // shares the result.
+    std::any cacheA, cacheB;
+    std::thread other([&] { qcp::algo::buildSharedL1Cache(src, ViewportParams{}, cacheB); });
+    qcp::algo::buildSharedL1Cache(src, ViewportParams{}, cacheA);
+    other.join();
+    auto* a = std::any_cast<Shared>(&cacheA);
+    auto* b = std::any_cast<Shared>(&cacheB);
+    QVERIFY(a && *a && b && *b);
+    QCOMPARE(a->get(), b->get());
+    QCOMPARE((*a)->sourceSize, qsizetype(N));
+    QCOMPARE(registry.buildCount(), builds + 1);
+
+    // A later pipeline shares it as long as someone holds it.
+    std::any cacheC;
+    qcp::algo::buildSharedL1Cache(src, ViewportParams{}, cacheC);
+    QCOMPARE(std::any_cast<Shared>(cacheC).get(), a->get());
+    QCOMPARE(registry.buildCount(), builds + 1);
+
+    // In-place change: the next request rebuilds, and a second notification
+    // of the same change does not cause another build.
+    registry.invalidate(&src);
+    registry.invalidate(&src);
+    std::any cacheD, cacheE;
+    qcp::algo::buildSharedL1Cache(src, ViewportParams{}, cacheD);
+    qcp::algo::buildSharedL1Cache(src, ViewportParams{}, cacheE);
+    QVERIFY(std::any_cast<Shared>(cacheD).get() != a->get());
+    QCOMPARE(std::any_cast<Shared>(cacheD).get(), std::any_cast<Shared>(cacheE).get());
+    QCOMPARE(registry.buildCount(), builds + 2);
+}
+
+void TestPipeline::sharedL1WaitersHelpTheBuild()
+{
+    // A pipeline waiting for another one's L1 occupies an executor worker; it
+    // must run the build's subtasks rather than idle. With two workers, the
+    // builder's two subtasks only meet at the barrier if the waiter runs one.
+    using Cache = QCPL1CacheRegistry::Cache;
+    QCPSoADataSource<std::vector<double>, std::vector<double>> src(
+        std::vector<double>{0, 1, 2}, std::vector<double>{0, 1, 2});
+    const QCPRange keyRange(0, 2);
+    QCPWorkExecutor executor(2);
+    executor.registerOwner(this, 2);
+
+    std::atomic<bool> building{false}, waiterStarted{false}, met{true};
+    std::atomic<int> arrived{0}, done{0};
+    std::shared_ptr<const Cache> built, shared;
+    auto subtask = [&] {
+        arrived.fetch_add(1);
+        QElapsedTimer timer;
+        timer.start();
+        while (arrived.load() < 2)
+        {
+            if (timer.elapsed() > 5000)
+            {
+                met.store(false);
+                return;
+            }
+            QThread::yieldCurrentThread();
+        }
+    };
+    executor.submit(this, QCPWorkExecutor::Heavy, [&] {
+        built = QCPL1CacheRegistry::instance().acquire(src, keyRange, {}, [&] {
+            building.store(true);
+            while (!waiterStarted.load()) QThread::msleep(1);
+            QCPTaskGroup group;
+            group.run(subtask);
+            group.run(subtask);
+            group.wait();
+            auto cache = std::make_shared<Cache>();
+            cache->sourceSize = src.size();
+            cache->cachedKeyRange = keyRange;
+            return std::shared_ptr<const Cache>(std::move(cache));
+        });
+        done.fetch_add(1);
+    });
+    while (!building.load()) QThread::msleep(1);
+    executor.submit(this, QCPWorkExecutor::Heavy, [&] {
+        waiterStarted.store(true);
+        shared = QCPL1CacheRegistry::instance().acquire(src, keyRange, {}, [] {
+            return std::shared_ptr<const Cache>();
+        });
+        done.fetch_add(1);
+    });
+    while (done.load() < 2) QThread::msleep(1);
+    executor.unregisterOwner(this);
+    QVERIFY(met.load());
+    QVERIFY(built);
+    QCOMPARE(shared.get(), built.get());
+}
+
+void TestPipeline::graph2SharedSourceSharesL1()
+{
+    const int N = 300'000;
+    std::vector<double> keys(N), vals(N);
+    for (int i = 0; i < N; ++i)
+    {
+        keys[i] = i;
+        vals[i] = std::cos(i * 0.001);
+    }
+    auto src = std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<double>>>(
+        std::move(keys), std::move(vals));
+    auto* g1 = new QCPGraph2(mPlot->xAxis, mPlot->yAxis);
+    auto* g2 = new QCPGraph2(mPlot->xAxis, mPlot->yAxis);
+    g1->setDataSource(src);
+    g2->setDataSource(src);
+    QTRY_VERIFY_WITH_TIMEOUT(g1->mL1Cache && g2->mL1Cache, 30000);
+    QCOMPARE(g1->mL1Cache.get(), g2->mL1Cache.get());
+
+    // In-place edit, both graphs notified: both end up on one fresh L1.
+    const auto stale = g1->mL1Cache;
+    g1->dataChanged();
+    g2->dataChanged();
+    QTRY_VERIFY_WITH_TIMEOUT(g1->mL1Cache && g2->mL1Cache, 30000);
+    QVERIFY(g1->mL1Cache != stale);
+    QVERIFY(g2->mL1Cache != stale);
+}
+
+void TestPipeline::graph2MemoryAccountingSplitsSharedL1()
+{
+    const int N = 300'000;
+    std::vector<double> keys(N), vals(N);
+    for (int i = 0; i < N; ++i)
+    {
+        keys[i] = i;
+        vals[i] = std::sin(i * 0.001);
+    }
+    auto src = std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<double>>>(
+        std::move(keys), std::move(vals));
+    auto* g1 = new QCPGraph2(mPlot->xAxis, mPlot->yAxis);
+    auto* g2 = new QCPGraph2(mPlot->xAxis, mPlot->yAxis);
+    g1->setDataSource(src);
+    g2->setDataSource(src);
+    QTRY_VERIFY_WITH_TIMEOUT(g1->mL1Cache && g2->mL1Cache, 30000);
+    QCOMPARE(g1->mL1Cache.get(), g2->mL1Cache.get());
+
+    QCPMemoryUsage u1, u2;
+    g1->accountMemory(u1);
+    g2->accountMemory(u2);
+    const quint64 l1Bytes = g1->mL1Cache->memoryBytes();
+    QVERIFY(l1Bytes > 0);
+    QCOMPARE(u1.bytes[QCPMemoryUsage::msL1Cache], l1Bytes / 2);
+    QCOMPARE(u2.bytes[QCPMemoryUsage::msL1Cache], l1Bytes / 2);
+    // Neither holder frees its share by releasing it alone.
+    QCOMPARE(u1.shared, l1Bytes / 2);
+    QCOMPARE(u1.reclaimable(), u1.total() - l1Bytes / 2);
+
+    const QCPMemoryReport report = mPlot->memoryReport();
+    QCOMPARE(report.plottables.size(), 2);
+    QCOMPARE(report.total().bytes[QCPMemoryUsage::msL1Cache], l1Bytes / 2 * 2);
+    QVERIFY(report.summary().startsWith("caches "));
+}
+
+void TestPipeline::memoryBudgetEvictsLeastRecentlyDrawn()
+{
+    const int N = 300'000;
+    auto makeSource = [N](double phase) {
+        std::vector<double> keys(N), vals(N);
+        for (int i = 0; i < N; ++i)
+        {
+            keys[i] = i;
+            vals[i] = std::sin(i * 0.001 + phase);
+        }
+        return std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<double>>>(
+            std::move(keys), std::move(vals));
+    };
+    auto* g1 = new QCPGraph2(mPlot->xAxis, mPlot->yAxis);
+    auto* g2 = new QCPGraph2(mPlot->xAxis, mPlot->yAxis);
+    g1->setDataSource(makeSource(0));
+    g2->setDataSource(makeSource(1));
+    QTRY_VERIFY_WITH_TIMEOUT(g1->mL1Cache && g2->mL1Cache, 30000);
+    mPlot->xAxis->setRange(0, N);
+    mPlot->yAxis->setRange(-1.5, 1.5);
+    mPlot->replot(QCustomPlot::rpImmediateRefresh);
+
+    // g2 is drawn once more than g1, so g1 is the least recently drawn.
+    g1->setVisible(false);
+    mPlot->replot(QCustomPlot::rpImmediateRefresh);
+
+    QCPMemoryBudget& budget = QCPMemoryBudget::instance();
+    const quint64 evictions = budget.evictionCount();
+    const quint64 total = budget.enforce();
+    QVERIFY(total > 0);
+    QVERIFY(g1->mL1Cache);
+
+    // Just under the total: releasing one plottable is enough.
+    budget.setLimit(total - 1);
+    QCOMPARE(budget.evictionCount(), evictions + 1);
+    QVERIFY(!g1->mL1Cache);
+    QVERIFY(g1->mCachedLines.isEmpty());
+    QVERIFY(g2->mL1Cache);
+    QVERIFY(budget.lastTotal() < total);
+    budget.setLimit(0);
+
+    // Released caches come back once the graph is drawn again, requested
+    // without the data-change path: no preview, nothing cancelled.
+    QSignalSpy previewSpy(&g1->mPipeline, &QCPGraphPipeline::previewReady);
+    const auto cancelled = g1->mPipeline.cancellationStats().cancelledJobs;
+    g1->setVisible(true);
+    mPlot->replot(QCustomPlot::rpImmediateRefresh);
+    QTRY_VERIFY_WITH_TIMEOUT(g1->mL1Cache, 30000);
+    QCOMPARE(previewSpy.count(), 0);
+    QCOMPARE(g1->mPipeline.cancellationStats().cancelledJobs, cancelled);
+}
+
+void TestPipeline::memoryBudgetCountsSharedL1Once()
+{
+    const int N = 300'000;
+    std::vector<double> keys(N), vals(N);
+    for (int i = 0; i < N; ++i)
+    {
+        keys[i] = i;
+        vals[i] = std::sin(i * 0.001);
+    }
+    auto src = std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<double>>>(
+        std::move(keys), std::move(vals));
+    auto* g1 = new QCPGraph2(mPlot->xAxis, mPlot->yAxis);
+    auto* g2 = new QCPGraph2(mPlot->xAxis, mPlot->yAxis);
+    g1->setDataSource(src);
+    g2->setDataSource(src);
+    QTRY_VERIFY_WITH_TIMEOUT(g1->mL1Cache && g2->mL1Cache, 30000);
+    QCOMPARE(g1->mL1Cache.get(), g2->mL1Cache.get());
+    const quint64 l1Bytes = g1->mL1Cache->memoryBytes();
+    g1->setVisible(false);
+    g2->setVisible(false);
+
+    // Releasing g1 alone frees none of the L1 g2 still holds, so the budget
+    // has to go on to g2 before the L1 is gone from the total.
+    QCPMemoryBudget& budget = QCPMemoryBudget::instance();
+    const quint64 evictions = budget.evictionCount();
+    const quint64 total = budget.enforce();
+    budget.setLimit(total - l1Bytes / 2);
+    QCOMPARE(budget.evictionCount(), evictions + 2);
+    QVERIFY(!g1->mL1Cache);
+    QVERIFY(!g2->mL1Cache);
+    QVERIFY(budget.lastTotal() <= total - l1Bytes);
+    budget.setLimit(0);
+}
+
+void TestPipeline::pipelinePreviewShownUntilFullResult()
+{
+    QCPPipelineScheduler scheduler(1);
+    std::atomic<bool> gate{false};
+
+    QCPGraphPipeline pipeline(&scheduler);
+    QSignalSpy previewSpy(&pipeline, &QCPGraphPipeline::previewReady);
+    pipeline.setTransform(TransformKind::ViewportIndependent,
+        [&](const QCPAbstractDataSource&, const ViewportParams&,
+            std::any&) -> std::shared_ptr<QCPAbstractDataSource> {
+            while (!gate.load()) QThread::msleep(1);
+            return std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<double>>>(
+                std::vector<double>{1, 2}, std::vector<double>{7, 8});
+        });
+    pipeline.setPreviewTransform(
+        [](const QCPAbstractDataSource&, const ViewportParams&,
+           const QCPCancellationToken&) -> std::shared_ptr<QCPAbstractDataSource> {
+            return std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<double>>>(
+                std::vector<double>{1}, std::vector<double>{5});
+        });
+
+    // One worker: the preview is queued on the Fast lane ahead of the full job.
+    pipeline.setSource(std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<double>>>(
+        std::vector<double>{1, 2}, std::vector<double>{3, 4}));
+    QTRY_VERIFY_WITH_TIMEOUT(pipeline.preview() != nullptr, 2000);
+    QCOMPARE(previewSpy.count(), 1);
+    QCOMPARE(pipeline.preview()->valueAt(0), 5.0);
+    QVERIFY(pipeline.result() == nullptr);
+    QVERIFY(pipeline.isBusy());
+
+    gate.store(true);
+    QTRY_VERIFY_WITH_TIMEOUT(!pipeline.isBusy(), 2000);
+    QVERIFY(pipeline.preview() == nullptr);
+    QVERIFY(pipeline.result() != nullptr);
+    QCOMPARE(pipeline.result()->valueAt(1), 8.0);
+    QCOMPARE(pipeline.stats().previews, quint64(1));
+}
+
+void TestPipeline::pipelineAppendKeepsCacheWorkInFlight()
+{
+    using Source = QCPSoADataSource<std::vector<double>, std::vector<double>>;
+    QCPPipelineScheduler scheduler(1);
+    std::atomic<bool> gate{false};
+
+    QCPGraphPipeline pipeline(&scheduler);
+    pipeline.setTransform(TransformKind::ViewportIndependent,
+        [&](const QCPAbstractDataSource& src, const ViewportParams&, std::any& cache,
+            const QCPCancellationToken&) -> std::shared_ptr<QCPAbstractDataSource> {
+            while (!gate.load()) QThread::msleep(1);
+            cache = src.size();
+            return nullptr;
+        });
+    std::vector<qsizetype> cached;
+    connect(&pipeline, &QCPGraphPipeline::finished, this, [&](uint64_t) {
+        auto* size = std::any_cast<qsizetype>(&pipeline.cache());
+        cached.push_back(size ? *size : -1);
+    });
+
+    pipeline.setSource(std::make_shared<Source>(std::vector<double>{1}, std::vector<double>{1}));
+    // Appended while the first job runs: only its result is obsolete.
+    pipeline.appendSource(std::make_shared<Source>(std::vector<double>{1, 2},
+                                                   std::vector<double>{1, 2}));
+    gate.store(true);
+    QTRY_VERIFY_WITH_TIMEOUT(!pipeline.isBusy(), 2000);
+    QCOMPARE(cached, (std::vector<qsizetype>{1, 2}));
+}
+
+void TestPipeline::graphPreviewSpansSourceFromFewBlocks()
+{
+    const qsizetype N = 50'000'000;
+    SyntheticLargeSource src(N);
+
+    std::atomic<quint64> bytes{0};
+    std::shared_ptr<QCPAbstractDataSource> preview;
+    {
+        qcp::ScanCounterScope scope(&bytes);
+        preview = qcp::algo::buildPreview(src, ViewportParams{});
+    }
+    QVERIFY(preview);
+    QVERIFY(preview->size() <= 2 * qcp::algo::kPreviewBins);
+
+    // Covers both ends of the key range...
+    const double binWidth = double(N - 1) / qcp::algo::kPreviewBins;
+    QVERIFY(preview->keyAt(0) <= binWidth);
+    QVERIFY(preview->keyAt(preview->size() - 1) >= N - 1 - binWidth);
+    for (qsizetype i = 0; i < preview->size(); ++i)
+        QVERIFY(std::abs(preview->valueAt(i)) <= 1.0);
+
+    // ...from a fixed number of samples, whatever the source size.
+    const quint64 samples = quint64(qcp::algo::kPreviewBlocks + 1) * qcp::algo::kPreviewBlockSamples;
+    QCOMPARE(bytes.load(), samples * quint64(src.sampleBytes()));
+
+    // Too small to need an L1: no preview either.
+    QVERIFY(!qcp::algo::buildPreview(SyntheticLargeSource(1000), ViewportParams{}));
+}
+
+void TestPipeline::graph2DrawsPreviewWhileL1Builds()
+{
+    const int N = 2'000'000;
+    auto source = std::make_shared<SyntheticLargeSource>(N);
+    auto* g = new QCPGraph2(mPlot->xAxis, mPlot->yAxis);
+    mPlot->xAxis->setRange(0, N - 1);
+    mPlot->yAxis->setRange(-1, 1);
+    g->setDataSource(source);
+    QTRY_VERIFY_WITH_TIMEOUT(g->mL1Cache, 30000);
+
+    // Hold the next L1 build until released; the preview is installed already.
+    std::atomic<bool> gate{false};
+    g->mPipeline.setTransform(TransformKind::ViewportIndependent,
+        [&gate](const QCPAbstractDataSource& src, const ViewportParams& vp, std::any& cache,
+                const QCPCancellationToken& cancel) -> std::shared_ptr<QCPAbstractDataSource> {
+            while (!gate.load()) QThread::msleep(1);
+            return qcp::algo::buildL1Cache(src, vp, cache, nullptr, cancel.cacheToken());
+        });
+    g->dataChanged();
+    QVERIFY(!g->mL1Cache);
+    QTRY_VERIFY_WITH_TIMEOUT(g->mPipeline.preview() != nullptr, 5000);
+    QVERIFY(g->canProduceContent());
+
+    mPlot->replot(QCustomPlot::rpImmediateRefresh);
+    QVERIFY(!g->mCachedLines.isEmpty());
+
+    gate.store(true);
+    QTRY_VERIFY_WITH_TIMEOUT(g->mL1Cache, 30000);
+    QVERIFY(g->mPipeline.preview() == nullptr);
+}
+
+void TestPipeline::graphResamplerPyramidLevels()
+{
+    // 2M points -> 125k base bins; coarse levels 15625 and 1954 bins
+    const int N = 2'000'000;
+    auto src = std::make_shared<SyntheticLargeSource>(N);
+    std::any cache;
+    qcp::algo::buildL1Cache(*src, ViewportParams{}, cache);
+    auto* c = std::any_cast<qcp::algo::GraphResamplerCache>(&cache);
+    QVERIFY(c);
+    QCOMPARE(c->level1.bins(), N / qcp::algo::kLevel1SamplesPerBin);
+    QCOMPARE(static_cast<int>(c->coarseLevels.size()), 2);
+
+    const auto* fine = &c->level1;
+    for (const auto& coarse : c->coarseLevels)
+    {
+        const int fineBins = fine->bins();
+        const int bins = coarse.bins();
+        QCOMPARE(bins, (fineBins + qcp::algo::kPyramidFactor - 1) / qcp::algo::kPyramidFactor);
+        QVERIFY(bins >= qcp::algo::kPyramidMinBins);
+        for (int b = 0; b < bins; ++b)
+        {
+            double mn = std::numeric_limits<double>::infinity(), mx = -mn;
+            for (int f = b * qcp::algo::kPyramidFactor;
+                 f < std::min((b + 1) * qcp::algo::kPyramidFactor, fineBins); ++f)
+            {
+                mn = std::min(mn, fine->value(f * 2 + 0));
+                mx = std::max(mx, fine->value(f * 2 + 1));
+            }
+            QCOMPARE(coarse.value(b * 2 + 0), mn);
+            QCOMPARE(coarse.value(b * 2 + 1), mx);
+        }
+        fine = &coarse;
+    }
+}
+
+void TestPipeline::graphResamplerL2PicksCoarsestLevel()
+{
+    const int N = 2'000'000;
+    auto src = std::make_shared<SyntheticLargeSource>(N);
+    std::any cache;
+    qcp::algo::buildL1Cache(*src, ViewportParams{}, cache);
+    auto* c = std::any_cast<qcp::algo::GraphResamplerCache>(&cache);
+    QVERIFY(c);
+
+    ViewportParams vp;
+    vp.plotWidthPx = 100; // 400 L2 bins
+    const int l2Bins = vp.plotWidthPx * qcp::algo::kLevel2PixelMultiplier;
+    auto expectFrom = [&](const qcp::algo::PyramidLevel& level) {
+        const auto flat = level.toBins();
+        auto b = qcp::algo::l1ViewportBounds(flat.keys, static_cast<int>(flat.keys.size()),
+                                             vp.keyRange);
+        QCOMPARE(qcp::algo::l1ViewportBounds(level, vp.keyRange).begin, b.begin);
+        QCOMPARE(qcp::algo::l1ViewportBounds(level, vp.keyRange).end, b.end);
+        QVERIFY(b.end - b.begin > l2Bins);
+        auto l2 = qcp::algo::binMinMax(flat.keys, flat.values, b.begin, b.end,
+                                       vp.keyRange, l2Bins);
+        auto result = qcp::algo::resampleL2(*c, vp);
+        QVERIFY(result);
+        int j = 0;
+        for (size_t i = 0; i < l2.values.size(); ++i)
+        {
+            if (std::isnan(l2.values[i]))
+                continue;
+            QCOMPARE(result->keyAt(j), l2.keys[i]);
+            QCOMPARE(result->valueAt(j), l2.values[i]);
+            ++j;
+        }
+        QCOMPARE(result->size(), j);
+    };
+
+    // Full view: the coarsest level already has ~3900 points in view
+    vp.keyRange = QCPRange(0, N - 1);
+    expectFrom(c->coarseLevels.back());
+
+    // ~195 coarsest bins in view is too few, the next finer level is used
+    vp.keyRange = QCPRange(0, 200'000);
+    expectFrom(c->coarseLevels.front());
+
+    // Deep zoom: even the base has fewer than l2Bins points in view -> raw
+    vp.keyRange = QCPRange(1000, 3000);
+    QVERIFY(!qcp::algo::resampleL2(*c, vp));
+}
+
+void TestPipeline::graphResamplerLogKeyL2()
+{
+    // Keys 0..N-1; a log view over 6+ decades puts most L2 bins far below
+    // the L1 resolution of the first decades.
+    const int N = 2'000'000;
+    auto src = std::make_shared<SyntheticLargeSource>(N);
+    std::any cache;
+    qcp::algo::buildL1Cache(*src, ViewportParams{}, cache);
+    auto* c = std::any_cast<qcp::algo::GraphResamplerCache>(&cache);
+    QVERIFY(c);
+
+    ViewportParams vp;
+    vp.keyLogScale = true;
+    vp.keyRange = QCPRange(1, N - 1);
+    vp.plotWidthPx = 100;
+    const int l2Bins = vp.plotWidthPx * qcp::algo::kLevel2PixelMultiplier;
+
+    auto result = qcp::algo::resampleL2(*c, vp, src.get());
+    QVERIFY(result);
+    QVERIFY(result->size() <= 2 * l2Bins);
+    for (qsizetype i = 0; i < result->size(); ++i)
+    {
+        QVERIFY(result->keyAt(i) >= vp.keyRange.lower);
+        QVERIFY(result->keyAt(i) <= vp.keyRange.upper * 1.0001);
+        if (i > 0)
+            QVERIFY(result->keyAt(i) > result->keyAt(i - 1));
+    }
+
+    // Samples 1..9 each fall into their own L2 bin (bins are ~0.016 decades
+    // wide), so their exact values must survive — the L1 alone can't resolve them.
+    for (int k = 1; k < 10; ++k)
+    {
+        bool seen = false;
+        for (qsizetype i = 0; i < result->size() && result->keyAt(i) < 10; ++i)
+            seen |= result->valueAt(i) == src->valueAt(k);
+        QVERIFY2(seen, qPrintable(QString("sample %1 not resolved").arg(k)));
+    }
+
+    // The overall envelope is exactly the raw one
+    double lo = std::numeric_limits<double>::max(), hi = std::numeric_limits<double>::lowest();
+    for (qsizetype i = 0; i < result->size(); ++i)
+    {
+        lo = std::min(lo, result->valueAt(i));
+        hi = std::max(hi, result->valueAt(i));
+    }
+    double rawLo = std::numeric_limits<double>::max(), rawHi = std::numeric_limits<double>::lowest();
+    for (int i = 1; i < N; ++i)
+    {
+        rawLo = std::min(rawLo, src->valueAt(i));
+        rawHi = std::max(rawHi, src->valueAt(i));
+    }
+    QCOMPARE(lo, rawLo);
+    QCOMPARE(hi, rawHi);
+
+    // Without the raw source the low end degrades to L1 resolution, never to nothing
+    auto l1Only = qcp::algo::resampleL2(*c, vp);
+    QVERIFY(l1Only);
+    QVERIFY(l1Only->size() > 0);
+}
+
+void TestPipeline::sourceIndicesBeyondInt32()
+{
+    // Keys equal indices, so every lookup past 2^31 must survive unwrapped.
+    const qsizetype N = 5'000'000'000LL;
+    SyntheticLargeSource src(N);
+    QCOMPARE(src.size(), N);
+
+    const qsizetype begin = src.findBegin(4'000'000'000.0, false);
+    const qsizetype end = src.findEnd(4'000'001'000.0, false);
+    QCOMPARE(begin, qsizetype(4'000'000'000LL));
+    QCOMPARE(end - begin, qsizetype(1001));
+
+    auto bins = qcp::algo::binMinMax(src, begin, end,
+                                     QCPRange(4'000'000'000.0, 4'000'001'000.0), 10);
+    QCOMPARE(bins.values.size(), size_t(20));
+    for (double v : bins.values)
+        QVERIFY(!std::isnan(v));
+
+    QCPDataSelection sel(QCPDataRange(begin, end));
+    QCOMPARE(sel.dataRange(0).begin(), begin);
+    QCOMPARE(sel.dataPointCount(), qsizetype(1001));
+    QVERIFY(sel.contains(QCPDataSelection(QCPDataRange(begin + 10, begin + 20))));
+}
+
+void TestPipeline::simdMinMaxKernelsMatchScalar()
+{
+    using namespace qcp::algo::simd;
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+
+    // Dense sorted runs with NaN values and non-finite keys sprinkled in,
+    // followed by an unsorted stretch that breaks every run.
+    const std::ptrdiff_t n = 20'000;
+    std::vector<double> keys(n), values(n);
+    for (std::ptrdiff_t i = 0; i < n; ++i)
+    {
+        keys[i] = i < 15'000 ? i * 0.01 : std::fmod(i * 7.31, 150.0);
+        values[i] = std::sin(i * 0.05) * 100.0 + (i % 13);
+        if (i % 97 == 0) values[i] = nan;
+        if (i % 211 == 0) keys[i] = nan;
+        if (i % 509 == 0) keys[i] = inf;
+    }
+    std::vector<int> bins(n);
+    for (std::ptrdiff_t i = 0; i < n; ++i)
+        bins[i] = (i % 331 == 0) ? -1 : static_cast<int>(i / 37) % 250;
+    const double* columns[] = {values.data(), keys.data()};
+
+    // NaN-aware bitwise comparison
+    auto same = [](const std::vector<double>& a, const std::vector<double>& b) {
+        for (size_t i = 0; i < a.size(); ++i)
+            if (!(std::isnan(a[i]) && std::isnan(b[i])) && a[i] != b[i])
+                return false;
+        return true;
+    };
+
+    const MinMaxKernels* scalar = minMaxKernelsFor(Isa::Scalar);
+    QVERIFY(scalar);
+    const int numBins = 700;
+    const double keyLo = 1.5, binWidth = 150.0 / numBins;
+    std::vector<double> expected(numBins * 2, nan), expectedSlice(numBins * 2, nan),
+        expectedBinned(1000, nan);
+    scalar->accumulate(keys.data(), values.data(), 0, n, keyLo, binWidth,
+                       expected.data(), 0, numBins);
+    scalar->accumulate(keys.data(), values.data(), 3'001, 12'345, keyLo, binWidth,
+                       expectedSlice.data(), 200, 400);
+    scalar->accumulateBinned(bins.data(), n, columns, 2, expectedBinned.data(), 500);
+
+    for (Isa isa : {Isa::Neon, Isa::Avx2, Isa::Avx512})
+    {
+        const MinMaxKernels* kernels = minMaxKernelsFor(isa);
+        if (!kernels)
+            continue;
+        std::vector<double> got(numBins * 2, nan), gotSlice(numBins * 2, nan),
+            gotBinned(1000, nan);
+        kernels->accumulate(keys.data(), values.data(), 0, n, keyLo, binWidth,
+                            got.data(), 0, numBins);
+        kernels->accumulate(keys.data(), values.data(), 3'001, 12'345, keyLo, binWidth,
+                            gotSlice.data(), 200, 400);
+        kernels->accumulateBinned(bins.data(), n, columns, 2, gotBinned.data(), 500);
+        QVERIFY2(same(got, expected), kernels->name);
+        QVERIFY2(same(gotSlice, expectedSlice), kernels->name);
+        QVERIFY2(same(gotBinned, expectedBinned), kernels->name);
+    }
+
+    // The resampler entry points dispatch through the active kernels
+    const Isa previous = minMaxKernels().isa;
+    QVERIFY(setMinMaxIsa(Isa::Scalar));
+    QCOMPARE(minMaxKernels().isa, Isa::Scalar);
+    QVERIFY(setMinMaxIsa(previous));
+}
 
 // --- Multi-column resampler tests ---
 
@@ -1417,6 +2722,155 @@ void TestPipeline::bin2dLogAllNonPositiveNoGrid()
     QVERIFY(!result);
 }
 
+void TestPipeline::bin2dParallelMatchesReference()
+{
+    // Above the parallel threshold: per-thread grids merged at the end must
+    // count exactly what a serial pass over the same grid counts.
+    const int N = 3'000'000;
+    std::vector<float> keys(N), vals(N);
+    for (int i = 0; i < N; ++i)
+    {
+        keys[i] = std::sin(i * 0.37f) * 10.0f;
+        vals[i] = std::cos(i * 0.11f) * 5.0f + keys[i] * 0.25f;
+        if (i % 1009 == 0)
+            keys[i] = std::numeric_limits<float>::quiet_NaN();
+        if (i % 2003 == 0)
+            vals[i] = std::numeric_limits<float>::infinity();
+    }
+    QCPSoADataSource<std::vector<float>, std::vector<float>> src(keys, vals);
+
+    const int kb = 128, vb = 64;
+    std::unique_ptr<QCPColorMapData> result(qcp::algo::bin2d(src, kb, vb));
+    QVERIFY(result);
+
+    QCPRange keyRange, valRange;
+    QVERIFY(src.finiteKeyValueBounds(keyRange, valRange));
+    QCOMPARE(result->keyRange().lower, keyRange.lower);
+    QCOMPARE(result->keyRange().upper, keyRange.upper);
+    QCOMPARE(result->valueRange().lower, valRange.lower);
+    QCOMPARE(result->valueRange().upper, valRange.upper);
+
+    const auto kAxis = qcp::algo::BinAxis::make(keyRange, kb, false);
+    const auto vAxis = qcp::algo::BinAxis::make(valRange, vb, false);
+    std::vector<double> expected(kb * vb, 0.0);
+    double expectedTotal = 0;
+    for (int i = 0; i < N; ++i)
+    {
+        if (!std::isfinite(keys[i]) || !std::isfinite(vals[i]))
+            continue;
+        expected[vAxis.index(vals[i]) * kb + kAxis.index(keys[i])] += 1.0;
+        expectedTotal += 1.0;
+    }
+    double total = 0;
+    for (int v = 0; v < vb; ++v)
+        for (int k = 0; k < kb; ++k)
+        {
+            QCOMPARE(result->cell(k, v), expected[v * kb + k]);
+            total += result->cell(k, v);
+        }
+    QCOMPARE(total, expectedTotal);
+}
+
+void TestPipeline::bin2dViewportMatchesBruteForce()
+{
+    // Scattered keys with NaN/Inf and non-positive samples; views inside,
+    // straddling and outside the data, linear and log. The same samples
+    // sorted by key are indexed in place, as source row ranges.
+    const int N = 200'000;
+    std::vector<double> keys(N), vals(N);
+    for (int i = 0; i < N; ++i)
+    {
+        keys[i] = std::sin(i * 0.37) * 10.0 + std::cos(i * 1.3);
+        vals[i] = std::cos(i * 0.11) * 5.0 + keys[i] * 0.25;
+        if (i % 2003 == 0)
+            vals[i] = -std::numeric_limits<double>::infinity();
+    }
+    std::vector<int> order(N);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int l, int r) { return keys[l] < keys[r]; });
+    std::vector<double> sortedKeys(N), sortedVals(N);
+    for (int i = 0; i < N; ++i)
+    {
+        sortedKeys[i] = keys[order[i]];
+        sortedVals[i] = vals[order[i]];
+    }
+    // NaN keys after sorting, so the sorted copy keeps them between rows.
+    for (int i = 0; i < N; i += 1009)
+    {
+        keys[i] = std::numeric_limits<double>::quiet_NaN();
+        sortedKeys[i] = std::numeric_limits<double>::quiet_NaN();
+    }
+
+    struct View { QCPRange key, value; bool keyLog, valueLog; };
+    const View views[] = {
+        {QCPRange(-2.5, 3.0), QCPRange(-1.0, 2.0), false, false},
+        {QCPRange(-50.0, 50.0), QCPRange(-50.0, 50.0), false, false},
+        {QCPRange(8.0, 30.0), QCPRange(0.0, 1.0), false, false},
+        {QCPRange(0.01, 5.0), QCPRange(0.1, 4.0), true, true},
+    };
+    const int viewKeyBins = 200, viewValueBins = 100;
+    auto check = [&](const std::vector<double>& ks, const std::vector<double>& vs,
+                     qcp::algo::Histogram2DIndex::Storage storage) {
+        QCPSoADataSource<std::vector<double>, std::vector<double>> src(ks, vs);
+        auto index = qcp::algo::buildHistogram2DIndex(src);
+        QVERIFY(index);
+        QVERIFY(index->storage == storage);
+        QVERIFY(index->bucketCount() > 1);
+        for (const View& view : views)
+        {
+            std::unique_ptr<QCPColorMapData> result(qcp::algo::bin2dViewport(
+                src, *index, view.key, view.value, viewKeyBins, viewValueBins,
+                view.keyLog, view.valueLog));
+            QVERIFY(result);
+            const QCPRange kr = result->keyRange(), vr = result->valueRange();
+            QVERIFY(kr.lower >= view.key.lower && kr.upper <= view.key.upper);
+            QVERIFY(vr.lower >= view.value.lower && vr.upper <= view.value.upper);
+            QVERIFY(result->keySize() <= viewKeyBins && result->valueSize() <= viewValueBins);
+
+            const int kb = result->keySize(), vb = result->valueSize();
+            const auto kAxis = qcp::algo::BinAxis::make(kr, kb, view.keyLog);
+            const auto vAxis = qcp::algo::BinAxis::make(vr, vb, view.valueLog);
+            std::vector<double> expected(kb * vb, 0.0);
+            for (int i = 0; i < N; ++i)
+            {
+                const double k = ks[i], v = vs[i];
+                if (!std::isfinite(k) || !std::isfinite(v))
+                    continue;
+                if (k < view.key.lower || k > view.key.upper || v < view.value.lower || v > view.value.upper)
+                    continue;
+                expected[vAxis.index(v) * kb + kAxis.index(k)] += 1.0;
+            }
+            for (int v = 0; v < vb; ++v)
+                for (int k = 0; k < kb; ++k)
+                    QCOMPARE(result->cell(k, v), expected[v * kb + k]);
+        }
+
+        // A view missing the data entirely produces no grid.
+        QVERIFY(!qcp::algo::bin2dViewport(src, *index, QCPRange(100, 200), QCPRange(-1, 1), 10, 10));
+    };
+    using Storage = qcp::algo::Histogram2DIndex::Storage;
+    check(keys, vals, Storage::Copied);
+    if (QTest::currentTestFailed())
+        return;
+    check(sortedKeys, sortedVals, Storage::SourceRows);
+    if (QTest::currentTestFailed())
+        return;
+
+    // In place, the index is just the bucket offsets.
+    QCPSoADataSource<std::vector<double>, std::vector<double>> sorted(sortedKeys, sortedVals);
+    auto inPlace = qcp::algo::buildHistogram2DIndex(sorted);
+    QVERIFY(inPlace->keys.empty() && inPlace->values.empty());
+    QVERIFY(inPlace->memoryBytes() < quint64(N));
+
+    // Past the copy cap a scattered source is not indexed; a sorted one is.
+    QCPSoADataSource<std::vector<double>, std::vector<double>> scattered(keys, vals);
+    auto none = qcp::algo::buildHistogram2DIndex(scattered, {}, N - 1);
+    QVERIFY(none && none->storage == Storage::None);
+    QCOMPARE(none->memoryBytes(), quint64(0));
+    QVERIFY(!qcp::algo::bin2dViewport(scattered, *none, views[0].key, views[0].value, 10, 10));
+    QVERIFY(qcp::algo::buildHistogram2DIndex(sorted, {}, N - 1)->storage == Storage::SourceRows);
+}
+
 // --- QCPHistogram2D tests ---
 
 // Axis auto-scaling asks the plottable for its key range. Histogram keys are
@@ -1554,6 +3008,53 @@ void TestPipeline::histogram2dAxisScaleTogglesRebinning()
     QCOMPARE(log->cell(2, 0), 2.0);
 }
 
+void TestPipeline::histogram2dViewportModeRebinsOnZoom()
+{
+    auto* hist = new QCPHistogram2D(mPlot->xAxis, mPlot->yAxis);
+    std::vector<double> keys, vals;
+    for (int i = 0; i < 10000; ++i)
+    {
+        keys.push_back(i * 0.001);
+        vals.push_back(std::sin(i * 0.001));
+    }
+    auto countIn = [&](const QCPRange& kr, const QCPRange& vr) {
+        double n = 0;
+        for (size_t i = 0; i < keys.size(); ++i)
+            n += kr.contains(keys[i]) && vr.contains(vals[i]);
+        return n;
+    };
+    auto total = [](const QCPColorMapData* d) {
+        double n = 0;
+        for (int v = 0; v < d->valueSize(); ++v)
+            for (int k = 0; k < d->keySize(); ++k)
+                n += d->cell(k, v);
+        return n;
+    };
+    const double expectedFull = countIn(QCPRange(-1, 11), QCPRange(-2, 2));
+    const double expectedZoom = countIn(QCPRange(2.0, 3.0), QCPRange(0.5, 1.0));
+
+    hist->setBinningMode(QCPHistogram2D::bmViewport);
+    QCOMPARE(hist->binningMode(), QCPHistogram2D::bmViewport);
+    mPlot->replot(); // lay out the axis rect: bins follow its pixel size
+    mPlot->xAxis->setRange(-1, 11);
+    mPlot->yAxis->setRange(-2, 2);
+    hist->setData(keys, vals);
+
+    QSignalSpy spy(&hist->pipeline(), &QCPHistogramPipeline::finished);
+    QTRY_VERIFY_WITH_TIMEOUT(!hist->pipeline().isBusy() && hist->pipeline().result(), 2000);
+    QCOMPARE(total(hist->pipeline().result()), expectedFull);
+
+    // Zooming re-bins only the visible region.
+    spy.clear();
+    mPlot->xAxis->setRange(2.0, 3.0);
+    mPlot->yAxis->setRange(0.5, 1.0);
+    QTRY_VERIFY_WITH_TIMEOUT(!hist->pipeline().isBusy() && spy.count() > 0, 2000);
+    auto* zoomed = hist->pipeline().result();
+    QVERIFY(zoomed);
+    QVERIFY(zoomed->keyRange().lower >= 2.0 && zoomed->keyRange().upper <= 3.0);
+    QCOMPARE(total(zoomed), expectedZoom);
+}
+
 void TestPipeline::histogram2dNormalizationColumn()
 {
     auto* hist = new QCPHistogram2D(mPlot->xAxis, mPlot->yAxis);
@@ -1688,12 +3189,12 @@ void TestPipeline::multiGraphL1AndL2()
 class SyntheticLargeMultiSource : public QCPAbstractMultiDataSource
 {
 public:
-    explicit SyntheticLargeMultiSource(int n, int cols) : mN(n), mCols(cols) {}
-    int size() const override { return mN; }
+    explicit SyntheticLargeMultiSource(qsizetype n, int cols) : mN(n), mCols(cols) {}
+    qsizetype size() const override { return mN; }
     bool empty() const override { return mN == 0; }
     int columnCount() const override { return mCols; }
-    double keyAt(int i) const override { return static_cast<double>(i); }
-    double valueAt(int col, int i) const override { return std::sin(i * 0.0001 + col); }
+    double keyAt(qsizetype i) const override { return static_cast<double>(i); }
+    double valueAt(int col, qsizetype i) const override { return std::sin(i * 0.0001 + col); }
     QCPRange keyRange(bool& found, QCP::SignDomain) const override
     {
         found = mN > 0;
@@ -1704,30 +3205,30 @@ public:
         found = mN > 0;
         return QCPRange(-1, 1);
     }
-    int findBegin(double sortKey, bool) const override
+    qsizetype findBegin(double sortKey, bool) const override
     {
-        return std::clamp(static_cast<int>(sortKey), 0, mN);
+        return std::clamp<qsizetype>(static_cast<qsizetype>(sortKey), 0, mN);
     }
-    int findEnd(double sortKey, bool) const override
+    qsizetype findEnd(double sortKey, bool) const override
     {
-        return std::clamp(static_cast<int>(std::ceil(sortKey)) + 1, 0, mN);
+        return std::clamp<qsizetype>(static_cast<qsizetype>(std::ceil(sortKey)) + 1, 0, mN);
     }
-    QVector<QPointF> getOptimizedLineData(int col, int begin, int end, int,
+    QVector<QPointF> getOptimizedLineData(int col, qsizetype begin, qsizetype end, int,
                                           QCPAxis* ka, QCPAxis* va) const override
     {
         return getLines(col, begin, end, ka, va);
     }
-    QVector<QPointF> getLines(int col, int begin, int end,
+    QVector<QPointF> getLines(int col, qsizetype begin, qsizetype end,
                                QCPAxis*, QCPAxis*) const override
     {
         QVector<QPointF> result;
         result.reserve(end - begin);
-        for (int i = begin; i < end; ++i)
+        for (qsizetype i = begin; i < end; ++i)
             result.append(QPointF(keyAt(i), valueAt(col, i)));
         return result;
     }
 private:
-    int mN;
+    qsizetype mN;
     int mCols;
 };
 
@@ -1865,7 +3366,7 @@ void TestPipeline::multiGraphLogScaleFallback()
             &loop, &QEventLoop::quit);
     loop.exec();
 
-    // Draw should not crash — log scale draw path falls back to raw data for L2
+    // Draw should not crash — log scale draw path uses log-spaced L2 bins
     mPlot->replot(QCustomPlot::rpImmediateRefresh);
 }
 
@@ -1970,6 +3471,68 @@ void TestPipeline::graph2LineCacheReusedOnSmallPan()
     QCOMPARE(graph->mCachedLines, cachedBefore);
 }
 
+void TestPipeline::pixelLineMatchesPointLines()
+{
+    const int N = 20000;
+    std::vector<double> keys(N), values(N);
+    for (int i = 0; i < N; ++i) { keys[i] = i; values[i] = std::sin(i * 0.003); }
+    keys[N / 2] = keys[N / 2 - 1] + 500; // gap: NaN break in both outputs
+    for (int i = N / 2 + 1; i < N; ++i)
+        keys[i] = keys[i - 1] + 1;
+    QCPSoADataSource<std::vector<double>, std::vector<double>> ds(std::move(keys), std::move(values));
+    mPlot->xAxis->setRange(0, N + 500);
+    mPlot->yAxis->setRange(-1.5, 1.5);
+    mPlot->replot(QCustomPlot::rpImmediateRefresh);
+
+    QCPPixelLine line;
+    line.origin = QPointF(mPlot->axisRect()->topLeft());
+    auto check = [&](const QVector<QPointF>& expected) {
+        QCOMPARE(line.size(), expected.size());
+        for (qsizetype i = 0; i < expected.size(); ++i)
+        {
+            if (qIsNaN(expected[i].x()))
+            {
+                QVERIFY(qIsNaN(line[i].x()));
+                continue;
+            }
+            QVERIFY(qAbs(line[i].x() - expected[i].x()) < 1e-3);
+            QVERIFY(qAbs(line[i].y() - expected[i].y()) < 1e-3);
+        }
+    };
+
+    ds.getPixelLine(0, N, mPlot->xAxis, mPlot->yAxis, line);
+    check(ds.getLines(0, N, mPlot->xAxis, mPlot->yAxis));
+    ds.getOptimizedPixelLine(0, N, 400, mPlot->xAxis, mPlot->yAxis, line);
+    check(ds.getOptimizedLineData(0, N, 400, mPlot->xAxis, mPlot->yAxis));
+}
+
+void TestPipeline::graph2LineCacheRebuildKeepsBuffer()
+{
+    auto* graph = new QCPGraph2(mPlot->xAxis, mPlot->yAxis);
+    const int N = 10000;
+    std::vector<double> keys(N), values(N);
+    for (int i = 0; i < N; ++i) { keys[i] = i; values[i] = std::sin(i * 0.01); }
+    graph->setDataSource(std::make_shared<QCPSoADataSource<std::vector<double>, std::vector<double>>>(
+        std::move(keys), std::move(values)));
+    mPlot->xAxis->setRange(0, N);
+    mPlot->yAxis->setRange(-1.5, 1.5);
+    mPlot->replot(QCustomPlot::rpImmediateRefresh);
+
+    QVERIFY(!graph->mCachedLines.isEmpty());
+    QCOMPARE(graph->mCachedLines.origin, QPointF(mPlot->axisRect()->topLeft()));
+    const auto cachedBefore = graph->mCachedLines;
+    const float* buffer = graph->mCachedLines.xy.data();
+    const quint64 capacity = graph->mCachedLines.capacityBytes();
+
+    // A rebuild of the same lines refills the buffer in place
+    graph->mLineCacheDirty = true;
+    mPlot->replot(QCustomPlot::rpImmediateRefresh);
+    QVERIFY(!graph->mLineCacheDirty);
+    QCOMPARE(graph->mCachedLines, cachedBefore);
+    QCOMPARE(graph->mCachedLines.xy.data(), buffer);
+    QCOMPARE(graph->mCachedLines.capacityBytes(), capacity);
+}
+
 void TestPipeline::graph2LineCacheRebuiltOnLargePan()
 {
     auto* graph = new QCPGraph2(mPlot->xAxis, mPlot->yAxis);
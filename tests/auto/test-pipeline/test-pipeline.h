@@ -14,6 +14,10 @@ private slots:
     void schedulerSubmitHeavy();
     void schedulerSubmitFast();
     void schedulerFastPriority();
+    void executorNestedTaskGroups();
+    void executorRoundRobinAcrossOwners();
+    void executorRanksAndSharedGroups();
+    void plotVisibilityRanksScheduler();
 
     // Pipeline base tests
     void pipelinePassthrough();
@@ -25,6 +29,8 @@ private slots:
     void pipelineCacheClearedOnDataChange();
     void pipelineInterimResult();
     void pipelineDestructionWhileRunning();
+    void pipelineStatsCountJobsAndBytes();
+    void latencyHistogramQuantiles();
 
     // QCPGraph2 pipeline integration
     void graph2PipelinePassthrough();
@@ -42,6 +48,9 @@ private slots:
     void pipelineSourceReplacedDuringJob();
     void pipelineRapidFireDeliverResult();
     void pipelineNullSourceWhileJobRunningResyncsGeneration();
+    void pipelineCancelsSupersededJob();
+    void pipelineViewportCancelKeepsCacheWork();
+    void cancelledBinningBailsOut();
     void schedulerDtorDropsQueuedJobs();
     void colormap2QueuedJobAfterDeleteDoesNotTouchFreedMemory();
     void colormap2GapThresholdBeforeDataDoesNotStickBusy();
@@ -60,6 +69,27 @@ private slots:
     void graphResamplerBinMinMaxZeroBins();
     void graphResamplerNonFiniteKeysSkipped();
     void graphResamplerParallelMatchesSingleThreaded();
+    void graphResamplerNativeTypeBinning();
+    void graphResamplerIncrementalL1BinsOnlyTail();
+    void graphResamplerIncrementalL1RegridsOnDoubling();
+    void graphResamplerIncrementalL1RejectsMovedStart();
+    void graphResamplerPyramidLevels();
+    void graphResamplerL2PicksCoarsestLevel();
+    void graphResamplerLogKeyL2();
+    void sourceIndicesBeyondInt32();
+    void simdMinMaxKernelsMatchScalar();
+    void graph2AddDataExtendsL1();
+    void graph2AddDataWhileExtending();
+    void sharedL1CacheBuiltOnce();
+    void sharedL1WaitersHelpTheBuild();
+    void graph2SharedSourceSharesL1();
+    void graph2MemoryAccountingSplitsSharedL1();
+    void memoryBudgetEvictsLeastRecentlyDrawn();
+    void memoryBudgetCountsSharedL1Once();
+    void pipelinePreviewShownUntilFullResult();
+    void pipelineAppendKeepsCacheWorkInFlight();
+    void graphPreviewSpansSourceFromFewBlocks();
+    void graph2DrawsPreviewWhileL1Builds();
 
     // Multi-column resampler
     void multiGraphBinMinMaxMulti();
@@ -94,6 +124,8 @@ private slots:
     void bin2dLogKeyBinning();
     void bin2dLogDropsNonPositive();
     void bin2dLogAllNonPositiveNoGrid();
+    void bin2dParallelMatchesReference();
+    void bin2dViewportMatchesBruteForce();
 
     // QCPHistogram2D
     void histogram2dKeyRangeUnsorted();
@@ -106,6 +138,7 @@ private slots:
     void histogram2dLogKeyBinScaleRebins();
     void histogram2dBinScaleDefaultsLinear();
     void histogram2dAxisScaleTogglesRebinning();
+    void histogram2dViewportModeRebinsOnZoom();
 
     // Layer-level GPU translation
     void stallPixelOffsetGraph2Busy();
@@ -124,6 +157,8 @@ private slots:
 
     // Line caching
     void graph2LineCacheReusedOnSmallPan();
+    void pixelLineMatchesPointLines();
+    void graph2LineCacheRebuildKeepsBuffer();
     void graph2LineCacheRebuiltOnLargePan();
     void graph2LineCacheSurvives75PercentPan();
     void graph2LineCacheRebuiltOnZoom();
@@ -209,16 +209,45 @@ void TestQCustomPlot::dateTimeTicker_extremeZoomOutNoCrash()
     // If we reach here without asserting, the guard works
 }
 
+void TestQCustomPlot::frameProfile_recordsReplot()
+{
+  QCPGraph *g1 = mPlot->addGraph();
+  g1->setName("slow graph");
+  g1->setData(QVector<double>() << 1 << 2 << 3, QVector<double>() << 1 << 4 << 9);
+
+  // off by default: nothing recorded
+  mPlot->replot();
+  QVERIFY(mPlot->frameProfile().layers.isEmpty());
+  QCOMPARE(mPlot->frameProfile().replotNs, qint64(0));
+
+  mPlot->setFrameProfiling(true);
+  mPlot->replot();
+  const QCPFrameProfile &profile = mPlot->frameProfile();
+  QVERIFY(profile.replotNs > 0);
+  QVERIFY(profile.layoutNs <= profile.replotNs);
+  QVERIFY(!profile.layers.isEmpty());
+  QCOMPARE(profile.plottables.size(), 1);
+  QCOMPARE(profile.plottables.first().plottable.data(), static_cast<QCPAbstractPlottable*>(g1));
+  QCOMPARE(profile.plottables.first().name, QString("slow graph"));
+  QVERIFY(profile.summary().contains("slow graph"));
+
+  // each replot starts a fresh profile
+  mPlot->replot();
+  QCOMPARE(mPlot->frameProfile().plottables.size(), 1);
+
+  mPlot->setFrameProfiling(false);
+  QVERIFY(mPlot->frameProfile().plottables.isEmpty());
+}
 
-
-
-
-
-
-
-
-
-
-
-
-
+void TestQCustomPlot::frameProfile_hudShowsSummary()
+{
+  mPlot->setFrameProfileHud(true);
+  QVERIFY(mPlot->frameProfiling());
+  mPlot->replot();
+  mPlot->replot();
+  QVERIFY(mPlot->overlay()->text().startsWith("replot "));
+  QCOMPARE(mPlot->overlay()->position(), QCPOverlay::Bottom);
+
+  mPlot->setFrameProfileHud(false);
+  QVERIFY(mPlot->overlay()->text().isEmpty());
+}
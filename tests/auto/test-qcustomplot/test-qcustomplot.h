@@ -15,6 +15,8 @@ private slots:
   void rescaleAxes_MultipleFlatGraphs();
   void calculateMargin_staleTickVectors();
   void dateTimeTicker_extremeZoomOutNoCrash();
+  void frameProfile_recordsReplot();
+  void frameProfile_hudShowsSummary();
 
 private:
   QCustomPlot *mPlot;
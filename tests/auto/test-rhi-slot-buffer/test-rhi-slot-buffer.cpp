@@ -0,0 +1,134 @@
+#include "test-rhi-slot-buffer.h"
+#include "../../../src/painting/rhi-slot-buffer.h"
+
+#include <vector>
+
+namespace {
+
+std::vector<float> ramp(int count, float start = 0)
+{
+    std::vector<float> v(count);
+    for (int i = 0; i < count; ++i)
+        v[i] = start + i;
+    return v;
+}
+
+} // namespace
+
+void TestRhiSlotBuffer::keyedSlotPersistsAcrossFrames()
+{
+    QCPRhiSlotBuffer buf;
+    const auto values = ramp(10);
+    buf.beginFrame();
+    const int offset = buf.write(1, values, true);
+    QVERIFY(buf.hasPendingUpload());
+
+    buf.beginFrame();
+    bool fill = true;
+    QCOMPARE(buf.acquire(1, 10, false, fill), offset);
+    QVERIFY(!fill);
+    QCOMPARE(buf.data()[offset + 9], 9.0f);
+}
+
+void TestRhiSlotBuffer::changedSlotRewritesInPlace()
+{
+    QCPRhiSlotBuffer buf;
+    buf.beginFrame();
+    const int offset = buf.write(1, ramp(10), true);
+
+    buf.beginFrame();
+    QCOMPARE(buf.write(1, ramp(10, 100), true), offset);
+    QCOMPARE(buf.data()[offset], 100.0f);
+
+    // A slightly shorter line still fits its range
+    buf.beginFrame();
+    QCOMPARE(buf.write(1, ramp(8), true), offset);
+}
+
+void TestRhiSlotBuffer::grownSlotMoves()
+{
+    QCPRhiSlotBuffer buf;
+    buf.beginFrame();
+    buf.write(1, ramp(8), true);
+    buf.write(2, ramp(8), true);
+
+    // Key 1 outgrows its range, which is freed behind key 2
+    buf.beginFrame();
+    const int offset2 = buf.write(2, ramp(8), false);
+    const int offset1 = buf.write(1, ramp(40), true);
+    QVERIFY(offset1 > offset2);
+    QCOMPARE(buf.data()[offset1 + 39], 39.0f);
+}
+
+void TestRhiSlotBuffer::unusedSlotIsReleased()
+{
+    QCPRhiSlotBuffer buf;
+    buf.beginFrame();
+    buf.write(1, ramp(10), true);
+    buf.write(2, ramp(10), true);
+    QCOMPARE(buf.slotCount(), 2);
+
+    buf.beginFrame();
+    buf.write(1, ramp(10), false);
+    buf.beginFrame(); // key 2 did not draw last frame
+    QCOMPARE(buf.slotCount(), 1);
+
+    buf.beginFrame(); // nor did key 1: the buffer is empty again
+    QCOMPARE(buf.slotCount(), 0);
+    QCOMPARE(buf.usedFloats(), 0);
+}
+
+void TestRhiSlotBuffer::freedRangeIsReused()
+{
+    QCPRhiSlotBuffer buf;
+    buf.beginFrame();
+    const int offset1 = buf.write(1, ramp(16), true);
+    buf.write(2, ramp(16), true);
+    const int used = buf.usedFloats();
+
+    buf.beginFrame();
+    buf.write(2, ramp(16), false);
+    buf.beginFrame();
+    buf.write(2, ramp(16), false);
+    QCOMPARE(buf.write(3, ramp(12), true), offset1);
+    QCOMPARE(buf.usedFloats(), used);
+}
+
+void TestRhiSlotBuffer::transientRangesLastOneFrame()
+{
+    QCPRhiSlotBuffer buf;
+    buf.beginFrame();
+    bool fill = false;
+    buf.acquire(0, 10, false, fill);
+    QVERIFY(fill); // unkeyed data is always written
+    QCOMPARE(buf.slotCount(), 0);
+    QCOMPARE(buf.usedFloats(), 10);
+
+    buf.beginFrame();
+    QCOMPARE(buf.usedFloats(), 0);
+}
+
+void TestRhiSlotBuffer::sameKeyTwiceInOneFrame()
+{
+    QCPRhiSlotBuffer buf;
+    buf.beginFrame();
+    const int first = buf.write(1, ramp(10), true);
+    const int second = buf.write(1, ramp(10, 50), false);
+    QVERIFY(second != first);
+    QCOMPARE(buf.data()[first], 0.0f);
+    QCOMPARE(buf.data()[second], 50.0f);
+}
+
+void TestRhiSlotBuffer::holdsComparesContents()
+{
+    QCPRhiSlotBuffer buf;
+    buf.beginFrame();
+    buf.write(1, ramp(10), true);
+
+    buf.beginFrame();
+    QVERIFY(buf.holds(1, ramp(10)));
+    QVERIFY(!buf.holds(1, ramp(10, 1)));
+    QVERIFY(!buf.holds(1, ramp(9)));
+    QVERIFY(!buf.holds(2, ramp(10)));
+    QVERIFY(!buf.holds(0, ramp(10)));
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <QtTest/QtTest>
+
+class TestRhiSlotBuffer : public QObject {
+    Q_OBJECT
+private slots:
+    void keyedSlotPersistsAcrossFrames();
+    void changedSlotRewritesInPlace();
+    void grownSlotMoves();
+    void unusedSlotIsReleased();
+    void freedRangeIsReused();
+    void transientRangesLastOneFrame();
+    void sameKeyTwiceInOneFrame();
+    void holdsComparesContents();
+};
@@ -1,6 +1,6 @@
 #!/usr/bin/env python
 from __future__ import print_function
-import re, sys, os, subprocess, time, math, argparse, platform, getpass
+import re, sys, os, subprocess, time, math, argparse, platform, getpass, json
 from collections import defaultdict
 
 # Define command line interface:
@@ -19,6 +19,16 @@ argparser.add_argument("-c", "--comment", default="",
                        help="Add a comment line to the benchmark output")
 argparser.add_argument("--anonymous", action="store_true",
                        help="Prevents user name and machine name to be included in the output.")
+argparser.add_argument("--json", action="store_true",
+                       help="Run the JSON-emitting scaling benchmark (tests/perf/scaling_bench) given by -x instead of the QTest one.")
+argparser.add_argument("--bench-args", default="",
+                       help="Extra arguments passed to the scaling benchmark in --json mode, e.g. \"--quick --only l1_build\".")
+argparser.add_argument("--baseline", default="",
+                       help="In --json mode, compare against this stored result file and flag regressions.")
+argparser.add_argument("--save", default="",
+                       help="In --json mode, store the results in this file (e.g. to become the next baseline).")
+argparser.add_argument("--tolerance", type=float, default=10.0,
+                       help="In --json mode, slowdown in percent of the median time beyond which a case counts as a regression.")
 config = argparser.parse_args()
 
 
@@ -37,6 +47,65 @@ if not os.path.isfile(config.executable):
     print("Benchmark executable not found:", config.executable)
     exit()
 
+
+# JSON mode: run the scaling benchmark once (it repeats each case itself),
+# then match cases to the baseline on suite plus parameters.
+def case_key(result):
+    return result["suite"] + " " + json.dumps(result["params"], sort_keys=True, separators=(",", ":"))
+
+
+def run_json_mode():
+    proc = subprocess.run([config.executable] + config.bench_args.split(), stdout=subprocess.PIPE)
+    if proc.returncode != 0:
+        print("Benchmark executable failed with exit code", proc.returncode)
+        return 2
+    current = json.loads(proc.stdout.decode('utf-8'))
+    if config.save:
+        with open(config.save, "w") as f:
+            json.dump(current, f, indent=2)
+
+    baseline = {}
+    if config.baseline:
+        with open(config.baseline) as f:
+            baseline = {case_key(r): r for r in json.load(f)["results"] if "median_ms" in r}
+
+    rows = []
+    regressions = 0
+    for r in current["results"]:
+        key = case_key(r)
+        if "median_ms" not in r:
+            rows.append((key, "skipped ({})".format(r.get("skipped", "?"))))
+            continue
+        line = "{: >10.3f} ms".format(r["median_ms"])
+        base = baseline.get(key)
+        if base:
+            change = (r["median_ms"] / base["median_ms"] - 1.0) * 100.0 if base["median_ms"] > 0 else 0.0
+            line += "  {:+7.1f}% vs {:.3f} ms".format(change, base["median_ms"])
+            if change > config.tolerance:
+                line += "  REGRESSION"
+                regressions += 1
+        elif config.baseline:
+            line += "  (new)"
+        rows.append((key, line))
+
+    if not config.quiet:
+        width = max([len(k) for k, _ in rows] + [0])
+        for key, line in rows:
+            print(key.ljust(width), line)
+        if config.baseline:
+            print("\n{} regression(s) beyond {:.0f}%".format(regressions, config.tolerance))
+    if config.log:
+        with open(config.logfile, "a") as logfile:
+            logfile.write("*** Scaling benchmark on " + time.strftime("%Y-%m-%d %H:%M", time.localtime()) + " ***\n")
+            for key, line in rows:
+                logfile.write(key + " " + line + "\n")
+            logfile.write("\n\n")
+    return 1 if regressions else 0
+
+
+if config.json:
+    sys.exit(run_json_mode())
+
 # Setup and start the actual benchmark loops
 results = defaultdict(list)
 namePattern = re.compile(r"RESULT : Benchmark::([^(]+)\(\):")
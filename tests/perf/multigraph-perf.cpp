@@ -4,7 +4,7 @@
 // Usage: multigraph_perf <scenario> [iterations]
 //
 // Scenarios:
-//   l1_resampling   — L1 bin-min-max (the heavy async stage)
+//   l1_resampling   — L1 bin-min-max (the heavy async stage), per SIMD kernel set
 //   l2_resampling   — L2 viewport rebinning (sync, per-zoom)
 //   full_replot     — full replot cycle (data→pixel→extrusion→composite)
 //   pan_replot      — cached-line pan replot (GPU translate path)
@@ -13,6 +13,7 @@
 
 #include <qcustomplot.h>
 #include <datasource/resampled-multi-datasource.h>
+#include <datasource/minmax-kernels.h>
 #include <QApplication>
 #include <QElapsedTimer>
 #include <csignal>
@@ -126,20 +127,49 @@ static void scenarioL1Resampling(int iters)
     QCPRange fullRange(data.keys.front(), data.keys.back());
     int numBins = qcp::algo::kLevel1TargetBins;
 
+    // Single-column source over the first column, for the graph (1D) path
+    auto graphSrc = std::make_shared<QCPSoADataSource<
+        std::span<const double>, std::span<const double>>>(
+        std::span<const double>(data.keys), std::span<const double>(data.columns[0]));
+
     fprintf(stderr, "l1_resampling: %d pts × %d cols, %d bins, %d iters\n",
             kDefaultPoints, kDefaultCols, numBins, iters);
     waitForProfiler();
 
-    QElapsedTimer timer;
-    timer.start();
-    for (int i = 0; i < iters; ++i) {
-        auto result = qcp::algo::binMinMaxMultiParallel(
-            *src, 0, src->size(), fullRange, numBins);
-        // Prevent optimizer from eliding
-        if (result.keys.empty()) abort();
+    // One pass per min/max kernel set the build and the CPU support
+    using qcp::algo::simd::Isa;
+    const Isa previous = qcp::algo::simd::minMaxKernels().isa;
+    for (Isa isa : {Isa::Scalar, Isa::Neon, Isa::Avx2, Isa::Avx512}) {
+        const auto* kernels = qcp::algo::simd::minMaxKernelsFor(isa);
+        if (!kernels)
+            continue;
+        qcp::algo::simd::setMinMaxIsa(isa);
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < iters; ++i) {
+            auto result = qcp::algo::binMinMaxMultiParallel(
+                *src, 0, src->size(), fullRange, numBins);
+            // Prevent optimizer from eliding
+            if (result.keys.empty()) abort();
+        }
+        double multiMs = timer.nsecsElapsed() / 1e6;
+
+        timer.restart();
+        for (int i = 0; i < iters; ++i) {
+            auto result = qcp::algo::binMinMaxParallel(
+                *graphSrc, 0, graphSrc->size(), fullRange, numBins);
+            if (result.keys.empty()) abort();
+        }
+        double graphMs = timer.nsecsElapsed() / 1e6;
+
+        fprintf(stderr, "  %-7s multi: %.1f ms/iter (%.0f Msamples/s), "
+                        "graph: %.1f ms/iter (%.0f Msamples/s)\n",
+                kernels->name,
+                multiMs / iters, double(kDefaultPoints) * kDefaultCols * iters / (multiMs * 1e3),
+                graphMs / iters, double(kDefaultPoints) * iters / (graphMs * 1e3));
     }
-    double ms = timer.nsecsElapsed() / 1e6;
-    fprintf(stderr, "  total: %.1f ms, per-iter: %.1f ms\n", ms, ms / iters);
+    qcp::algo::simd::setMinMaxIsa(previous);
 }
 
 static void scenarioL2Resampling(int iters)
@@ -0,0 +1,685 @@
+// Scaling benchmark for the zero-copy plottables (QCPGraph2, QCPMultiGraph,
+// QCPColorMap2, QCPHistogram2D) and the stages behind them.
+//
+// Sweeps the sample count N by decades, and per suite the column count,
+// worker thread count and storage type, then prints one JSON document on
+// stdout (progress goes to stderr). tests/benchmark/run-benchmark.py --json
+// runs it, keeps a baseline and flags regressions.
+//
+// Usage: scaling_bench [options]
+//   --min-n N         smallest sample count (default 1e5)
+//   --max-n N         largest sample count (default 1e9)
+//   --max-mem MiB     skip cases needing more memory (default: half the RAM)
+//   --threads a,b,..  worker counts for the parallel stages (default 1,ideal)
+//   --repeat R        timed runs per case (default 5)
+//   --only s1,s2,..   run only these suites
+//   --quick           N up to 1e6, 2 runs per case (smoke test)
+//   -o FILE           write the JSON there instead of stdout
+//
+// Suites:
+//   l1_build          QCPGraph2 L1 min/max pyramid build, per value type
+//   l2_rebuild        L2 rebuild from a built L1, full view and 1% zoom
+//   multigraph_l1     QCPMultiGraph L1 build, per column count
+//   colormap2_resample  QCPColorMap2 viewport resampling, per cell type
+//   histogram2d_bin   QCPHistogram2D fixed binning
+//   extrusion         polyline extrusion of pixel-space lines
+//   frame_pan / frame_zoom  replot cost of each plottable on pan and zoom
+
+#include <qcustomplot.h>
+#include <datasource/graph-resampler.h>
+#include <datasource/histogram-binner.h>
+#include <datasource/resample.h>
+#include <datasource/soa-datasource.h>
+#include <datasource/soa-datasource-2d.h>
+#include <datasource/soa-multi-datasource.h>
+#include <datasource/work-executor.h>
+#include <painting/line-extruder.h>
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QThread>
+#include <algorithm>
+#include <any>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <set>
+#include <span>
+#include <vector>
+#if defined(Q_OS_UNIX)
+#include <unistd.h>
+#endif
+
+namespace {
+
+// ── Options ─────────────────────────────────────────────────────
+
+struct Options {
+    qsizetype minN = 100'000;
+    qsizetype maxN = 1'000'000'000;
+    quint64 maxMemBytes = 0;
+    std::vector<int> threads;
+    int repeat = 5;
+    std::set<QString> only;
+    QString output;
+};
+
+Options gOpt;
+
+quint64 physicalMemory()
+{
+#if defined(Q_OS_UNIX) && defined(_SC_PHYS_PAGES)
+    const long pages = sysconf(_SC_PHYS_PAGES);
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && pageSize > 0)
+        return quint64(pages) * quint64(pageSize);
+#endif
+    return quint64(8) << 30;
+}
+
+std::vector<qsizetype> sampleCounts()
+{
+    std::vector<qsizetype> out;
+    for (qsizetype n = 100'000; n <= gOpt.maxN; n *= 10)
+        if (n >= gOpt.minN)
+            out.push_back(n);
+    return out;
+}
+
+bool enabled(const char* suite)
+{
+    return gOpt.only.empty() || gOpt.only.count(QString::fromLatin1(suite));
+}
+
+// ── Results ─────────────────────────────────────────────────────
+
+QJsonArray gResults;
+
+struct Params {
+    QJsonObject values;
+    Params& set(const char* key, qint64 v) { values[QLatin1String(key)] = v; return *this; }
+    Params& set(const char* key, const char* v) { values[QLatin1String(key)] = QLatin1String(v); return *this; }
+};
+
+void reportSkipped(const char* suite, const Params& params, const char* reason)
+{
+    QJsonObject r;
+    r[QStringLiteral("suite")] = QLatin1String(suite);
+    r[QStringLiteral("params")] = params.values;
+    r[QStringLiteral("skipped")] = QLatin1String(reason);
+    gResults.append(r);
+    fprintf(stderr, "  %-20s %s: skipped (%s)\n", suite,
+            QJsonDocument(params.values).toJson(QJsonDocument::Compact).constData(), reason);
+}
+
+// Times `body` gOpt.repeat times after one warm-up run; `samples` is the
+// work per run, for the throughput column.
+void measure(const char* suite, const Params& params, double samples,
+             const std::function<void()>& body)
+{
+    body();
+    std::vector<double> ms;
+    for (int i = 0; i < gOpt.repeat; ++i)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        body();
+        ms.push_back(timer.nsecsElapsed() * 1e-6);
+    }
+    std::sort(ms.begin(), ms.end());
+    const double median = ms[ms.size() / 2];
+    const double mean = std::accumulate(ms.begin(), ms.end(), 0.0) / ms.size();
+
+    QJsonObject r;
+    r[QStringLiteral("suite")] = QLatin1String(suite);
+    r[QStringLiteral("params")] = params.values;
+    r[QStringLiteral("runs")] = int(ms.size());
+    r[QStringLiteral("min_ms")] = ms.front();
+    r[QStringLiteral("median_ms")] = median;
+    r[QStringLiteral("mean_ms")] = mean;
+    if (samples > 0 && median > 0)
+        r[QStringLiteral("msamples_per_s")] = samples / (median * 1e3);
+    gResults.append(r);
+    fprintf(stderr, "  %-20s %s: %.3f ms\n", suite,
+            QJsonDocument(params.values).toJson(QJsonDocument::Compact).constData(), median);
+}
+
+// Cases past the memory budget are reported as skipped instead of run.
+bool fits(const char* suite, const Params& params, quint64 bytes)
+{
+    if (bytes <= gOpt.maxMemBytes)
+        return true;
+    reportSkipped(suite, params, "memory");
+    return false;
+}
+
+// ── Thread count control ────────────────────────────────────────
+
+// Runs `fn` as an outer job on a private executor of `threads` workers, so
+// the parallel loops inside it fan out over exactly those workers.
+class ThreadScope
+{
+public:
+    explicit ThreadScope(int threads) : mExecutor(threads)
+    {
+        mExecutor.registerOwner(this, 1);
+    }
+    ~ThreadScope() { mExecutor.unregisterOwner(this); }
+
+    void run(const std::function<void()>& fn)
+    {
+        std::mutex m;
+        std::condition_variable cv;
+        bool done = false;
+        mExecutor.submit(this, QCPWorkExecutor::Heavy, [&] {
+            fn();
+            std::lock_guard<std::mutex> lock(m);
+            done = true;
+            cv.notify_one();
+        });
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [&] { return done; });
+    }
+
+private:
+    QCPWorkExecutor mExecutor;
+};
+
+// ── Data generation ─────────────────────────────────────────────
+
+// Deterministic signal with enough structure for min/max binning to do work:
+// a slow ramp plus hashed noise, scaled into the range of T.
+template <typename T>
+T sampleValue(qsizetype i)
+{
+    const double noise = double((quint64(i) * 2654435761u >> 7) & 0x3ff) / 1024.0 - 0.5;
+    const double v = double((i / 1000) % 200) / 100.0 - 1.0 + 0.2 * noise;
+    if constexpr (std::is_integral_v<T>)
+        return static_cast<T>(v * 10000.0 + (std::is_signed_v<T> ? 0.0 : 20000.0));
+    else
+        return static_cast<T>(v);
+}
+
+std::vector<double> makeKeys(qsizetype n)
+{
+    std::vector<double> keys(n);
+    for (qsizetype i = 0; i < n; ++i)
+        keys[i] = double(i) * 1e-3;
+    return keys;
+}
+
+template <typename T>
+std::vector<T> makeValues(qsizetype n, qsizetype offset = 0)
+{
+    std::vector<T> values(n);
+    for (qsizetype i = 0; i < n; ++i)
+        values[i] = sampleValue<T>(i + offset);
+    return values;
+}
+
+template <typename F>
+void forEachValueType(F&& f)
+{
+    f(double{}, "f64");
+    f(float{}, "f32");
+    f(std::int16_t{}, "i16");
+}
+
+// ── Suites ──────────────────────────────────────────────────────
+
+void suiteL1Build()
+{
+    const char* suite = "l1_build";
+    for (qsizetype n : sampleCounts())
+    {
+        forEachValueType([&](auto tag, const char* dtype) {
+            using V = decltype(tag);
+            Params base;
+            base.set("n", n).set("dtype", dtype);
+            if (!fits(suite, base, quint64(n) * (sizeof(double) + sizeof(V))))
+                return;
+            try
+            {
+                const auto keys = makeKeys(n);
+                const auto values = makeValues<V>(n);
+                QCPSoADataSource<std::span<const double>, std::span<const V>> src(
+                    std::span<const double>(keys), std::span<const V>(values));
+                for (int t : gOpt.threads)
+                {
+                    Params p = base;
+                    p.set("threads", t);
+                    ThreadScope scope(t);
+                    measure(suite, p, double(n), [&] {
+                        scope.run([&] {
+                            std::any cache;
+                            qcp::algo::buildL1Cache(src, ViewportParams{}, cache);
+                        });
+                    });
+                }
+            }
+            catch (const std::bad_alloc&)
+            {
+                reportSkipped(suite, base, "allocation");
+            }
+        });
+    }
+}
+
+void suiteL2Rebuild()
+{
+    const char* suite = "l2_rebuild";
+    for (qsizetype n : sampleCounts())
+    {
+        Params base;
+        base.set("n", n).set("dtype", "f64");
+        if (!fits(suite, base, quint64(n) * 2 * sizeof(double)))
+            continue;
+        try
+        {
+            const auto keys = makeKeys(n);
+            const auto values = makeValues<double>(n);
+            QCPSoADataSource<std::span<const double>, std::span<const double>> src(
+                std::span<const double>(keys), std::span<const double>(values));
+            std::any cache;
+            qcp::algo::buildL1Cache(src, ViewportParams{}, cache);
+            const auto* l1 = std::any_cast<qcp::algo::GraphResamplerCache>(&cache);
+            if (!l1)
+            {
+                reportSkipped(suite, base, "below resampling threshold");
+                continue;
+            }
+            const QCPRange full(keys.front(), keys.back());
+            for (int zoomPercent : {100, 1})
+            {
+                ViewportParams vp;
+                const double mid = full.center();
+                const double half = full.size() * zoomPercent / 200.0;
+                vp.keyRange = QCPRange(mid - half, mid + half);
+                vp.plotWidthPx = 1920;
+                vp.plotHeightPx = 1080;
+                Params p = base;
+                p.set("zoom_percent", zoomPercent);
+                measure(suite, p, 0, [&] { qcp::algo::resampleL2(*l1, vp, &src); });
+            }
+        }
+        catch (const std::bad_alloc&)
+        {
+            reportSkipped(suite, base, "allocation");
+        }
+    }
+}
+
+void suiteMultiGraphL1()
+{
+    const char* suite = "multigraph_l1";
+    for (qsizetype n : sampleCounts())
+    {
+        for (int columns : {1, 8, 64})
+        {
+            Params base;
+            base.set("n", n).set("columns", columns).set("dtype", "f64");
+            if (!fits(suite, base, quint64(n) * (columns + 1) * sizeof(double)))
+                continue;
+            try
+            {
+                const auto keys = makeKeys(n);
+                std::vector<std::vector<double>> data;
+                std::vector<std::span<const double>> spans;
+                for (int c = 0; c < columns; ++c)
+                {
+                    data.push_back(makeValues<double>(n, c * 977));
+                    spans.emplace_back(data.back());
+                }
+                QCPSoAMultiDataSource<std::span<const double>, std::span<const double>> src(
+                    std::span<const double>(keys), std::move(spans));
+                for (int t : gOpt.threads)
+                {
+                    Params p = base;
+                    p.set("threads", t);
+                    ThreadScope scope(t);
+                    measure(suite, p, double(n) * columns, [&] {
+                        scope.run([&] {
+                            std::any cache;
+                            qcp::algo::buildL1CacheMulti(src, ViewportParams{}, cache);
+                        });
+                    });
+                }
+            }
+            catch (const std::bad_alloc&)
+            {
+                reportSkipped(suite, base, "allocation");
+            }
+        }
+    }
+}
+
+void suiteColormapResample()
+{
+    const char* suite = "colormap2_resample";
+    constexpr int ny = 256;
+    auto runType = [&](auto tag, const char* dtype, qsizetype n) {
+        using Z = decltype(tag);
+        const qsizetype nx = n / ny;
+        Params base;
+        base.set("n", n).set("ny", ny).set("dtype", dtype);
+        if (!fits(suite, base, quint64(n) * sizeof(Z) + quint64(nx) * sizeof(double)))
+            return;
+        try
+        {
+            const auto x = makeKeys(nx);
+            std::vector<double> y(ny);
+            std::iota(y.begin(), y.end(), 0.0);
+            const auto z = makeValues<Z>(n);
+            QCPSoADataSource2D<std::span<const double>, std::span<const double>, std::span<const Z>>
+                src(std::span<const double>(x), std::span<const double>(y), std::span<const Z>(z));
+            const QCPRange xRange(x.front(), x.back());
+            const QCPRange yRange(y.front(), y.back());
+            for (int t : gOpt.threads)
+            {
+                Params p = base;
+                p.set("threads", t);
+                ThreadScope scope(t);
+                qcp::algo2d::ResampleCache cache;
+                measure(suite, p, double(n), [&] {
+                    scope.run([&] {
+                        delete qcp::algo2d::resample(src, 0, nx, xRange, yRange, 1920, 1080,
+                                                     false, 0.0, &cache);
+                    });
+                });
+            }
+        }
+        catch (const std::bad_alloc&)
+        {
+            reportSkipped(suite, base, "allocation");
+        }
+    };
+    for (qsizetype n : sampleCounts())
+    {
+        runType(double{}, "f64", n);
+        runType(float{}, "f32", n);
+        runType(std::uint16_t{}, "u16", n);
+    }
+}
+
+void suiteHistogramBin()
+{
+    const char* suite = "histogram2d_bin";
+    for (qsizetype n : sampleCounts())
+    {
+        Params base;
+        base.set("n", n).set("bins", 512).set("dtype", "f64");
+        if (!fits(suite, base, quint64(n) * 2 * sizeof(double)))
+            continue;
+        try
+        {
+            const auto keys = makeKeys(n);
+            const auto values = makeValues<double>(n);
+            QCPSoADataSource<std::span<const double>, std::span<const double>> src(
+                std::span<const double>(keys), std::span<const double>(values));
+            for (int t : gOpt.threads)
+            {
+                Params p = base;
+                p.set("threads", t);
+                ThreadScope scope(t);
+                measure(suite, p, double(n), [&] {
+                    scope.run([&] { delete qcp::algo::bin2d(src, 512, 512); });
+                });
+            }
+        }
+        catch (const std::bad_alloc&)
+        {
+            reportSkipped(suite, base, "allocation");
+        }
+    }
+}
+
+// Extrusion works on pixel-space lines, whose length is bounded by the
+// resampled output (a few points per pixel column), not by N.
+void suiteExtrusion()
+{
+    const char* suite = "extrusion";
+    for (int points : {1'000, 10'000, 100'000, 1'000'000})
+    {
+        QVector<QPointF> line(points);
+        for (int i = 0; i < points; ++i)
+            line[i] = QPointF(i * 1920.0 / points, 540.0 + 400.0 * sampleValue<double>(i * 1000));
+        for (float width : {1.0f, 3.0f})
+        {
+            Params p;
+            p.set("points", points).set("pen_width", qint64(width));
+            std::vector<float> out;
+            measure(suite, p, double(points), [&] {
+                QCPLineExtruder::extrudePolyline(line, width, out);
+            });
+        }
+    }
+}
+
+// ── Frame cost ──────────────────────────────────────────────────
+
+void pumpUntilIdle(const std::function<bool()>& busy, int timeoutMs = 600'000)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (busy() && timer.elapsed() < timeoutMs)
+        QApplication::processEvents(QEventLoop::AllEvents, 5);
+    QApplication::processEvents();
+}
+
+// Pan: 0.5% steps replotted right away (translation fast path plus async
+// follow-up). Zoom: 10% steps, each waited on until the pipeline has
+// delivered, then replotted — the latency a user sees per wheel notch.
+void measureFrames(const char* plottable, qsizetype n, QCustomPlot* plot,
+                   const std::function<bool()>& busy)
+{
+    plot->rescaleAxes();
+    plot->replot(QCustomPlot::rpImmediateRefresh);
+    pumpUntilIdle(busy);
+    plot->replot(QCustomPlot::rpImmediateRefresh);
+
+    Params p;
+    p.set("plottable", plottable).set("n", n);
+    measure("frame_pan", p, 0, [&] {
+        for (int i = 0; i < 20; ++i)
+        {
+            const QCPRange r = plot->xAxis->range();
+            const double step = r.size() * 0.005;
+            plot->xAxis->setRange(r.lower + step, r.upper + step);
+            plot->replot(QCustomPlot::rpImmediateRefresh);
+            QApplication::processEvents();
+        }
+    });
+    measure("frame_zoom", p, 0, [&] {
+        for (int i = 0; i < 5; ++i)
+        {
+            plot->xAxis->scaleRange(i % 2 ? 1.0 / 0.9 : 0.9);
+            plot->replot(QCustomPlot::rpImmediateRefresh);
+            pumpUntilIdle(busy);
+            plot->replot(QCustomPlot::rpImmediateRefresh);
+        }
+    });
+}
+
+std::unique_ptr<QCustomPlot> makePlot()
+{
+    auto plot = std::make_unique<QCustomPlot>();
+    plot->resize(1920, 1080);
+    plot->show();
+    QElapsedTimer timer;
+    timer.start();
+    while (!plot->rhi() && timer.elapsed() < 5000)
+        QApplication::processEvents(QEventLoop::AllEvents, 50);
+    return plot;
+}
+
+void suiteFrames()
+{
+    for (qsizetype n : sampleCounts())
+    {
+        Params base;
+        base.set("n", n);
+        if (!fits("frame_pan", base, quint64(n) * 10 * sizeof(double)))
+            continue;
+        try
+        {
+            const auto keys = makeKeys(n);
+            const auto values = makeValues<double>(n);
+            {
+                auto plot = makePlot();
+                auto* graph = new QCPGraph2(plot->xAxis, plot->yAxis);
+                graph->viewData(keys.data(), values.data(), n);
+                measureFrames("graph2", n, plot.get(), [graph] { return graph->pipeline().isBusy(); });
+            }
+            {
+                const auto values2 = makeValues<double>(n, 977);
+                auto plot = makePlot();
+                auto* mg = new QCPMultiGraph(plot->xAxis, plot->yAxis);
+                mg->viewData(std::span<const double>(keys),
+                             std::vector<std::span<const double>>{values, values2});
+                measureFrames("multigraph", n, plot.get(), [mg] { return mg->pipeline().isBusy(); });
+            }
+            {
+                constexpr int ny = 256;
+                const qsizetype nx = n / ny;
+                std::vector<double> y(ny);
+                std::iota(y.begin(), y.end(), 0.0);
+                auto plot = makePlot();
+                auto* cmap = new QCPColorMap2(plot->xAxis, plot->yAxis);
+                cmap->viewData(keys.data(), nx, y.data(), ny, values.data(), nx * ny);
+                measureFrames("colormap2", n, plot.get(), [cmap] { return cmap->pipeline().isBusy(); });
+            }
+            {
+                auto plot = makePlot();
+                auto* hist = new QCPHistogram2D(plot->xAxis, plot->yAxis);
+                hist->setBinningMode(QCPHistogram2D::bmViewport);
+                hist->viewData(keys.data(), values.data(), n);
+                measureFrames("histogram2d", n, plot.get(), [hist] { return hist->pipeline().isBusy(); });
+            }
+        }
+        catch (const std::bad_alloc&)
+        {
+            reportSkipped("frame_pan", base, "allocation");
+        }
+    }
+}
+
+// ── Main ────────────────────────────────────────────────────────
+
+std::vector<int> parseList(const char* s)
+{
+    std::vector<int> out;
+    for (const QString& part : QString::fromLatin1(s).split(QLatin1Char(','), Qt::SkipEmptyParts))
+        out.push_back(part.toInt());
+    return out;
+}
+
+qsizetype parseCount(const char* s)
+{
+    return static_cast<qsizetype>(QString::fromLatin1(s).toDouble());
+}
+
+struct Suite {
+    const char* name;
+    void (*fn)();
+};
+
+const Suite kSuites[] = {
+    {"l1_build", suiteL1Build},
+    {"l2_rebuild", suiteL2Rebuild},
+    {"multigraph_l1", suiteMultiGraphL1},
+    {"colormap2_resample", suiteColormapResample},
+    {"histogram2d_bin", suiteHistogramBin},
+    {"extrusion", suiteExtrusion},
+    {"frames", suiteFrames},
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QApplication app(argc, argv);
+
+    gOpt.maxMemBytes = physicalMemory() / 2;
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* a = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (!strcmp(a, "--min-n") && hasValue)
+            gOpt.minN = parseCount(argv[++i]);
+        else if (!strcmp(a, "--max-n") && hasValue)
+            gOpt.maxN = parseCount(argv[++i]);
+        else if (!strcmp(a, "--max-mem") && hasValue)
+            gOpt.maxMemBytes = quint64(parseCount(argv[++i])) << 20;
+        else if (!strcmp(a, "--threads") && hasValue)
+            gOpt.threads = parseList(argv[++i]);
+        else if (!strcmp(a, "--repeat") && hasValue)
+            gOpt.repeat = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(a, "--only") && hasValue)
+        {
+            for (const QString& s : QString::fromLatin1(argv[++i]).split(QLatin1Char(',')))
+                gOpt.only.insert(s);
+        }
+        else if (!strcmp(a, "--quick"))
+        {
+            gOpt.maxN = std::min<qsizetype>(gOpt.maxN, 1'000'000);
+            gOpt.repeat = 2;
+        }
+        else if (!strcmp(a, "-o") && hasValue)
+            gOpt.output = QString::fromLocal8Bit(argv[++i]);
+        else
+        {
+            fprintf(stderr, "Unknown or incomplete option: %s (see the header of scaling-bench.cpp)\n", a);
+            return 1;
+        }
+    }
+    if (gOpt.threads.empty())
+    {
+        gOpt.threads = {1};
+        if (QThread::idealThreadCount() > 1)
+            gOpt.threads.push_back(QThread::idealThreadCount());
+    }
+
+    for (const Suite& s : kSuites)
+    {
+        if (!enabled(s.name))
+            continue;
+        fprintf(stderr, "%s\n", s.name);
+        s.fn();
+    }
+
+    QJsonObject machine;
+    machine[QStringLiteral("cpu")] = QSysInfo::currentCpuArchitecture();
+    machine[QStringLiteral("os")] = QSysInfo::prettyProductName();
+    machine[QStringLiteral("ideal_threads")] = QThread::idealThreadCount();
+    machine[QStringLiteral("qt")] = QLatin1String(qVersion());
+
+    QJsonObject doc;
+    doc[QStringLiteral("format")] = QStringLiteral("neoqcp-scaling-bench");
+    doc[QStringLiteral("version")] = 1;
+    doc[QStringLiteral("machine")] = machine;
+    doc[QStringLiteral("results")] = gResults;
+    const QByteArray json = QJsonDocument(doc).toJson(QJsonDocument::Indented);
+
+    if (gOpt.output.isEmpty())
+    {
+        fwrite(json.constData(), 1, size_t(json.size()), stdout);
+        return 0;
+    }
+    QFile file(gOpt.output);
+    if (!file.open(QIODevice::WriteOnly) || file.write(json) != json.size())
+    {
+        fprintf(stderr, "Cannot write %s\n", qPrintable(gOpt.output));
+        return 1;
+    }
+    return 0;
+}